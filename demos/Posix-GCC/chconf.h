@@ -44,6 +44,26 @@
 #define CH_FREQUENCY                    1000
 #endif
 
+/**
+ * @brief   Tickless mode minimum delta.
+ * @details If this value is greater than zero then the kernel works in
+ *          tickless mode, the periodic system tick is replaced by a
+ *          one-shot alarm programmed on the next virtual timer deadline and
+ *          the system time is read from a free-running counter. The value is
+ *          the minimum number of ticks an alarm can be programmed ahead of
+ *          the current time.
+ *          Setting this value to zero selects the classic periodic tick.
+ *
+ * @note    Tickless mode allows for much higher @p CH_FREQUENCY values
+ *          without the interrupts overhead, the port must implement the
+ *          @p port_timer_xxx() hooks.
+ * @note    Tickless mode requires @p CH_TIME_QUANTUM set to zero and
+ *          @p CH_DBG_THREADS_PROFILING disabled.
+ */
+#if !defined(CH_TIMEDELTA) || defined(__DOXYGEN__)
+#define CH_TIMEDELTA                    0
+#endif
+
 /**
  * @brief   Round robin interval.
  * @details This constant is the number of system ticks allowed for the
@@ -112,6 +132,64 @@
 #define CH_OPTIMIZE_SPEED               TRUE
 #endif
 
+/**
+ * @brief   Constant time ready list.
+ * @details If enabled then the ready list keeps track of the last thread of
+ *          each priority level and of the non-empty levels using a bitmap,
+ *          threads insertion and removal become constant time operations
+ *          regardless of the number of ready threads.
+ *
+ * @note    The default is @p FALSE.
+ * @note    This option increases the size of the @p ReadyList structure
+ *          by one pointer per priority level plus the bitmap, it is only
+ *          useful in systems with many ready threads at different
+ *          priorities.
+ */
+#if !defined(CH_USE_READYLIST_BITMAP) || defined(__DOXYGEN__)
+#define CH_USE_READYLIST_BITMAP         FALSE
+#endif
+
+/**
+ * @brief   Virtual timers timing wheel.
+ * @details If enabled then the virtual timers are kept in a hierarchical
+ *          timing wheel instead of a delta list, setting and resetting a
+ *          timer become constant time operations and the system tick
+ *          processing is constant time when amortized.
+ *
+ * @note    The default is @p FALSE.
+ * @note    The wheel requires @p VT_WHEEL_LEVELS * 2^VT_WHEEL_BITS list
+ *          headers in the @p VTList structure, it is only useful in systems
+ *          with a large number of armed timers.
+ */
+#if !defined(CH_USE_TIMING_WHEEL) || defined(__DOXYGEN__)
+#define CH_USE_TIMING_WHEEL             FALSE
+#endif
+
+/**
+ * @brief   Atomic fast paths.
+ * @details If enabled then the uncontended wait/signal operations on
+ *          semaphores and lock/unlock operations on mutexes are performed
+ *          using the port compare and swap, the kernel lock is only entered
+ *          in order to queue or wake threads.
+ *
+ * @note    The default is @p FALSE.
+ * @note    The option has effect only on ports implementing the word
+ *          compare and swap (@p PORT_SUPPORTS_CAS), on the other ports the
+ *          kernel lock is still used.
+ * @note    Operations on priority ceiling mutexes always take the locked
+ *          path. The fast paths record their events in the tracer
+ *          (@p CH_USE_TRACE) and update the lock statistics
+ *          (@p CH_DBG_LOCK_STATISTICS).
+ * @note    In this demo the fast paths follow @p POSIX_USE_SIGNALS. With
+ *          signals the kernel lock is a system call and the fast paths are
+ *          more than twenty times faster, in polling mode the kernel lock
+ *          costs nothing and the locked compare and swap makes the fast
+ *          paths about 15-20% slower.
+ */
+#if !defined(CH_USE_ATOMIC_FASTPATH) || defined(__DOXYGEN__)
+#define CH_USE_ATOMIC_FASTPATH          POSIX_USE_SIGNALS
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -131,6 +209,20 @@
 #define CH_USE_REGISTRY                 TRUE
 #endif
 
+/**
+ * @brief   Threads registry index.
+ * @details If enabled then the registry assigns a stable numeric
+ *          identifier to each thread and keeps an identifiers table and a
+ *          names hash table, threads can be looked up by identifier or by
+ *          name in constant time.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_REGISTRY.
+ */
+#if !defined(CH_USE_REGISTRY_INDEX) || defined(__DOXYGEN__)
+#define CH_USE_REGISTRY_INDEX           TRUE
+#endif
+
 /**
  * @brief   Threads synchronization APIs.
  * @details If enabled then the @p chThdWait() function is included in
@@ -186,6 +278,20 @@
 #define CH_USE_MUTEXES                  TRUE
 #endif
 
+/**
+ * @brief   Priority ceiling mutexes.
+ * @details If enabled then mutexes can be initialized with a priority
+ *          ceiling using @p chMtxInitCeiling(), such mutexes implement the
+ *          immediate priority ceiling protocol instead of the priority
+ *          inheritance protocol.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_MUTEXES.
+ */
+#if !defined(CH_USE_MUTEXES_CEILING) || defined(__DOXYGEN__)
+#define CH_USE_MUTEXES_CEILING          TRUE
+#endif
+
 /**
  * @brief   Conditional Variables APIs.
  * @details If enabled then the conditional variables APIs are included
@@ -210,6 +316,17 @@
 #define CH_USE_CONDVARS_TIMEOUT         TRUE
 #endif
 
+/**
+ * @brief   Readers-Writer Locks APIs.
+ * @details If enabled then the readers-writer locks APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#if !defined(CH_USE_RWLOCKS) || defined(__DOXYGEN__)
+#define CH_USE_RWLOCKS                  TRUE
+#endif
+
 /**
  * @brief   Events Flags APIs.
  * @details If enabled then the event flags APIs are included in the kernel.
@@ -267,6 +384,31 @@
 #define CH_USE_MAILBOXES                TRUE
 #endif
 
+/**
+ * @brief   Message Queues APIs.
+ * @details If enabled then the asynchronous message queues APIs are
+ *          included in the kernel, the message queues transfer memory pool
+ *          buffers between threads without copying the payload.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_SEMAPHORES and @p CH_USE_MEMPOOLS.
+ */
+#if !defined(CH_USE_MSGQUEUES) || defined(__DOXYGEN__)
+#define CH_USE_MSGQUEUES                TRUE
+#endif
+
+/**
+ * @brief   Message Queues delivery mode.
+ * @details If enabled then the messages are delivered by buffer priority
+ *          rather than in FIFO order.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_MSGQUEUES.
+ */
+#if !defined(CH_USE_MSGQUEUES_PRIORITY) || defined(__DOXYGEN__)
+#define CH_USE_MSGQUEUES_PRIORITY       FALSE
+#endif
+
 /**
  * @brief   I/O Queues APIs.
  * @details If enabled then the I/O queues APIs are included in the kernel.
@@ -277,6 +419,33 @@
 #define CH_USE_QUEUES                   TRUE
 #endif
 
+/**
+ * @brief   Ring Buffers and Doorbells APIs.
+ * @details If enabled then the lock-free ring buffers and doorbells APIs
+ *          are included in the kernel, they allow interrupt handlers above
+ *          the kernel priority to pass data to threads and wake them.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_USE_RINGBUFFERS) || defined(__DOXYGEN__)
+#define CH_USE_RINGBUFFERS              TRUE
+#endif
+
+/**
+ * @brief   Wait Sets APIs.
+ * @details If enabled then the wait sets APIs are included in the kernel,
+ *          a wait set allows a thread to wait on several semaphores,
+ *          mailboxes, input queues and event sources at once.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_SEMAPHORES.
+ * @note    Semaphores and I/O queues are one pointer larger when this
+ *          option is enabled.
+ */
+#if !defined(CH_USE_WAITSETS) || defined(__DOXYGEN__)
+#define CH_USE_WAITSETS                 TRUE
+#endif
+
 /**
  * @brief   Core Memory Manager APIs.
  * @details If enabled then the core memory manager APIs are included
@@ -316,6 +485,24 @@
 #define CH_USE_MALLOC_HEAP              FALSE
 #endif
 
+/**
+ * @brief   TLSF heap allocator.
+ * @details If enabled the heap allocator uses a Two-Level Segregated Fit
+ *          strategy instead of first-fit, blocks allocation and release
+ *          are constant time operations regardless of the number of free
+ *          blocks and the fragmentation is bounded.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_HEAP and is not compatible with
+ *          @p CH_USE_MALLOC_HEAP.
+ * @note    This option increases the size of the @p MemoryHeap structure
+ *          by the segregated lists headers and of each heap block header
+ *          by one pointer.
+ */
+#if !defined(CH_USE_HEAP_TLSF) || defined(__DOXYGEN__)
+#define CH_USE_HEAP_TLSF                FALSE
+#endif
+
 /**
  * @brief   Memory Pools Allocator APIs.
  * @details If enabled then the memory pools allocator APIs are included
@@ -327,6 +514,26 @@
 #define CH_USE_MEMPOOLS                 TRUE
 #endif
 
+/**
+ * @brief   Lock-free Memory Pools.
+ * @details If enabled then the memory pools free lists are managed using
+ *          ABA-safe atomic operations instead of the kernel lock. Objects
+ *          can be allocated and released from any context, including
+ *          interrupts above the kernel priority.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_MEMPOOLS.
+ * @note    The option has effect only on ports implementing either the
+ *          double word compare and swap (@p PORT_SUPPORTS_CAS2) used on a
+ *          tagged list head or the load-linked/store-conditional list pop
+ *          (@p PORT_SUPPORTS_LLSC) used on a plain list head, the ARMv7-M
+ *          port implements the latter. On the other ports the kernel lock
+ *          is still used.
+ */
+#if !defined(CH_USE_MEMPOOLS_LOCKFREE) || defined(__DOXYGEN__)
+#define CH_USE_MEMPOOLS_LOCKFREE        FALSE
+#endif
+
 /**
  * @brief   Dynamic Threads APIs.
  * @details If enabled then the dynamic threads creation APIs are included
@@ -340,6 +547,59 @@
 #define CH_USE_DYNAMIC                  TRUE
 #endif
 
+/**
+ * @brief   Thread Cache APIs.
+ * @details If enabled then the working areas of the threads created from
+ *          a thread cache are retained after termination and reused by
+ *          the next threads creation, avoiding the heap allocator in the
+ *          dynamic threads create/exit cycles.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_DYNAMIC and @p CH_USE_HEAP.
+ * @note    Not compatible with @p CH_USE_MALLOC_HEAP.
+ */
+#if !defined(CH_USE_THREAD_CACHE) || defined(__DOXYGEN__)
+#define CH_USE_THREAD_CACHE             TRUE
+#endif
+
+/**
+ * @brief   Work Queues APIs.
+ * @details If enabled then the work queues APIs are included in the kernel,
+ *          a work queue defers the execution of functions to a pool of
+ *          worker threads.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_SEMAPHORES and @p CH_USE_MEMPOOLS.
+ */
+#if !defined(CH_USE_WORKQUEUES) || defined(__DOXYGEN__)
+#define CH_USE_WORKQUEUES               TRUE
+#endif
+
+/**
+ * @brief   Stackless Tasks APIs.
+ * @details If enabled then the stackless tasks APIs are included in the
+ *          kernel, the stackless tasks are coroutines executed by an host
+ *          thread without a dedicated stack.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_WAITSETS and @p CH_USE_EVENTS.
+ */
+#if !defined(CH_USE_TASKS) || defined(__DOXYGEN__)
+#define CH_USE_TASKS                    TRUE
+#endif
+
+/**
+ * @brief   Kernel events tracer.
+ * @details If enabled then the kernel records context switches, ISRs,
+ *          synchronization primitives operations, timers and user events
+ *          as timestamped binary records into a circular buffer.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_USE_TRACE) || defined(__DOXYGEN__)
+#define CH_USE_TRACE                    TRUE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -433,6 +693,56 @@
 #define CH_DBG_THREADS_PROFILING        TRUE
 #endif
 
+/**
+ * @brief   Debug option, runtime statistics.
+ * @details If enabled then the time spent by each thread and by the ISRs is
+ *          measured at each context switch and ISR boundary using the port
+ *          realtime counter, the switches count and the longest run burst
+ *          of each thread are also recorded.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires a port supporting the realtime counter.
+ */
+#if !defined(CH_DBG_STATISTICS) || defined(__DOXYGEN__)
+#define CH_DBG_STATISTICS               TRUE
+#endif
+
+/**
+ * @brief   Debug option, lock statistics.
+ * @details If enabled then the acquisitions, the contentions, the wait
+ *          times and the hold times of each mutex and semaphore are
+ *          recorded using the port realtime counter. The objects named
+ *          using @p chMtxSetName() or @p chSemSetName() are listed in a
+ *          global list that can be dumped by the shell.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires a port supporting the realtime counter.
+ * @note    The atomic fast paths of mutexes and semaphores
+ *          (@p CH_USE_ATOMIC_FASTPATH) remain active and update the
+ *          statistics too, the acquisitions of semaphores through the fast
+ *          path are counted using the port compare and swap.
+ */
+#if !defined(CH_DBG_LOCK_STATISTICS) || defined(__DOXYGEN__)
+#define CH_DBG_LOCK_STATISTICS          TRUE
+#endif
+
+/**
+ * @brief   Debug option, mutex deadlocks and priority inversions detection.
+ * @details If enabled then the chain of the mutex owners is explored each
+ *          time a thread is about to wait on a mutex, if the chain leads
+ *          back to the waiting thread then the chain is reported through
+ *          the @p MUTEX_DEADLOCK_HOOK() and the system panics. Threads whose
+ *          priority has been raised by the priority inheritance for longer
+ *          than @p CH_INVERSION_THRESHOLD are reported through the
+ *          @p MUTEX_INVERSION_HOOK().
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_MUTEXES.
+ */
+#if !defined(CH_DBG_DEADLOCK_DETECTION) || defined(__DOXYGEN__)
+#define CH_DBG_DEADLOCK_DETECTION       TRUE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -521,6 +831,40 @@
 }
 #endif
 
+/**
+ * @brief   Mutex deadlock hook.
+ * @details This hook is invoked when a thread is about to wait on a mutex
+ *          closing a cycle of mutex owners, the system panics when the hook
+ *          returns.
+ * @note    Requires @p CH_DBG_DEADLOCK_DETECTION.
+ *
+ * @param[in] drp       pointer to the @p deadlock_report_t describing the
+ *                      cycle
+ */
+#if !defined(MUTEX_DEADLOCK_HOOK) || defined(__DOXYGEN__)
+#define MUTEX_DEADLOCK_HOOK(drp) {                                          \
+  /* Deadlock report code here.*/                                           \
+}
+#endif
+
+/**
+ * @brief   Priority inversion hook.
+ * @details This hook is invoked when the priority of a mutex owner has been
+ *          raised by the priority inheritance for longer than
+ *          @p CH_INVERSION_THRESHOLD.
+ * @note    The hook is invoked within the kernel lock, usually from the
+ *          system timer ISR context when the threshold expires.
+ * @note    Requires @p CH_DBG_DEADLOCK_DETECTION.
+ *
+ * @param[in] tp        pointer to the boosted thread
+ * @param[in] time      duration of the boost in system ticks
+ */
+#if !defined(MUTEX_INVERSION_HOOK) || defined(__DOXYGEN__)
+#define MUTEX_INVERSION_HOOK(tp, time) {                                    \
+  /* Priority inversion report code here.*/                                 \
+}
+#endif
+
 /** @} */
 
 /*===========================================================================*/
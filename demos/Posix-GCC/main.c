@@ -55,13 +55,21 @@ static void cmd_threads(BaseSequentialStream *chp, int argc, char *argv[]) {
     chprintf(chp, "Usage: threads\r\n");
     return;
   }
+#if CH_DBG_THREADS_PROFILING
   chprintf(chp, "    addr    stack prio refs     state time\r\n");
+#else
+  chprintf(chp, "    addr    stack prio refs     state\r\n");
+#endif
   tp = chRegFirstThread();
   do {
-    chprintf(chp, "%.8lx %.8lx %4lu %4lu %9s %lu\r\n",
-            (uint32_t)tp, (uint32_t)tp->p_ctx.esp,
-            (uint32_t)tp->p_prio, (uint32_t)(tp->p_refs - 1),
-            states[tp->p_state], (uint32_t)tp->p_time);
+    chprintf(chp, "%.8lx %.8lx %4lu %4lu %9s",
+            (unsigned long)tp, (unsigned long)tp->p_ctx.esp,
+            (unsigned long)tp->p_prio, (unsigned long)(tp->p_refs - 1),
+            states[tp->p_state]);
+#if CH_DBG_THREADS_PROFILING
+    chprintf(chp, " %lu", (unsigned long)tp->p_time);
+#endif
+    chprintf(chp, "\r\n");
     tp = chRegNextThread(tp);
   } while (tp != NULL);
 }
@@ -83,10 +91,68 @@ static void cmd_test(BaseSequentialStream *chp, int argc, char *argv[]) {
   chThdWait(tp);
 }
 
+#if CH_USE_TRACE
+/*
+ * Stream writing into a host file, used for saving the trace dumps.
+ */
+typedef struct {
+  const struct BaseSequentialStreamVMT *vmt;
+  FILE *fp;
+} HostFileStream;
+
+static size_t hfs_write(void *ip, const uint8_t *bp, size_t n) {
+
+  return fwrite(bp, 1, n, ((HostFileStream *)ip)->fp);
+}
+
+static size_t hfs_read(void *ip, uint8_t *bp, size_t n) {
+
+  return fread(bp, 1, n, ((HostFileStream *)ip)->fp);
+}
+
+static msg_t hfs_put(void *ip, uint8_t b) {
+
+  return fputc(b, ((HostFileStream *)ip)->fp) == EOF ? RDY_RESET : RDY_OK;
+}
+
+static msg_t hfs_get(void *ip) {
+  int c = fgetc(((HostFileStream *)ip)->fp);
+
+  return c == EOF ? RDY_RESET : (msg_t)c;
+}
+
+static const struct BaseSequentialStreamVMT hfs_vmt = {
+  hfs_write, hfs_read, hfs_put, hfs_get
+};
+
+static void cmd_trace(BaseSequentialStream *chp, int argc, char *argv[]) {
+  HostFileStream hfs = {&hfs_vmt, NULL};
+  const char *name = argc > 0 ? argv[0] : "trace.bin";
+  size_t n;
+
+  if (argc > 1) {
+    chprintf(chp, "Usage: trace [file]\r\n");
+    return;
+  }
+  hfs.fp = fopen(name, "wb");
+  if (hfs.fp == NULL) {
+    chprintf(chp, "cannot create %s\r\n", name);
+    return;
+  }
+  chTraceWriteHeader((BaseSequentialStream *)&hfs);
+  n = chTraceDrain((BaseSequentialStream *)&hfs);
+  fclose(hfs.fp);
+  chprintf(chp, "%u records written into %s\r\n", (unsigned)n, name);
+}
+#endif /* CH_USE_TRACE */
+
 static const ShellCommand commands[] = {
   {"mem", cmd_mem},
   {"threads", cmd_threads},
   {"test", cmd_test},
+#if CH_USE_TRACE
+  {"trace", cmd_trace},
+#endif
   {NULL, NULL}
 };
 
@@ -213,6 +279,15 @@ int main(void) {
   halInit();
   chSysInit();
 
+#if CH_USE_TRACE && !POSIX_USE_SIGNALS
+  /*
+   * Without signals the interrupt sources are polled continuously from the
+   * idle loop, the ISR events would just fill the trace ring.
+   */
+  chTraceSetMask(chTraceGetMask() & ~((1U << TRACE_EV_ISR_ENTER) |
+                                      (1U << TRACE_EV_ISR_LEAVE)));
+#endif
+
   /*
    * Serial ports (simulated) initialization.
    */
@@ -312,6 +312,8 @@ extern "C" {
   void sdStop(SerialDriver *sdp);
   void sdIncomingDataI(SerialDriver *sdp, uint8_t b);
   msg_t sdRequestDataI(SerialDriver *sdp);
+  void sdIncomingDataBlockI(SerialDriver *sdp, const uint8_t *bp, size_t n);
+  size_t sdRequestDataBlockI(SerialDriver *sdp, uint8_t *bp, size_t n);
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
 #include <sys/time.h>
 
 #include "ch.h"
@@ -37,17 +40,242 @@
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
-static struct timeval nextcnt;
-static struct timeval tick = {0, 1000000 / CH_FREQUENCY};
+#if !POSIX_USE_VIRTUAL_TIME || defined(__DOXYGEN__)
+static struct timeval basetime;
+#endif
+#if POSIX_USE_VIRTUAL_TIME || defined(__DOXYGEN__)
+static uint64_t vclock;
+#endif
+#if ((CH_TIMEDELTA == 0) && !POSIX_USE_SIGNALS) || defined(__DOXYGEN__)
+static uint64_t nexttick;
+#endif
+#if (CH_TIMEDELTA > 0) || defined(__DOXYGEN__)
+static bool_t alarm_active;
+static systime_t alarm_set;
+static systime_t alarm_delta;
+#endif
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Simulated time elapsed since initialization.
+ * @details The time is derived from the host clock or, if
+ *          @p POSIX_USE_VIRTUAL_TIME is enabled, from the virtual clock.
+ *
+ * @return              The elapsed time in microseconds.
+ */
+static uint64_t sim_time_us(void) {
+#if POSIX_USE_VIRTUAL_TIME
+  return vclock;
+#else
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  timersub(&tv, &basetime, &tv);
+  return (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
+#endif
+}
+
+#if ((CH_TIMEDELTA == 0) && !POSIX_USE_SIGNALS) ||                          \
+    ((CH_TIMEDELTA > 0) && (POSIX_USE_SIGNALS || POSIX_USE_VIRTUAL_TIME)) ||  \
+    defined(__DOXYGEN__)
+/**
+ * @brief   Start time of a system tick.
+ *
+ * @param[in] cnt       the tick number
+ * @return              The tick start time in microseconds.
+ */
+static uint64_t tick_time_us(uint64_t cnt) {
+
+  return (cnt * 1000000 + CH_FREQUENCY - 1) / CH_FREQUENCY;
+}
+#endif
+
+#if ((CH_TIMEDELTA > 0) &&                                                  \
+     (POSIX_USE_SIGNALS || POSIX_USE_VIRTUAL_TIME)) || defined(__DOXYGEN__)
+/**
+ * @brief   Start time of the alarm tick.
+ *
+ * @param[in] now       the current time in microseconds
+ * @return              The alarm tick start time in microseconds, @p now
+ *                      if the alarm time has already been reached.
+ */
+static uint64_t alarm_time_us(uint64_t now) {
+  uint64_t cnt = (now * CH_FREQUENCY) / 1000000;
+  systime_t elapsed = (systime_t)cnt - alarm_set;
+
+  if (elapsed >= alarm_delta)
+    return now;
+  return tick_time_us(cnt + (alarm_delta - elapsed));
+}
+#endif
+
+#if (CH_TIMEDELTA > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Checks the simulated alarm comparator.
+ * @details The alarm is disarmed when triggered.
+ *
+ * @return              The alarm status.
+ * @retval FALSE        if the alarm is not armed or not yet reached.
+ * @retval TRUE         if the alarm time has been reached or passed.
+ */
+static bool_t alarm_triggered(void) {
+
+  if (!alarm_active ||
+      ((systime_t)(hal_lld_get_time() - alarm_set) < alarm_delta))
+    return FALSE;
+  alarm_active = FALSE;
+  return TRUE;
+}
+#endif
+
+#if POSIX_USE_SIGNALS || defined(__DOXYGEN__)
+/**
+ * @brief   Programs the host interval timer.
+ *
+ * @param[in] value     first expiration in microseconds, zero stops the
+ *                      timer
+ * @param[in] interval  reload value in microseconds, zero for one-shot
+ */
+static void itimer_set(long value, long interval) {
+  struct itimerval itv;
+
+  itv.it_value.tv_sec = value / 1000000;
+  itv.it_value.tv_usec = value % 1000000;
+  itv.it_interval.tv_sec = interval / 1000000;
+  itv.it_interval.tv_usec = interval % 1000000;
+  setitimer(ITIMER_REAL, &itv, NULL);
+}
+
+#if (CH_TIMEDELTA > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Programs the host timer on the remaining alarm time.
+ * @details The host timer is aimed at the start of the alarm tick so that
+ *          the signal delivery latency does not spill into the next tick.
+ */
+static void alarm_program(void) {
+  uint64_t now = sim_time_us();
+  uint64_t target = alarm_time_us(now);
+
+  itimer_set(target > now ? (long)(target - now) : 1, 0);
+}
+#endif
+#endif /* POSIX_USE_SIGNALS */
+
+#if (POSIX_USE_VIRTUAL_TIME && (CH_TIMEDELTA == 0)) || defined(__DOXYGEN__)
+/**
+ * @brief   Tick of the first virtual timer deadline.
+ * @note    The timing wheel does not keep the first deadline, the next
+ *          tick is returned.
+ *
+ * @return              The tick number.
+ */
+static uint64_t first_deadline_tick(void) {
+#if !CH_USE_TIMING_WHEEL
+  /* The first delta is decremented by the next tick.*/
+  if ((VTList *)vtlist.vt_next != &vtlist)
+    return nexttick + vtlist.vt_next->vt_time - 1;
+#endif
+  return nexttick;
+}
+#endif
+
+#if POSIX_USE_VIRTUAL_TIME || defined(__DOXYGEN__)
+/**
+ * @brief   Advances the virtual clock.
+ * @details When invoked from the idle thread the virtual clock jumps to the
+ *          next timer deadline, when invoked by a polling thread it
+ *          advances by @p POSIX_VIRTUAL_TIME_STEP.
+ */
+static void vclock_advance(void) {
+
+  if (chThdGetPriority() == IDLEPRIO) {
+#if CH_TIMEDELTA > 0
+    if (alarm_active) {
+      vclock = alarm_time_us(vclock);
+      return;
+    }
+#else
+    if (vclock < tick_time_us(first_deadline_tick()))
+      vclock = tick_time_us(first_deadline_tick());
+    return;
+#endif
+  }
+  vclock += POSIX_VIRTUAL_TIME_STEP;
+}
+#endif
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
 
+#if POSIX_USE_SIGNALS || defined(__DOXYGEN__)
+/**
+ * @brief   System timer interrupt handler, served on @p SIGALRM.
+ * @note    The handler runs on the stack of the preempted thread, the
+ *          host @p errno is preserved because the handler can switch
+ *          context.
+ *
+ * @param[in] signo     the signal number
+ */
+static void sigalrm_handler(int signo) {
+  int e = errno;
+
+  (void)signo;
+
+#if CH_TIMEDELTA > 0
+  if (!alarm_triggered()) {
+    /* Host timer expired before the simulated comparator, it is
+       reprogrammed on the remaining time.*/
+    if (alarm_active)
+      alarm_program();
+    errno = e;
+    return;
+  }
+#endif
+
+  CH_IRQ_PROLOGUE();
+
+  chSysLockFromIsr();
+  chSysTimerHandlerI();
+  chSysUnlockFromIsr();
+
+  CH_IRQ_EPILOGUE();
+
+  dbg_check_lock();
+  if (chSchIsPreemptionRequired())
+    chSchDoReschedule();
+  dbg_check_unlock();
+
+  errno = e;
+}
+
+#if HAL_USE_SERIAL || defined(__DOXYGEN__)
+/**
+ * @brief   Simulated serial ports interrupt handler, served on @p SIGIO.
+ *
+ * @param[in] signo     the signal number
+ */
+static void sigio_handler(int signo) {
+  int e = errno;
+
+  (void)signo;
+
+  while (sd_lld_interrupt_pending())
+    ;
+
+  dbg_check_lock();
+  if (chSchIsPreemptionRequired())
+    chSchDoReschedule();
+  dbg_check_unlock();
+
+  errno = e;
+}
+#endif
+#endif /* POSIX_USE_SIGNALS */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -62,15 +290,107 @@ void hal_lld_init(void) {
 #else
   puts("ChibiOS/RT simulator (Linux)\n");
 #endif
-  gettimeofday(&nextcnt, NULL);
-  timeradd(&nextcnt, &tick, &nextcnt);
+#if !POSIX_USE_VIRTUAL_TIME
+  gettimeofday(&basetime, NULL);
+#endif
+#if CH_TIMEDELTA > 0
+  alarm_active = FALSE;
+#endif
+#if POSIX_USE_SIGNALS
+  {
+    struct sigaction sa;
+
+    /* The simulated interrupt sources stay masked until chSysInit().*/
+    port_disable();
+
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sigaddset(&sa.sa_mask, SIGALRM);
+    sigaddset(&sa.sa_mask, SIGIO);
+    sa.sa_flags = SA_RESTART;
+    sa.sa_handler = sigalrm_handler;
+    sigaction(SIGALRM, &sa, NULL);
+#if HAL_USE_SERIAL
+    sa.sa_handler = sigio_handler;
+    sigaction(SIGIO, &sa, NULL);
+#endif
+#if CH_TIMEDELTA == 0
+    itimer_set(1000000 / CH_FREQUENCY, 1000000 / CH_FREQUENCY);
+#endif
+  }
+#elif CH_TIMEDELTA == 0
+  nexttick = 1;
+#endif
+}
+
+#if (CH_TIMEDELTA > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts or moves the simulated one-shot alarm.
+ * @details The alarm triggers when the free-running counter reaches or
+ *          passes the specified time, the check is performed by
+ *          @p ChkIntSources() or, if @p POSIX_USE_SIGNALS is enabled, on
+ *          expiration of the host timer.
+ *
+ * @param[in] time      the time to be set for the alarm
+ */
+void hal_lld_start_alarm(systime_t time) {
+
+  alarm_set = hal_lld_get_time();
+  alarm_delta = time - alarm_set;
+  alarm_active = TRUE;
+#if POSIX_USE_SIGNALS
+  alarm_program();
+#endif
+}
+
+/**
+ * @brief   Stops the simulated alarm.
+ */
+void hal_lld_stop_alarm(void) {
+
+  alarm_active = FALSE;
+#if POSIX_USE_SIGNALS
+  itimer_set(0, 0);
+#endif
+}
+
+/**
+ * @brief   Free-running system time counter.
+ * @details The counter is derived from the simulated time and incremented
+ *          at @p CH_FREQUENCY.
+ *
+ * @return              The counter value.
+ */
+systime_t hal_lld_get_time(void) {
+
+  return (systime_t)((sim_time_us() * CH_FREQUENCY) / 1000000);
+}
+#endif /* CH_TIMEDELTA > 0 */
+
+/**
+ * @brief   Returns the current value of the realtime counter.
+ * @details The counter is derived from the simulated time and incremented
+ *          at @p hal_lld_get_counter_frequency().
+ *
+ * @return              The value of the realtime counter of type
+ *                      halrtcnt_t.
+ *
+ * @notapi
+ */
+halrtcnt_t hal_lld_get_counter_value(void) {
+
+  return (halrtcnt_t)sim_time_us();
 }
 
 /**
  * @brief Interrupt simulation.
+ * @note  Does nothing if @p POSIX_USE_SIGNALS is enabled, the interrupt
+ *        sources are served asynchronously by the signal handlers.
+ * @note  If @p POSIX_USE_VIRTUAL_TIME is enabled each invocation advances
+ *        the virtual clock.
  */
 void ChkIntSources(void) {
-  struct timeval tv;
+#if !POSIX_USE_SIGNALS
 
 #if HAL_USE_SERIAL
   if (sd_lld_interrupt_pending()) {
@@ -82,9 +402,21 @@ void ChkIntSources(void) {
   }
 #endif
 
-  gettimeofday(&tv, NULL);
-  if (timercmp(&tv, &nextcnt, >=)) {
-    timeradd(&nextcnt, &tick, &nextcnt);
+#if POSIX_USE_VIRTUAL_TIME
+  vclock_advance();
+#endif
+
+#if CH_TIMEDELTA > 0
+  if (alarm_triggered()) {
+#elif POSIX_USE_VIRTUAL_TIME
+  /* The ticks skipped by a jump of the virtual clock are served together,
+     a thread made ready runs before the next tick is served.*/
+  while (sim_time_us() >= tick_time_us(nexttick)) {
+    nexttick++;
+#else
+  if (sim_time_us() >= tick_time_us(nexttick)) {
+    nexttick++;
+#endif
 
     CH_IRQ_PROLOGUE();
 
@@ -99,6 +431,7 @@ void ChkIntSources(void) {
       chSchDoReschedule();
     dbg_check_unlock();
   }
+#endif /* !POSIX_USE_SIGNALS */
 }
 
 /** @} */
@@ -36,7 +36,7 @@
 /**
  * @brief   Defines the support for realtime counters in the HAL.
  */
-#define HAL_IMPLEMENTS_COUNTERS FALSE
+#define HAL_IMPLEMENTS_COUNTERS TRUE
 
 /**
  * @brief   Platform name.
@@ -50,18 +50,72 @@
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Virtual time mode.
+ * @details If enabled the system time is not derived from the host clock,
+ *          a virtual clock is advanced by @p ChkIntSources() instead. When
+ *          all threads are idle the virtual clock jumps straight to the
+ *          next timer event so timing tests run at full host speed and
+ *          the scheduling is reproducible across runs.
+ * @note    Only the serial ports, driven by external connections, are not
+ *          deterministic.
+ */
+#if !defined(POSIX_USE_VIRTUAL_TIME) || defined(__DOXYGEN__)
+#define POSIX_USE_VIRTUAL_TIME          FALSE
+#endif
+
+/**
+ * @brief   Virtual time step.
+ * @details Amount of virtual time, in microseconds, elapsing on each
+ *          @p ChkIntSources() invocation performed by a thread other than
+ *          the idle thread, this is the simulated cost of a polling loop
+ *          iteration.
+ */
+#if !defined(POSIX_VIRTUAL_TIME_STEP) || defined(__DOXYGEN__)
+#define POSIX_VIRTUAL_TIME_STEP         10
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if POSIX_USE_VIRTUAL_TIME && POSIX_USE_SIGNALS
+#error "POSIX_USE_VIRTUAL_TIME is not compatible with POSIX_USE_SIGNALS"
+#endif
+
+#if POSIX_USE_VIRTUAL_TIME && (POSIX_VIRTUAL_TIME_STEP <= 0)
+#error "invalid POSIX_VIRTUAL_TIME_STEP value"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Type representing a system clock frequency.
+ */
+typedef uint32_t halclock_t;
+
+/**
+ * @brief   Type of the realtime free counter value.
+ */
+typedef uint32_t halrtcnt_t;
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Realtime counter frequency.
+ * @note    The counter is derived from the simulated time, it follows the
+ *          virtual clock if @p POSIX_USE_VIRTUAL_TIME is enabled.
+ *
+ * @return              The realtime counter frequency of type halclock_t.
+ *
+ * @notapi
+ */
+#define hal_lld_get_counter_frequency()     1000000
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -71,6 +125,12 @@ extern "C" {
 #endif
   void hal_lld_init(void);
   void ChkIntSources(void);
+  halrtcnt_t hal_lld_get_counter_value(void);
+#if CH_TIMEDELTA > 0
+  void hal_lld_start_alarm(systime_t time);
+  void hal_lld_stop_alarm(void);
+  systime_t hal_lld_get_time(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,9 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 
 #include "ch.h"
@@ -61,6 +64,41 @@ static u_long nb = 1;
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if POSIX_USE_SIGNALS || defined(__DOXYGEN__)
+/**
+ * @brief   Enables @p SIGIO delivery on a socket.
+ *
+ * @param[in] fd        the socket descriptor
+ * @return              The operation status.
+ * @retval 0            if the operation succeeded.
+ * @retval -1           if the operation failed.
+ */
+static int async_enable(int fd) {
+  int flags;
+
+  if ((fcntl(fd, F_SETOWN, getpid()) != 0) ||
+      ((flags = fcntl(fd, F_GETFL)) < 0) ||
+      (fcntl(fd, F_SETFL, flags | O_ASYNC) != 0))
+    return -1;
+  return 0;
+}
+
+/**
+ * @brief   Output queue notification.
+ * @details The @p SIGIO is raised under lock, it is served as soon as the
+ *          simulated interrupt sources are unmasked.
+ *
+ * @param[in] qp        the queue pointer
+ */
+static void onotify(GenericQueue *qp) {
+
+  (void)qp;
+  raise(SIGIO);
+}
+#else
+#define onotify NULL
+#endif
+
 static void init(SerialDriver *sdp, uint16_t port) {
   struct sockaddr_in sad;
   struct protoent *prtp;
@@ -87,6 +125,13 @@ static void init(SerialDriver *sdp, uint16_t port) {
     goto abort;
   }
 
+#if POSIX_USE_SIGNALS
+  if (async_enable(sdp->com_listen) != 0) {
+    printf("%s: Unable to setup asynchronous mode on socket\n", sdp->com_name);
+    goto abort;
+  }
+#endif
+
   memset(&sad, 0, sizeof(sad));
   sad.sin_family = AF_INET;
   sad.sin_addr.s_addr = INADDR_ANY;
@@ -122,6 +167,12 @@ static bool_t connint(SerialDriver *sdp) {
       printf("%s: Unable to setup non blocking mode on data socket\n", sdp->com_name);
       goto abort;
     }
+#if POSIX_USE_SIGNALS
+    if (async_enable(sdp->com_data) != 0) {
+      printf("%s: Unable to setup asynchronous mode on data socket\n", sdp->com_name);
+      goto abort;
+    }
+#endif
     chSysLockFromIsr();
     chnAddFlagsI(sdp, CHN_CONNECTED);
     chSysUnlockFromIsr();
@@ -139,7 +190,6 @@ abort:
 static bool_t inint(SerialDriver *sdp) {
 
   if (sdp->com_data != INVALID_SOCKET) {
-    int i;
     uint8_t data[32];
 
     /*
@@ -161,11 +211,9 @@ static bool_t inint(SerialDriver *sdp) {
       sdp->com_data = INVALID_SOCKET;
       return FALSE;
     }
-    for (i = 0; i < n; i++) {
-      chSysLockFromIsr();
-      sdIncomingDataI(sdp, data[i]);
-      chSysUnlockFromIsr();
-    }
+    chSysLockFromIsr();
+    sdIncomingDataBlockI(sdp, data, (size_t)n);
+    chSysUnlockFromIsr();
     return TRUE;
   }
   return FALSE;
@@ -175,18 +223,21 @@ static bool_t outint(SerialDriver *sdp) {
 
   if (sdp->com_data != INVALID_SOCKET) {
     int n;
-    uint8_t data[1];
+    uint8_t *p;
+    size_t span;
 
     /*
-     * Input.
+     * Output, the filled span of the output queue is sent in place and only
+     * the bytes accepted by the socket are removed from the queue.
      */
     chSysLockFromIsr();
-    n = sdRequestDataI(sdp);
+    p = chOQGetFullSpanI(&sdp->oqueue, &span);
+    if (span == 0)
+      chnAddFlagsI(sdp, CHN_OUTPUT_EMPTY);
     chSysUnlockFromIsr();
-    if (n < 0)
+    if (span == 0)
       return FALSE;
-    data[0] = (uint8_t)n;
-    n = send(sdp->com_data, data, sizeof(data), 0);
+    n = send(sdp->com_data, p, span, 0);
     switch (n) {
     case 0:
       close(sdp->com_data);
@@ -202,6 +253,9 @@ static bool_t outint(SerialDriver *sdp) {
       sdp->com_data = INVALID_SOCKET;
       return FALSE;
     }
+    chSysLockFromIsr();
+    chOQConsumeI(&sdp->oqueue, (size_t)n);
+    chSysUnlockFromIsr();
     return TRUE;
   }
   return FALSE;
@@ -221,14 +275,14 @@ static bool_t outint(SerialDriver *sdp) {
 void sd_lld_init(void) {
 
 #if USE_SIM_SERIAL1
-  sdObjectInit(&SD1, NULL, NULL);
+  sdObjectInit(&SD1, NULL, onotify);
   SD1.com_listen = INVALID_SOCKET;
   SD1.com_data = INVALID_SOCKET;
   SD1.com_name = "SD1";
 #endif
 
 #if USE_SIM_SERIAL2
-  sdObjectInit(&SD2, NULL, NULL);
+  sdObjectInit(&SD2, NULL, onotify);
   SD2.com_listen = INVALID_SOCKET;
   SD2.com_data = INVALID_SOCKET;
   SD2.com_name = "SD2";
@@ -268,9 +322,30 @@ void sd_lld_stop(SerialDriver *sdp) {
   (void)sdp;
 }
 
+/*
+ * Checks for activity on the driver socket without entering the ISR
+ * context, an idle poll is not accounted as an interrupt.
+ */
+static bool_t sockpending(SerialDriver *sdp) {
+  struct pollfd pfd;
+
+  if (sdp->com_data == INVALID_SOCKET) {
+    pfd.fd = sdp->com_listen;
+    pfd.events = POLLIN;
+  }
+  else {
+    pfd.fd = sdp->com_data;
+    pfd.events = chOQIsEmptyI(&sdp->oqueue) ? POLLIN : POLLIN | POLLOUT;
+  }
+  return poll(&pfd, 1, 0) > 0;
+}
+
 bool_t sd_lld_interrupt_pending(void) {
   bool_t b;
 
+  if (!sockpending(&SD1) && !sockpending(&SD2))
+    return FALSE;
+
   CH_IRQ_PROLOGUE();
 
   b =  connint(&SD1) || connint(&SD2) ||
@@ -283,8 +283,12 @@ static void otg_fifo_write_from_buffer(volatile uint32_t *fifop,
 static void otg_fifo_write_from_queue(volatile uint32_t *fifop,
                                       OutputQueue *oqp,
                                       size_t n) {
+  uint8_t *p;
   size_t ntogo;
 
+  /* The data is read in place, the queue pointers are only updated by
+     chOQConsumeI() at the end.*/
+  p = oqp->q_rdptr;
   ntogo = n;
   while (ntogo > 0) {
     uint32_t w, i;
@@ -292,12 +296,12 @@ static void otg_fifo_write_from_queue(volatile uint32_t *fifop,
 
     if (nw > 0) {
       size_t streak;
-      uint32_t nw2end = (oqp->q_top - oqp->q_rdptr) / 4;
+      uint32_t nw2end = (oqp->q_top - p) / 4;
 
       ntogo -= (streak = nw <= nw2end ? nw : nw2end) * 4;
-      oqp->q_rdptr = otg_do_push(fifop, oqp->q_rdptr, streak);
-      if (oqp->q_rdptr >= oqp->q_top) {
-        oqp->q_rdptr = oqp->q_buffer;
+      p = otg_do_push(fifop, p, streak);
+      if (p >= oqp->q_top) {
+        p = oqp->q_buffer;
         continue;
       }
     }
@@ -311,9 +315,9 @@ static void otg_fifo_write_from_queue(volatile uint32_t *fifop,
     w = 0;
     i = 0;
     while ((ntogo > 0) && (i < 4)) {
-      w |= (uint32_t)*oqp->q_rdptr++ << (i * 8);
-      if (oqp->q_rdptr >= oqp->q_top)
-        oqp->q_rdptr = oqp->q_buffer;
+      w |= (uint32_t)*p++ << (i * 8);
+      if (p >= oqp->q_top)
+        p = oqp->q_buffer;
       ntogo--;
       i++;
     }
@@ -322,9 +326,7 @@ static void otg_fifo_write_from_queue(volatile uint32_t *fifop,
 
   /* Updating queue.*/
   chSysLock();
-  oqp->q_counter += n;
-  while (notempty(&oqp->q_waiting))
-    chSchReadyI(fifo_remove(&oqp->q_waiting))->p_u.rdymsg = Q_OK;
+  chOQConsumeI(oqp, n);
   chSchRescheduleS();
   chSysUnlock();
 }
@@ -396,8 +398,12 @@ static void otg_fifo_read_to_buffer(volatile uint32_t *fifop,
 static void otg_fifo_read_to_queue(volatile uint32_t *fifop,
                                    InputQueue *iqp,
                                    size_t n) {
+  uint8_t *p;
   size_t ntogo;
 
+  /* The data is written in place, the queue pointers are only updated by
+     chIQCommitI() at the end.*/
+  p = iqp->q_wrptr;
   ntogo = n;
   while (ntogo > 0) {
     uint32_t w, i;
@@ -405,12 +411,12 @@ static void otg_fifo_read_to_queue(volatile uint32_t *fifop,
 
     if (nw > 0) {
       size_t streak;
-      uint32_t nw2end = (iqp->q_wrptr - iqp->q_wrptr) / 4;
+      uint32_t nw2end = (iqp->q_top - p) / 4;
 
       ntogo -= (streak = nw <= nw2end ? nw : nw2end) * 4;
-      iqp->q_wrptr = otg_do_pop(fifop, iqp->q_wrptr, streak);
-      if (iqp->q_wrptr >= iqp->q_top) {
-        iqp->q_wrptr = iqp->q_buffer;
+      p = otg_do_pop(fifop, p, streak);
+      if (p >= iqp->q_top) {
+        p = iqp->q_buffer;
         continue;
       }
     }
@@ -424,9 +430,9 @@ static void otg_fifo_read_to_queue(volatile uint32_t *fifop,
     w = *fifop;
     i = 0;
     while ((ntogo > 0) && (i < 4)) {
-      *iqp->q_wrptr++ = (uint8_t)(w >> (i * 8));
-      if (iqp->q_wrptr >= iqp->q_top)
-        iqp->q_wrptr = iqp->q_buffer;
+      *p++ = (uint8_t)(w >> (i * 8));
+      if (p >= iqp->q_top)
+        p = iqp->q_buffer;
       ntogo--;
       i++;
     }
@@ -434,9 +440,7 @@ static void otg_fifo_read_to_queue(volatile uint32_t *fifop,
 
   /* Updating queue.*/
   chSysLock();
-  iqp->q_counter += n;
-  while (notempty(&iqp->q_waiting))
-    chSchReadyI(fifo_remove(&iqp->q_waiting))->p_u.rdymsg = Q_OK;
+  chIQCommitI(iqp, n);
   chSchRescheduleS();
   chSysUnlock();
 }
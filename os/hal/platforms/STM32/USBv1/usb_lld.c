@@ -154,32 +154,31 @@ static void usb_packet_read_to_queue(stm32_usb_descriptor_t *udp,
                                      InputQueue *iqp, size_t n) {
   size_t nhw;
   uint32_t *pmap= USB_ADDR2PTR(udp->RXADDR0);
+  uint8_t *p = iqp->q_wrptr;
 
   nhw = n / 2;
   while (nhw > 0) {
     uint32_t w;
 
     w = *pmap++;
-    *iqp->q_wrptr++ = (uint8_t)w;
-    if (iqp->q_wrptr >= iqp->q_top)
-      iqp->q_wrptr = iqp->q_buffer;
-    *iqp->q_wrptr++ = (uint8_t)(w >> 8);
-    if (iqp->q_wrptr >= iqp->q_top)
-      iqp->q_wrptr = iqp->q_buffer;
+    *p++ = (uint8_t)w;
+    if (p >= iqp->q_top)
+      p = iqp->q_buffer;
+    *p++ = (uint8_t)(w >> 8);
+    if (p >= iqp->q_top)
+      p = iqp->q_buffer;
     nhw--;
   }
   /* Last byte for odd numbers.*/
   if ((n & 1) != 0) {
-    *iqp->q_wrptr++ = (uint8_t)*pmap;
-    if (iqp->q_wrptr >= iqp->q_top)
-      iqp->q_wrptr = iqp->q_buffer;
+    *p++ = (uint8_t)*pmap;
+    if (p >= iqp->q_top)
+      p = iqp->q_buffer;
   }
 
   /* Updating queue.*/
   chSysLockFromIsr();
-  iqp->q_counter += n;
-  while (notempty(&iqp->q_waiting))
-    chSchReadyI(fifo_remove(&iqp->q_waiting))->p_u.rdymsg = Q_OK;
+  chIQCommitI(iqp, n);
   chSysUnlockFromIsr();
 }
 
@@ -223,27 +222,28 @@ static void usb_packet_write_from_queue(stm32_usb_descriptor_t *udp,
                                         OutputQueue *oqp, size_t n) {
   size_t nhw;
   uint32_t *pmap = USB_ADDR2PTR(udp->TXADDR0);
+  uint8_t *p = oqp->q_rdptr;
 
   udp->TXCOUNT0 = (uint16_t)n;
   nhw = n / 2;
   while (nhw > 0) {
     uint32_t w;
 
-    w  = (uint32_t)*oqp->q_rdptr++;
-    if (oqp->q_rdptr >= oqp->q_top)
-      oqp->q_rdptr = oqp->q_buffer;
-    w |= (uint32_t)*oqp->q_rdptr++ << 8;
-    if (oqp->q_rdptr >= oqp->q_top)
-      oqp->q_rdptr = oqp->q_buffer;
+    w  = (uint32_t)*p++;
+    if (p >= oqp->q_top)
+      p = oqp->q_buffer;
+    w |= (uint32_t)*p++ << 8;
+    if (p >= oqp->q_top)
+      p = oqp->q_buffer;
     *pmap++ = w;
     nhw--;
   }
 
   /* Last byte for odd numbers.*/
   if ((n & 1) != 0) {
-    *pmap = (uint32_t)*oqp->q_rdptr++;
-    if (oqp->q_rdptr >= oqp->q_top)
-      oqp->q_rdptr = oqp->q_buffer;
+    *pmap = (uint32_t)*p++;
+    if (p >= oqp->q_top)
+      p = oqp->q_buffer;
   }
 
   /* Updating queue. Note, the lock is done in this unusual way because this
@@ -252,9 +252,7 @@ static void usb_packet_write_from_queue(stm32_usb_descriptor_t *udp,
   port_lock();
   dbg_enter_lock();
 
-  oqp->q_counter += n;
-  while (notempty(&oqp->q_waiting))
-    chSchReadyI(fifo_remove(&oqp->q_waiting))->p_u.rdymsg = Q_OK;
+  chOQConsumeI(oqp, n);
 
   dbg_leave_lock();
   port_unlock();
@@ -221,6 +221,34 @@ void sdIncomingDataI(SerialDriver *sdp, uint8_t b) {
     chnAddFlagsI(sdp, SD_OVERRUN_ERROR);
 }
 
+/**
+ * @brief   Handles a block of incoming data.
+ * @details This function must be called from the input interrupt service
+ *          routine in order to enqueue a block of incoming data and generate
+ *          the related events. The whole block is written into the input
+ *          queue with a single queue update.
+ * @note    The incoming data event is only generated when the input queue
+ *          becomes non-empty.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver structure
+ * @param[in] bp        pointer to the received data
+ * @param[in] n         number of received bytes
+ *
+ * @iclass
+ */
+void sdIncomingDataBlockI(SerialDriver *sdp, const uint8_t *bp, size_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck(sdp != NULL, "sdIncomingDataBlockI");
+
+  if (n == 0)
+    return;
+  if (chIQIsEmptyI(&sdp->iqueue))
+    chnAddFlagsI(sdp, CHN_INPUT_AVAILABLE);
+  if (chIQWriteI(&sdp->iqueue, bp, n) < n)
+    chnAddFlagsI(sdp, SD_OVERRUN_ERROR);
+}
+
 /**
  * @brief   Handles outgoing data.
  * @details Must be called from the output interrupt service routine in order
@@ -248,6 +276,34 @@ msg_t sdRequestDataI(SerialDriver *sdp) {
   return b;
 }
 
+/**
+ * @brief   Handles a block of outgoing data.
+ * @details Must be called from the output interrupt service routine in order
+ *          to get the next block of data to be transmitted. The data is
+ *          removed from the output queue with a single queue update.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver structure
+ * @param[out] bp       pointer to the buffer receiving the data
+ * @param[in] n         maximum number of bytes to be read
+ * @return              The number of bytes read from the driver's output
+ *                      queue.
+ * @retval 0            if the queue is empty (the lower driver usually
+ *                      disables the interrupt source when this happens).
+ *
+ * @iclass
+ */
+size_t sdRequestDataBlockI(SerialDriver *sdp, uint8_t *bp, size_t n) {
+  size_t r;
+
+  chDbgCheckClassI();
+  chDbgCheck(sdp != NULL, "sdRequestDataBlockI");
+
+  r = chOQReadI(&sdp->oqueue, bp, n);
+  if (r == 0)
+    chnAddFlagsI(sdp, CHN_OUTPUT_EMPTY);
+  return r;
+}
+
 #endif /* HAL_USE_SERIAL */
 
 /** @} */
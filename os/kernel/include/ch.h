@@ -118,19 +118,26 @@
 #include "chbsem.h"
 #include "chmtx.h"
 #include "chcond.h"
+#include "chrwlock.h"
 #include "chevents.h"
 #include "chmsg.h"
 #include "chmboxes.h"
 #include "chmemcore.h"
 #include "chheap.h"
 #include "chmempools.h"
+#include "chmsgq.h"
 #include "chthreads.h"
 #include "chdynamic.h"
 #include "chregistry.h"
+#include "chworkq.h"
 #include "chinline.h"
 #include "chqueues.h"
+#include "chwaitset.h"
+#include "chring.h"
+#include "chtasks.h"
 #include "chstreams.h"
 #include "chfiles.h"
+#include "chtrace.h"
 #include "chdebug.h"
 
 #if !defined(__DOXYGEN__)
@@ -37,7 +37,8 @@
 #define _CHDEBUG_H_
 
 #if CH_DBG_ENABLE_ASSERTS     || CH_DBG_ENABLE_CHECKS      ||               \
-    CH_DBG_ENABLE_STACK_CHECK || CH_DBG_SYSTEM_STATE_CHECK
+    CH_DBG_ENABLE_STACK_CHECK || CH_DBG_SYSTEM_STATE_CHECK ||               \
+    CH_DBG_DEADLOCK_DETECTION
 #define CH_DBG_ENABLED              TRUE
 #else
 #define CH_DBG_ENABLED              FALSE
@@ -45,6 +46,14 @@
 
 #define __QUOTE_THIS(p) #p
 
+#if !defined(MUTEX_DEADLOCK_HOOK)
+#define MUTEX_DEADLOCK_HOOK(drp) {}
+#endif
+
+#if !defined(MUTEX_INVERSION_HOOK)
+#define MUTEX_INVERSION_HOOK(tp, time) {}
+#endif
+
 /*===========================================================================*/
 /**
  * @name    Debug related settings
@@ -77,6 +86,25 @@
 #define CH_THREAD_FILL_VALUE        0xFF
 #endif
 
+/**
+ * @brief   Maximum length of an explored mutex owners chain.
+ * @details Longer chains are not explored further and are not reported as
+ *          deadlocks.
+ */
+#ifndef CH_DEADLOCK_MAX_CHAIN
+#define CH_DEADLOCK_MAX_CHAIN       16
+#endif
+
+/**
+ * @brief   Priority inversion threshold in system ticks.
+ * @details A thread whose priority has been raised by the priority
+ *          inheritance for longer than this time is reported through the
+ *          @p MUTEX_INVERSION_HOOK() as soon as the threshold expires.
+ */
+#ifndef CH_INVERSION_THRESHOLD
+#define CH_INVERSION_THRESHOLD      MS2ST(100)
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -139,6 +167,89 @@ extern ch_trace_buffer_t dbg_trace_buffer;
 #define dbg_trace(otp)
 #endif
 
+/*===========================================================================*/
+/* Runtime statistics related macros.                                        */
+/*===========================================================================*/
+
+#if CH_DBG_STATISTICS
+#if !defined(PORT_SUPPORTS_RT) || !PORT_SUPPORTS_RT
+#error "CH_DBG_STATISTICS requires a port supporting the realtime counter"
+#endif
+#if !defined(__DOXYGEN__)
+extern kernel_stats_t dbg_kernel_stats;
+#endif
+#else
+/* When the statistics are disabled these functions are replaced by empty
+   macros.*/
+#define dbg_stats_switch(ntp, otp)
+#define dbg_stats_enter_isr()
+#define dbg_stats_leave_isr()
+#endif
+
+/*===========================================================================*/
+/* Lock statistics related macros.                                           */
+/*===========================================================================*/
+
+#if CH_DBG_LOCK_STATISTICS
+#if !defined(PORT_SUPPORTS_RT) || !PORT_SUPPORTS_RT
+#error "CH_DBG_LOCK_STATISTICS requires a port supporting the realtime counter"
+#endif
+#else
+/* When the lock statistics are disabled these functions are replaced by
+   empty macros.*/
+#define dbg_lock_init(lsp)
+#define dbg_lock_acquired(lsp)
+#define dbg_lock_acquired_atomic(lsp)
+#define dbg_lock_waited(lsp, start)
+#define dbg_lock_released(lsp)
+#endif
+
+/*===========================================================================*/
+/* Deadlock detection related structures and macros.                         */
+/*===========================================================================*/
+
+#if CH_DBG_DEADLOCK_DETECTION || defined(__DOXYGEN__)
+#if !CH_USE_MUTEXES
+#error "CH_DBG_DEADLOCK_DETECTION requires CH_USE_MUTEXES"
+#endif
+
+/**
+ * @name    Priority inheritance boost states
+ * @{
+ */
+#define THD_BOOST_NONE      0       /**< @brief Not boosted.                */
+#define THD_BOOST_ACTIVE    1       /**< @brief Boosted.                    */
+#define THD_BOOST_REPORTED  2       /**< @brief Boosted, already reported.  */
+/** @} */
+
+/**
+ * @brief   Deadlock report.
+ * @details The thread @p dr_threads[i] is waiting on the mutex
+ *          @p dr_mutexes[i] owned by the thread @p dr_threads[i + 1], the
+ *          last mutex is owned by the first thread.
+ */
+typedef struct {
+  unsigned              dr_length;  /**< @brief Number of links in the cycle.*/
+  /** @brief Threads in the cycle.*/
+  Thread                *dr_threads[CH_DEADLOCK_MAX_CHAIN];
+  /** @brief Mutexes in the cycle.*/
+  Mutex                 *dr_mutexes[CH_DEADLOCK_MAX_CHAIN];
+} deadlock_report_t;
+
+#if !defined(__DOXYGEN__)
+extern deadlock_report_t dbg_deadlock_report;
+extern cnt_t dbg_inversions;
+extern Thread *dbg_inversion_thread;
+extern systime_t dbg_inversion_time;
+#endif
+#else
+/* When the deadlock detection is disabled these functions are replaced by
+   empty macros.*/
+#define dbg_mtx_wait(mp)
+#define dbg_mtx_boost(tp)
+#define dbg_mtx_unboost(tp)
+#endif
+
 /*===========================================================================*/
 /* Parameters checking related macros.                                       */
 /*===========================================================================*/
@@ -241,6 +352,33 @@ extern "C" {
   void _trace_init(void);
   void dbg_trace(Thread *otp);
 #endif
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+  void _stats_init(void);
+  void dbg_stats_switch(Thread *ntp, Thread *otp);
+  void dbg_stats_enter_isr(void);
+  void dbg_stats_leave_isr(void);
+#endif
+#if CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+  void dbg_lock_init(lock_stats_t *lsp);
+  void dbg_lock_acquired(lock_stats_t *lsp);
+#if (defined(PORT_SUPPORTS_CAS) && PORT_SUPPORTS_CAS) || defined(__DOXYGEN__)
+  void dbg_lock_acquired_atomic(lock_stats_t *lsp);
+#endif
+  void dbg_lock_waited(lock_stats_t *lsp, uint32_t start);
+  void dbg_lock_released(lock_stats_t *lsp);
+  void chDbgLockRegister(lock_stats_t *lsp, const char *name);
+  void chDbgLockUnregister(lock_stats_t *lsp);
+  lock_stats_t *chDbgLockFirst(void);
+  lock_stats_t *chDbgLockNext(lock_stats_t *lsp);
+  void chDbgGetLockStats(lock_stats_t *lsp, lock_stats_t *dstp);
+  void chDbgResetLockStats(void);
+#endif
+#if CH_DBG_DEADLOCK_DETECTION || defined(__DOXYGEN__)
+  void dbg_mtx_wait(Mutex *mp);
+  void dbg_mtx_boost(Thread *tp);
+  void dbg_mtx_unboost(Thread *tp);
+  bool_t chDbgCheckDeadlockS(Mutex *mp, deadlock_report_t *drp);
+#endif
 #if CH_DBG_ENABLED
   extern const char *dbg_panic_msg;
   void chDbgPanic(const char *msg);
@@ -47,6 +47,75 @@
 #if CH_USE_DYNAMIC && !CH_USE_HEAP && !CH_USE_MEMPOOLS
 #error "CH_USE_DYNAMIC requires CH_USE_HEAP and/or CH_USE_MEMPOOLS"
 #endif
+#if CH_USE_THREAD_CACHE && (!CH_USE_HEAP || CH_USE_MALLOC_HEAP)
+#error "CH_USE_THREAD_CACHE requires CH_USE_HEAP and not CH_USE_MALLOC_HEAP"
+#endif
+
+#if CH_USE_THREAD_CACHE || defined(__DOXYGEN__)
+/**
+ * @name    Thread cache settings
+ * @{
+ */
+/**
+ * @brief   Number of size classes in a thread cache.
+ * @details Each class holds the working areas whose size is between
+ *          @p THD_CACHE_MIN_SIZE multiplied by a power of two and the next
+ *          power of two, the last class holds all the bigger working areas.
+ */
+#if !defined(THD_CACHE_CLASSES) || defined(__DOXYGEN__)
+#define THD_CACHE_CLASSES       8
+#endif
+
+/**
+ * @brief   Size of the working areas of the first class.
+ * @details Requests are rounded up to the size of their class so that the
+ *          cached working areas are interchangeable within a class.
+ */
+#if !defined(THD_CACHE_MIN_SIZE) || defined(__DOXYGEN__)
+#define THD_CACHE_MIN_SIZE      THD_WA_SIZE(128)
+#endif
+/** @} */
+
+#if THD_CACHE_CLASSES < 1
+#error "invalid THD_CACHE_CLASSES value"
+#endif
+
+/**
+ * @brief   Cached working area header.
+ * @details The header overlaps the @p Thread structure of a terminated
+ *          thread.
+ */
+struct cache_header {
+  struct cache_header   *ch_next;       /**< @brief Pointer to the next
+                                                    cached working area.    */
+};
+
+/**
+ * @brief   Structure representing a thread cache.
+ */
+typedef struct {
+  MemoryHeap            *tc_heap;       /**< @brief Heap the working areas
+                                                    are allocated from.     */
+  struct cache_header   *tc_free[THD_CACHE_CLASSES];
+                                        /**< @brief Cached working areas,
+                                                    one list for each size
+                                                    class.                  */
+  cnt_t                 tc_count;       /**< @brief Number of cached
+                                                    working areas.          */
+  cnt_t                 tc_max;         /**< @brief Maximum number of cached
+                                                    working areas.          */
+} ThreadCache;
+
+/**
+ * @brief   Returns the number of working areas held in a thread cache.
+ *
+ * @param[in] tcp       pointer to the @p ThreadCache object
+ * @return              The number of cached working areas.
+ *
+ * @iclass
+ */
+#define chThdCacheGetCountI(tcp) ((tcp)->tc_count)
+#endif /* CH_USE_THREAD_CACHE */
 
 /*
  * Dynamic threads APIs.
@@ -64,6 +133,12 @@ extern "C" {
   Thread *chThdCreateFromMemoryPool(MemoryPool *mp, tprio_t prio,
                                     tfunc_t pf, void *arg);
 #endif
+#if CH_USE_THREAD_CACHE
+  void chThdCacheInit(ThreadCache *tcp, MemoryHeap *heapp, cnt_t max);
+  Thread *chThdCreateFromCache(ThreadCache *tcp, size_t size,
+                               tprio_t prio, tfunc_t pf, void *arg);
+  void chThdCacheFlush(ThreadCache *tcp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -49,8 +49,117 @@
 #error "CH_USE_HEAP requires CH_USE_MUTEXES and/or CH_USE_SEMAPHORES"
 #endif
 
+#if CH_USE_HEAP_TLSF && CH_USE_MALLOC_HEAP
+#error "CH_USE_HEAP_TLSF is not compatible with CH_USE_MALLOC_HEAP"
+#endif
+
+#if CH_USE_HEAP_TLSF || defined(__DOXYGEN__)
+/**
+ * @name    TLSF heap settings
+ * @{
+ */
+/**
+ * @brief   Number of second level lists per first level range, log2.
+ * @details Each power of two size range is split in this number of linear
+ *          sub-ranges, the wasted memory because of the size classes
+ *          rounding is bounded to 1 / 2^HEAP_TLSF_SL_LOG2 of the request.
+ */
+#if !defined(HEAP_TLSF_SL_LOG2) || defined(__DOXYGEN__)
+#define HEAP_TLSF_SL_LOG2       4
+#endif
+
+/**
+ * @brief   Maximum heap block size, log2.
+ * @details Static heap areas are trimmed to this size and bigger requests
+ *          fail.
+ */
+#if !defined(HEAP_TLSF_MAX_LOG2) || defined(__DOXYGEN__)
+#define HEAP_TLSF_MAX_LOG2      24
+#endif
+/** @} */
+
+/**
+ * @name    TLSF heap constants
+ * @{
+ */
+/**
+ * @brief   Number of second level lists.
+ */
+#define HEAP_TLSF_SL_COUNT      (1 << HEAP_TLSF_SL_LOG2)
+
+/**
+ * @brief   Allocation granularity, log2.
+ * @note    The granularity is @p MEM_ALIGN_SIZE, it is required to be at
+ *          least 4 because the block flags share the size field.
+ */
+#define HEAP_TLSF_ALIGN_LOG2    ((MEM_ALIGN_SIZE >= 16) ? 4 :               \
+                                 (MEM_ALIGN_SIZE >= 8) ? 3 : 2)
+
+/**
+ * @brief   First level index of the first non linear range.
+ */
+#define HEAP_TLSF_FL_SHIFT      (HEAP_TLSF_SL_LOG2 + HEAP_TLSF_ALIGN_LOG2)
+
+/**
+ * @brief   Number of first level ranges.
+ */
+#define HEAP_TLSF_FL_COUNT      (HEAP_TLSF_MAX_LOG2 - HEAP_TLSF_FL_SHIFT + 1)
+/** @} */
+
+#if (HEAP_TLSF_SL_LOG2 < 1) || (HEAP_TLSF_SL_LOG2 > 5)
+#error "invalid HEAP_TLSF_SL_LOG2 value"
+#endif
+
+#if (HEAP_TLSF_MAX_LOG2 < 12) || (HEAP_TLSF_MAX_LOG2 > 31)
+#error "invalid HEAP_TLSF_MAX_LOG2 value"
+#endif
+#endif /* CH_USE_HEAP_TLSF */
+
 typedef struct memory_heap MemoryHeap;
 
+#if CH_USE_HEAP_TLSF || defined(__DOXYGEN__)
+/**
+ * @brief   Memory heap block header.
+ * @details Blocks are physically linked to their predecessor in order to
+ *          allow constant time coalescing, the free flag is encoded in the
+ *          lowest bit of the size field. Free blocks store the pointer to
+ *          the previous block in their free list in the first word of
+ *          their payload.
+ */
+union heap_header {
+  stkalign_t align;
+  struct {
+    union heap_header   *prev;      /**< @brief Previous physical block or
+                                                @p NULL.                    */
+    size_t              size;       /**< @brief Size of the memory block
+                                                and free flag.              */
+    union {
+      union heap_header *next;      /**< @brief Next block in free list.    */
+      MemoryHeap        *heap;      /**< @brief Block owner heap.           */
+    } u;                            /**< @brief Overlapped fields.          */
+  } h;
+};
+
+/**
+ * @brief   Structure describing a memory heap.
+ */
+struct memory_heap {
+  memgetfunc_t          h_provider; /**< @brief Memory blocks provider for
+                                                this heap.                  */
+  uint32_t              h_flmap;    /**< @brief Non-empty first level
+                                                ranges bitmap.              */
+  uint32_t              h_slmap[HEAP_TLSF_FL_COUNT];
+                                    /**< @brief Non-empty second level
+                                                lists bitmaps.              */
+  union heap_header     *h_free[HEAP_TLSF_FL_COUNT][HEAP_TLSF_SL_COUNT];
+                                    /**< @brief Segregated free lists.      */
+#if CH_USE_MUTEXES
+  Mutex                 h_mtx;      /**< @brief Heap access mutex.          */
+#else
+  Semaphore             h_sem;      /**< @brief Heap access semaphore.      */
+#endif
+};
+#else /* !CH_USE_HEAP_TLSF */
 /**
  * @brief   Memory heap block header.
  */
@@ -78,6 +187,19 @@ struct memory_heap {
   Semaphore             h_sem;      /**< @brief Heap access semaphore.      */
 #endif
 };
+#endif /* !CH_USE_HEAP_TLSF */
+
+#if !CH_USE_MALLOC_HEAP || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the usable size of an allocated block.
+ * @note    The returned size can be greater than the size requested on
+ *          allocation because of the heap granularity.
+ *
+ * @param[in] p         pointer to a block allocated from an heap
+ * @return              The usable size of the block.
+ */
+#define chHeapGetSize(p) (((union heap_header *)(p) - 1)->h.size)
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -85,6 +207,7 @@ extern "C" {
   void _heap_init(void);
 #if !CH_USE_MALLOC_HEAP
   void chHeapInit(MemoryHeap *heapp, void *buf, size_t size);
+  void chHeapInitProvider(MemoryHeap *heapp, memgetfunc_t provider);
 #endif
   void *chHeapAlloc(MemoryHeap *heapp, size_t size);
   void chHeapFree(void *p);
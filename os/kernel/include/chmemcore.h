@@ -75,6 +75,54 @@ typedef void *(*memgetfunc_t)(size_t size);
 
 #if CH_USE_MEMCORE || defined(__DOXYGEN__)
 
+/**
+ * @brief   Type of a memory region.
+ */
+typedef struct memory_region MemoryRegion;
+
+/**
+ * @brief   Structure describing a core memory region.
+ */
+struct memory_region {
+  MemoryRegion          *mr_next;   /**< @brief Next registered region.     */
+  const char            *mr_name;   /**< @brief Region name.                */
+  uint8_t               *mr_nextmem;/**< @brief First free location.        */
+  uint8_t               *mr_endmem; /**< @brief End of the region.          */
+  size_t                mr_align;   /**< @brief Blocks alignment.           */
+};
+
+/**
+ * @brief   Name of the default core memory region.
+ */
+#define CORE_DEFAULT_REGION_NAME    "core"
+
+/**
+ * @brief   Defines a memory provider bound to a region.
+ * @details The provider is an API-class function assignment compatible
+ *          with @p memgetfunc_t, it is meant for heaps initialized using
+ *          @p chHeapInitProvider().
+ *
+ * @param[in] name      the name of the provider function
+ * @param[in] mrp       pointer to the @p MemoryRegion object
+ */
+#define CORE_REGION_PROVIDER(name, mrp)                                     \
+void *name(size_t size) {                                                   \
+  return chCoreAllocFrom(mrp, size);                                        \
+}
+
+/**
+ * @brief   Defines an I-class memory provider bound to a region.
+ * @details The provider is an I-class function assignment compatible
+ *          with @p memgetfunc_t, it is meant for memory pools.
+ *
+ * @param[in] name      the name of the provider function
+ * @param[in] mrp       pointer to the @p MemoryRegion object
+ */
+#define CORE_REGION_PROVIDER_I(name, mrp)                                   \
+void *name(size_t size) {                                                   \
+  return chCoreAllocFromI(mrp, size);                                       \
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -82,6 +130,12 @@ extern "C" {
   void *chCoreAlloc(size_t size);
   void *chCoreAllocI(size_t size);
   size_t chCoreStatus(void);
+  void chCoreRegionInit(MemoryRegion *mrp, const char *name,
+                        void *base, size_t size, size_t align);
+  MemoryRegion *chCoreGetRegion(const char *name);
+  void *chCoreAllocFrom(MemoryRegion *mrp, size_t size);
+  void *chCoreAllocFromI(MemoryRegion *mrp, size_t size);
+  size_t chCoreRegionStatus(MemoryRegion *mrp);
 #ifdef __cplusplus
 }
 #endif
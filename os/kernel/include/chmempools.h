@@ -38,6 +38,36 @@
 
 #if CH_USE_MEMPOOLS || defined(__DOXYGEN__)
 
+/**
+ * @brief   Lock-free memory pools.
+ * @details The lock-free implementation is used if enabled by the
+ *          @p CH_USE_MEMPOOLS_LOCKFREE option and if the port implements
+ *          the double word compare and swap or the load-linked/
+ *          store-conditional list pop, else the pools fall back to the
+ *          kernel lock. The double word compare and swap is preferred when
+ *          both are available.
+ */
+#if (CH_USE_MEMPOOLS_LOCKFREE && defined(PORT_SUPPORTS_CAS2) &&            \
+     PORT_SUPPORTS_CAS2) || defined(__DOXYGEN__)
+#define MP_LOCKFREE                     TRUE
+#define MP_LOCKFREE_LLSC                FALSE
+#elif CH_USE_MEMPOOLS_LOCKFREE && defined(PORT_SUPPORTS_LLSC) &&           \
+      PORT_SUPPORTS_LLSC && defined(PORT_SUPPORTS_CAS) && PORT_SUPPORTS_CAS
+#define MP_LOCKFREE                     TRUE
+#define MP_LOCKFREE_LLSC                TRUE
+#else
+#define MP_LOCKFREE                     FALSE
+#define MP_LOCKFREE_LLSC                FALSE
+#endif
+
+/**
+ * @brief   Tagged list head.
+ * @details The list head is a tagged pointer updated by a double word
+ *          compare and swap, with the load-linked/store-conditional list
+ *          pop a plain pointer is enough.
+ */
+#define MP_TAGGED_HEAD                  (MP_LOCKFREE && !MP_LOCKFREE_LLSC)
+
 /**
  * @brief   Memory pool free object header.
  */
@@ -46,11 +76,31 @@ struct pool_header {
                                                     header in the list.     */
 };
 
+#if MP_TAGGED_HEAD || defined(__DOXYGEN__)
+/**
+ * @brief   Tagged memory pool list head.
+ * @details The tag is incremented on each update of the head so that a
+ *          compare and swap based on a stale copy of the head fails even
+ *          if the same object has been removed and reinserted meanwhile.
+ */
+typedef union {
+  port_cas2_t           mph_cas;        /**< @brief Double word view.       */
+  struct {
+    struct pool_header  *mph_next;      /**< @brief Pointer to the header.  */
+    size_t              mph_tag;        /**< @brief Modifications counter.  */
+  } mph;                                /**< @brief Head fields.            */
+} pool_head_t;
+#endif
+
 /**
  * @brief   Memory pool descriptor.
  */
 typedef struct {
+#if MP_TAGGED_HEAD || defined(__DOXYGEN__)
+  pool_head_t           mp_head;        /**< @brief Tagged list head.       */
+#else
   struct pool_header    *mp_next;       /**< @brief Pointer to the header.  */
+#endif
   size_t                mp_object_size; /**< @brief Memory pool objects
                                                     size.                   */
   memgetfunc_t          mp_provider;    /**< @brief Memory blocks provider for
@@ -66,8 +116,13 @@ typedef struct {
  * @param[in] size      size of the memory pool contained objects
  * @param[in] provider  memory provider function for the memory pool
  */
+#if MP_TAGGED_HEAD || defined(__DOXYGEN__)
+#define _MEMORYPOOL_DATA(name, size, provider)                              \
+  {{0}, size, provider}
+#else
 #define _MEMORYPOOL_DATA(name, size, provider)                              \
   {NULL, size, provider}
+#endif
 
 /**
  * @brief Static memory pool initializer in hungry mode.
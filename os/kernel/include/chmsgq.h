@@ -0,0 +1,158 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chmsgq.h
+ * @brief   Message Queues macros and structures.
+ *
+ * @addtogroup msgqueues
+ * @{
+ */
+
+#ifndef _CHMSGQ_H_
+#define _CHMSGQ_H_
+
+#if CH_USE_MSGQUEUES || defined(__DOXYGEN__)
+
+/*
+ * Module dependencies check.
+ */
+#if !CH_USE_SEMAPHORES
+#error "CH_USE_MSGQUEUES requires CH_USE_SEMAPHORES"
+#endif
+
+#if !CH_USE_MEMPOOLS
+#error "CH_USE_MSGQUEUES requires CH_USE_MEMPOOLS"
+#endif
+
+/**
+ * @brief   Message buffer header.
+ * @details The header is placed in front of the payload of each message
+ *          buffer, the buffer pointers used by the APIs point to the
+ *          payload.
+ */
+typedef struct MsgHeader {
+  struct MsgHeader      *mh_next;       /**< @brief Next queued message.    */
+  MemoryPool            *mh_pool;       /**< @brief Pool owning the buffer. */
+#if CH_USE_MSGQUEUES_PRIORITY || defined(__DOXYGEN__)
+  tprio_t               mh_prio;        /**< @brief Message priority.       */
+#endif
+} MsgHeader;
+
+/**
+ * @brief   Structure representing a message queue object.
+ */
+typedef struct {
+  MsgHeader             *mq_head;       /**< @brief First queued message.   */
+  MsgHeader             *mq_tail;       /**< @brief Last queued message.    */
+  Semaphore             mq_sem;         /**< @brief Queued messages counter
+                                                    @p Semaphore.           */
+} MsgQueue;
+
+/**
+ * @brief   Size of the pool objects for a given payload size.
+ * @details The memory pools used for the message buffers must be
+ *          initialized with this object size.
+ *
+ * @param[in] n         the payload size
+ */
+#define MSGQ_BUFFER_SIZE(n) (sizeof (MsgHeader) + (n))
+
+/**
+ * @name    Macro Functions
+ * @{
+ */
+#if CH_USE_MSGQUEUES_PRIORITY || defined(__DOXYGEN__)
+/**
+ * @brief   Sets the priority of a message buffer.
+ * @details The messages are queued after the ones with higher or equal
+ *          priority, the allocated buffers have priority @p NORMALPRIO.
+ *
+ * @param[in] buf       pointer to the message buffer
+ * @param[in] prio      the message priority
+ *
+ * @api
+ */
+#define chMsgBufSetPriority(buf, prio)                                      \
+        (((MsgHeader *)(buf) - 1)->mh_prio = (prio))
+#endif
+
+/**
+ * @brief   Returns the number of queued messages.
+ * @note    Can be invoked in any system state but if invoked out of a locked
+ *          state then the returned value may change after reading.
+ * @note    The returned value can be less than zero when there are waiting
+ *          threads on the internal semaphore.
+ *
+ * @param[in] mqp       the pointer to an initialized @p MsgQueue object
+ * @return              The number of queued messages.
+ *
+ * @iclass
+ */
+#define chMsgQGetUsedCountI(mqp) chSemGetCounterI(&(mqp)->mq_sem)
+/** @} */
+
+/**
+ * @brief   Data part of a static message queue initializer.
+ * @details This macro should be used when statically initializing a
+ *          message queue that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the message queue variable
+ */
+#define _MSGQUEUE_DATA(name) {NULL, NULL, _SEMAPHORE_DATA(name.mq_sem, 0)}
+
+/**
+ * @brief   Static message queue initializer.
+ * @details Statically initialized message queues require no explicit
+ *          initialization using @p chMsgQInit().
+ *
+ * @param[in] name      the name of the message queue variable
+ */
+#define MSGQUEUE_DECL(name) MsgQueue name = _MSGQUEUE_DATA(name)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void *chMsgBufAllocI(MemoryPool *mp);
+  void *chMsgBufAlloc(MemoryPool *mp);
+  void chMsgBufReleaseI(void *buf);
+  void chMsgBufRelease(void *buf);
+  void chMsgQInit(MsgQueue *mqp);
+  void chMsgQPost(MsgQueue *mqp, void *buf);
+  void chMsgQPostI(MsgQueue *mqp, void *buf);
+  void *chMsgQFetch(MsgQueue *mqp, systime_t time);
+  void *chMsgQFetchS(MsgQueue *mqp, systime_t time);
+  void *chMsgQFetchI(MsgQueue *mqp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CH_USE_MSGQUEUES */
+
+#endif /* _CHMSGQ_H_ */
+
+/** @} */
@@ -38,6 +38,19 @@
 
 #if CH_USE_MUTEXES || defined(__DOXYGEN__)
 
+/**
+ * @brief   Mutexes atomic fast path.
+ * @details The fast path is used if enabled by the
+ *          @p CH_USE_ATOMIC_FASTPATH option and if the port implements the
+ *          word compare and swap.
+ */
+#if (CH_USE_ATOMIC_FASTPATH && defined(PORT_SUPPORTS_CAS) &&                \
+     PORT_SUPPORTS_CAS) || defined(__DOXYGEN__)
+#define MTX_FASTPATH                    TRUE
+#else
+#define MTX_FASTPATH                    FALSE
+#endif
+
 /**
  * @brief   Mutex structure.
  */
@@ -45,15 +58,27 @@ typedef struct Mutex {
   ThreadsQueue          m_queue;    /**< @brief Queue of the threads sleeping
                                                 on this Mutex.              */
   Thread                *m_owner;   /**< @brief Owner @p Thread pointer or
-                                                @p NULL.                    */
+                                                @p NULL, see
+                                                @p chMtxGetOwnerI().        */
   struct Mutex          *m_next;    /**< @brief Next @p Mutex into an
                                                 owner-list or @p NULL.      */
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+  tprio_t               m_ceiling;  /**< @brief Priority ceiling or
+                                                @p NOPRIO for priority
+                                                inheritance.                */
+#endif
+#if CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+  lock_stats_t          m_stats;    /**< @brief Lock statistics.            */
+#endif
 } Mutex;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
   void chMtxInit(Mutex *mp);
+#if CH_USE_MUTEXES_CEILING
+  void chMtxInitCeiling(Mutex *mp, tprio_t ceiling);
+#endif
   void chMtxLock(Mutex *mp);
   void chMtxLockS(Mutex *mp);
   bool_t chMtxTryLock(Mutex *mp);
@@ -72,7 +97,22 @@ extern "C" {
  *
  * @param[in] name      the name of the mutex variable
  */
+#if !CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+#if !CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
 #define _MUTEX_DATA(name) {_THREADSQUEUE_DATA(name.m_queue), NULL, NULL}
+#else
+#define _MUTEX_DATA(name) {_THREADSQUEUE_DATA(name.m_queue), NULL, NULL,     \
+                           NOPRIO}
+#endif
+#else /* CH_DBG_LOCK_STATISTICS */
+#if !CH_USE_MUTEXES_CEILING
+#define _MUTEX_DATA(name) {_THREADSQUEUE_DATA(name.m_queue), NULL, NULL,     \
+                           _LOCK_STATS_DATA}
+#else
+#define _MUTEX_DATA(name) {_THREADSQUEUE_DATA(name.m_queue), NULL, NULL,     \
+                           NOPRIO, _LOCK_STATS_DATA}
+#endif
+#endif /* CH_DBG_LOCK_STATISTICS */
 
 /**
  * @brief   Static mutex initializer.
@@ -83,6 +123,35 @@ extern "C" {
  */
 #define MUTEX_DECL(name) Mutex name = _MUTEX_DATA(name)
 
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @brief   Data part of a static priority ceiling mutex initializer.
+ * @details This macro should be used when statically initializing a priority
+ *          ceiling mutex that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] ceiling   the priority ceiling
+ */
+#if !CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+#define _MUTEX_CEILING_DATA(name, ceiling)                                  \
+  {_THREADSQUEUE_DATA(name.m_queue), NULL, NULL, ceiling}
+#else
+#define _MUTEX_CEILING_DATA(name, ceiling)                                  \
+  {_THREADSQUEUE_DATA(name.m_queue), NULL, NULL, ceiling, _LOCK_STATS_DATA}
+#endif
+
+/**
+ * @brief   Static priority ceiling mutex initializer.
+ * @details Statically initialized mutexes require no explicit initialization
+ *          using @p chMtxInitCeiling().
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] ceiling   the priority ceiling
+ */
+#define MUTEX_CEILING_DECL(name, ceiling)                                   \
+  Mutex name = _MUTEX_CEILING_DATA(name, ceiling)
+#endif
+
 /**
  * @name    Macro Functions
  * @{
@@ -94,6 +163,42 @@ extern "C" {
  * @sclass
  */
 #define chMtxQueueNotEmptyS(mp) notempty(&(mp)->m_queue)
+
+/**
+ * @brief   Names a mutex for the lock statistics.
+ * @details The mutex is added to the list of the named locks, if the
+ *          option @p CH_DBG_LOCK_STATISTICS is disabled then no action is
+ *          performed.
+ *
+ * @param[in] mp        pointer to the @p Mutex structure
+ * @param[in] name      mutex name as a zero terminated string
+ *
+ * @api
+ */
+#if CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+#define chMtxSetName(mp, name) chDbgLockRegister(&(mp)->m_stats, (name))
+#else
+#define chMtxSetName(mp, name)
+#endif
+
+/**
+ * @brief   Returns the mutex owner.
+ * @note    When the atomic fast path is enabled the least significant bit
+ *          of the @p m_owner field flags the presence of waiting threads
+ *          so the field must not be accessed directly.
+ *
+ * @param[in] mp        pointer to the @p Mutex structure
+ * @return              The owner thread or @p NULL if the mutex is not
+ *                      owned.
+ *
+ * @iclass
+ */
+#if MTX_FASTPATH || defined(__DOXYGEN__)
+#define chMtxGetOwnerI(mp)                                                  \
+  ((Thread *)((size_t)(mp)->m_owner & ~(size_t)1))
+#else
+#define chMtxGetOwnerI(mp) ((mp)->m_owner)
+#endif
 /** @} */
 
 #endif /* CH_USE_MUTEXES */
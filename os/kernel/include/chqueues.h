@@ -76,8 +76,22 @@ struct GenericQueue {
   uint8_t               *q_rdptr;   /**< @brief Read pointer.               */
   qnotify_t             q_notify;   /**< @brief Data notification callback. */
   void                  *q_link;    /**< @brief Application defined field.  */
+#if CH_USE_WAITSETS || defined(__DOXYGEN__)
+  struct WaitSetEntry   *q_wslist;  /**< @brief Wait sets entries watching
+                                                the queue.                  */
+#endif
 };
 
+/*
+ * Trailing part of the static queue initializers, the wait sets list is
+ * only present if the wait sets are enabled.
+ */
+#if CH_USE_WAITSETS
+#define _QUEUE_WSLIST_DATA , NULL
+#else
+#define _QUEUE_WSLIST_DATA
+#endif
+
 /**
  * @name    Macro Functions
  * @{
@@ -215,6 +229,7 @@ typedef GenericQueue InputQueue;
   (uint8_t *)(buffer),                                                      \
   (inotify),                                                                \
   (link)                                                                    \
+  _QUEUE_WSLIST_DATA                                                        \
 }
 
 /**
@@ -332,6 +347,7 @@ typedef GenericQueue OutputQueue;
   (uint8_t *)(buffer),                                                      \
   (onotify),                                                                \
   (link)                                                                    \
+  _QUEUE_WSLIST_DATA                                                        \
 }
 
 /**
@@ -355,6 +371,9 @@ extern "C" {
                 void *link);
   void chIQResetI(InputQueue *iqp);
   msg_t chIQPutI(InputQueue *iqp, uint8_t b);
+  size_t chIQWriteI(InputQueue *iqp, const uint8_t *bp, size_t n);
+  uint8_t *chIQGetEmptySpanI(InputQueue *iqp, size_t *np);
+  void chIQCommitI(InputQueue *iqp, size_t n);
   msg_t chIQGetTimeout(InputQueue *iqp, systime_t time);
   size_t chIQReadTimeout(InputQueue *iqp, uint8_t *bp,
                          size_t n, systime_t time);
@@ -364,6 +383,9 @@ extern "C" {
   void chOQResetI(OutputQueue *oqp);
   msg_t chOQPutTimeout(OutputQueue *oqp, uint8_t b, systime_t time);
   msg_t chOQGetI(OutputQueue *oqp);
+  size_t chOQReadI(OutputQueue *oqp, uint8_t *bp, size_t n);
+  uint8_t *chOQGetFullSpanI(OutputQueue *oqp, size_t *np);
+  void chOQConsumeI(OutputQueue *oqp, size_t n);
   size_t chOQWriteTimeout(OutputQueue *oqp, const uint8_t *bp,
                           size_t n, systime_t time);
 #ifdef __cplusplus
@@ -36,8 +36,50 @@
 #ifndef _CHREGISTRY_H_
 #define _CHREGISTRY_H_
 
+/*
+ * Module dependencies check.
+ */
+#if CH_USE_REGISTRY_INDEX && !CH_USE_REGISTRY
+#error "CH_USE_REGISTRY_INDEX requires CH_USE_REGISTRY"
+#endif
+
 #if CH_USE_REGISTRY || defined(__DOXYGEN__)
 
+#if CH_USE_REGISTRY_INDEX || defined(__DOXYGEN__)
+/**
+ * @name    Registry index settings
+ * @{
+ */
+/**
+ * @brief   Size of the thread identifiers table.
+ * @details This is the maximum number of threads that can be indexed at
+ *          the same time, threads created when the table is full are not
+ *          assigned an identifier.
+ * @note    Must be a power of two not greater than 256.
+ */
+#if !defined(REG_INDEX_SIZE) || defined(__DOXYGEN__)
+#define REG_INDEX_SIZE          32
+#endif
+
+/**
+ * @brief   Number of buckets in the thread names hash table.
+ * @note    Must be a power of two.
+ */
+#if !defined(REG_HASH_SIZE) || defined(__DOXYGEN__)
+#define REG_HASH_SIZE           16
+#endif
+/** @} */
+
+#if (REG_INDEX_SIZE < 1) || (REG_INDEX_SIZE > 256) ||                      \
+    ((REG_INDEX_SIZE & (REG_INDEX_SIZE - 1)) != 0)
+#error "invalid REG_INDEX_SIZE value"
+#endif
+
+#if (REG_HASH_SIZE < 1) || ((REG_HASH_SIZE & (REG_HASH_SIZE - 1)) != 0)
+#error "invalid REG_HASH_SIZE value"
+#endif
+#endif /* CH_USE_REGISTRY_INDEX */
+
 /**
  * @brief   ChibiOS/RT memory signature record.
  */
@@ -68,16 +110,20 @@ typedef struct {
  * @name    Macro Functions
  * @{
  */
+#if !CH_USE_REGISTRY_INDEX || defined(__DOXYGEN__)
 /**
  * @brief   Sets the current thread name.
  * @pre     This function only stores the pointer to the name if the option
  *          @p CH_USE_REGISTRY is enabled else no action is performed.
+ * @note    If the option @p CH_USE_REGISTRY_INDEX is enabled then this is
+ *          a function updating the names hash table.
  *
  * @param[in] p         thread name as a zero terminated string
  *
  * @api
  */
 #define chRegSetThreadName(p) (currp->p_name = (p))
+#endif
 
 /**
  * @brief   Returns the name of the specified thread.
@@ -90,6 +136,24 @@ typedef struct {
  * @retval NULL         if the thread name has not been set.
  */
 #define chRegGetThreadName(tp) ((tp)->p_name)
+
+#if CH_USE_REGISTRY_INDEX || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the identifier of the specified thread.
+ * @details The identifier can be passed around in place of the thread
+ *          pointer and resolved using @p chRegFindThreadById(), the
+ *          identifier of a terminated thread is not reused by the threads
+ *          created after it.
+ * @pre     The option @p CH_USE_REGISTRY_INDEX must be enabled.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @return              Thread identifier.
+ * @retval 0            if the thread is not indexed because the identifiers
+ *                      table was full at its creation.
+ */
+#define chRegGetThreadId(tp) ((tp)->p_id)
+#endif
 /** @} */
 #else /* !CH_USE_REGISTRY */
 #define chRegSetThreadName(p)
@@ -97,20 +161,31 @@ typedef struct {
 #endif /* !CH_USE_REGISTRY */
 
 #if CH_USE_REGISTRY || defined(__DOXYGEN__)
+#if CH_USE_REGISTRY_INDEX || defined(__DOXYGEN__)
+#define REG_INDEX_INSERT(tp) _reg_index_insert(tp)
+#define REG_INDEX_REMOVE(tp) _reg_index_remove(tp)
+#else
+#define REG_INDEX_INSERT(tp)
+#define REG_INDEX_REMOVE(tp)
+#endif
+
 /**
  * @brief   Removes a thread from the registry list.
  * @note    This macro is not meant for use in application code.
+ * @note    The kernel must be locked.
  *
  * @param[in] tp        thread to remove from the registry
  */
 #define REG_REMOVE(tp) {                                                    \
   (tp)->p_older->p_newer = (tp)->p_newer;                                   \
   (tp)->p_newer->p_older = (tp)->p_older;                                   \
+  REG_INDEX_REMOVE(tp);                                                     \
 }
 
 /**
  * @brief   Adds a thread to the registry list.
  * @note    This macro is not meant for use in application code.
+ * @note    The kernel must be locked.
  *
  * @param[in] tp        thread to add to the registry
  */
@@ -118,6 +193,7 @@ typedef struct {
   (tp)->p_newer = (Thread *)&rlist;                                         \
   (tp)->p_older = rlist.r_older;                                            \
   (tp)->p_older->p_newer = rlist.r_older = (tp);                            \
+  REG_INDEX_INSERT(tp);                                                     \
 }
 
 #ifdef __cplusplus
@@ -126,6 +202,19 @@ extern "C" {
   extern ROMCONST chdebug_t ch_debug;
   Thread *chRegFirstThread(void);
   Thread *chRegNextThread(Thread *tp);
+#if CH_USE_REGISTRY_INDEX
+  void _reg_init(void);
+  void _reg_index_insert(Thread *tp);
+  void _reg_index_remove(Thread *tp);
+  void chRegSetThreadName(const char *name);
+  Thread *chRegFindThreadById(tid_t id);
+  Thread *chRegFindThreadByName(const char *name);
+#endif
+#if CH_DBG_STATISTICS
+  void chRegGetThreadStats(Thread *tp, thread_stats_t *tsp);
+  void chRegGetKernelStats(kernel_stats_t *ksp);
+  void chRegResetStats(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,199 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chring.h
+ * @brief   Lock-free ring buffers and doorbells macros and structures.
+ *
+ * @addtogroup ringbuffers
+ * @{
+ */
+
+#ifndef _CHRING_H_
+#define _CHRING_H_
+
+#if CH_USE_RINGBUFFERS || defined(__DOXYGEN__)
+
+/**
+ * @brief   Doorbells polling period in system ticks.
+ * @details In tickless mode there is no periodic interrupt serving the rung
+ *          doorbells, a virtual timer with this period is kept armed while
+ *          a thread is waiting on a doorbell.
+ * @note    Only used when @p CH_TIMEDELTA is greater than zero.
+ */
+#ifndef CH_DOORBELL_POLL_PERIOD
+#define CH_DOORBELL_POLL_PERIOD     MS2ST(1)
+#endif
+
+/**
+ * @brief   Memory barrier.
+ * @details Default for ports not providing the barrier, the ring buffer
+ *          fields are accessed as volatile so the compiler keeps the
+ *          accesses in program order.
+ */
+#if !defined(port_memory_barrier) || defined(__DOXYGEN__)
+#define port_memory_barrier()
+#endif
+
+/**
+ * @brief   Structure representing a ring buffer object.
+ * @details The ring buffer keeps one slot empty in order to distinguish
+ *          the full and empty conditions, a buffer of @p n slots holds up
+ *          to <tt>n - 1</tt> messages.
+ */
+typedef struct {
+  volatile msg_t        *rb_buffer;     /**< @brief Pointer to the buffer
+                                                    area.                   */
+  volatile msg_t        *rb_top;        /**< @brief Pointer to the location
+                                                    after the buffer.       */
+  volatile msg_t * volatile rb_wrptr;   /**< @brief Write pointer, only
+                                                    written by the
+                                                    producer.               */
+  volatile msg_t * volatile rb_rdptr;   /**< @brief Read pointer, only
+                                                    written by the
+                                                    consumer.               */
+} RingBuffer;
+
+/**
+ * @brief   Type of a doorbell object.
+ */
+typedef struct Doorbell Doorbell;
+
+/**
+ * @brief   Structure representing a doorbell object.
+ */
+struct Doorbell {
+  Doorbell              *db_next;       /**< @brief Next registered
+                                                    doorbell.               */
+  volatile cnt_t        db_rung;        /**< @brief Rings counter, only
+                                                    written by the ringer.  */
+  cnt_t                 db_served;      /**< @brief Value of the rings
+                                                    counter at the last
+                                                    wakeup.                 */
+  Thread                *db_thread;     /**< @brief Waiting thread or
+                                                    @p NULL.                */
+};
+
+/**
+ * @brief   Doorbells registry structure.
+ */
+typedef struct {
+  Doorbell              *dl_next;       /**< @brief First registered
+                                                    doorbell.               */
+  volatile bool_t       dl_pending;     /**< @brief At least a doorbell has
+                                                    been rung since the last
+                                                    serve.                  */
+#if (CH_TIMEDELTA > 0) || defined(__DOXYGEN__)
+  VirtualTimer          dl_vt;          /**< @brief Polling timer used in
+                                                    tickless mode.          */
+#endif
+} DoorbellList;
+
+/**
+ * @name    Macro Functions
+ * @{
+ */
+/**
+ * @brief   Evaluates to @p TRUE if the ring buffer is empty.
+ *
+ * @param[in] rbp       the pointer to an initialized @p RingBuffer object
+ * @return              The ring buffer status.
+ *
+ * @special
+ */
+#define chRbIsEmpty(rbp) ((bool_t)((rbp)->rb_wrptr == (rbp)->rb_rdptr))
+/** @} */
+
+/**
+ * @brief   Data part of a static ring buffer initializer.
+ * @details This macro should be used when statically initializing a
+ *          ring buffer that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the ring buffer variable
+ * @param[in] buffer    pointer to the ring buffer array of @p msg_t
+ * @param[in] size      number of @p msg_t elements in the buffer array
+ */
+#define _RINGBUFFER_DATA(name, buffer, size) {                              \
+  (msg_t *)(buffer),                                                        \
+  (msg_t *)(buffer) + (size),                                               \
+  (msg_t *)(buffer),                                                        \
+  (msg_t *)(buffer)                                                         \
+}
+
+/**
+ * @brief   Static ring buffer initializer.
+ * @details Statically initialized ring buffers require no explicit
+ *          initialization using @p chRbInit().
+ *
+ * @param[in] name      the name of the ring buffer variable
+ * @param[in] buffer    pointer to the ring buffer array of @p msg_t
+ * @param[in] size      number of @p msg_t elements in the buffer array
+ */
+#define RINGBUFFER_DECL(name, buffer, size)                                 \
+  RingBuffer name = _RINGBUFFER_DATA(name, buffer, size)
+
+/**
+ * @brief   Serves the rung doorbells on exit from a kernel-level ISR.
+ * @details Invoked by @p CH_IRQ_EPILOGUE(), the test is a single memory
+ *          read when no doorbell has been rung.
+ */
+#define db_serve_isr() {                                                    \
+  if (dblist.dl_pending) {                                                  \
+    chSysLockFromIsr();                                                     \
+    chDbServeI();                                                           \
+    chSysUnlockFromIsr();                                                   \
+  }                                                                         \
+}
+
+#if !defined(__DOXYGEN__)
+extern DoorbellList dblist;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRbInit(RingBuffer *rbp, msg_t *buf, cnt_t n);
+  bool_t chRbPut(RingBuffer *rbp, msg_t msg);
+  bool_t chRbGet(RingBuffer *rbp, msg_t *msgp);
+  cnt_t chRbGetUsedCount(RingBuffer *rbp);
+  void _db_init(void);
+  void chDbInit(Doorbell *dbp);
+  void chDbRing(Doorbell *dbp);
+  void chDbServeI(void);
+  msg_t chDbWaitTimeoutS(Doorbell *dbp, systime_t time);
+  msg_t chDbWaitTimeout(Doorbell *dbp, systime_t time);
+#ifdef __cplusplus
+}
+#endif
+
+#else /* !CH_USE_RINGBUFFERS */
+#define db_serve_isr()
+#endif /* !CH_USE_RINGBUFFERS */
+
+#endif /* _CHRING_H_ */
+
+/** @} */
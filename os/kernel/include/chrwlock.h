@@ -0,0 +1,124 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chrwlock.h
+ * @brief   Readers-Writer Locks macros and structures.
+ *
+ * @addtogroup rwlocks
+ * @{
+ */
+
+#ifndef _CHRWLOCK_H_
+#define _CHRWLOCK_H_
+
+#if CH_USE_RWLOCKS || defined(__DOXYGEN__)
+
+/**
+ * @brief   RWLock structure.
+ */
+typedef struct RWLock {
+  ThreadsQueue          rw_rqueue;      /**< @brief Queue of the waiting
+                                             readers, priority ordered.     */
+  ThreadsQueue          rw_wqueue;      /**< @brief Queue of the waiting
+                                             writers, priority ordered.     */
+  Thread                *rw_owner;      /**< @brief Writer owning the lock
+                                             or @p NULL.                    */
+  cnt_t                 rw_readers;     /**< @brief Number of readers
+                                             holding the lock.              */
+} RWLock;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRWLockInit(RWLock *rwp);
+  void chRWLockReadLock(RWLock *rwp);
+  void chRWLockReadLockS(RWLock *rwp);
+  msg_t chRWLockReadLockTimeout(RWLock *rwp, systime_t time);
+  msg_t chRWLockReadLockTimeoutS(RWLock *rwp, systime_t time);
+  void chRWLockReadUnlock(RWLock *rwp);
+  void chRWLockReadUnlockS(RWLock *rwp);
+  void chRWLockWriteLock(RWLock *rwp);
+  void chRWLockWriteLockS(RWLock *rwp);
+  msg_t chRWLockWriteLockTimeout(RWLock *rwp, systime_t time);
+  msg_t chRWLockWriteLockTimeoutS(RWLock *rwp, systime_t time);
+  void chRWLockWriteUnlock(RWLock *rwp);
+  void chRWLockWriteUnlockS(RWLock *rwp);
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @brief   Data part of a static readers-writer lock initializer.
+ * @details This macro should be used when statically initializing a
+ *          readers-writer lock that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the readers-writer lock variable
+ */
+#define _RWLOCK_DATA(name) {_THREADSQUEUE_DATA(name.rw_rqueue),             \
+                            _THREADSQUEUE_DATA(name.rw_wqueue), NULL, 0}
+
+/**
+ * @brief   Static readers-writer lock initializer.
+ * @details Statically initialized readers-writer locks require no explicit
+ *          initialization using @p chRWLockInit().
+ *
+ * @param[in] name      the name of the readers-writer lock variable
+ */
+#define RWLOCK_DECL(name) RWLock name = _RWLOCK_DATA(name)
+
+/**
+ * @name    Macro Functions
+ * @{
+ */
+/**
+ * @brief   Returns the number of readers holding the lock.
+ *
+ * @param[in] rwp       pointer to a @p RWLock structure
+ * @return              The number of readers.
+ *
+ * @iclass
+ */
+#define chRWLockGetReadersI(rwp) ((rwp)->rw_readers)
+
+/**
+ * @brief   Returns the writer owning the lock.
+ *
+ * @param[in] rwp       pointer to a @p RWLock structure
+ * @return              The pointer to the owner thread.
+ * @retval NULL         if the lock is not owned by a writer.
+ *
+ * @iclass
+ */
+#define chRWLockGetWriterI(rwp) ((rwp)->rw_owner)
+/** @} */
+
+#endif /* CH_USE_RWLOCKS */
+
+#endif /* _CHRWLOCK_H_ */
+
+/** @} */
@@ -78,6 +78,23 @@
 #define TIME_INFINITE   ((systime_t)-1)
 /** @} */
 
+#if CH_USE_READYLIST_BITMAP || defined(__DOXYGEN__)
+/**
+ * @name    Ready list bitmap constants
+ * @{
+ */
+/**
+ * @brief   Number of priority levels tracked by the ready list.
+ */
+#define RL_PRIO_LEVELS  (HIGHPRIO + 1)
+
+/**
+ * @brief   Number of 32 bits words composing the priority levels bitmap.
+ */
+#define RL_MAP_WORDS    ((RL_PRIO_LEVELS + 31) / 32)
+/** @} */
+#endif /* CH_USE_READYLIST_BITMAP */
+
 /**
  * @brief   Returns the priority of the first thread on the given ready list.
  *
@@ -104,6 +121,16 @@ typedef struct {
   /* End of the fields shared with the Thread structure.*/
   Thread                *r_current; /**< @brief The currently running
                                                 thread.                     */
+#if CH_USE_READYLIST_BITMAP || defined(__DOXYGEN__)
+  uint32_t              r_mapmask;  /**< @brief Non-empty words in
+                                                @p r_map.                   */
+  uint32_t              r_map[RL_MAP_WORDS];
+                                    /**< @brief Non-empty priority levels
+                                                bitmap.                     */
+  Thread                *r_tails[RL_PRIO_LEVELS];
+                                    /**< @brief Last thread of each
+                                                non-empty priority level.   */
+#endif
 } ReadyList;
 #endif /* !defined(PORT_OPTIMIZED_READYLIST_STRUCT) */
 
@@ -143,6 +170,9 @@ extern "C" {
 #if !defined(PORT_OPTIMIZED_READYI)
   Thread *chSchReadyI(Thread *tp);
 #endif
+#if CH_USE_READYLIST_BITMAP || defined(__DOXYGEN__)
+  Thread *chSchDequeueI(Thread *tp);
+#endif
 #if !defined(PORT_OPTIMIZED_GOSLEEPS)
   void chSchGoSleepS(tstate_t newstate);
 #endif
@@ -175,6 +205,12 @@ extern "C" {
  * @name    Macro Functions
  * @{
  */
+/* Without the priority levels bitmap the ready list is a plain threads
+   queue and the removal is a simple dequeue operation.*/
+#if !CH_USE_READYLIST_BITMAP && !defined(__DOXYGEN__)
+#define chSchDequeueI(tp) dequeue(tp)
+#endif /* !CH_USE_READYLIST_BITMAP */
+
 /**
  * @brief   Determines if the current thread must reschedule.
  * @details This function returns @p TRUE if there is a ready thread with
@@ -38,6 +38,19 @@
 
 #if CH_USE_SEMAPHORES || defined(__DOXYGEN__)
 
+/**
+ * @brief   Semaphores atomic fast path.
+ * @details The fast path is used if enabled by the
+ *          @p CH_USE_ATOMIC_FASTPATH option and if the port implements the
+ *          word compare and swap.
+ */
+#if (CH_USE_ATOMIC_FASTPATH && defined(PORT_SUPPORTS_CAS) &&                \
+     PORT_SUPPORTS_CAS) || defined(__DOXYGEN__)
+#define SEM_FASTPATH                    TRUE
+#else
+#define SEM_FASTPATH                    FALSE
+#endif
+
 /**
  * @brief   Semaphore structure.
  */
@@ -45,6 +58,13 @@ typedef struct Semaphore {
   ThreadsQueue          s_queue;    /**< @brief Queue of the threads sleeping
                                                 on this semaphore.          */
   cnt_t                 s_cnt;      /**< @brief The semaphore counter.      */
+#if CH_USE_WAITSETS || defined(__DOXYGEN__)
+  struct WaitSetEntry   *s_wslist;  /**< @brief Wait sets entries watching
+                                                the semaphore.              */
+#endif
+#if CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+  lock_stats_t          s_stats;    /**< @brief Lock statistics.            */
+#endif
 } Semaphore;
 
 #ifdef __cplusplus
@@ -76,7 +96,21 @@ extern "C" {
  * @param[in] n         the counter initial value, this value must be
  *                      non-negative
  */
+#if !CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+#if !CH_USE_WAITSETS || defined(__DOXYGEN__)
 #define _SEMAPHORE_DATA(name, n) {_THREADSQUEUE_DATA(name.s_queue), n}
+#else
+#define _SEMAPHORE_DATA(name, n) {_THREADSQUEUE_DATA(name.s_queue), n, NULL}
+#endif
+#else /* CH_DBG_LOCK_STATISTICS */
+#if !CH_USE_WAITSETS
+#define _SEMAPHORE_DATA(name, n) {_THREADSQUEUE_DATA(name.s_queue), n,     \
+                                  _LOCK_STATS_DATA}
+#else
+#define _SEMAPHORE_DATA(name, n) {_THREADSQUEUE_DATA(name.s_queue), n,     \
+                                  NULL, _LOCK_STATS_DATA}
+#endif
+#endif /* CH_DBG_LOCK_STATISTICS */
 
 /**
  * @brief   Static semaphore initializer.
@@ -116,6 +150,23 @@ extern "C" {
  * @iclass
  */
 #define chSemGetCounterI(sp)    ((sp)->s_cnt)
+
+/**
+ * @brief   Names a semaphore for the lock statistics.
+ * @details The semaphore is added to the list of the named locks, if the
+ *          option @p CH_DBG_LOCK_STATISTICS is disabled then no action is
+ *          performed.
+ *
+ * @param[in] sp        pointer to a @p Semaphore structure
+ * @param[in] name      semaphore name as a zero terminated string
+ *
+ * @api
+ */
+#if CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+#define chSemSetName(sp, name) chDbgLockRegister(&(sp)->s_stats, (name))
+#else
+#define chSemSetName(sp, name)
+#endif
 /** @} */
 
 #endif /* CH_USE_SEMAPHORES */
@@ -36,6 +36,65 @@
 #ifndef _CHSYS_H_
 #define _CHSYS_H_
 
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Kernel runtime statistics.
+ * @details Times are expressed in realtime counter ticks, see
+ *          @p PORT_RT_FREQUENCY.
+ */
+typedef struct {
+  uint32_t              ks_last;    /**< @brief Counter value at the last
+                                                accounting point.           */
+  uint64_t              ks_isr_time;/**< @brief Cumulative time spent in
+                                                ISRs.                       */
+  uint32_t              ks_isr_count;/**< @brief Number of served ISRs.     */
+  uint32_t              ks_switches;/**< @brief Number of context
+                                                switches.                   */
+  cnt_t                 ks_isr_nesting;/**< @brief ISRs nesting level.      */
+} kernel_stats_t;
+#endif
+
+#if CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Number of top waiters recorded for each lock.
+ */
+#if !defined(LOCK_STATS_WAITERS) || defined(__DOXYGEN__)
+#define LOCK_STATS_WAITERS      4
+#endif
+
+/**
+ * @brief   Lock statistics.
+ * @details Times are expressed in realtime counter ticks, see
+ *          @p PORT_RT_FREQUENCY. The hold times are only measured for
+ *          mutexes.
+ */
+typedef struct lock_stats {
+  struct lock_stats     *ls_next;   /**< @brief Next named lock.            */
+  const char            *ls_name;   /**< @brief Lock name.                  */
+  uint32_t              ls_acquisitions;/**< @brief Number of successful
+                                                acquisitions.               */
+  uint32_t              ls_contentions;/**< @brief Number of waits.         */
+  uint64_t              ls_wait_total;/**< @brief Cumulative wait time.     */
+  uint32_t              ls_wait_max;/**< @brief Longest wait.               */
+  uint32_t              ls_hold_start;/**< @brief Counter value at the last
+                                                acquisition.                */
+  uint32_t              ls_hold_max;/**< @brief Longest hold.               */
+  struct {
+    Thread              *lw_thread; /**< @brief Waiting thread or
+                                                @p NULL.                    */
+    uint32_t            lw_time;    /**< @brief Longest wait of the
+                                                thread.                     */
+  } ls_waiters[LOCK_STATS_WAITERS]; /**< @brief Threads with the longest
+                                                waits, sorted by wait
+                                                time.                       */
+} lock_stats_t;
+
+/**
+ * @brief   Data part of a static lock statistics initializer.
+ */
+#define _LOCK_STATS_DATA {0}
+#endif
+
 /**
  * @name    Macro Functions
  * @{
@@ -87,6 +146,8 @@
  */
 #define chSysSwitch(ntp, otp) {                                             \
   dbg_trace(otp);                                                           \
+  dbg_stats_switch(ntp, otp);                                               \
+  trace_switch(ntp, otp);                                                   \
   THREAD_CONTEXT_SWITCH_HOOK(ntp, otp);                                     \
   port_switch(ntp, otp);                                                    \
 }
@@ -202,7 +263,9 @@
  */
 #define CH_IRQ_PROLOGUE()                                                   \
   PORT_IRQ_PROLOGUE();                                                      \
-  dbg_check_enter_isr();
+  dbg_check_enter_isr();                                                    \
+  dbg_stats_enter_isr();                                                    \
+  trace_isr_enter();
 
 /**
  * @brief   IRQ handler exit code.
@@ -213,6 +276,9 @@
  * @special
  */
 #define CH_IRQ_EPILOGUE()                                                   \
+  trace_isr_leave();                                                        \
+  dbg_stats_leave_isr();                                                    \
+  db_serve_isr();                                                           \
   dbg_check_leave_isr();                                                    \
   PORT_IRQ_EPILOGUE();
 
@@ -0,0 +1,318 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chtasks.h
+ * @brief   Stackless Tasks macros and structures.
+ *
+ * @addtogroup tasks
+ * @{
+ */
+
+#ifndef _CHTASKS_H_
+#define _CHTASKS_H_
+
+#if CH_USE_TASKS || defined(__DOXYGEN__)
+
+/*
+ * Module dependencies check.
+ */
+#if !CH_USE_WAITSETS
+#error "CH_USE_TASKS requires CH_USE_WAITSETS"
+#endif
+
+#if !CH_USE_EVENTS
+#error "CH_USE_TASKS requires CH_USE_EVENTS"
+#endif
+
+/**
+ * @brief   Event used to notify the host thread about ready tasks.
+ * @note    The event must not be used by the application in the host
+ *          thread.
+ */
+#if !defined(TASK_READY_EVENT) || defined(__DOXYGEN__)
+#define TASK_READY_EVENT    ((eventmask_t)1 << (sizeof (eventmask_t) * 8 - 1))
+#endif
+
+/**
+ * @name    Task function return codes
+ * @{
+ */
+#define TASK_WAITING        0   /**< @brief The task is waiting.            */
+#define TASK_YIELDED        1   /**< @brief The task is still ready.        */
+#define TASK_EXITED         2   /**< @brief The task terminated.            */
+/** @} */
+
+/**
+ * @name    Task states
+ * @{
+ */
+#define TASK_STATE_READY    0   /**< @brief Waiting in the ready list.      */
+#define TASK_STATE_CURRENT  1   /**< @brief Currently executing.            */
+#define TASK_STATE_WTOBJ    2   /**< @brief Waiting on a semaphore or a
+                                     mailbox.                               */
+#define TASK_STATE_WTEVT    3   /**< @brief Waiting for events.             */
+#define TASK_STATE_SLEEPING 4   /**< @brief Sleeping.                       */
+#define TASK_STATE_FINAL    5   /**< @brief Terminated.                     */
+/** @} */
+
+/**
+ * @brief   Type of a task.
+ */
+typedef struct Task Task;
+
+/**
+ * @brief   Task function type.
+ * @details The function returns one of @p TASK_WAITING, @p TASK_YIELDED or
+ *          @p TASK_EXITED, the return codes are handled by the task macros.
+ */
+typedef msg_t (*taskfunc_t)(Task *tp);
+
+/**
+ * @brief   Tasks scheduler structure.
+ */
+typedef struct {
+  Task                  *ts_rhead;      /**< @brief First ready task.       */
+  Task                  *ts_rtail;      /**< @brief Last ready task.        */
+  Task                  *ts_evlist;     /**< @brief Tasks waiting for
+                                             events.                        */
+  Task                  *ts_slist;      /**< @brief Sleeping tasks delta
+                                             list.                          */
+  systime_t             ts_lasttime;    /**< @brief System time of the last
+                                             sleeping tasks update.         */
+  Thread                *ts_thread;     /**< @brief Host thread or
+                                             @p NULL.                       */
+  cnt_t                 ts_n;           /**< @brief Number of tasks not yet
+                                             terminated.                    */
+} TaskScheduler;
+
+/**
+ * @brief   Task structure.
+ * @note    The watcher data must be the first field, a waiting task is
+ *          linked in the list of the watched object.
+ */
+struct Task {
+  _wait_set_entry_data
+  Task                  *t_next;        /**< @brief Next task in the ready,
+                                             events or sleeping list.       */
+  TaskScheduler         *t_tsp;         /**< @brief Owner scheduler.        */
+  taskfunc_t            t_func;         /**< @brief Task function.          */
+  void                  *t_arg;         /**< @brief Task argument.          */
+  WaitSetEntry          **t_wlpp;       /**< @brief List of the watched
+                                             object or @p NULL.             */
+  union {
+    eventmask_t         events;         /**< @brief Events waited for or
+                                             received.                      */
+    systime_t           delta;          /**< @brief Sleep delta.            */
+  }                     t_u;
+  uint16_t              t_lc;           /**< @brief Resume point.           */
+  uint8_t               t_state;        /**< @brief Current task state.     */
+};
+
+/**
+ * @name    Task macros
+ * @details The task functions are stackless coroutines, the execution
+ *          is resumed after the last blocking macro when the task function
+ *          is invoked again.
+ * @note    The local variables of a task function are not preserved
+ *          across blocking macros, the task state must be kept in the
+ *          structure pointed by the task argument.
+ * @note    The blocking macros cannot be used inside a @p switch statement
+ *          of the task function.
+ * @{
+ */
+/**
+ * @brief   Starts the body of a task function.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ */
+#define TASK_BEGIN(tp)      switch ((tp)->t_lc) { case 0:
+
+/**
+ * @brief   Ends the body of a task function.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ */
+#define TASK_END(tp)        } (tp)->t_lc = 0; return TASK_EXITED
+
+/**
+ * @brief   Terminates the task.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ */
+#define TASK_EXIT(tp) do {                                                  \
+  (tp)->t_lc = 0;                                                           \
+  return TASK_EXITED;                                                       \
+} while (0)
+
+/**
+ * @brief   Yields the host thread to the other ready tasks.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ */
+#define TASK_YIELD(tp) do {                                                 \
+  (tp)->t_lc = __LINE__;                                                    \
+  return TASK_YIELDED;                                                      \
+  case __LINE__:;                                                           \
+} while (0)
+
+/**
+ * @brief   Yields until a condition is true.
+ * @note    The condition is evaluated each time the task is scheduled, the
+ *          task is not made waiting.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @param[in] cond      the condition
+ */
+#define TASK_WAIT_UNTIL(tp, cond) do {                                      \
+  while (!(cond)) {                                                         \
+    (tp)->t_lc = __LINE__;                                                  \
+    return TASK_YIELDED;                                                    \
+  case __LINE__:;                                                           \
+  }                                                                         \
+} while (0)
+
+/**
+ * @brief   Waits on a semaphore.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @param[in] sp        pointer to the @p Semaphore structure
+ */
+#define TASK_SEM_WAIT(tp, sp) do {                                          \
+  while (!_task_sem_wait(tp, sp)) {                                         \
+    (tp)->t_lc = __LINE__;                                                  \
+    return TASK_WAITING;                                                    \
+  case __LINE__:;                                                           \
+  }                                                                         \
+} while (0)
+
+#if CH_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @brief   Fetches a message from a mailbox.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @param[in] mbp       pointer to the @p Mailbox structure
+ * @param[out] msgp     pointer to a message variable for the received
+ *                      message, the variable must not be local
+ */
+#define TASK_MB_FETCH(tp, mbp, msgp) do {                                   \
+  while (!_task_mb_fetch(tp, mbp, msgp)) {                                  \
+    (tp)->t_lc = __LINE__;                                                  \
+    return TASK_WAITING;                                                    \
+  case __LINE__:;                                                           \
+  }                                                                         \
+} while (0)
+#endif
+
+/**
+ * @brief   Waits for any of the specified events.
+ * @details The events are received by the host thread, the received events
+ *          can be retrieved using @p chTaskGetEvents().
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @param[in] mask      mask of the events to wait for
+ */
+#define TASK_EVT_WAIT(tp, mask) do {                                        \
+  _task_evt_wait(tp, mask);                                                 \
+  (tp)->t_lc = __LINE__;                                                    \
+  return TASK_WAITING;                                                      \
+  case __LINE__:;                                                           \
+} while (0)
+
+/**
+ * @brief   Suspends the task for the specified time.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @param[in] time      the number of ticks, @p TIME_IMMEDIATE and
+ *                      @p TIME_INFINITE are not allowed
+ */
+#define TASK_SLEEP(tp, time) do {                                           \
+  _task_sleep(tp, time);                                                    \
+  (tp)->t_lc = __LINE__;                                                    \
+  return TASK_WAITING;                                                      \
+  case __LINE__:;                                                           \
+} while (0)
+/** @} */
+
+/**
+ * @name    Macro Functions
+ * @{
+ */
+/**
+ * @brief   Returns the argument of a task.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @return              The task argument.
+ *
+ * @api
+ */
+#define chTaskGetArg(tp) ((tp)->t_arg)
+
+/**
+ * @brief   Returns the events received by the last events wait.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @return              The received events.
+ *
+ * @api
+ */
+#define chTaskGetEvents(tp) ((tp)->t_u.events)
+
+/**
+ * @brief   Verifies if a task terminated.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @retval TRUE         terminated.
+ * @retval FALSE        not terminated.
+ *
+ * @api
+ */
+#define chTaskIsTerminated(tp) ((tp)->t_state == TASK_STATE_FINAL)
+/** @} */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chTaskSchedulerInit(TaskScheduler *tsp);
+  void chTaskSchedulerRun(TaskScheduler *tsp);
+  void chTaskStart(TaskScheduler *tsp, Task *tp, taskfunc_t func, void *arg);
+  void chTaskStartI(TaskScheduler *tsp, Task *tp, taskfunc_t func, void *arg);
+  bool_t _task_sem_wait(Task *tp, Semaphore *sp);
+#if CH_USE_MAILBOXES
+  bool_t _task_mb_fetch(Task *tp, Mailbox *mbp, msg_t *msgp);
+#endif
+  void _task_evt_wait(Task *tp, eventmask_t mask);
+  void _task_sleep(Task *tp, systime_t time);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CH_USE_TASKS */
+
+#endif /* _CHTASKS_H_ */
+
+/** @} */
@@ -58,6 +58,9 @@
 #define THD_STATE_WTMSG         12  /**< @brief Waiting for a message.      */
 #define THD_STATE_WTQUEUE       13  /**< @brief Waiting on an I/O queue.    */
 #define THD_STATE_FINAL         14  /**< @brief Thread terminated.          */
+#define THD_STATE_WTRWLOCK      15  /**< @brief Waiting on a readers-writer
+                                         lock.                              */
+#define THD_STATE_WTSET         16  /**< @brief Waiting on a wait set.      */
 
 /**
  * @brief   Thread states as array of strings.
@@ -67,7 +70,7 @@
 #define THD_STATE_NAMES                                                     \
   "READY", "CURRENT", "SUSPENDED", "WTSEM", "WTMTX", "WTCOND", "SLEEPING",  \
   "WTEXIT", "WTOREVT", "WTANDEVT", "SNDMSGQ", "SNDMSG", "WTMSG", "WTQUEUE", \
-  "FINAL"
+  "FINAL", "WTRWLOCK", "WTSET"
 /** @} */
 
 /**
@@ -80,9 +83,37 @@
                                          Memory Heap.                       */
 #define THD_MEM_MODE_MEMPOOL    2   /**< @brief Thread allocated from a
                                          Memory Pool.                       */
+#define THD_MEM_MODE_CACHE      3   /**< @brief Thread allocated from a
+                                         Thread Cache.                      */
 #define THD_TERMINATE           4   /**< @brief Termination requested flag. */
 /** @} */
 
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Thread runtime statistics.
+ * @details Times are expressed in realtime counter ticks, see
+ *          @p PORT_RT_FREQUENCY.
+ */
+typedef struct {
+  uint64_t              ts_runtime; /**< @brief Cumulative running time.    */
+  uint32_t              ts_burst;   /**< @brief Duration of the current
+                                                run burst.                  */
+  uint32_t              ts_worst;   /**< @brief Longest run burst.          */
+  uint32_t              ts_switches;/**< @brief Times the thread has been
+                                                switched in.                */
+} thread_stats_t;
+#endif
+
+#if CH_USE_REGISTRY_INDEX || defined(__DOXYGEN__)
+/**
+ * @brief   Thread identifier.
+ * @details The lower bits are the index of the thread in the registry
+ *          index table, the upper bits are a sequence number making the
+ *          identifiers of successive threads different.
+ */
+typedef uint32_t tid_t;
+#endif
+
 /**
  * @extends ThreadsQueue
  *
@@ -109,6 +140,16 @@ struct Thread {
    */
   const char            *p_name;
 #endif
+#if CH_USE_REGISTRY_INDEX || defined(__DOXYGEN__)
+  /**
+   * @brief Thread identifier or zero if the thread is not indexed.
+   */
+  tid_t                 p_id;
+  /**
+   * @brief Next thread in the registry name hash chain.
+   */
+  Thread                *p_hnext;
+#endif
 #if CH_DBG_ENABLE_STACK_CHECK || defined(__DOXYGEN__)
   /**
    * @brief Thread stack boundary.
@@ -141,6 +182,14 @@ struct Thread {
    * @note  This field can overflow.
    */
   volatile systime_t    p_time;
+#endif
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+  /**
+   * @brief Thread runtime statistics.
+   * @note  The time spent in ISRs is not accounted to the interrupted
+   *        thread.
+   */
+  thread_stats_t        p_stats;
 #endif
   /**
    * @brief State-specific fields.
@@ -211,9 +260,26 @@ struct Thread {
    */
   tprio_t               p_realprio;
 #endif
-#if (CH_USE_DYNAMIC && CH_USE_MEMPOOLS) || defined(__DOXYGEN__)
+#if CH_DBG_DEADLOCK_DETECTION || defined(__DOXYGEN__)
+  /**
+   * @brief System time of the priority inheritance boost start.
+   */
+  systime_t             p_boosttime;
+  /**
+   * @brief Priority inheritance boost state.
+   */
+  uint8_t               p_boosted;
+  /**
+   * @brief Timer reporting the boosts lasting more than the priority
+   *        inversion threshold.
+   */
+  VirtualTimer          p_boostvt;
+#endif
+#if (CH_USE_DYNAMIC && (CH_USE_MEMPOOLS || CH_USE_THREAD_CACHE)) ||       \
+    defined(__DOXYGEN__)
   /**
-   * @brief Memory Pool where the thread workspace is returned.
+   * @brief Memory Pool or Thread Cache where the thread workspace is
+   *        returned.
    */
   void                  *p_mpool;
 #endif
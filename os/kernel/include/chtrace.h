@@ -0,0 +1,334 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chtrace.h
+ * @brief   Kernel events tracer macros and structures.
+ *
+ * @addtogroup trace
+ * @{
+ */
+
+#ifndef _CHTRACE_H_
+#define _CHTRACE_H_
+
+#if CH_USE_TRACE || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/**
+ * @name    Tracer settings
+ * @{
+ */
+/*===========================================================================*/
+
+/**
+ * @brief   Number of records in the trace ring.
+ * @note    Must be a power of two.
+ */
+#if !defined(TRACE_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define TRACE_BUFFER_SIZE           256
+#endif
+
+/**
+ * @brief   Maximum number of threads listed in a trace dump header.
+ */
+#if !defined(TRACE_MAX_THREADS) || defined(__DOXYGEN__)
+#define TRACE_MAX_THREADS           32
+#endif
+/** @} */
+
+#if (TRACE_BUFFER_SIZE < 4) ||                                              \
+    ((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) != 0)
+#error "TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief   Lock-free records writer.
+ * @details The records are written without entering the kernel lock if the
+ *          port implements the compare and swap, else the instrumentation
+ *          points are only invoked from within the kernel lock.
+ */
+#if (defined(PORT_SUPPORTS_CAS) && PORT_SUPPORTS_CAS) || defined(__DOXYGEN__)
+#define TRACE_LOCKFREE              TRUE
+#else
+#define TRACE_LOCKFREE              FALSE
+#endif
+
+/**
+ * @name    Trace dump format constants
+ * @{
+ */
+/**
+ * @brief   Trace dump format version.
+ */
+#define TRACE_FORMAT_VERSION        2
+
+/**
+ * @brief   Byte order mark, the decoder uses it to detect the endianness.
+ */
+#define TRACE_BOM                   0xFEFF
+
+/**
+ * @brief   Length of the thread names in the dump header.
+ */
+#define TRACE_NAME_SIZE             16
+/** @} */
+
+/**
+ * @name    Event types
+ * @{
+ */
+#define TRACE_EV_LOST               0   /**< @brief Records lost, @p arg is
+                                                the count.                  */
+#define TRACE_EV_SWITCH             1   /**< @brief Context switch.         */
+#define TRACE_EV_ISR_ENTER          2   /**< @brief ISR entry.              */
+#define TRACE_EV_ISR_LEAVE          3   /**< @brief ISR exit.               */
+#define TRACE_EV_SEM_WAIT           4   /**< @brief Semaphore wait.         */
+#define TRACE_EV_SEM_SIGNAL         5   /**< @brief Semaphore signal.       */
+#define TRACE_EV_MTX_LOCK           6   /**< @brief Mutex lock.             */
+#define TRACE_EV_MTX_UNLOCK         7   /**< @brief Mutex unlock.           */
+#define TRACE_EV_QUEUE_PUT          8   /**< @brief Data written in a queue,
+                                                @p arg is the byte or, if
+                                                @p info is one, the size of
+                                                a bulk write.               */
+#define TRACE_EV_QUEUE_GET          9   /**< @brief Data read from a queue,
+                                                @p arg is the byte or, if
+                                                @p info is one, the size of
+                                                a bulk read.                */
+#define TRACE_EV_TIMER              10  /**< @brief Virtual timer fired.    */
+#define TRACE_EV_USER               11  /**< @brief User event.             */
+/** @} */
+
+/**
+ * @brief   Mask of all the event types.
+ */
+#define TRACE_MASK_ALL              ((trace_mask_t)0xFFFF)
+
+/**
+ * @brief   Type of an events mask, bit @p n enables the event type @p n.
+ */
+typedef uint16_t trace_mask_t;
+
+/**
+ * @brief   Trace record.
+ * @details Records are dumped in the native byte order and layout, the
+ *          object and argument fields are as wide as a pointer.
+ */
+typedef struct {
+  size_t                tr_obj;     /**< @brief Object of the event.        */
+  size_t                tr_arg;     /**< @brief Event specific argument.    */
+  uint32_t              tr_time;    /**< @brief Timestamp.                  */
+  volatile uint32_t     tr_seq;     /**< @brief Sequence number of the
+                                                record, it is the bitwise
+                                                complement while the record
+                                                is being written.           */
+  uint8_t               tr_type;    /**< @brief Event type.                 */
+  uint8_t               tr_info;    /**< @brief Event specific small value.*/
+  uint16_t              tr_prio;    /**< @brief Current thread priority.   */
+} trace_record_t;
+
+/**
+ * @brief   Trace dump header.
+ * @details The header is followed by @p th_nthreads thread descriptors
+ *          then by the records.
+ */
+typedef struct {
+  char                  th_magic[4];/**< @brief Always "CHTR".              */
+  uint16_t              th_bom;     /**< @brief Always @p TRACE_BOM.        */
+  uint8_t               th_version; /**< @brief Dump format version.        */
+  uint8_t               th_recsize; /**< @brief Size of a record.           */
+  uint32_t              th_frequency;/**< @brief Timestamps frequency.      */
+  uint16_t              th_nthreads;/**< @brief Number of thread
+                                                descriptors.                */
+  uint8_t               th_objsize; /**< @brief Size of the object and
+                                                argument fields.            */
+  uint8_t               th_reserved;/**< @brief Must be zero.               */
+} trace_header_t;
+
+/**
+ * @brief   Thread descriptor in a trace dump.
+ */
+typedef struct {
+  size_t                td_obj;     /**< @brief Thread pointer.             */
+  char                  td_name[TRACE_NAME_SIZE];/**< @brief Thread name,
+                                                not terminated if the name
+                                                fills the field.            */
+} trace_thread_t;
+
+/**
+ * @brief   Trace ring.
+ */
+typedef struct {
+  trace_mask_t          tr_mask;    /**< @brief Enabled event types.        */
+  volatile uint32_t     tr_wrseq;   /**< @brief Records reserved, free
+                                                running.                    */
+  uint32_t              tr_rdseq;   /**< @brief Records drained, free
+                                                running.                    */
+  /** @brief Records ring.*/
+  trace_record_t        tr_buffer[TRACE_BUFFER_SIZE];
+} trace_ring_t;
+
+/*
+ * Timestamps source, the port realtime counter if available else the
+ * system time.
+ */
+#if (defined(PORT_SUPPORTS_RT) && PORT_SUPPORTS_RT) || defined(__DOXYGEN__)
+#define TRACE_TIMESTAMP() port_rt_get_counter_value()
+#define TRACE_FREQUENCY PORT_RT_FREQUENCY
+#else
+#define TRACE_TIMESTAMP() ((uint32_t)chTimeNow())
+#define TRACE_FREQUENCY CH_FREQUENCY
+#endif
+
+#if !defined(__DOXYGEN__)
+extern trace_ring_t trace_ring;
+#endif
+
+/**
+ * @name    Macro Functions
+ * @{
+ */
+/**
+ * @brief   Records an event if its type is enabled.
+ * @note    Not a user macro, it is used by the kernel instrumentation.
+ *
+ * @param[in] type      the event type
+ * @param[in] info      event specific 8 bits value
+ * @param[in] obj       object of the event
+ * @param[in] arg       event specific argument
+ *
+ * @notapi
+ */
+#define _trace_event(type, info, obj, arg) {                                \
+  if (trace_ring.tr_mask & (1U << (type)))                                  \
+    _trace_write((type), (uint8_t)(info), (size_t)(obj), (size_t)(arg));    \
+}
+
+/**
+ * @brief   Records a user event.
+ *
+ * @param[in] id        user event identifier
+ * @param[in] arg       user event argument
+ *
+ * @iclass
+ */
+#define chTraceUserI(id, arg) _trace_event(TRACE_EV_USER, 0, (id), (arg))
+
+/**
+ * @brief   Returns the mask of the recorded event types.
+ *
+ * @special
+ */
+#define chTraceGetMask() (trace_ring.tr_mask)
+/** @} */
+
+/*
+ * Kernel instrumentation points.
+ */
+#define trace_switch(ntp, otp)                                              \
+  _trace_event(TRACE_EV_SWITCH, (otp)->p_state, (ntp), (size_t)(otp))
+#if TRACE_LOCKFREE
+#define trace_isr_enter() _trace_event(TRACE_EV_ISR_ENTER, 0, 0, 0)
+#define trace_isr_leave() _trace_event(TRACE_EV_ISR_LEAVE, 0, 0, 0)
+#else
+#define trace_isr_enter() {                                                 \
+  port_lock_from_isr();                                                     \
+  _trace_event(TRACE_EV_ISR_ENTER, 0, 0, 0);                                \
+  port_unlock_from_isr();                                                   \
+}
+#define trace_isr_leave() {                                                 \
+  port_lock_from_isr();                                                     \
+  _trace_event(TRACE_EV_ISR_LEAVE, 0, 0, 0);                                \
+  port_unlock_from_isr();                                                   \
+}
+#endif
+#define trace_sem_wait(sp)                                                  \
+  _trace_event(TRACE_EV_SEM_WAIT, 0, (sp), (sp)->s_cnt)
+#define trace_sem_signal(sp)                                                \
+  _trace_event(TRACE_EV_SEM_SIGNAL, 0, (sp), (sp)->s_cnt)
+#define trace_mtx_lock(mp)                                                  \
+  _trace_event(TRACE_EV_MTX_LOCK, (mp)->m_owner != NULL, (mp),              \
+               (size_t)(mp)->m_owner)
+#define trace_mtx_unlock(mp)                                                \
+  _trace_event(TRACE_EV_MTX_UNLOCK, 0, (mp), 0)
+#define trace_sem_fast_wait(sp, cnt)                                        \
+  _trace_event(TRACE_EV_SEM_WAIT, 0, (sp), (cnt))
+#define trace_sem_fast_signal(sp, cnt)                                      \
+  _trace_event(TRACE_EV_SEM_SIGNAL, 0, (sp), (cnt))
+#define trace_mtx_fast_lock(mp)                                             \
+  _trace_event(TRACE_EV_MTX_LOCK, 0, (mp), 0)
+#define trace_queue_put(qp, b)                                              \
+  _trace_event(TRACE_EV_QUEUE_PUT, 0, (qp), (b))
+#define trace_queue_get(qp, b)                                              \
+  _trace_event(TRACE_EV_QUEUE_GET, 0, (qp), (b))
+#define trace_queue_write(qp, n)                                            \
+  _trace_event(TRACE_EV_QUEUE_PUT, 1, (qp), (n))
+#define trace_queue_read(qp, n)                                             \
+  _trace_event(TRACE_EV_QUEUE_GET, 1, (qp), (n))
+#define trace_timer(vtp)                                                    \
+  _trace_event(TRACE_EV_TIMER, 0, (vtp), (size_t)(vtp)->vt_par)
+
+#endif /* CH_USE_TRACE */
+
+#if !CH_USE_TRACE
+/* When the tracer is disabled the instrumentation points are replaced by
+   empty macros.*/
+#define trace_switch(ntp, otp)
+#define trace_isr_enter()
+#define trace_isr_leave()
+#define trace_sem_wait(sp)
+#define trace_sem_signal(sp)
+#define trace_mtx_lock(mp)
+#define trace_mtx_unlock(mp)
+#define trace_sem_fast_wait(sp, cnt)
+#define trace_sem_fast_signal(sp, cnt)
+#define trace_mtx_fast_lock(mp)
+#define trace_queue_put(qp, b)
+#define trace_queue_get(qp, b)
+#define trace_queue_write(qp, n)
+#define trace_queue_read(qp, n)
+#define trace_timer(vtp)
+#endif
+
+#if CH_USE_TRACE || defined(__DOXYGEN__)
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void _tracer_init(void);
+  void _trace_write(uint8_t type, uint8_t info, size_t obj, size_t arg);
+  void chTraceSetMask(trace_mask_t mask);
+  void chTraceUser(uint32_t id, uint32_t arg);
+  void chTraceWriteHeader(BaseSequentialStream *chp);
+  size_t chTraceDrain(BaseSequentialStream *chp);
+#ifdef __cplusplus
+}
+#endif
+#endif /* CH_USE_TRACE */
+
+#endif /* _CHTRACE_H_ */
+
+/** @} */
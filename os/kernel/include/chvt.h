@@ -82,6 +82,56 @@
                 1000000UL) + 1UL))
 /** @} */
 
+#if CH_TIMEDELTA > 0
+#if CH_USE_TIMING_WHEEL
+#error "CH_USE_TIMING_WHEEL is not compatible with tickless mode"
+#endif
+#if CH_TIME_QUANTUM > 0
+#error "tickless mode requires CH_TIME_QUANTUM == 0"
+#endif
+#if CH_DBG_THREADS_PROFILING
+#error "CH_DBG_THREADS_PROFILING is not compatible with tickless mode"
+#endif
+#endif /* CH_TIMEDELTA > 0 */
+
+#if CH_USE_TIMING_WHEEL || defined(__DOXYGEN__)
+/**
+ * @name    Timing wheel geometry
+ * @{
+ */
+/**
+ * @brief   Number of bits of system time covered by each wheel level.
+ */
+#if !defined(VT_WHEEL_BITS) || defined(__DOXYGEN__)
+#define VT_WHEEL_BITS       6
+#endif
+
+/**
+ * @brief   Number of wheel levels.
+ * @note    Timers with a deadline beyond the wheel span, 2^(VT_WHEEL_BITS *
+ *          VT_WHEEL_LEVELS) ticks, are parked on the last level and
+ *          re-evaluated when their slot is cascaded.
+ */
+#if !defined(VT_WHEEL_LEVELS) || defined(__DOXYGEN__)
+#define VT_WHEEL_LEVELS     4
+#endif
+
+/**
+ * @brief   Number of slots for each wheel level.
+ */
+#define VT_WHEEL_SLOTS      (1 << VT_WHEEL_BITS)
+
+/**
+ * @brief   Slot index mask.
+ */
+#define VT_WHEEL_MASK       (VT_WHEEL_SLOTS - 1)
+/** @} */
+
+#if (VT_WHEEL_BITS * VT_WHEEL_LEVELS) > 31
+#error "timing wheel span exceeds 31 bits"
+#endif
+#endif /* CH_USE_TIMING_WHEEL */
+
 /**
  * @brief   Virtual Timer callback function.
  */
@@ -102,26 +152,56 @@ struct VirtualTimer {
                                                 list.                       */
   VirtualTimer          *vt_prev;   /**< @brief Previous timer in the delta
                                                 list.                       */
-  systime_t             vt_time;    /**< @brief Time delta before timeout.  */
+  systime_t             vt_time;    /**< @brief Time delta before timeout
+                                                or absolute deadline if
+                                                the timing wheel is used.   */
   vtfunc_t              vt_func;    /**< @brief Timer callback function
                                                 pointer.                    */
   void                  *vt_par;    /**< @brief Timer callback function
                                                 parameter.                  */
 };
 
+#if CH_USE_TIMING_WHEEL || defined(__DOXYGEN__)
+/**
+ * @brief   Timing wheel slot header.
+ */
+typedef struct {
+  VirtualTimer          *vt_next;   /**< @brief First timer in the slot.    */
+  VirtualTimer          *vt_prev;   /**< @brief Last timer in the slot.     */
+} VTWheelSlot;
+#endif
+
 /**
  * @brief   Virtual timers list header.
  * @note    The delta list is implemented as a double link bidirectional list
  *          in order to make the unlink time constant, the reset of a virtual
  *          timer is often used in the code.
+ * @note    When @p CH_USE_TIMING_WHEEL is enabled the delta list is replaced
+ *          by the wheel slots, each slot is a double link list of timers
+ *          having deadlines in the slot time range.
+ * @note    In tickless mode the first delta is relative to @p vt_lasttime
+ *          and the system time is read from the port free-running counter.
  */
 typedef struct {
+#if !CH_USE_TIMING_WHEEL || defined(__DOXYGEN__)
   VirtualTimer          *vt_next;   /**< @brief Next timer in the delta
                                                 list.                       */
   VirtualTimer          *vt_prev;   /**< @brief Last timer in the delta
                                                 list.                       */
   systime_t             vt_time;    /**< @brief Must be initialized to -1.  */
+#endif
+#if (CH_TIMEDELTA == 0) || defined(__DOXYGEN__)
   volatile systime_t    vt_systime; /**< @brief System Time counter.        */
+#endif
+#if (CH_TIMEDELTA > 0) || defined(__DOXYGEN__)
+  systime_t             vt_lasttime;/**< @brief System time of the last
+                                                processed deadline, base
+                                                of the delta list.          */
+#endif
+#if CH_USE_TIMING_WHEEL || defined(__DOXYGEN__)
+  VTWheelSlot           vt_wheel[VT_WHEEL_LEVELS][VT_WHEEL_SLOTS];
+                                    /**< @brief Timing wheel slots.         */
+#endif
 } VTList;
 
 /**
@@ -137,6 +217,9 @@ typedef struct {
  *
  * @iclass
  */
+#if CH_TIMEDELTA > 0
+#define chVTDoTickI() _vt_alarm_tick()
+#elif !CH_USE_TIMING_WHEEL || defined(__DOXYGEN__)
 #define chVTDoTickI() {                                                     \
   vtlist.vt_systime++;                                                      \
   if (&vtlist != (VTList *)vtlist.vt_next) {                                \
@@ -148,12 +231,16 @@ typedef struct {
       vtp->vt_func = (vtfunc_t)NULL;                                        \
       vtp->vt_next->vt_prev = (void *)&vtlist;                              \
       (&vtlist)->vt_next = vtp->vt_next;                                    \
+      trace_timer(vtp);                                                     \
       chSysUnlockFromIsr();                                                 \
       fn(vtp->vt_par);                                                      \
       chSysLockFromIsr();                                                   \
     }                                                                       \
   }                                                                         \
 }
+#else /* CH_USE_TIMING_WHEEL */
+#define chVTDoTickI() _vt_wheel_tick()
+#endif /* CH_USE_TIMING_WHEEL */
 
 /**
  * @brief   Returns @p TRUE if the specified timer is armed.
@@ -208,12 +295,18 @@ typedef struct {
  *          invocation.
  * @note    The counter can reach its maximum and then restart from zero.
  * @note    This function is designed to work with the @p chThdSleepUntil().
+ * @note    In tickless mode the time is read from the port free-running
+ *          counter.
  *
  * @return              The system time in ticks.
  *
  * @api
  */
+#if (CH_TIMEDELTA == 0) || defined(__DOXYGEN__)
 #define chTimeNow() (vtlist.vt_systime)
+#else
+#define chTimeNow() port_timer_get_time()
+#endif
 
 /**
  * @brief   Returns the elapsed time since the specified start time.
@@ -251,6 +344,12 @@ extern VTList vtlist;
 extern "C" {
 #endif
   void _vt_init(void);
+#if CH_USE_TIMING_WHEEL
+  void _vt_wheel_tick(void);
+#endif
+#if CH_TIMEDELTA > 0
+  void _vt_alarm_tick(void);
+#endif
   void chVTSetI(VirtualTimer *vtp, systime_t time, vtfunc_t vtfunc, void *par);
   void chVTResetI(VirtualTimer *vtp);
 #ifdef __cplusplus
@@ -0,0 +1,213 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chwaitset.h
+ * @brief   Wait Sets macros and structures.
+ *
+ * @addtogroup waitsets
+ * @{
+ */
+
+#ifndef _CHWAITSET_H_
+#define _CHWAITSET_H_
+
+#if CH_USE_WAITSETS || defined(__DOXYGEN__)
+
+/*
+ * Module dependencies check.
+ */
+#if !CH_USE_SEMAPHORES
+#error "CH_USE_WAITSETS requires CH_USE_SEMAPHORES"
+#endif
+
+/**
+ * @name    Wait set entry types
+ * @{
+ */
+#define WS_SEMAPHORE            0   /**< @brief Semaphore entry.            */
+#define WS_MAILBOX              1   /**< @brief Mailbox entry.              */
+#define WS_INPUTQUEUE           2   /**< @brief Input queue entry.          */
+#define WS_EVENTSOURCE          3   /**< @brief Event source entry.         */
+/** @} */
+
+/**
+ * @brief   Type of a wait set.
+ */
+typedef struct WaitSet WaitSet;
+
+/**
+ * @brief   Type of a wait set entry.
+ */
+typedef struct WaitSetEntry WaitSetEntry;
+
+/**
+ * @brief   Object notification callback type.
+ */
+typedef void (*wsfunc_t)(WaitSetEntry *wep);
+
+/**
+ * @brief   Watcher data.
+ * @details The structures starting with these fields can be linked in the
+ *          list of a watched object, the callback is invoked from within
+ *          the kernel lock when the object becomes ready.
+ */
+#define _wait_set_entry_data                                                \
+  /* Next watcher of the same object.*/                                     \
+  WaitSetEntry          *we_next;                                           \
+  /* Notification callback.*/                                               \
+  wsfunc_t              we_func;
+
+/**
+ * @brief   Wait set entry structure.
+ * @details Each entry watches a single object, the entries watching the
+ *          same object are linked in a list owned by the object.
+ */
+struct WaitSetEntry {
+  _wait_set_entry_data
+  WaitSet               *we_wsp;        /**< @brief Wait set owning the
+                                             entry.                         */
+  void                  *we_obj;        /**< @brief Watched object.         */
+  uint8_t               we_type;        /**< @brief Entry type.             */
+#if CH_USE_EVENTS || defined(__DOXYGEN__)
+  EventListener         we_listener;    /**< @brief Listener registered on
+                                             a watched event source.        */
+#endif
+};
+
+/**
+ * @brief   Wait set structure.
+ */
+struct WaitSet {
+  WaitSetEntry          *ws_entries;    /**< @brief Array of the entries.   */
+  cnt_t                 ws_size;        /**< @brief Size of the entries
+                                             array.                         */
+  cnt_t                 ws_n;           /**< @brief Number of used entries. */
+  cnt_t                 ws_next;        /**< @brief First entry scanned by
+                                             the next wait.                 */
+  Thread                *ws_thread;     /**< @brief Thread waiting on the
+                                             set or @p NULL.                */
+#if CH_USE_EVENTS || defined(__DOXYGEN__)
+  eventmask_t           ws_evmask;      /**< @brief Union of the events
+                                             masks of the entries.          */
+#endif
+  union {
+    msg_t               msg;            /**< @brief Message fetched from a
+                                             mailbox entry.                 */
+#if CH_USE_EVENTS || defined(__DOXYGEN__)
+    eventmask_t         events;         /**< @brief Events consumed by an
+                                             event source entry.            */
+#endif
+  }                     ws_u;           /**< @brief Data of the last ready
+                                             entry.                         */
+};
+
+/**
+ * @name    Macro Functions
+ * @{
+ */
+/**
+ * @brief   Returns the message fetched by the last wait.
+ * @pre     The last wait returned the index of a @p WS_MAILBOX entry.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ * @return              The message fetched from the mailbox.
+ *
+ * @api
+ */
+#define chWSGetMessage(wsp) ((wsp)->ws_u.msg)
+
+/**
+ * @brief   Returns the events consumed by the last wait.
+ * @pre     The last wait returned the index of a @p WS_EVENTSOURCE entry.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ * @return              The pending events of the entry, the events are
+ *                      cleared from the thread.
+ *
+ * @api
+ */
+#define chWSGetEvents(wsp) ((wsp)->ws_u.events)
+
+/**
+ * @brief   Returns the number of entries in the wait set.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ * @return              The number of entries.
+ *
+ * @api
+ */
+#define chWSGetCount(wsp) ((wsp)->ws_n)
+/** @} */
+
+/**
+ * @brief   Notifies the watchers of an object.
+ * @details Invoked by the watched objects when they become ready, the
+ *          check on the list is inlined in order to not add a call to the
+ *          unwatched objects.
+ *
+ * @param[in] wlp       list of the entries watching the object
+ *
+ * @notapi
+ */
+#define ws_notify_i(wlp) {                                                  \
+  if ((wlp) != NULL)                                                        \
+    _ws_notify_i(wlp);                                                      \
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void _ws_notify_i(WaitSetEntry *wep);
+  void _ws_link_i(WaitSetEntry **wlpp, WaitSetEntry *wep);
+  void _ws_unlink_i(WaitSetEntry **wlpp, WaitSetEntry *wep);
+  void chWSInit(WaitSet *wsp, WaitSetEntry *entries, cnt_t n);
+  cnt_t chWSAddSemaphore(WaitSet *wsp, Semaphore *sp);
+#if CH_USE_MAILBOXES
+  cnt_t chWSAddMailbox(WaitSet *wsp, Mailbox *mbp);
+#endif
+#if CH_USE_QUEUES
+  cnt_t chWSAddInputQueue(WaitSet *wsp, InputQueue *iqp);
+#endif
+#if CH_USE_EVENTS
+  cnt_t chWSAddEventSource(WaitSet *wsp, EventSource *esp, eventmask_t mask);
+#endif
+  void chWSClear(WaitSet *wsp);
+  msg_t chWSWait(WaitSet *wsp);
+  msg_t chWSWaitTimeout(WaitSet *wsp, systime_t time);
+  msg_t chWSWaitTimeoutS(WaitSet *wsp, systime_t time);
+#ifdef __cplusplus
+}
+#endif
+
+#else /* !CH_USE_WAITSETS */
+#define ws_notify_i(wlp) {}
+#endif /* !CH_USE_WAITSETS */
+
+#endif /* _CHWAITSET_H_ */
+
+/** @} */
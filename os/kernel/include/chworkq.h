@@ -0,0 +1,127 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chworkq.h
+ * @brief   Work Queues macros and structures.
+ *
+ * @addtogroup workqueues
+ * @{
+ */
+
+#ifndef _CHWORKQ_H_
+#define _CHWORKQ_H_
+
+#if CH_USE_WORKQUEUES || defined(__DOXYGEN__)
+
+/*
+ * Module dependencies check.
+ */
+#if !CH_USE_SEMAPHORES
+#error "CH_USE_WORKQUEUES requires CH_USE_SEMAPHORES"
+#endif
+
+#if !CH_USE_MEMPOOLS
+#error "CH_USE_WORKQUEUES requires CH_USE_MEMPOOLS"
+#endif
+
+/**
+ * @brief   Work function type.
+ */
+typedef void (*workfunc_t)(void *arg);
+
+/**
+ * @brief   Type of a work queue.
+ */
+typedef struct WorkQueue WorkQueue;
+
+/**
+ * @brief   Work item structure.
+ * @details The work items are allocated from the pool of the work queue
+ *          when a work is submitted and returned to the pool before the
+ *          work function is invoked.
+ */
+typedef struct WorkItem {
+  struct WorkItem       *wi_next;       /**< @brief Next item in the queue. */
+  WorkQueue             *wi_wqp;        /**< @brief Owner work queue.       */
+  size_t                wi_seq;         /**< @brief Allocations counter,
+                                             it tells apart the reuses of
+                                             the item.                      */
+  workfunc_t            wi_func;        /**< @brief Work function.          */
+  void                  *wi_arg;        /**< @brief Work function argument. */
+  VirtualTimer          wi_vt;          /**< @brief Timer of the delayed
+                                             works.                         */
+} WorkItem;
+
+/**
+ * @brief   Delayed work handle.
+ * @details The handle records the allocation of the item so that a stale
+ *          handle does not match the item once it has been reused by
+ *          another submission.
+ */
+typedef struct {
+  WorkItem              *wh_wip;        /**< @brief Work item.              */
+  size_t                wh_seq;         /**< @brief Allocation of the item
+                                             at submission time.            */
+} WorkHandle;
+
+/**
+ * @brief   Work queue structure.
+ */
+struct WorkQueue {
+  WorkItem              *wq_head;       /**< @brief First queued item.      */
+  WorkItem              *wq_tail;       /**< @brief Last queued item.       */
+  Semaphore             wq_sem;         /**< @brief Queued items counter,
+                                             the workers wait on it.        */
+  MemoryPool            wq_pool;        /**< @brief Pool of the free
+                                             items.                         */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chWorkQueueInit(WorkQueue *wqp, WorkItem *items, size_t n);
+  Thread *chWorkQueueAddWorker(WorkQueue *wqp, void *wsp, size_t size,
+                               tprio_t prio);
+  void chWorkQueueReset(WorkQueue *wqp);
+  bool_t chWorkSubmit(WorkQueue *wqp, workfunc_t func, void *arg);
+  bool_t chWorkSubmitI(WorkQueue *wqp, workfunc_t func, void *arg);
+  bool_t chWorkSubmitDelayed(WorkQueue *wqp, workfunc_t func, void *arg,
+                             systime_t delay, WorkHandle *whp);
+  bool_t chWorkSubmitDelayedI(WorkQueue *wqp, workfunc_t func, void *arg,
+                              systime_t delay, WorkHandle *whp);
+  bool_t chWorkCancel(const WorkHandle *whp);
+  bool_t chWorkCancelI(const WorkHandle *whp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CH_USE_WORKQUEUES */
+
+#endif /* _CHWORKQ_H_ */
+
+/** @} */
@@ -8,16 +8,23 @@ KERNSRC = ${CHIBIOS}/os/kernel/src/chsys.c \
           ${CHIBIOS}/os/kernel/src/chthreads.c \
           ${CHIBIOS}/os/kernel/src/chdynamic.c \
           ${CHIBIOS}/os/kernel/src/chregistry.c \
+          ${CHIBIOS}/os/kernel/src/chworkq.c \
           ${CHIBIOS}/os/kernel/src/chsem.c \
           ${CHIBIOS}/os/kernel/src/chmtx.c \
           ${CHIBIOS}/os/kernel/src/chcond.c \
+          ${CHIBIOS}/os/kernel/src/chrwlock.c \
           ${CHIBIOS}/os/kernel/src/chevents.c \
           ${CHIBIOS}/os/kernel/src/chmsg.c \
           ${CHIBIOS}/os/kernel/src/chmboxes.c \
+          ${CHIBIOS}/os/kernel/src/chmsgq.c \
           ${CHIBIOS}/os/kernel/src/chqueues.c \
+          ${CHIBIOS}/os/kernel/src/chwaitset.c \
+          ${CHIBIOS}/os/kernel/src/chring.c \
+          ${CHIBIOS}/os/kernel/src/chtasks.c \
           ${CHIBIOS}/os/kernel/src/chmemcore.c \
           ${CHIBIOS}/os/kernel/src/chheap.c \
-          ${CHIBIOS}/os/kernel/src/chmempools.c
+          ${CHIBIOS}/os/kernel/src/chmempools.c \
+          ${CHIBIOS}/os/kernel/src/chtrace.c
 
 # Required include directories
 KERNINC = ${CHIBIOS}/os/kernel/include
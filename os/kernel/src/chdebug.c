@@ -251,6 +251,501 @@ void dbg_trace(Thread *otp) {
 }
 #endif /* CH_DBG_ENABLE_TRACE */
 
+/*===========================================================================*/
+/* Runtime statistics related code and variables.                            */
+/*===========================================================================*/
+
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Kernel runtime statistics.
+ */
+kernel_stats_t dbg_kernel_stats;
+
+/**
+ * @brief   Runtime statistics initialization.
+ * @note    Internal use only.
+ */
+void _stats_init(void) {
+
+  dbg_kernel_stats.ks_isr_time = 0;
+  dbg_kernel_stats.ks_isr_count = 0;
+  dbg_kernel_stats.ks_switches = 0;
+  dbg_kernel_stats.ks_isr_nesting = 0;
+  dbg_kernel_stats.ks_last = port_rt_get_counter_value();
+}
+
+/**
+ * @brief   Accounts the time elapsed since the last accounting point to a
+ *          thread.
+ *
+ * @param[in] tp        the thread
+ */
+static void stats_account(Thread *tp) {
+  uint32_t now = port_rt_get_counter_value();
+  uint32_t delta = now - dbg_kernel_stats.ks_last;
+
+  dbg_kernel_stats.ks_last = now;
+  tp->p_stats.ts_runtime += delta;
+  tp->p_stats.ts_burst += delta;
+}
+
+/**
+ * @brief   Accounts a context switch.
+ * @details The time elapsed since the last accounting point is accounted
+ *          to the thread being switched out, its run burst ends.
+ *
+ * @param[in] ntp       the thread being switched in
+ * @param[in] otp       the thread being switched out
+ *
+ * @notapi
+ */
+void dbg_stats_switch(Thread *ntp, Thread *otp) {
+
+  stats_account(otp);
+  if (otp->p_stats.ts_burst > otp->p_stats.ts_worst)
+    otp->p_stats.ts_worst = otp->p_stats.ts_burst;
+  otp->p_stats.ts_burst = 0;
+  ntp->p_stats.ts_switches++;
+  dbg_kernel_stats.ks_switches++;
+}
+
+/**
+ * @brief   Accounts an ISR entry.
+ * @details The time elapsed since the last accounting point is accounted
+ *          to the interrupted thread.
+ *
+ * @notapi
+ */
+void dbg_stats_enter_isr(void) {
+
+  port_lock_from_isr();
+  if (dbg_kernel_stats.ks_isr_nesting++ == 0)
+    stats_account(currp);
+  dbg_kernel_stats.ks_isr_count++;
+  port_unlock_from_isr();
+}
+
+/**
+ * @brief   Accounts an ISR exit.
+ * @details The time elapsed since the outermost ISR entry is accounted to
+ *          the ISRs.
+ *
+ * @notapi
+ */
+void dbg_stats_leave_isr(void) {
+
+  port_lock_from_isr();
+  if (--dbg_kernel_stats.ks_isr_nesting == 0) {
+    uint32_t now = port_rt_get_counter_value();
+
+    dbg_kernel_stats.ks_isr_time += now - dbg_kernel_stats.ks_last;
+    dbg_kernel_stats.ks_last = now;
+  }
+  port_unlock_from_isr();
+}
+#endif /* CH_DBG_STATISTICS */
+
+/*===========================================================================*/
+/* Lock statistics related code and variables.                               */
+/*===========================================================================*/
+
+#if CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   List of the named locks.
+ */
+static lock_stats_t *dbg_lock_list;
+
+/**
+ * @brief   Clears the statistics of a lock.
+ * @note    The name and the list link are not affected so that a named
+ *          lock can be initialized again.
+ *
+ * @param[out] lsp      pointer to the lock statistics
+ *
+ * @notapi
+ */
+void dbg_lock_init(lock_stats_t *lsp) {
+  unsigned i;
+
+  lsp->ls_acquisitions = 0;
+  lsp->ls_contentions = 0;
+  lsp->ls_wait_total = 0;
+  lsp->ls_wait_max = 0;
+  lsp->ls_hold_start = 0;
+  lsp->ls_hold_max = 0;
+  for (i = 0; i < LOCK_STATS_WAITERS; i++) {
+    lsp->ls_waiters[i].lw_thread = NULL;
+    lsp->ls_waiters[i].lw_time = 0;
+  }
+}
+
+/**
+ * @brief   Accounts a lock acquisition.
+ *
+ * @param[in] lsp       pointer to the lock statistics
+ *
+ * @notapi
+ */
+void dbg_lock_acquired(lock_stats_t *lsp) {
+
+  lsp->ls_acquisitions++;
+  lsp->ls_hold_start = port_rt_get_counter_value();
+}
+
+#if (defined(PORT_SUPPORTS_CAS) && PORT_SUPPORTS_CAS) || defined(__DOXYGEN__)
+/**
+ * @brief   Accounts a lock acquisition performed outside the kernel lock.
+ * @details The acquisitions counter is incremented using the port compare
+ *          and swap because other threads or interrupts can acquire the
+ *          same lock meanwhile, this is the case of semaphores.
+ *
+ * @param[in] lsp       pointer to the lock statistics
+ *
+ * @notapi
+ */
+void dbg_lock_acquired_atomic(lock_stats_t *lsp) {
+  volatile cnt_t *cp = (volatile cnt_t *)&lsp->ls_acquisitions;
+  cnt_t n;
+
+  do {
+    n = *cp;
+  } while (!port_cas(cp, n, (cnt_t)((uint32_t)n + 1)));
+  lsp->ls_hold_start = port_rt_get_counter_value();
+}
+#endif
+
+/**
+ * @brief   Accounts a wait of the current thread on a lock.
+ * @details The wait time is accounted whatever the wait outcome, the
+ *          current thread is recorded among the top waiters if its wait
+ *          is one of the longest.
+ *
+ * @param[in] lsp       pointer to the lock statistics
+ * @param[in] start     counter value at the beginning of the wait
+ *
+ * @notapi
+ */
+void dbg_lock_waited(lock_stats_t *lsp, uint32_t start) {
+  uint32_t wait = port_rt_get_counter_value() - start;
+  unsigned i;
+
+  lsp->ls_contentions++;
+  lsp->ls_wait_total += wait;
+  if (wait > lsp->ls_wait_max)
+    lsp->ls_wait_max = wait;
+
+  /* The entry of the current thread is used if present, else the one with
+     the shortest wait, then the entry is moved up to keep the order.*/
+  i = 0;
+  while ((i < LOCK_STATS_WAITERS - 1) &&
+         (lsp->ls_waiters[i].lw_thread != currp))
+    i++;
+  if (wait <= lsp->ls_waiters[i].lw_time)
+    return;
+  while ((i > 0) && (wait > lsp->ls_waiters[i - 1].lw_time)) {
+    lsp->ls_waiters[i] = lsp->ls_waiters[i - 1];
+    i--;
+  }
+  lsp->ls_waiters[i].lw_thread = currp;
+  lsp->ls_waiters[i].lw_time = wait;
+}
+
+/**
+ * @brief   Accounts a lock release.
+ *
+ * @param[in] lsp       pointer to the lock statistics
+ *
+ * @notapi
+ */
+void dbg_lock_released(lock_stats_t *lsp) {
+  uint32_t hold = port_rt_get_counter_value() - lsp->ls_hold_start;
+
+  if (hold > lsp->ls_hold_max)
+    lsp->ls_hold_max = hold;
+}
+
+/**
+ * @brief   Names a lock and adds it to the list of the named locks.
+ * @details If the lock is already in the list then it is just renamed.
+ * @note    Locks allocated on the stack or in dynamic memory must be
+ *          removed from the list using @p chDbgLockUnregister() before
+ *          their memory is reused.
+ *
+ * @param[in] lsp       pointer to the lock statistics
+ * @param[in] name      lock name as a zero terminated string
+ *
+ * @api
+ */
+void chDbgLockRegister(lock_stats_t *lsp, const char *name) {
+  lock_stats_t *p;
+
+  chDbgCheck((lsp != NULL) && (name != NULL), "chDbgLockRegister");
+
+  chSysLock();
+  p = dbg_lock_list;
+  while ((p != NULL) && (p != lsp))
+    p = p->ls_next;
+  if (p == NULL) {
+    lsp->ls_next = dbg_lock_list;
+    dbg_lock_list = lsp;
+  }
+  lsp->ls_name = name;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Removes a lock from the list of the named locks.
+ * @note    Locks not in the list are ignored.
+ *
+ * @param[in] lsp       pointer to the lock statistics
+ *
+ * @api
+ */
+void chDbgLockUnregister(lock_stats_t *lsp) {
+  lock_stats_t **pp;
+
+  chDbgCheck(lsp != NULL, "chDbgLockUnregister");
+
+  chSysLock();
+  pp = &dbg_lock_list;
+  while (*pp != NULL) {
+    if (*pp == lsp) {
+      *pp = lsp->ls_next;
+      break;
+    }
+    pp = &(*pp)->ls_next;
+  }
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns the most recently named lock.
+ *
+ * @return              Pointer to the lock statistics.
+ * @retval NULL         if there are no named locks.
+ *
+ * @api
+ */
+lock_stats_t *chDbgLockFirst(void) {
+  lock_stats_t *lsp;
+
+  chSysLock();
+  lsp = dbg_lock_list;
+  chSysUnlock();
+  return lsp;
+}
+
+/**
+ * @brief   Returns the named lock next to the specified one.
+ * @note    Removing locks from the list while it is being scanned is not
+ *          supported.
+ *
+ * @param[in] lsp       pointer to the lock statistics
+ * @return              Pointer to the next lock statistics.
+ * @retval NULL         if there is no next lock.
+ *
+ * @api
+ */
+lock_stats_t *chDbgLockNext(lock_stats_t *lsp) {
+
+  chDbgCheck(lsp != NULL, "chDbgLockNext");
+
+  chSysLock();
+  lsp = lsp->ls_next;
+  chSysUnlock();
+  return lsp;
+}
+
+/**
+ * @brief   Returns a consistent copy of the statistics of a lock.
+ *
+ * @param[in] lsp       pointer to the lock statistics
+ * @param[out] dstp     pointer to a @p lock_stats_t structure
+ *
+ * @api
+ */
+void chDbgGetLockStats(lock_stats_t *lsp, lock_stats_t *dstp) {
+
+  chDbgCheck((lsp != NULL) && (dstp != NULL), "chDbgGetLockStats");
+
+  chSysLock();
+  *dstp = *lsp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Clears the statistics of all the named locks.
+ *
+ * @api
+ */
+void chDbgResetLockStats(void) {
+  lock_stats_t *lsp;
+
+  chSysLock();
+  for (lsp = dbg_lock_list; lsp != NULL; lsp = lsp->ls_next)
+    dbg_lock_init(lsp);
+  chSysUnlock();
+}
+#endif /* CH_DBG_LOCK_STATISTICS */
+
+/*===========================================================================*/
+/* Deadlock detection related code and variables.                            */
+/*===========================================================================*/
+
+#if CH_DBG_DEADLOCK_DETECTION || defined(__DOXYGEN__)
+/**
+ * @brief   Last detected deadlock.
+ * @details This structure is meant to be accessed through the debugger after
+ *          a deadlock panic.
+ */
+deadlock_report_t dbg_deadlock_report;
+
+/**
+ * @brief   Number of detected priority inversions.
+ */
+cnt_t dbg_inversions;
+
+/**
+ * @brief   Last thread reported for a priority inversion.
+ */
+Thread *dbg_inversion_thread;
+
+/**
+ * @brief   Boost duration of the last reported priority inversion.
+ */
+systime_t dbg_inversion_time;
+
+/*
+ * Reports a thread boosted for longer than the threshold, a boost is
+ * reported only once.
+ */
+static void inversion_check(Thread *tp) {
+  systime_t time;
+
+  if (tp->p_boosted != THD_BOOST_ACTIVE)
+    return;
+  time = chTimeNow() - tp->p_boosttime;
+  if (time < CH_INVERSION_THRESHOLD)
+    return;
+  tp->p_boosted = THD_BOOST_REPORTED;
+  dbg_inversions++;
+  dbg_inversion_thread = tp;
+  dbg_inversion_time = time;
+  MUTEX_INVERSION_HOOK(tp, time);
+}
+
+/*
+ * Boost timer callback, the boost is reported if it is still active when
+ * the threshold expires, also if the owner never unlocks the mutex.
+ */
+static void inversion_timer_cb(void *p) {
+
+  chSysLockFromIsr();
+  inversion_check((Thread *)p);
+  chSysUnlockFromIsr();
+}
+
+/**
+ * @brief   Checks if waiting on a mutex would deadlock the current thread.
+ * @details The chain of the mutex owners is followed starting from the owner
+ *          of the specified mutex, a deadlock is detected if the chain leads
+ *          back to the current thread.
+ * @note    Chains longer than @p CH_DEADLOCK_MAX_CHAIN are not reported.
+ *
+ * @param[in] mp        pointer to the @p Mutex the current thread is about
+ *                      to wait on
+ * @param[out] drp      pointer to a @p deadlock_report_t structure receiving
+ *                      the cycle, can be @p NULL
+ * @return              The check result.
+ * @retval FALSE        if waiting on the mutex would not deadlock.
+ * @retval TRUE         if a deadlock has been detected.
+ *
+ * @sclass
+ */
+bool_t chDbgCheckDeadlockS(Mutex *mp, deadlock_report_t *drp) {
+  Thread *tp = currp;
+  unsigned n = 0;
+
+  chDbgCheckClassS();
+  chDbgCheck(mp != NULL, "chDbgCheckDeadlockS");
+
+  while (n < CH_DEADLOCK_MAX_CHAIN) {
+    if (drp != NULL) {
+      drp->dr_threads[n] = tp;
+      drp->dr_mutexes[n] = mp;
+    }
+    n++;
+    tp = chMtxGetOwnerI(mp);
+    if (tp == currp) {
+      if (drp != NULL)
+        drp->dr_length = n;
+      return TRUE;
+    }
+    if ((tp == NULL) || (tp->p_state != THD_STATE_WTMTX))
+      return FALSE;
+    mp = (Mutex *)tp->p_u.wtobjp;
+  }
+  return FALSE;
+}
+
+/**
+ * @brief   Checks a mutex the current thread is about to wait on.
+ * @details A deadlock is reported through the @p MUTEX_DEADLOCK_HOOK() and
+ *          then the system panics. An owner boosted for longer than
+ *          @p CH_INVERSION_THRESHOLD is reported through the
+ *          @p MUTEX_INVERSION_HOOK().
+ *
+ * @param[in] mp        pointer to the @p Mutex structure
+ *
+ * @notapi
+ */
+void dbg_mtx_wait(Mutex *mp) {
+
+  if (chDbgCheckDeadlockS(mp, &dbg_deadlock_report)) {
+    MUTEX_DEADLOCK_HOOK(&dbg_deadlock_report);
+    chDbgPanic("mutex deadlock");
+  }
+  inversion_check(chMtxGetOwnerI(mp));
+}
+
+/**
+ * @brief   Records the start of a priority inheritance boost.
+ * @details A timer is armed in order to report the boost when it reaches
+ *          @p CH_INVERSION_THRESHOLD.
+ *
+ * @param[in] tp        pointer to the boosted thread
+ *
+ * @notapi
+ */
+void dbg_mtx_boost(Thread *tp) {
+
+  if (tp->p_boosted == THD_BOOST_NONE) {
+    tp->p_boosted = THD_BOOST_ACTIVE;
+    tp->p_boosttime = chTimeNow();
+    chVTSetI(&tp->p_boostvt, CH_INVERSION_THRESHOLD, inversion_timer_cb, tp);
+  }
+}
+
+/**
+ * @brief   Records the end of a priority inheritance boost.
+ * @details The boost ends when the thread priority is back to its base
+ *          priority, its duration is checked against the threshold.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void dbg_mtx_unboost(Thread *tp) {
+
+  if ((tp->p_boosted != THD_BOOST_NONE) && (tp->p_prio <= tp->p_realprio)) {
+    inversion_check(tp);
+    tp->p_boosted = THD_BOOST_NONE;
+    if (chVTIsArmedI(&tp->p_boostvt))
+      chVTResetI(&tp->p_boostvt);
+  }
+}
+#endif /* CH_DBG_DEADLOCK_DETECTION */
+
 /*===========================================================================*/
 /* Panic related code and variables.                                         */
 /*===========================================================================*/
@@ -38,6 +38,53 @@
 
 #if CH_USE_DYNAMIC || defined(__DOXYGEN__)
 
+#if CH_USE_THREAD_CACHE || defined(__DOXYGEN__)
+/*
+ * Size class of a working area request, the smallest class able to
+ * satisfy the request.
+ */
+static unsigned cache_class_of_request(size_t size) {
+  unsigned c = 0;
+
+  while ((c < THD_CACHE_CLASSES - 1) && (size > (THD_CACHE_MIN_SIZE << c)))
+    c++;
+  return c;
+}
+
+/*
+ * Size class of a cached working area, the biggest class whose requests
+ * are all satisfied by the working area.
+ */
+static unsigned cache_class_of_block(size_t size) {
+  unsigned c = 0;
+
+  while ((c < THD_CACHE_CLASSES - 1) &&
+         (size >= (THD_CACHE_MIN_SIZE << (c + 1))))
+    c++;
+  return c;
+}
+
+/*
+ * Returns the working area of a terminated thread to its cache, the
+ * working area is released to the heap if the cache is full.
+ */
+static void cache_release(ThreadCache *tcp, void *wsp) {
+  struct cache_header *chp = (struct cache_header *)wsp;
+  unsigned c = cache_class_of_block(chHeapGetSize(wsp));
+
+  chSysLock();
+  if (tcp->tc_count < tcp->tc_max) {
+    chp->ch_next = tcp->tc_free[c];
+    tcp->tc_free[c] = chp;
+    tcp->tc_count++;
+    chSysUnlock();
+    return;
+  }
+  chSysUnlock();
+  chHeapFree(wsp);
+}
+#endif /* CH_USE_THREAD_CACHE */
+
 /**
  * @brief   Adds a reference to a thread object.
  * @pre     The configuration option @p CH_USE_DYNAMIC must be enabled in order
@@ -73,32 +120,40 @@ Thread *chThdAddRef(Thread *tp) {
  */
 void chThdRelease(Thread *tp) {
   trefs_t refs;
+  bool_t final;
 
   chSysLock();
   chDbgAssert(tp->p_refs > 0, "chThdRelease(), #1", "not referenced");
   refs = --tp->p_refs;
+  final = (refs == 0) && (tp->p_state == THD_STATE_FINAL);
+#if CH_USE_REGISTRY
+  /* Static threads have already been removed from the registry on exit,
+     the other threads are removed while the kernel is still locked.*/
+  if (final &&
+      ((tp->p_flags & THD_MEM_MODE_MASK) != THD_MEM_MODE_STATIC))
+    REG_REMOVE(tp);
+#endif
   chSysUnlock();
 
   /* If the references counter reaches zero and the thread is in its
      terminated state then the memory can be returned to the proper
      allocator. Of course static threads are not affected.*/
-  if ((refs == 0) && (tp->p_state == THD_STATE_FINAL)) {
+  if (final) {
     switch (tp->p_flags & THD_MEM_MODE_MASK) {
 #if CH_USE_HEAP
     case THD_MEM_MODE_HEAP:
-#if CH_USE_REGISTRY
-      REG_REMOVE(tp);
-#endif
       chHeapFree(tp);
       break;
 #endif
 #if CH_USE_MEMPOOLS
     case THD_MEM_MODE_MEMPOOL:
-#if CH_USE_REGISTRY
-      REG_REMOVE(tp);
-#endif
       chPoolFree(tp->p_mpool, tp);
       break;
+#endif
+#if CH_USE_THREAD_CACHE
+    case THD_MEM_MODE_CACHE:
+      cache_release(tp->p_mpool, tp);
+      break;
 #endif
     }
   }
@@ -206,6 +261,143 @@ Thread *chThdCreateFromMemoryPool(MemoryPool *mp, tprio_t prio,
 }
 #endif /* CH_USE_MEMPOOLS */
 
+#if CH_USE_THREAD_CACHE || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a thread cache.
+ * @note    The cache is initially empty, working areas are allocated from
+ *          the heap by the first threads creations and retained when the
+ *          threads are released.
+ *
+ * @param[out] tcp      pointer to a @p ThreadCache structure
+ * @param[in] heapp     heap from which allocate the working areas or
+ *                      @p NULL for the default heap
+ * @param[in] max       maximum number of working areas retained by the
+ *                      cache, the excess working areas are returned to
+ *                      the heap
+ *
+ * @init
+ */
+void chThdCacheInit(ThreadCache *tcp, MemoryHeap *heapp, cnt_t max) {
+  unsigned c;
+
+  chDbgCheck((tcp != NULL) && (max >= 0), "chThdCacheInit");
+
+  tcp->tc_heap = heapp;
+  for (c = 0; c < THD_CACHE_CLASSES; c++)
+    tcp->tc_free[c] = NULL;
+  tcp->tc_count = 0;
+  tcp->tc_max = max;
+}
+
+/**
+ * @brief   Creates a new thread reusing a working area from a thread cache.
+ * @details A cached working area of the same size class is used if
+ *          available, else a new working area is allocated from the heap
+ *          associated to the cache.
+ * @pre     The configuration options @p CH_USE_DYNAMIC and
+ *          @p CH_USE_THREAD_CACHE must be enabled in order to use this
+ *          function.
+ * @note    A thread can terminate by calling @p chThdExit() or by simply
+ *          returning from its main function.
+ * @note    The working area is returned to the cache, not to the heap, when
+ *          a @p chThdWait() is performed.
+ *
+ * @param[in] tcp       pointer to the @p ThreadCache object
+ * @param[in] size      size of the working area
+ * @param[in] prio      the priority level for the new thread
+ * @param[in] pf        the thread function
+ * @param[in] arg       an argument passed to the thread function. It can be
+ *                      @p NULL.
+ * @return              The pointer to the @p Thread structure allocated for
+ *                      the thread into the working space area.
+ * @retval NULL         if the memory cannot be allocated.
+ *
+ * @api
+ */
+Thread *chThdCreateFromCache(ThreadCache *tcp, size_t size,
+                             tprio_t prio, tfunc_t pf, void *arg) {
+  struct cache_header **chpp;
+  void *wsp;
+  Thread *tp;
+  unsigned c;
+
+  chDbgCheck(tcp != NULL, "chThdCreateFromCache");
+
+  c = cache_class_of_request(size);
+  if (c < THD_CACHE_CLASSES - 1)
+    size = THD_CACHE_MIN_SIZE << c;
+
+  /* First fit in the size class list, only the working areas of the last
+     class can be smaller than the request.*/
+  chSysLock();
+  chpp = &tcp->tc_free[c];
+  while ((*chpp != NULL) && (chHeapGetSize(*chpp) < size))
+    chpp = &(*chpp)->ch_next;
+  wsp = *chpp;
+  if (wsp != NULL) {
+    *chpp = (*chpp)->ch_next;
+    tcp->tc_count--;
+    size = chHeapGetSize(wsp);
+  }
+  chSysUnlock();
+
+  if (wsp == NULL) {
+    wsp = chHeapAlloc(tcp->tc_heap, size);
+    if (wsp == NULL)
+      return NULL;
+  }
+
+#if CH_DBG_FILL_THREADS
+  _thread_memfill((uint8_t *)wsp,
+                  (uint8_t *)wsp + sizeof(Thread),
+                  CH_THREAD_FILL_VALUE);
+  _thread_memfill((uint8_t *)wsp + sizeof(Thread),
+                  (uint8_t *)wsp + size,
+                  CH_STACK_FILL_VALUE);
+#endif
+
+  chSysLock();
+  tp = chThdCreateI(wsp, size, prio, pf, arg);
+  tp->p_flags = THD_MEM_MODE_CACHE;
+  tp->p_mpool = tcp;
+  chSchWakeupS(tp, RDY_OK);
+  chSysUnlock();
+  return tp;
+}
+
+/**
+ * @brief   Returns all the cached working areas to the heap.
+ * @note    The working areas of the threads still referenced are not
+ *          affected, they are returned to the cache when released.
+ *
+ * @param[in] tcp       pointer to the @p ThreadCache object
+ *
+ * @api
+ */
+void chThdCacheFlush(ThreadCache *tcp) {
+  unsigned c;
+
+  chDbgCheck(tcp != NULL, "chThdCacheFlush");
+
+  for (c = 0; c < THD_CACHE_CLASSES; c++) {
+    while (TRUE) {
+      struct cache_header *chp;
+
+      chSysLock();
+      chp = tcp->tc_free[c];
+      if (chp == NULL) {
+        chSysUnlock();
+        break;
+      }
+      tcp->tc_free[c] = chp->ch_next;
+      tcp->tc_count--;
+      chSysUnlock();
+      chHeapFree(chp);
+    }
+  }
+}
+#endif /* CH_USE_THREAD_CACHE */
+
 #endif /* CH_USE_DYNAMIC */
 
 /** @} */
@@ -260,6 +260,13 @@ void chEvtSignalI(Thread *tp, eventmask_t mask) {
       ((tp->p_state == THD_STATE_WTANDEVT) &&
        ((tp->p_epending & tp->p_u.ewmask) == tp->p_u.ewmask)))
     chSchReadyI(tp)->p_u.rdymsg = RDY_OK;
+#if CH_USE_WAITSETS
+  /* Test on the wait set condition, the mask is the union of the events
+     watched by the set.*/
+  else if ((tp->p_state == THD_STATE_WTSET) &&
+           ((tp->p_epending & tp->p_u.ewmask) != 0))
+    chSchReadyI(tp)->p_u.rdymsg = RDY_OK;
+#endif
 }
 
 /**
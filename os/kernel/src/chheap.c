@@ -36,6 +36,10 @@
  *          are functionally equivalent to the usual @p malloc() and @p free()
  *          library functions. The main difference is that the OS heap APIs
  *          are guaranteed to be thread safe.<br>
+ *          By enabling the @p CH_USE_HEAP_TLSF option the heap manager
+ *          uses a Two-Level Segregated Fit allocator instead, both the
+ *          allocation and the release of a block become constant time
+ *          operations and the fragmentation is bounded.<br>
  *          By enabling the @p CH_USE_MALLOC_HEAP option the heap manager
  *          will use the runtime-provided @p malloc() and @p free() as
  *          back end for the heap APIs instead of the system provided
@@ -67,19 +71,233 @@
  */
 static MemoryHeap default_heap;
 
+#if CH_USE_HEAP_TLSF || defined(__DOXYGEN__)
+/*
+ * TLSF free blocks management.
+ * The free blocks are kept in segregated lists indexed by a first level,
+ * the power of two range of the block size, and by a second level, a
+ * linear subdivision of that range. Two levels of bitmaps mark the
+ * non-empty lists so a suitable list is found in constant time. Each block
+ * is linked to the physically previous block and each memory area is
+ * terminated by a zero sized allocated block, so the coalescing of a
+ * released block is constant time too.
+ */
+#if defined(__GNUC__)
+#define heap_ctz(w) ((unsigned)__builtin_ctzl((unsigned long)(w)))
+#define heap_fls(w) ((unsigned)(sizeof(unsigned long) * 8 - 1 -             \
+                                __builtin_clzl((unsigned long)(w))))
+#else
+static const uint8_t heap_debruijn[32] = {
+  0,  1,  28, 2,  29, 14, 24, 3,  30, 22, 20, 15, 25, 17, 4,  8,
+  31, 27, 13, 23, 21, 19, 16, 7,  26, 12, 18, 6,  11, 5,  10, 9
+};
+#define heap_ctz(w)                                                         \
+  ((unsigned)heap_debruijn[(uint32_t)(((w) & (0U - (w))) * 0x077CB531U) >> 27])
+
+static unsigned heap_fls(size_t w) {
+  unsigned n = 0;
+
+  while (w >>= 1)
+    n++;
+  return n;
+}
+#endif
+
+#define HDR_SIZE        sizeof(union heap_header)
+#define TLSF_FREE       ((size_t)1)
+#define TLSF_MIN_SIZE   MEM_ALIGN_NEXT(sizeof(union heap_header *))
+#define TLSF_MAX_SIZE   (((size_t)1 << HEAP_TLSF_MAX_LOG2) - MEM_ALIGN_SIZE)
+#define TLSF_SMALL      ((size_t)HEAP_TLSF_SL_COUNT << HEAP_TLSF_ALIGN_LOG2)
+
+#define BSIZE(hp)       ((hp)->h.size & ~TLSF_FREE)
+#define IS_FREE(hp)     (((hp)->h.size & TLSF_FREE) != 0)
+#define NEXT_PHYS(hp)   ((union heap_header *)((uint8_t *)((hp) + 1) +      \
+                                               BSIZE(hp)))
+#define FREE_PREV(hp)   (*(union heap_header **)((hp) + 1))
+
+/*
+ * Computes the indexes of the free list a block size belongs to.
+ */
+static void tlsf_mapping(size_t size, unsigned *flp, unsigned *slp) {
+
+  if (size < TLSF_SMALL) {
+    *flp = 0;
+    *slp = (unsigned)(size >> HEAP_TLSF_ALIGN_LOG2);
+  }
+  else {
+    unsigned m = heap_fls(size);
+
+    *flp = m - HEAP_TLSF_FL_SHIFT + 1;
+    *slp = (unsigned)(size >> (m - HEAP_TLSF_SL_LOG2)) - HEAP_TLSF_SL_COUNT;
+  }
+}
+
+/*
+ * Empties all the free lists of a heap.
+ */
+static void tlsf_reset(MemoryHeap *heapp) {
+  unsigned fl, sl;
+
+  heapp->h_flmap = 0;
+  for (fl = 0; fl < HEAP_TLSF_FL_COUNT; fl++) {
+    heapp->h_slmap[fl] = 0;
+    for (sl = 0; sl < HEAP_TLSF_SL_COUNT; sl++)
+      heapp->h_free[fl][sl] = NULL;
+  }
+}
+
+/*
+ * Inserts a block in its free list.
+ */
+static void tlsf_insert(MemoryHeap *heapp, union heap_header *hp) {
+  unsigned fl, sl;
+
+  tlsf_mapping(BSIZE(hp), &fl, &sl);
+  hp->h.size |= TLSF_FREE;
+  hp->h.u.next = heapp->h_free[fl][sl];
+  FREE_PREV(hp) = NULL;
+  if (hp->h.u.next != NULL)
+    FREE_PREV(hp->h.u.next) = hp;
+  heapp->h_free[fl][sl] = hp;
+  heapp->h_flmap |= (uint32_t)1 << fl;
+  heapp->h_slmap[fl] |= (uint32_t)1 << sl;
+}
+
+/*
+ * Removes a block from its free list.
+ */
+static void tlsf_remove(MemoryHeap *heapp, union heap_header *hp) {
+  unsigned fl, sl;
+
+  tlsf_mapping(BSIZE(hp), &fl, &sl);
+  hp->h.size &= ~TLSF_FREE;
+  if (hp->h.u.next != NULL)
+    FREE_PREV(hp->h.u.next) = FREE_PREV(hp);
+  if (FREE_PREV(hp) != NULL)
+    FREE_PREV(hp)->h.u.next = hp->h.u.next;
+  else {
+    heapp->h_free[fl][sl] = hp->h.u.next;
+    if ((hp->h.u.next == NULL) &&
+        ((heapp->h_slmap[fl] &= ~((uint32_t)1 << sl)) == 0))
+      heapp->h_flmap &= ~((uint32_t)1 << fl);
+  }
+}
+
+/*
+ * Finds a free block of at least the specified size. The size is rounded
+ * up to the next list boundary so that any block in the first non-empty
+ * list is big enough, if there is none then only the head of the list the
+ * size belongs to is checked, this allows to allocate a block matching
+ * exactly the size of the last free block without scanning the list.
+ */
+static union heap_header *tlsf_find(MemoryHeap *heapp, size_t size) {
+  union heap_header *hp;
+  unsigned fl, sl;
+  uint32_t map;
+
+  tlsf_mapping(size, &fl, &sl);
+  if ((size >= TLSF_SMALL) &&
+      ((size & (((size_t)1 << (heap_fls(size) - HEAP_TLSF_SL_LOG2)) - 1)) != 0)) {
+    if (++sl >= HEAP_TLSF_SL_COUNT) {
+      sl = 0;
+      fl++;
+    }
+  }
+  if (fl < HEAP_TLSF_FL_COUNT) {
+    map = heapp->h_slmap[fl] & ((uint32_t)-1 << sl);
+    if (map == 0) {
+      map = heapp->h_flmap & ((uint32_t)-1 << (fl + 1));
+      if (map != 0) {
+        fl = heap_ctz(map);
+        map = heapp->h_slmap[fl];
+      }
+    }
+    if (map != 0)
+      return heapp->h_free[fl][heap_ctz(map)];
+  }
+
+  tlsf_mapping(size, &fl, &sl);
+  hp = heapp->h_free[fl][sl];
+  if ((hp != NULL) && (BSIZE(hp) >= size))
+    return hp;
+  return NULL;
+}
+
+/*
+ * Trims an allocated block to the specified size, the remainder, if big
+ * enough, becomes a free block.
+ */
+static void tlsf_split(MemoryHeap *heapp, union heap_header *hp,
+                       size_t size) {
+  size_t rem = BSIZE(hp) - size;
+
+  if (rem >= HDR_SIZE + TLSF_MIN_SIZE) {
+    union heap_header *fp = (union heap_header *)((uint8_t *)(hp + 1) + size);
+
+    fp->h.prev = hp;
+    fp->h.size = rem - HDR_SIZE;
+    hp->h.size = size;
+    NEXT_PHYS(fp)->h.prev = fp;
+    tlsf_insert(heapp, fp);
+  }
+}
+
+/*
+ * Formats a memory area as a single allocated block followed by the
+ * terminating zero sized block.
+ */
+static union heap_header *tlsf_area(void *buf, size_t size) {
+  union heap_header *hp = buf, *sp;
+
+  hp->h.prev = NULL;
+  hp->h.size = size - 2 * HDR_SIZE;
+  sp = NEXT_PHYS(hp);
+  sp->h.prev = hp;
+  sp->h.size = 0;
+  sp->h.u.heap = NULL;
+  return hp;
+}
+#endif /* CH_USE_HEAP_TLSF */
+
 /**
  * @brief   Initializes the default heap.
  *
  * @notapi
  */
 void _heap_init(void) {
-  default_heap.h_provider = chCoreAlloc;
-  default_heap.h_free.h.u.next = (union heap_header *)NULL;
-  default_heap.h_free.h.size = 0;
+
+  chHeapInitProvider(&default_heap, chCoreAlloc);
+}
+
+/**
+ * @brief   Initializes an empty memory heap fed by a memory provider.
+ * @details The heap has initially no memory, blocks are requested to the
+ *          provider when the heap is unable to satisfy an allocation. A
+ *          provider defined using @p CORE_REGION_PROVIDER() binds the heap
+ *          to a core memory region.
+ * @pre     In order to use this function the option @p CH_USE_MALLOC_HEAP
+ *          must be disabled.
+ *
+ * @param[out] heapp    pointer to the memory heap descriptor to be initialized
+ * @param[in] provider  API-class memory provider function
+ *
+ * @init
+ */
+void chHeapInitProvider(MemoryHeap *heapp, memgetfunc_t provider) {
+
+  chDbgCheck((heapp != NULL) && (provider != NULL), "chHeapInitProvider");
+
+  heapp->h_provider = provider;
+#if CH_USE_HEAP_TLSF
+  tlsf_reset(heapp);
+#else
+  heapp->h_free.h.u.next = (union heap_header *)NULL;
+  heapp->h_free.h.size = 0;
+#endif
 #if CH_USE_MUTEXES || defined(__DOXYGEN__)
-  chMtxInit(&default_heap.h_mtx);
+  chMtxInit(&heapp->h_mtx);
 #else
-  chSemInit(&default_heap.h_sem, 1);
+  chSemInit(&heapp->h_sem, 1);
 #endif
 }
 
@@ -89,6 +307,8 @@ void _heap_init(void) {
  *          the @p stkalign_t type size.
  * @pre     In order to use this function the option @p CH_USE_MALLOC_HEAP
  *          must be disabled.
+ * @note    If @p CH_USE_HEAP_TLSF is enabled the heap size is trimmed to
+ *          @p HEAP_TLSF_MAX_LOG2 bits.
  *
  * @param[out] heapp    pointer to the memory heap descriptor to be initialized
  * @param[in] buf       heap buffer base
@@ -97,6 +317,17 @@ void _heap_init(void) {
  * @init
  */
 void chHeapInit(MemoryHeap *heapp, void *buf, size_t size) {
+#if CH_USE_HEAP_TLSF
+
+  chDbgCheck(MEM_IS_ALIGNED(buf) && MEM_IS_ALIGNED(size) &&
+             (size >= 2 * HDR_SIZE + TLSF_MIN_SIZE), "chHeapInit");
+
+  heapp->h_provider = (memgetfunc_t)NULL;
+  tlsf_reset(heapp);
+  if (size > TLSF_MAX_SIZE + 2 * HDR_SIZE)
+    size = TLSF_MAX_SIZE + 2 * HDR_SIZE;
+  tlsf_insert(heapp, tlsf_area(buf, size));
+#else /* !CH_USE_HEAP_TLSF */
   union heap_header *hp;
 
   chDbgCheck(MEM_IS_ALIGNED(buf) && MEM_IS_ALIGNED(size), "chHeapInit");
@@ -106,6 +337,7 @@ void chHeapInit(MemoryHeap *heapp, void *buf, size_t size) {
   heapp->h_free.h.size = 0;
   hp->h.u.next = NULL;
   hp->h.size = size - sizeof(union heap_header);
+#endif /* !CH_USE_HEAP_TLSF */
 #if CH_USE_MUTEXES || defined(__DOXYGEN__)
   chMtxInit(&heapp->h_mtx);
 #else
@@ -118,6 +350,9 @@ void chHeapInit(MemoryHeap *heapp, void *buf, size_t size) {
  *          algorithm.
  * @details The allocated block is guaranteed to be properly aligned for a
  *          pointer data type (@p stkalign_t).
+ * @note    If @p CH_USE_HEAP_TLSF is enabled the block is taken from the
+ *          first non-empty segregated list fitting the request, the
+ *          operation is performed in constant time.
  *
  * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
  *                      access the default heap.
@@ -130,6 +365,43 @@ void chHeapInit(MemoryHeap *heapp, void *buf, size_t size) {
  * @api
  */
 void *chHeapAlloc(MemoryHeap *heapp, size_t size) {
+#if CH_USE_HEAP_TLSF
+  union heap_header *hp;
+
+  if (heapp == NULL)
+    heapp = &default_heap;
+
+  if (size > TLSF_MAX_SIZE)
+    return NULL;
+  size = MEM_ALIGN_NEXT(size);
+  if (size < TLSF_MIN_SIZE)
+    size = TLSF_MIN_SIZE;
+  H_LOCK(heapp);
+
+  hp = tlsf_find(heapp, size);
+  if (hp != NULL) {
+    tlsf_remove(heapp, hp);
+    tlsf_split(heapp, hp, size);
+    hp->h.u.heap = heapp;
+
+    H_UNLOCK(heapp);
+    return (void *)(hp + 1);
+  }
+
+  H_UNLOCK(heapp);
+
+  /* More memory is required, tries to get it from the associated provider
+     as a new memory area else fails.*/
+  if (heapp->h_provider) {
+    hp = heapp->h_provider(size + 2 * HDR_SIZE);
+    if (hp != NULL) {
+      hp = tlsf_area(hp, size + 2 * HDR_SIZE);
+      hp->h.u.heap = heapp;
+      return (void *)(hp + 1);
+    }
+  }
+  return NULL;
+#else /* !CH_USE_HEAP_TLSF */
   union heap_header *qp, *hp, *fp;
 
   if (heapp == NULL)
@@ -178,6 +450,7 @@ void *chHeapAlloc(MemoryHeap *heapp, size_t size) {
     }
   }
   return NULL;
+#endif /* !CH_USE_HEAP_TLSF */
 }
 
 #define LIMIT(p) (union heap_header *)((uint8_t *)(p) + \
@@ -186,6 +459,8 @@ void *chHeapAlloc(MemoryHeap *heapp, size_t size) {
 
 /**
  * @brief   Frees a previously allocated memory block.
+ * @note    If @p CH_USE_HEAP_TLSF is enabled the block is merged with its
+ *          physical neighbors in constant time.
  *
  * @param[in] p         pointer to the memory block to be freed
  *
@@ -199,6 +474,28 @@ void chHeapFree(void *p) {
 
   hp = (union heap_header *)p - 1;
   heapp = hp->h.u.heap;
+#if CH_USE_HEAP_TLSF
+  H_LOCK(heapp);
+
+  chDbgAssert(!IS_FREE(hp), "chHeapFree(), #1", "already free");
+
+  qp = hp->h.prev;
+  if ((qp != NULL) && IS_FREE(qp)) {
+    /* Merge with the previous block.*/
+    tlsf_remove(heapp, qp);
+    qp->h.size += HDR_SIZE + BSIZE(hp);
+    hp = qp;
+    NEXT_PHYS(hp)->h.prev = hp;
+  }
+  qp = NEXT_PHYS(hp);
+  if (IS_FREE(qp)) {
+    /* Merge with the next block.*/
+    tlsf_remove(heapp, qp);
+    hp->h.size += HDR_SIZE + BSIZE(qp);
+    NEXT_PHYS(hp)->h.prev = hp;
+  }
+  tlsf_insert(heapp, hp);
+#else /* !CH_USE_HEAP_TLSF */
   qp = &heapp->h_free;
   H_LOCK(heapp);
 
@@ -227,6 +524,7 @@ void chHeapFree(void *p) {
     }
     qp = qp->h.u.next;
   }
+#endif /* !CH_USE_HEAP_TLSF */
 
   H_UNLOCK(heapp);
   return;
@@ -250,6 +548,9 @@ void chHeapFree(void *p) {
 size_t chHeapStatus(MemoryHeap *heapp, size_t *sizep) {
   union heap_header *qp;
   size_t n, sz;
+#if CH_USE_HEAP_TLSF
+  unsigned fl, sl;
+#endif
 
   if (heapp == NULL)
     heapp = &default_heap;
@@ -257,8 +558,20 @@ size_t chHeapStatus(MemoryHeap *heapp, size_t *sizep) {
   H_LOCK(heapp);
 
   sz = 0;
+#if CH_USE_HEAP_TLSF
+  n = 0;
+  for (fl = 0; fl < HEAP_TLSF_FL_COUNT; fl++) {
+    for (sl = 0; sl < HEAP_TLSF_SL_COUNT; sl++) {
+      for (qp = heapp->h_free[fl][sl]; qp != NULL; qp = qp->h.u.next) {
+        sz += BSIZE(qp);
+        n++;
+      }
+    }
+  }
+#else
   for (n = 0, qp = &heapp->h_free; qp->h.u.next; n++, qp = qp->h.u.next)
     sz += qp->h.u.next->h.size;
+#endif
   if (sizep)
     *sizep = sz;
 
@@ -45,7 +45,12 @@
  *          can coexist and share the main memory.<br>
  *          This allocator, alone, is also useful for very simple
  *          applications that just require a simple way to get memory
- *          blocks.
+ *          blocks.<br>
+ *          Additional named regions can be registered, for example
+ *          separate fast and slow RAM banks. Each region has its own
+ *          blocks alignment and can be bound to heaps and memory pools
+ *          through providers defined with @p CORE_REGION_PROVIDER() and
+ *          @p CORE_REGION_PROVIDER_I().
  * @pre     In order to use the core memory manager APIs the @p CH_USE_MEMCORE
  *          option must be enabled in @p chconf.h.
  * @{
@@ -55,8 +60,10 @@
 
 #if CH_USE_MEMCORE || defined(__DOXYGEN__)
 
-static uint8_t *nextmem;
-static uint8_t *endmem;
+/**
+ * @brief   Default core memory region, first of the registered regions.
+ */
+static MemoryRegion default_region;
 
 /**
  * @brief   Low level memory manager initialization.
@@ -67,13 +74,17 @@ void _core_init(void) {
 #if CH_MEMCORE_SIZE == 0
   extern uint8_t __heap_base__[];
   extern uint8_t __heap_end__[];
-  nextmem = (uint8_t *)MEM_ALIGN_NEXT(__heap_base__);
-  endmem = (uint8_t *)MEM_ALIGN_PREV(__heap_end__);
+  default_region.mr_nextmem = (uint8_t *)MEM_ALIGN_NEXT(__heap_base__);
+  default_region.mr_endmem = (uint8_t *)MEM_ALIGN_PREV(__heap_end__);
 #else
   static stkalign_t buffer[MEM_ALIGN_NEXT(CH_MEMCORE_SIZE)/MEM_ALIGN_SIZE];
-  nextmem = (uint8_t *)&buffer[0];
-  endmem = (uint8_t *)&buffer[MEM_ALIGN_NEXT(CH_MEMCORE_SIZE)/MEM_ALIGN_SIZE];
+  default_region.mr_nextmem = (uint8_t *)&buffer[0];
+  default_region.mr_endmem =
+    (uint8_t *)&buffer[MEM_ALIGN_NEXT(CH_MEMCORE_SIZE)/MEM_ALIGN_SIZE];
 #endif
+  default_region.mr_next = NULL;
+  default_region.mr_name = CORE_DEFAULT_REGION_NAME;
+  default_region.mr_align = MEM_ALIGN_SIZE;
 }
 
 /**
@@ -110,28 +121,158 @@ void *chCoreAlloc(size_t size) {
  * @iclass
  */
 void *chCoreAllocI(size_t size) {
+
+  return chCoreAllocFromI(&default_region, size);
+}
+
+/**
+ * @brief   Core memory status.
+ *
+ * @return              The size, in bytes, of the free core memory.
+ *
+ * @api
+ */
+size_t chCoreStatus(void) {
+
+  return chCoreRegionStatus(&default_region);
+}
+
+/**
+ * @brief   Initializes and registers a core memory region.
+ * @details The memory area is trimmed to the region alignment. Initializing
+ *          an already registered region resets it.
+ * @note    Regions cannot be unregistered.
+ *
+ * @param[out] mrp      pointer to the @p MemoryRegion structure to be
+ *                      initialized
+ * @param[in] name      region name, it is used by @p chCoreGetRegion()
+ * @param[in] base      base of the region memory area
+ * @param[in] size      size of the region memory area
+ * @param[in] align     alignment of the allocated blocks, it must be a
+ *                      power of two not smaller than @p MEM_ALIGN_SIZE
+ *
+ * @api
+ */
+void chCoreRegionInit(MemoryRegion *mrp, const char *name,
+                      void *base, size_t size, size_t align) {
+  MemoryRegion *rp;
+
+  chDbgCheck((mrp != NULL) && (name != NULL) && (align >= MEM_ALIGN_SIZE) &&
+             ((align & (align - 1)) == 0), "chCoreRegionInit");
+
+  chSysLock();
+  mrp->mr_name = name;
+  mrp->mr_align = align;
+  mrp->mr_nextmem = (uint8_t *)(((size_t)base + align - 1) & ~(align - 1));
+  mrp->mr_endmem = (uint8_t *)MEM_ALIGN_PREV((uint8_t *)base + size);
+  if (mrp->mr_endmem < mrp->mr_nextmem)
+    mrp->mr_endmem = mrp->mr_nextmem;
+
+  /* Linked after the default region, if not already registered.*/
+  for (rp = &default_region; rp != NULL; rp = rp->mr_next)
+    if (rp == mrp)
+      break;
+  if (rp == NULL) {
+    mrp->mr_next = default_region.mr_next;
+    default_region.mr_next = mrp;
+  }
+  chSysUnlock();
+}
+
+/**
+ * @brief   Finds a registered core memory region by name.
+ * @details The default region is registered as
+ *          @p CORE_DEFAULT_REGION_NAME.
+ *
+ * @param[in] name      the region name
+ * @return              Pointer to the region.
+ * @retval NULL         if a region with the specified name does not exist.
+ *
+ * @api
+ */
+MemoryRegion *chCoreGetRegion(const char *name) {
+  MemoryRegion *rp;
+
+  chSysLock();
+  for (rp = &default_region; rp != NULL; rp = rp->mr_next) {
+    const char *s1 = rp->mr_name, *s2 = name;
+
+    while ((*s1 != '\0') && (*s1 == *s2)) {
+      s1++;
+      s2++;
+    }
+    if (*s1 == *s2)
+      break;
+  }
+  chSysUnlock();
+  return rp;
+}
+
+/**
+ * @brief   Allocates a memory block from a region.
+ * @details The returned block is aligned to the region alignment and its
+ *          size is aligned to the alignment type.
+ *
+ * @param[in] mrp       pointer to the @p MemoryRegion object or @p NULL in
+ *                      order to access the default region
+ * @param[in] size      the size of the block to be allocated
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, region memory exhausted.
+ *
+ * @api
+ */
+void *chCoreAllocFrom(MemoryRegion *mrp, size_t size) {
   void *p;
 
+  chSysLock();
+  p = chCoreAllocFromI(mrp, size);
+  chSysUnlock();
+  return p;
+}
+
+/**
+ * @brief   Allocates a memory block from a region.
+ * @details The returned block is aligned to the region alignment and its
+ *          size is aligned to the alignment type.
+ *
+ * @param[in] mrp       pointer to the @p MemoryRegion object or @p NULL in
+ *                      order to access the default region
+ * @param[in] size      the size of the block to be allocated
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, region memory exhausted.
+ *
+ * @iclass
+ */
+void *chCoreAllocFromI(MemoryRegion *mrp, size_t size) {
+  uint8_t *p;
+
   chDbgCheckClassI();
 
+  if (mrp == NULL)
+    mrp = &default_region;
+  p = (uint8_t *)(((size_t)mrp->mr_nextmem + mrp->mr_align - 1) &
+                  ~(mrp->mr_align - 1));
   size = MEM_ALIGN_NEXT(size);
-  if ((size_t)(endmem - nextmem) < size)
+  if ((p > mrp->mr_endmem) || ((size_t)(mrp->mr_endmem - p) < size))
     return NULL;
-  p = nextmem;
-  nextmem += size;
+  mrp->mr_nextmem = p + size;
   return p;
 }
 
 /**
- * @brief   Core memory status.
+ * @brief   Core memory region status.
  *
- * @return              The size, in bytes, of the free core memory.
+ * @param[in] mrp       pointer to the @p MemoryRegion object or @p NULL in
+ *                      order to access the default region
+ * @return              The size, in bytes, of the free region memory.
  *
  * @api
  */
-size_t chCoreStatus(void) {
+size_t chCoreRegionStatus(MemoryRegion *mrp) {
 
-  return (size_t)(endmem - nextmem);
+  if (mrp == NULL)
+    mrp = &default_region;
+  return (size_t)(mrp->mr_endmem - mrp->mr_nextmem);
 }
 #endif /* CH_USE_MEMCORE */
 
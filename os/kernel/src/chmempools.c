@@ -37,7 +37,12 @@
  *          problems.<br>
  *          Memory Pools do not enforce any alignment constraint on the
  *          contained object however the objects must be properly aligned
- *          to contain a pointer to void.
+ *          to contain a pointer to void.<br>
+ *          By enabling the @p CH_USE_MEMPOOLS_LOCKFREE option, on ports
+ *          supporting a double word compare and swap or a
+ *          load-linked/store-conditional list pop, the pools free lists
+ *          are managed without the kernel lock and objects can be allocated
+ *          and released from any context.
  * @pre     In order to use the memory pools APIs the @p CH_USE_MEMPOOLS option
  *          must be enabled in @p chconf.h.
  * @{
@@ -46,6 +51,65 @@
 #include "ch.h"
 
 #if CH_USE_MEMPOOLS || defined(__DOXYGEN__)
+
+#if MP_TAGGED_HEAD || defined(__DOXYGEN__)
+/*
+ * Lock-free free list management.
+ * The list head is read without atomicity guarantees, a torn or stale copy
+ * simply makes the following compare and swap fail. The objects memory is
+ * never returned by the pools so reading the link field of an object that
+ * has been allocated meanwhile is harmless, the tag prevents the ABA
+ * problem.
+ */
+static struct pool_header *pool_pop(MemoryPool *mp) {
+  volatile pool_head_t *hp = &mp->mp_head;
+  pool_head_t old, new;
+
+  do {
+    old.mph.mph_next = hp->mph.mph_next;
+    old.mph.mph_tag = hp->mph.mph_tag;
+    if (old.mph.mph_next == NULL)
+      return NULL;
+    new.mph.mph_next = old.mph.mph_next->ph_next;
+    new.mph.mph_tag = old.mph.mph_tag + 1;
+  } while (!port_cas2(&hp->mph_cas, old.mph_cas, new.mph_cas));
+  return old.mph.mph_next;
+}
+
+static void pool_push(MemoryPool *mp, struct pool_header *php) {
+  volatile pool_head_t *hp = &mp->mp_head;
+  pool_head_t old, new;
+
+  do {
+    old.mph.mph_next = hp->mph.mph_next;
+    old.mph.mph_tag = hp->mph.mph_tag;
+    php->ph_next = old.mph.mph_next;
+    new.mph.mph_next = php;
+    new.mph.mph_tag = old.mph.mph_tag + 1;
+  } while (!port_cas2(&hp->mph_cas, old.mph_cas, new.mph_cas));
+}
+#elif MP_LOCKFREE_LLSC
+/*
+ * Lock-free free list management.
+ * The pop is performed by the port, the store-conditional fails if the
+ * head has been modified or if an interrupt occurred since the head has
+ * been loaded so there is no ABA problem. The push is a plain compare and
+ * swap, a push is never affected by the ABA problem.
+ */
+#define pool_pop(mp) ((struct pool_header *)                                \
+                      port_llsc_pop((void * volatile *)&(mp)->mp_next))
+
+static void pool_push(MemoryPool *mp, struct pool_header *php) {
+  struct pool_header * volatile *pp = &mp->mp_next;
+  struct pool_header *next;
+
+  do {
+    next = *pp;
+    php->ph_next = next;
+  } while (!port_casp((void * volatile *)pp, next, php));
+}
+#endif /* MP_LOCKFREE_LLSC */
+
 /**
  * @brief   Initializes an empty memory pool.
  *
@@ -63,7 +127,12 @@ void chPoolInit(MemoryPool *mp, size_t size, memgetfunc_t provider) {
 
   chDbgCheck((mp != NULL) && (size >= sizeof(void *)), "chPoolInit");
 
+#if MP_TAGGED_HEAD
+  mp->mp_head.mph.mph_next = NULL;
+  mp->mp_head.mph.mph_tag = 0;
+#else
   mp->mp_next = NULL;
+#endif
   mp->mp_object_size = size;
   mp->mp_provider = provider;
 }
@@ -95,6 +164,9 @@ void chPoolLoadArray(MemoryPool *mp, void *p, size_t n) {
 /**
  * @brief   Allocates an object from a memory pool.
  * @pre     The memory pool must be already been initialized.
+ * @note    If the pools are lock-free this function can also be invoked
+ *          outside the kernel lock, including fast interrupts, as long as
+ *          the pool has no memory provider.
  *
  * @param[in] mp        pointer to a @p MemoryPool structure
  * @return              The pointer to the allocated object.
@@ -105,12 +177,18 @@ void chPoolLoadArray(MemoryPool *mp, void *p, size_t n) {
 void *chPoolAllocI(MemoryPool *mp) {
   void *objp;
 
+#if !MP_LOCKFREE
   chDbgCheckClassI();
+#endif
   chDbgCheck(mp != NULL, "chPoolAllocI");
 
+#if MP_LOCKFREE
+  if (((objp = pool_pop(mp)) == NULL) && (mp->mp_provider != NULL))
+#else
   if ((objp = mp->mp_next) != NULL)
     mp->mp_next = mp->mp_next->ph_next;
   else if (mp->mp_provider != NULL)
+#endif
     objp = mp->mp_provider(mp->mp_object_size);
   return objp;
 }
@@ -128,9 +206,20 @@ void *chPoolAllocI(MemoryPool *mp) {
 void *chPoolAlloc(MemoryPool *mp) {
   void *objp;
 
+#if MP_LOCKFREE
+  chDbgCheck(mp != NULL, "chPoolAlloc");
+
+  /* The kernel lock is only required by the memory provider.*/
+  if (((objp = pool_pop(mp)) == NULL) && (mp->mp_provider != NULL)) {
+    chSysLock();
+    objp = mp->mp_provider(mp->mp_object_size);
+    chSysUnlock();
+  }
+#else
   chSysLock();
   objp = chPoolAllocI(mp);
   chSysUnlock();
+#endif
   return objp;
 }
 
@@ -140,6 +229,8 @@ void *chPoolAlloc(MemoryPool *mp) {
  * @pre     The freed object must be of the right size for the specified
  *          memory pool.
  * @pre     The object must be properly aligned to contain a pointer to void.
+ * @note    If the pools are lock-free this function can also be invoked
+ *          outside the kernel lock, including fast interrupts.
  *
  * @param[in] mp        pointer to a @p MemoryPool structure
  * @param[in] objp      the pointer to the object to be released
@@ -149,11 +240,17 @@ void *chPoolAlloc(MemoryPool *mp) {
 void chPoolFreeI(MemoryPool *mp, void *objp) {
   struct pool_header *php = objp;
 
+#if !MP_LOCKFREE
   chDbgCheckClassI();
+#endif
   chDbgCheck((mp != NULL) && (objp != NULL), "chPoolFreeI");
 
+#if MP_LOCKFREE
+  pool_push(mp, php);
+#else
   php->ph_next = mp->mp_next;
   mp->mp_next = php;
+#endif
 }
 
 /**
@@ -170,9 +267,13 @@ void chPoolFreeI(MemoryPool *mp, void *objp) {
  */
 void chPoolFree(MemoryPool *mp, void *objp) {
 
+#if MP_LOCKFREE
+  chPoolFreeI(mp, objp);
+#else
   chSysLock();
   chPoolFreeI(mp, objp);
   chSysUnlock();
+#endif
 }
 
 #endif /* CH_USE_MEMPOOLS */
@@ -0,0 +1,299 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chmsgq.c
+ * @brief   Message Queues code.
+ *
+ * @addtogroup msgqueues
+ * @details Asynchronous message queues related APIs and services.
+ *
+ *          <h2>Operation mode</h2>
+ *          A message queue transfers the ownership of message buffers
+ *          between threads without copying the payload. The buffers are
+ *          allocated from memory pools, posted into a queue without
+ *          blocking the sender, fetched by the receiver as pointers and
+ *          returned to their pool when released.<br>
+ *          Each buffer has an header placed in front of the payload, the
+ *          header links the buffer in the queue and remembers the owner
+ *          pool so the buffer can be released by any thread. The pools
+ *          must be initialized with an objects size calculated using the
+ *          @p MSGQ_BUFFER_SIZE() macro.<br>
+ *          The messages are delivered in FIFO order or, if the
+ *          @p CH_USE_MSGQUEUES_PRIORITY option is enabled, by buffer
+ *          priority.<br>
+ *          The queue has no size limit, the number of pending messages is
+ *          limited by the number of buffers in the pools so a sender can
+ *          pipeline requests up to the pool size.
+ * @pre     In order to use the message queues APIs the @p CH_USE_MSGQUEUES
+ *          option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_USE_MSGQUEUES || defined(__DOXYGEN__)
+
+/*
+ * Removes the first message from the queue, the internal semaphore must
+ * have been already acquired.
+ */
+static void *mq_dequeue(MsgQueue *mqp) {
+  MsgHeader *mhp = mqp->mq_head;
+
+  mqp->mq_head = mhp->mh_next;
+  return mhp + 1;
+}
+
+/**
+ * @brief   Allocates a message buffer.
+ *
+ * @param[in] mp        pointer to the @p MemoryPool of the buffers
+ * @return              The pointer to the buffer payload.
+ * @retval NULL         if the pool is empty.
+ *
+ * @iclass
+ */
+void *chMsgBufAllocI(MemoryPool *mp) {
+  MsgHeader *mhp;
+
+  chDbgCheckClassI();
+  chDbgCheck(mp != NULL, "chMsgBufAllocI");
+
+  mhp = chPoolAllocI(mp);
+  if (mhp == NULL)
+    return NULL;
+  mhp->mh_pool = mp;
+#if CH_USE_MSGQUEUES_PRIORITY
+  mhp->mh_prio = NORMALPRIO;
+#endif
+  return mhp + 1;
+}
+
+/**
+ * @brief   Allocates a message buffer.
+ *
+ * @param[in] mp        pointer to the @p MemoryPool of the buffers
+ * @return              The pointer to the buffer payload.
+ * @retval NULL         if the pool is empty.
+ *
+ * @api
+ */
+void *chMsgBufAlloc(MemoryPool *mp) {
+  void *buf;
+
+  chSysLock();
+  buf = chMsgBufAllocI(mp);
+  chSysUnlock();
+  return buf;
+}
+
+/**
+ * @brief   Releases a message buffer.
+ * @details The buffer is returned to the pool it was allocated from.
+ *
+ * @param[in] buf       pointer to the message buffer
+ *
+ * @iclass
+ */
+void chMsgBufReleaseI(void *buf) {
+  MsgHeader *mhp = (MsgHeader *)buf - 1;
+
+  chDbgCheckClassI();
+  chDbgCheck(buf != NULL, "chMsgBufReleaseI");
+
+  chPoolFreeI(mhp->mh_pool, mhp);
+}
+
+/**
+ * @brief   Releases a message buffer.
+ * @details The buffer is returned to the pool it was allocated from.
+ *
+ * @param[in] buf       pointer to the message buffer
+ *
+ * @api
+ */
+void chMsgBufRelease(void *buf) {
+
+  chSysLock();
+  chMsgBufReleaseI(buf);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Initializes a @p MsgQueue object.
+ *
+ * @param[out] mqp      the pointer to the @p MsgQueue structure to be
+ *                      initialized
+ *
+ * @init
+ */
+void chMsgQInit(MsgQueue *mqp) {
+
+  chDbgCheck(mqp != NULL, "chMsgQInit");
+
+  mqp->mq_head = NULL;
+  mqp->mq_tail = NULL;
+  chSemInit(&mqp->mq_sem, 0);
+}
+
+/**
+ * @brief   Posts a message.
+ * @details The ownership of the buffer is transferred to the queue, the
+ *          invoking thread is never suspended.
+ *
+ * @param[in] mqp       the pointer to an initialized @p MsgQueue object
+ * @param[in] buf       pointer to the message buffer
+ *
+ * @api
+ */
+void chMsgQPost(MsgQueue *mqp, void *buf) {
+
+  chSysLock();
+  chMsgQPostI(mqp, buf);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Posts a message.
+ * @details The ownership of the buffer is transferred to the queue.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] mqp       the pointer to an initialized @p MsgQueue object
+ * @param[in] buf       pointer to the message buffer
+ *
+ * @iclass
+ */
+void chMsgQPostI(MsgQueue *mqp, void *buf) {
+  MsgHeader *mhp = (MsgHeader *)buf - 1;
+
+  chDbgCheckClassI();
+  chDbgCheck((mqp != NULL) && (buf != NULL), "chMsgQPostI");
+
+#if CH_USE_MSGQUEUES_PRIORITY
+  if ((mqp->mq_head != NULL) && (mqp->mq_tail->mh_prio < mhp->mh_prio)) {
+    MsgHeader **mhpp = &mqp->mq_head;
+
+    /* Inserted after the messages with higher or equal priority, the last
+       message has a lower priority so the tail is not affected.*/
+    while ((*mhpp)->mh_prio >= mhp->mh_prio)
+      mhpp = &(*mhpp)->mh_next;
+    mhp->mh_next = *mhpp;
+    *mhpp = mhp;
+    chSemSignalI(&mqp->mq_sem);
+    return;
+  }
+#endif
+  mhp->mh_next = NULL;
+  if (mqp->mq_head == NULL)
+    mqp->mq_head = mhp;
+  else
+    mqp->mq_tail->mh_next = mhp;
+  mqp->mq_tail = mhp;
+  chSemSignalI(&mqp->mq_sem);
+}
+
+/**
+ * @brief   Fetches a message.
+ * @details The ownership of the buffer is transferred to the invoking
+ *          thread, the buffer must be released after use.
+ *
+ * @param[in] mqp       the pointer to an initialized @p MsgQueue object
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the message buffer.
+ * @retval NULL         if the operation timed out.
+ *
+ * @api
+ */
+void *chMsgQFetch(MsgQueue *mqp, systime_t time) {
+  void *buf;
+
+  chSysLock();
+  buf = chMsgQFetchS(mqp, time);
+  chSysUnlock();
+  return buf;
+}
+
+/**
+ * @brief   Fetches a message.
+ * @details The ownership of the buffer is transferred to the invoking
+ *          thread, the buffer must be released after use.
+ *
+ * @param[in] mqp       the pointer to an initialized @p MsgQueue object
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the message buffer.
+ * @retval NULL         if the operation timed out.
+ *
+ * @sclass
+ */
+void *chMsgQFetchS(MsgQueue *mqp, systime_t time) {
+
+  chDbgCheckClassS();
+  chDbgCheck(mqp != NULL, "chMsgQFetchS");
+
+  if (chSemWaitTimeoutS(&mqp->mq_sem, time) != RDY_OK)
+    return NULL;
+  return mq_dequeue(mqp);
+}
+
+/**
+ * @brief   Fetches a message.
+ * @details The ownership of the buffer is transferred to the invoking
+ *          thread, the buffer must be released after use.
+ *
+ * @param[in] mqp       the pointer to an initialized @p MsgQueue object
+ * @return              The pointer to the message buffer.
+ * @retval NULL         if the queue is empty.
+ *
+ * @iclass
+ */
+void *chMsgQFetchI(MsgQueue *mqp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(mqp != NULL, "chMsgQFetchI");
+
+  if (chSemGetCounterI(&mqp->mq_sem) <= 0)
+    return NULL;
+  chSemFastWaitI(&mqp->mq_sem);
+  return mq_dequeue(mqp);
+}
+
+#endif /* CH_USE_MSGQUEUES */
+
+/** @} */
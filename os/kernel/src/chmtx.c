@@ -65,6 +65,33 @@
  *          The mechanism works with any number of nested mutexes and any
  *          number of involved threads. The algorithm complexity (worst case)
  *          is N with N equal to the number of nested mutexes.
+ *
+ *          <h2>The priority ceiling protocol</h2>
+ *          If the @p CH_USE_MUTEXES_CEILING option is enabled then a mutex
+ *          can be initialized with a priority ceiling using
+ *          @p chMtxInitCeiling(). The ceiling must be equal or greater than
+ *          the priority of all the threads using the mutex.<br>
+ *          Such mutexes implement the <b>immediate</b> priority ceiling
+ *          protocol, the owner thread is raised to the ceiling priority as
+ *          soon as the mutex is locked and returns to its base priority on
+ *          unlock. No other thread using the mutex can preempt the owner so
+ *          the mutex is normally found free and both lock and unlock are
+ *          constant time operations, no owners chain walk is performed. The
+ *          cost is linear only when other mutexes are held by the thread at
+ *          unlock time.<br>
+ *          Contention is still possible if the owner sleeps while holding
+ *          the mutex, in that case the priority inheritance mechanism is
+ *          used as fall back.
+ *
+ *          <h2>Atomic fast path</h2>
+ *          If the @p CH_USE_ATOMIC_FASTPATH option is enabled and the port
+ *          supports it, @p chMtxLock(), @p chMtxTryLock() and
+ *          @p chMtxUnlock() take and release a mutex without entering the
+ *          kernel lock when there is no contention. The owner field is
+ *          updated using a compare and swap and its least significant bit
+ *          flags the presence of waiting threads, so that the fast unlock
+ *          fails and the locked code path wakes the next owner. Priority
+ *          ceiling mutexes always use the locked code paths.
  * @pre     In order to use the mutex APIs the @p CH_USE_MUTEXES option
  *          must be enabled in @p chconf.h.
  * @post    Enabling mutexes requires 5-12 (depending on the architecture)
@@ -76,6 +103,95 @@
 
 #if CH_USE_MUTEXES || defined(__DOXYGEN__)
 
+#if MTX_FASTPATH || defined(__DOXYGEN__)
+/*
+ * Flag in the owner field marking the presence of waiting threads.
+ */
+#define MTX_WAITERS     ((size_t)1)
+
+/*
+ * Assigns the mutex to a thread, the waiters flag is set if other threads
+ * are still queued.
+ */
+#define mtx_set_owner(mp, tp)                                               \
+  ((mp)->m_owner = chMtxQueueNotEmptyS(mp) ?                                \
+                   (Thread *)((size_t)(tp) | MTX_WAITERS) : (tp))
+
+/*
+ * Takes a free mutex without entering the kernel lock.
+ */
+static bool_t mtx_fast_lock(Mutex *mp) {
+  Thread *ctp = currp;
+
+#if CH_USE_MUTEXES_CEILING
+  if (mp->m_ceiling != NOPRIO)
+    return FALSE;
+#endif
+  if (!port_casp((void * volatile *)&mp->m_owner, NULL, ctp))
+    return FALSE;
+  trace_mtx_fast_lock(mp);
+  /* The owned mutexes list is only modified by the owner thread or while
+     it is sleeping on a mutex.*/
+  mp->m_next = ctp->p_mtxlist;
+  ctp->p_mtxlist = mp;
+  dbg_lock_acquired(&mp->m_stats);
+  return TRUE;
+}
+
+/*
+ * Releases the last locked mutex without entering the kernel lock, the
+ * compare and swap fails if the waiters flag is set.
+ */
+static Mutex *mtx_fast_unlock(void) {
+  Thread *ctp = currp;
+  Mutex *ump = ctp->p_mtxlist;
+  Mutex *next;
+
+  if (ump == NULL)
+    return NULL;
+#if CH_USE_MUTEXES_CEILING
+  if (ump->m_ceiling != NOPRIO)
+    return NULL;
+#endif
+  /* The link must be read and the hold time accounted before releasing the
+     mutex, a new owner would overwrite them. If the release fails then the
+     locked path accounts the hold time again, a longer one.*/
+  next = ump->m_next;
+  dbg_lock_released(&ump->m_stats);
+  if (!port_casp((void * volatile *)&ump->m_owner, ctp, NULL))
+    return NULL;
+  trace_mtx_unlock(ump);
+  ctp->p_mtxlist = next;
+  return ump;
+}
+#else /* !MTX_FASTPATH */
+#define mtx_set_owner(mp, tp) ((mp)->m_owner = (tp))
+#endif /* !MTX_FASTPATH */
+
+/*
+ * Returns the priority a thread is entitled to because of the mutexes it
+ * still owns, the base priority if none.
+ */
+static tprio_t mtx_priority(Thread *tp) {
+  tprio_t newprio = tp->p_realprio;
+  Mutex *mp = tp->p_mtxlist;
+
+  while (mp != NULL) {
+    /* If the highest priority thread waiting in the mutexes list has a
+       greater priority than the current thread base priority then the final
+       priority will have at least that priority.*/
+    if (chMtxQueueNotEmptyS(mp) && (mp->m_queue.p_next->p_prio > newprio))
+      newprio = mp->m_queue.p_next->p_prio;
+#if CH_USE_MUTEXES_CEILING
+    /* Same for the ceiling of priority ceiling mutexes.*/
+    if (mp->m_ceiling > newprio)
+      newprio = mp->m_ceiling;
+#endif
+    mp = mp->m_next;
+  }
+  return newprio;
+}
+
 /**
  * @brief   Initializes s @p Mutex structure.
  *
@@ -89,7 +205,37 @@ void chMtxInit(Mutex *mp) {
 
   queue_init(&mp->m_queue);
   mp->m_owner = NULL;
+#if CH_USE_MUTEXES_CEILING
+  mp->m_ceiling = NOPRIO;
+#endif
+  dbg_lock_init(&mp->m_stats);
+}
+
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes s @p Mutex structure with a priority ceiling.
+ * @details The mutex implements the immediate priority ceiling protocol,
+ *          the owner thread runs at the ceiling priority for as long as it
+ *          owns the mutex.
+ * @pre     The ceiling must be equal or greater than the base priority of
+ *          any thread locking the mutex.
+ *
+ * @param[out] mp       pointer to a @p Mutex structure
+ * @param[in] ceiling   the priority ceiling
+ *
+ * @init
+ */
+void chMtxInitCeiling(Mutex *mp, tprio_t ceiling) {
+
+  chDbgCheck((mp != NULL) && (ceiling > NOPRIO) && (ceiling <= HIGHPRIO),
+             "chMtxInitCeiling");
+
+  queue_init(&mp->m_queue);
+  mp->m_owner = NULL;
+  mp->m_ceiling = ceiling;
+  dbg_lock_init(&mp->m_stats);
 }
+#endif /* CH_USE_MUTEXES_CEILING */
 
 /**
  * @brief   Locks the specified mutex.
@@ -102,6 +248,10 @@ void chMtxInit(Mutex *mp) {
  */
 void chMtxLock(Mutex *mp) {
 
+#if MTX_FASTPATH
+  if (mtx_fast_lock(mp))
+    return;
+#endif
   chSysLock();
 
   chMtxLockS(mp);
@@ -123,24 +273,43 @@ void chMtxLockS(Mutex *mp) {
 
   chDbgCheckClassS();
   chDbgCheck(mp != NULL, "chMtxLockS");
+#if CH_USE_MUTEXES_CEILING
+  chDbgAssert((mp->m_ceiling == NOPRIO) || (ctp->p_realprio <= mp->m_ceiling),
+              "chMtxLockS(), #3",
+              "priority above ceiling");
+#endif
 
+  trace_mtx_lock(mp);
   /* Is the mutex already locked? */
   if (mp->m_owner != NULL) {
     /* Priority inheritance protocol; explores the thread-mutex dependencies
        boosting the priority of all the affected threads to equal the priority
        of the running thread requesting the mutex.*/
-    Thread *tp = mp->m_owner;
+    Thread *tp = chMtxGetOwnerI(mp);
+#if CH_DBG_LOCK_STATISTICS
+    uint32_t start = port_rt_get_counter_value();
+#endif
+
+    /* Waiting on a mutex closing a cycle of owners would never end.*/
+    dbg_mtx_wait(mp);
     /* Does the running thread have higher priority than the mutex
        owning thread? */
     while (tp->p_prio < ctp->p_prio) {
+#if CH_USE_READYLIST_BITMAP
+      /* The ready list is indexed by priority, a ready thread must be
+         removed from it before its priority is changed.*/
+      if (tp->p_state == THD_STATE_READY)
+        chSchDequeueI(tp);
+#endif
       /* Make priority of thread tp match the running thread's priority.*/
       tp->p_prio = ctp->p_prio;
+      dbg_mtx_boost(tp);
       /* The following states need priority queues reordering.*/
       switch (tp->p_state) {
       case THD_STATE_WTMTX:
         /* Re-enqueues the mutex owner with its new priority.*/
         prio_insert(dequeue(tp), (ThreadsQueue *)tp->p_u.wtobjp);
-        tp = ((Mutex *)tp->p_u.wtobjp)->m_owner;
+        tp = chMtxGetOwnerI((Mutex *)tp->p_u.wtobjp);
         continue;
 #if CH_USE_CONDVARS |                                                       \
     (CH_USE_SEMAPHORES && CH_USE_SEMAPHORES_PRIORITY) |                     \
@@ -164,25 +333,42 @@ void chMtxLockS(Mutex *mp) {
         tp->p_state = THD_STATE_CURRENT;
 #endif
         /* Re-enqueues tp with its new priority on the ready list.*/
+#if CH_USE_READYLIST_BITMAP
+        chSchReadyI(tp);
+#else
         chSchReadyI(dequeue(tp));
+#endif
         break;
       }
       break;
     }
     /* Sleep on the mutex.*/
     prio_insert(ctp, &mp->m_queue);
+#if MTX_FASTPATH
+    /* Makes the owner fast unlock fail.*/
+    mtx_set_owner(mp, chMtxGetOwnerI(mp));
+#endif
     ctp->p_u.wtobjp = mp;
     chSchGoSleepS(THD_STATE_WTMTX);
     /* It is assumed that the thread performing the unlock operation assigns
-       the mutex to this thread.*/
-    chDbgAssert(mp->m_owner == ctp, "chMtxLockS(), #1", "not owner");
+       the mutex to this thread and raises it to the ceiling, if any.*/
+    chDbgAssert(chMtxGetOwnerI(mp) == ctp, "chMtxLockS(), #1", "not owner");
     chDbgAssert(ctp->p_mtxlist == mp, "chMtxLockS(), #2", "not owned");
+    dbg_lock_waited(&mp->m_stats, start);
+    dbg_lock_acquired(&mp->m_stats);
   }
   else {
     /* It was not owned, inserted in the owned mutexes list.*/
     mp->m_owner = ctp;
     mp->m_next = ctp->p_mtxlist;
     ctp->p_mtxlist = mp;
+#if CH_USE_MUTEXES_CEILING
+    /* Immediate priority ceiling, the running thread is not in the ready
+       list so raising its priority is a simple assignment.*/
+    if (ctp->p_prio < mp->m_ceiling)
+      ctp->p_prio = mp->m_ceiling;
+#endif
+    dbg_lock_acquired(&mp->m_stats);
   }
 }
 
@@ -206,6 +392,10 @@ void chMtxLockS(Mutex *mp) {
 bool_t chMtxTryLock(Mutex *mp) {
   bool_t b;
 
+#if MTX_FASTPATH
+  if (mtx_fast_lock(mp))
+    return TRUE;
+#endif
   chSysLock();
 
   b = chMtxTryLockS(mp);
@@ -238,9 +428,19 @@ bool_t chMtxTryLockS(Mutex *mp) {
 
   if (mp->m_owner != NULL)
     return FALSE;
+  trace_mtx_lock(mp);
   mp->m_owner = currp;
   mp->m_next = currp->p_mtxlist;
   currp->p_mtxlist = mp;
+#if CH_USE_MUTEXES_CEILING
+  chDbgAssert((mp->m_ceiling == NOPRIO) ||
+              (currp->p_realprio <= mp->m_ceiling),
+              "chMtxTryLockS(), #1",
+              "priority above ceiling");
+  if (currp->p_prio < mp->m_ceiling)
+    currp->p_prio = mp->m_ceiling;
+#endif
+  dbg_lock_acquired(&mp->m_stats);
   return TRUE;
 }
 
@@ -256,48 +456,59 @@ bool_t chMtxTryLockS(Mutex *mp) {
  */
 Mutex *chMtxUnlock(void) {
   Thread *ctp = currp;
-  Mutex *ump, *mp;
+  Mutex *ump;
 
+#if MTX_FASTPATH
+  ump = mtx_fast_unlock();
+  if (ump != NULL)
+    return ump;
+#endif
   chSysLock();
   chDbgAssert(ctp->p_mtxlist != NULL,
               "chMtxUnlock(), #1",
               "owned mutexes list empty");
-  chDbgAssert(ctp->p_mtxlist->m_owner == ctp,
+  chDbgAssert(chMtxGetOwnerI(ctp->p_mtxlist) == ctp,
               "chMtxUnlock(), #2",
               "ownership failure");
   /* Removes the top Mutex from the Thread's owned mutexes list and marks it
      as not owned.*/
   ump = ctp->p_mtxlist;
   ctp->p_mtxlist = ump->m_next;
+  trace_mtx_unlock(ump);
+  dbg_lock_released(&ump->m_stats);
   /* If a thread is waiting on the mutex then the fun part begins.*/
   if (chMtxQueueNotEmptyS(ump)) {
     Thread *tp;
 
     /* Recalculates the optimal thread priority by scanning the owned
-       mutexes list.*/
-    tprio_t newprio = ctp->p_realprio;
-    mp = ctp->p_mtxlist;
-    while (mp != NULL) {
-      /* If the highest priority thread waiting in the mutexes list has a
-         greater priority than the current thread base priority then the final
-         priority will have at least that priority.*/
-      if (chMtxQueueNotEmptyS(mp) && (mp->m_queue.p_next->p_prio > newprio))
-        newprio = mp->m_queue.p_next->p_prio;
-      mp = mp->m_next;
-    }
-    /* Assigns to the current thread the highest priority among all the
-       waiting threads.*/
-    ctp->p_prio = newprio;
+       mutexes list, assigns to the current thread the highest priority
+       among all the waiting threads.*/
+    ctp->p_prio = mtx_priority(ctp);
+    dbg_mtx_unboost(ctp);
     /* Awakens the highest priority thread waiting for the unlocked mutex and
        assigns the mutex to it.*/
     tp = fifo_remove(&ump->m_queue);
-    ump->m_owner = tp;
+    mtx_set_owner(ump, tp);
     ump->m_next = tp->p_mtxlist;
     tp->p_mtxlist = ump;
+#if CH_USE_MUTEXES_CEILING
+    if (tp->p_prio < ump->m_ceiling)
+      tp->p_prio = ump->m_ceiling;
+#endif
     chSchWakeupS(tp, RDY_OK);
   }
-  else
+  else {
     ump->m_owner = NULL;
+#if CH_USE_MUTEXES_CEILING
+    /* Leaving the ceiling, threads preempted meanwhile could now have
+       precedence.*/
+    if (ump->m_ceiling != NOPRIO) {
+      ctp->p_prio = mtx_priority(ctp);
+      dbg_mtx_unboost(ctp);
+      chSchRescheduleS();
+    }
+#endif
+  }
   chSysUnlock();
   return ump;
 }
@@ -316,13 +527,13 @@ Mutex *chMtxUnlock(void) {
  */
 Mutex *chMtxUnlockS(void) {
   Thread *ctp = currp;
-  Mutex *ump, *mp;
+  Mutex *ump;
 
   chDbgCheckClassS();
   chDbgAssert(ctp->p_mtxlist != NULL,
               "chMtxUnlockS(), #1",
               "owned mutexes list empty");
-  chDbgAssert(ctp->p_mtxlist->m_owner == ctp,
+  chDbgAssert(chMtxGetOwnerI(ctp->p_mtxlist) == ctp,
               "chMtxUnlockS(), #2",
               "ownership failure");
 
@@ -330,33 +541,37 @@ Mutex *chMtxUnlockS(void) {
      owned.*/
   ump = ctp->p_mtxlist;
   ctp->p_mtxlist = ump->m_next;
+  trace_mtx_unlock(ump);
+  dbg_lock_released(&ump->m_stats);
   /* If a thread is waiting on the mutex then the fun part begins.*/
   if (chMtxQueueNotEmptyS(ump)) {
     Thread *tp;
 
     /* Recalculates the optimal thread priority by scanning the owned
        mutexes list.*/
-    tprio_t newprio = ctp->p_realprio;
-    mp = ctp->p_mtxlist;
-    while (mp != NULL) {
-      /* If the highest priority thread waiting in the mutexes list has a
-         greater priority than the current thread base priority then the final
-         priority will have at least that priority.*/
-      if (chMtxQueueNotEmptyS(mp) && (mp->m_queue.p_next->p_prio > newprio))
-        newprio = mp->m_queue.p_next->p_prio;
-      mp = mp->m_next;
-    }
-    ctp->p_prio = newprio;
+    ctp->p_prio = mtx_priority(ctp);
+    dbg_mtx_unboost(ctp);
     /* Awakens the highest priority thread waiting for the unlocked mutex and
        assigns the mutex to it.*/
     tp = fifo_remove(&ump->m_queue);
-    ump->m_owner = tp;
+    mtx_set_owner(ump, tp);
     ump->m_next = tp->p_mtxlist;
     tp->p_mtxlist = ump;
+#if CH_USE_MUTEXES_CEILING
+    if (tp->p_prio < ump->m_ceiling)
+      tp->p_prio = ump->m_ceiling;
+#endif
     chSchReadyI(tp);
   }
-  else
+  else {
     ump->m_owner = NULL;
+#if CH_USE_MUTEXES_CEILING
+    if (ump->m_ceiling != NOPRIO) {
+      ctp->p_prio = mtx_priority(ctp);
+      dbg_mtx_unboost(ctp);
+    }
+#endif
+  }
   return ump;
 }
 
@@ -379,17 +594,24 @@ void chMtxUnlockAll(void) {
     do {
       Mutex *ump = ctp->p_mtxlist;
       ctp->p_mtxlist = ump->m_next;
+      trace_mtx_unlock(ump);
+      dbg_lock_released(&ump->m_stats);
       if (chMtxQueueNotEmptyS(ump)) {
         Thread *tp = fifo_remove(&ump->m_queue);
-        ump->m_owner = tp;
+        mtx_set_owner(ump, tp);
         ump->m_next = tp->p_mtxlist;
         tp->p_mtxlist = ump;
+#if CH_USE_MUTEXES_CEILING
+        if (tp->p_prio < ump->m_ceiling)
+          tp->p_prio = ump->m_ceiling;
+#endif
         chSchReadyI(tp);
       }
       else
         ump->m_owner = NULL;
     } while (ctp->p_mtxlist != NULL);
     ctp->p_prio = ctp->p_realprio;
+    dbg_mtx_unboost(ctp);
     chSchRescheduleS();
   }
   chSysUnlock();
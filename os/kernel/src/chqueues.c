@@ -76,6 +76,19 @@ static msg_t qwait(GenericQueue *qp, systime_t time) {
   return chSchGoSleepTimeoutS(THD_STATE_WTQUEUE, time);
 }
 
+/**
+ * @brief   Copies a block of bytes.
+ *
+ * @param[out] dp       pointer to the destination area
+ * @param[in] sp        pointer to the source area
+ * @param[in] n         number of bytes to be copied
+ */
+static void qcopy(uint8_t *dp, const uint8_t *sp, size_t n) {
+
+  while (n-- > 0)
+    *dp++ = *sp++;
+}
+
 /**
  * @brief   Initializes an input queue.
  * @details A Semaphore is internally initialized and works as a counter of
@@ -101,6 +114,9 @@ void chIQInit(InputQueue *iqp, uint8_t *bp, size_t size, qnotify_t infy,
   iqp->q_top = bp + size;
   iqp->q_notify = infy;
   iqp->q_link = link;
+#if CH_USE_WAITSETS
+  iqp->q_wslist = NULL;
+#endif
 }
 
 /**
@@ -144,6 +160,7 @@ msg_t chIQPutI(InputQueue *iqp, uint8_t b) {
   if (chIQIsFullI(iqp))
     return Q_FULL;
 
+  trace_queue_put(iqp, b);
   iqp->q_counter++;
   *iqp->q_wrptr++ = b;
   if (iqp->q_wrptr >= iqp->q_top)
@@ -151,10 +168,105 @@ msg_t chIQPutI(InputQueue *iqp, uint8_t b) {
 
   if (notempty(&iqp->q_waiting))
     chSchReadyI(fifo_remove(&iqp->q_waiting))->p_u.rdymsg = Q_OK;
+  ws_notify_i(iqp->q_wslist);
 
   return Q_OK;
 }
 
+/**
+ * @brief   Input queue block write.
+ * @details The data in the buffer is written into the low end of an input
+ *          queue as a single queue update, data not fitting in the queue is
+ *          discarded.
+ *
+ * @param[in] iqp       pointer to an @p InputQueue structure
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @return              The number of bytes effectively transferred.
+ *
+ * @iclass
+ */
+size_t chIQWriteI(InputQueue *iqp, const uint8_t *bp, size_t n) {
+  uint8_t *p;
+  size_t span;
+
+  chDbgCheckClassI();
+
+  if (n > chIQGetEmptyI(iqp))
+    n = chIQGetEmptyI(iqp);
+  if (n == 0)
+    return 0;
+
+  /* The data is copied into the contiguous free span starting at the write
+     pointer, the remaining part, if any, wraps at the buffer start.*/
+  p = chIQGetEmptySpanI(iqp, &span);
+  if (span > n)
+    span = n;
+  qcopy(p, bp, span);
+  qcopy(iqp->q_buffer, bp + span, n - span);
+  chIQCommitI(iqp, n);
+  return n;
+}
+
+/**
+ * @brief   Returns the contiguous free span of an input queue.
+ * @details The span starts at the queue write pointer and ends at the read
+ *          pointer or at the end of the buffer, whichever comes first. The
+ *          area can be filled directly, for example by a DMA channel, and
+ *          then made available to the reader using @p chIQCommitI().
+ * @note    The span can only grow after the call because only the writer
+ *          can reduce it, so the writer can fill it outside of the
+ *          critical zone.
+ *
+ * @param[in] iqp       pointer to an @p InputQueue structure
+ * @param[out] np       pointer to a variable receiving the span size
+ * @return              Pointer to the start of the span.
+ *
+ * @iclass
+ */
+uint8_t *chIQGetEmptySpanI(InputQueue *iqp, size_t *np) {
+  size_t n;
+
+  chDbgCheckClassI();
+
+  n = chIQGetEmptyI(iqp);
+  if (n > (size_t)(iqp->q_top - iqp->q_wrptr))
+    n = (size_t)(iqp->q_top - iqp->q_wrptr);
+  *np = n;
+  return iqp->q_wrptr;
+}
+
+/**
+ * @brief   Commits data written in place into an input queue.
+ * @details The specified amount of bytes following the write pointer is
+ *          made available to the reader and up to @p n waiting threads are
+ *          resumed.
+ *
+ * @param[in] iqp       pointer to an @p InputQueue structure
+ * @param[in] n         number of bytes to be committed, it cannot exceed
+ *                      the empty space in the queue
+ *
+ * @iclass
+ */
+void chIQCommitI(InputQueue *iqp, size_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck(n <= chIQGetEmptyI(iqp), "chIQCommitI");
+
+  if (n == 0)
+    return;
+
+  trace_queue_write(iqp, n);
+  iqp->q_counter += n;
+  iqp->q_wrptr += n;
+  if (iqp->q_wrptr >= iqp->q_top)
+    iqp->q_wrptr -= chQSizeI(iqp);
+
+  while (notempty(&iqp->q_waiting) && (n-- > 0))
+    chSchReadyI(fifo_remove(&iqp->q_waiting))->p_u.rdymsg = Q_OK;
+  ws_notify_i(iqp->q_wslist);
+}
+
 /**
  * @brief   Input queue read with timeout.
  * @details This function reads a byte value from an input queue. If the queue
@@ -194,6 +306,7 @@ msg_t chIQGetTimeout(InputQueue *iqp, systime_t time) {
   b = *iqp->q_rdptr++;
   if (iqp->q_rdptr >= iqp->q_top)
     iqp->q_rdptr = iqp->q_buffer;
+  trace_queue_get(iqp, b);
 
   chSysUnlock();
   return b;
@@ -231,6 +344,7 @@ size_t chIQReadTimeout(InputQueue *iqp, uint8_t *bp,
   chDbgCheck(n > 0, "chIQReadTimeout");
 
   chSysLock();
+  trace_queue_read(iqp, n);
   while (TRUE) {
     if (nfy)
       nfy(iqp);
@@ -281,6 +395,9 @@ void chOQInit(OutputQueue *oqp, uint8_t *bp, size_t size, qnotify_t onfy,
   oqp->q_top = bp + size;
   oqp->q_notify = onfy;
   oqp->q_link = link;
+#if CH_USE_WAITSETS
+  oqp->q_wslist = NULL;
+#endif
 }
 
 /**
@@ -338,6 +455,7 @@ msg_t chOQPutTimeout(OutputQueue *oqp, uint8_t b, systime_t time) {
     }
   }
 
+  trace_queue_put(oqp, b);
   oqp->q_counter--;
   *oqp->q_wrptr++ = b;
   if (oqp->q_wrptr >= oqp->q_top)
@@ -372,6 +490,7 @@ msg_t chOQGetI(OutputQueue *oqp) {
   b = *oqp->q_rdptr++;
   if (oqp->q_rdptr >= oqp->q_top)
     oqp->q_rdptr = oqp->q_buffer;
+  trace_queue_get(oqp, b);
 
   if (notempty(&oqp->q_waiting))
     chSchReadyI(fifo_remove(&oqp->q_waiting))->p_u.rdymsg = Q_OK;
@@ -379,6 +498,99 @@ msg_t chOQGetI(OutputQueue *oqp) {
   return b;
 }
 
+/**
+ * @brief   Output queue block read.
+ * @details Data is read from the low end of an output queue into a buffer
+ *          as a single queue update.
+ *
+ * @param[in] oqp       pointer to an @p OutputQueue structure
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @return              The number of bytes effectively transferred.
+ * @retval 0            if the queue is empty.
+ *
+ * @iclass
+ */
+size_t chOQReadI(OutputQueue *oqp, uint8_t *bp, size_t n) {
+  uint8_t *p;
+  size_t span;
+
+  chDbgCheckClassI();
+
+  if (n > chOQGetFullI(oqp))
+    n = chOQGetFullI(oqp);
+  if (n == 0)
+    return 0;
+
+  /* The data is copied from the contiguous filled span starting at the read
+     pointer, the remaining part, if any, wraps at the buffer start.*/
+  p = chOQGetFullSpanI(oqp, &span);
+  if (span > n)
+    span = n;
+  qcopy(bp, p, span);
+  qcopy(bp + span, oqp->q_buffer, n - span);
+  chOQConsumeI(oqp, n);
+  return n;
+}
+
+/**
+ * @brief   Returns the contiguous filled span of an output queue.
+ * @details The span starts at the queue read pointer and ends at the write
+ *          pointer or at the end of the buffer, whichever comes first. The
+ *          area can be read directly, for example by a DMA channel, and then
+ *          released to the writer using @p chOQConsumeI().
+ * @note    The span can only grow after the call because only the reader
+ *          can reduce it, so the reader can access it outside of the
+ *          critical zone.
+ *
+ * @param[in] oqp       pointer to an @p OutputQueue structure
+ * @param[out] np       pointer to a variable receiving the span size
+ * @return              Pointer to the start of the span.
+ *
+ * @iclass
+ */
+uint8_t *chOQGetFullSpanI(OutputQueue *oqp, size_t *np) {
+  size_t n;
+
+  chDbgCheckClassI();
+
+  n = chOQGetFullI(oqp);
+  if (n > (size_t)(oqp->q_top - oqp->q_rdptr))
+    n = (size_t)(oqp->q_top - oqp->q_rdptr);
+  *np = n;
+  return oqp->q_rdptr;
+}
+
+/**
+ * @brief   Releases data read in place from an output queue.
+ * @details The specified amount of bytes following the read pointer is
+ *          returned to the writer and up to @p n waiting threads are
+ *          resumed.
+ *
+ * @param[in] oqp       pointer to an @p OutputQueue structure
+ * @param[in] n         number of bytes to be released, it cannot exceed
+ *                      the filled space in the queue
+ *
+ * @iclass
+ */
+void chOQConsumeI(OutputQueue *oqp, size_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck(n <= chOQGetFullI(oqp), "chOQConsumeI");
+
+  if (n == 0)
+    return;
+
+  oqp->q_counter += n;
+  oqp->q_rdptr += n;
+  if (oqp->q_rdptr >= oqp->q_top)
+    oqp->q_rdptr -= chQSizeI(oqp);
+  trace_queue_read(oqp, n);
+
+  while (notempty(&oqp->q_waiting) && (n-- > 0))
+    chSchReadyI(fifo_remove(&oqp->q_waiting))->p_u.rdymsg = Q_OK;
+}
+
 /**
  * @brief   Output queue write with timeout.
  * @details The function writes data from a buffer to an output queue. The
@@ -411,6 +623,7 @@ size_t chOQWriteTimeout(OutputQueue *oqp, const uint8_t *bp,
   chDbgCheck(n > 0, "chOQWriteTimeout");
 
   chSysLock();
+  trace_queue_write(oqp, n);
   while (TRUE) {
     while (chOQIsFullI(oqp)) {
       if (qwait((GenericQueue *)oqp, time) != Q_OK) {
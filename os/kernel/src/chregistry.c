@@ -40,6 +40,9 @@
  *            in the system.
  *          - <b>Next</b>, returns the next, in creation order, active thread
  *            in the system.
+ *          - <b>Find</b>, returns the thread having the specified identifier
+ *            or name, this operation requires the @p CH_USE_REGISTRY_INDEX
+ *            option.
  *          .
  *          The registry is meant to be mainly a debug feature, for example,
  *          using the registry a debugger can enumerate the active threads
@@ -60,6 +63,74 @@
 #define _offsetof(st, m)                                                     \
   ((size_t)((char *)&((st *)0)->m - (char *)0))
 
+#if CH_USE_REGISTRY_INDEX || defined(__DOXYGEN__)
+/*
+ * Identifiers table, names hash table and stack of the free slots in the
+ * identifiers table.
+ */
+static Thread *reg_index[REG_INDEX_SIZE];
+static Thread *reg_hash[REG_HASH_SIZE];
+static uint8_t reg_free[REG_INDEX_SIZE];
+static unsigned reg_nfree;
+
+/*
+ * Sequence part of the last assigned identifier, it is incremented by
+ * REG_INDEX_SIZE so that the lower bits are left to the slot index.
+ */
+static tid_t reg_seq;
+
+/*
+ * Hashes a thread name.
+ */
+static Thread **hash_bucket(const char *name) {
+  uint32_t h = 0;
+
+  while (*name != '\0')
+    h = (h * 31) + (uint8_t)*name++;
+  return &reg_hash[h & (REG_HASH_SIZE - 1)];
+}
+
+/*
+ * Compares two thread names.
+ */
+static bool_t name_equal(const char *s1, const char *s2) {
+
+  while (*s1 == *s2) {
+    if (*s1 == '\0')
+      return TRUE;
+    s1++;
+    s2++;
+  }
+  return FALSE;
+}
+
+/*
+ * Links a thread in the names hash table.
+ */
+static void hash_insert(Thread *tp) {
+  Thread **tpp = hash_bucket(tp->p_name);
+
+  tp->p_hnext = *tpp;
+  *tpp = tp;
+}
+
+/*
+ * Unlinks a thread from the names hash table, the thread may be not
+ * linked.
+ */
+static void hash_remove(Thread *tp) {
+  Thread **tpp = hash_bucket(tp->p_name);
+
+  while (*tpp != NULL) {
+    if (*tpp == tp) {
+      *tpp = tp->p_hnext;
+      return;
+    }
+    tpp = &(*tpp)->p_hnext;
+  }
+}
+#endif /* CH_USE_REGISTRY_INDEX */
+
 /*
  * OS signature in ROM plus debug-related information.
  */
@@ -158,6 +229,234 @@ Thread *chRegNextThread(Thread *tp) {
   return ntp;
 }
 
+#if CH_USE_REGISTRY_INDEX || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes the registry index.
+ *
+ * @notapi
+ */
+void _reg_init(void) {
+  unsigned i;
+
+  for (i = 0; i < REG_INDEX_SIZE; i++) {
+    reg_index[i] = NULL;
+    reg_free[i] = (uint8_t)(REG_INDEX_SIZE - 1 - i);
+  }
+  for (i = 0; i < REG_HASH_SIZE; i++)
+    reg_hash[i] = NULL;
+  reg_nfree = REG_INDEX_SIZE;
+  reg_seq = 0;
+}
+
+/**
+ * @brief   Assigns an identifier to a thread being added to the registry.
+ * @details If the identifiers table is full the thread is not indexed and
+ *          its identifier is zero.
+ * @note    The thread name is not set yet so the thread is not added to
+ *          the names hash table.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void _reg_index_insert(Thread *tp) {
+  unsigned i;
+
+  tp->p_hnext = NULL;
+  if (reg_nfree == 0) {
+    tp->p_id = 0;
+    return;
+  }
+  i = reg_free[--reg_nfree];
+  reg_seq += REG_INDEX_SIZE;
+  if (reg_seq == 0)
+    reg_seq = REG_INDEX_SIZE;
+  tp->p_id = reg_seq | i;
+  reg_index[i] = tp;
+}
+
+/**
+ * @brief   Removes a thread being removed from the registry from the
+ *          identifiers and names tables.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void _reg_index_remove(Thread *tp) {
+
+  if (tp->p_id != 0) {
+    unsigned i = tp->p_id & (REG_INDEX_SIZE - 1);
+
+    reg_index[i] = NULL;
+    reg_free[reg_nfree++] = (uint8_t)i;
+    tp->p_id = 0;
+  }
+  if (tp->p_name != NULL)
+    hash_remove(tp);
+}
+
+/**
+ * @brief   Sets the current thread name.
+ * @details The thread is moved in the names hash table so that it can be
+ *          found by @p chRegFindThreadByName().
+ * @pre     The option @p CH_USE_REGISTRY_INDEX must be enabled.
+ *
+ * @param[in] name      thread name as a zero terminated string or @p NULL
+ *
+ * @api
+ */
+void chRegSetThreadName(const char *name) {
+
+  chSysLock();
+  if (currp->p_name != NULL)
+    hash_remove(currp);
+  currp->p_name = name;
+  if (name != NULL)
+    hash_insert(currp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns the thread having the specified identifier.
+ * @details A reference is added to the returned thread in order to make
+ *          sure its status is not lost, the reference must be released
+ *          using @p chThdRelease().
+ * @pre     The option @p CH_USE_REGISTRY_INDEX must be enabled.
+ *
+ * @param[in] id        thread identifier
+ * @return              A reference to the thread.
+ * @retval NULL         if the thread is no more in the registry.
+ *
+ * @api
+ */
+Thread *chRegFindThreadById(tid_t id) {
+  Thread *tp;
+
+  chSysLock();
+  tp = reg_index[id & (REG_INDEX_SIZE - 1)];
+  if ((id == 0) || (tp == NULL) || (tp->p_id != id))
+    tp = NULL;
+#if CH_USE_DYNAMIC
+  else {
+    chDbgAssert(tp->p_refs < 255, "chRegFindThreadById(), #1",
+                "too many references");
+    tp->p_refs++;
+  }
+#endif
+  chSysUnlock();
+  return tp;
+}
+
+/**
+ * @brief   Returns a thread having the specified name.
+ * @details A reference is added to the returned thread in order to make
+ *          sure its status is not lost, the reference must be released
+ *          using @p chThdRelease().
+ * @pre     The option @p CH_USE_REGISTRY_INDEX must be enabled.
+ * @note    If more threads have the same name then the one that most
+ *          recently set its name is returned.
+ *
+ * @param[in] name      thread name as a zero terminated string
+ * @return              A reference to the thread.
+ * @retval NULL         if there is no thread with the specified name in
+ *                      the registry.
+ *
+ * @api
+ */
+Thread *chRegFindThreadByName(const char *name) {
+  Thread *tp;
+
+  chDbgCheck(name != NULL, "chRegFindThreadByName");
+
+  chSysLock();
+  tp = *hash_bucket(name);
+  while ((tp != NULL) && !name_equal(tp->p_name, name))
+    tp = tp->p_hnext;
+#if CH_USE_DYNAMIC
+  if (tp != NULL) {
+    chDbgAssert(tp->p_refs < 255, "chRegFindThreadByName(), #1",
+                "too many references");
+    tp->p_refs++;
+  }
+#endif
+  chSysUnlock();
+  return tp;
+}
+#endif /* CH_USE_REGISTRY_INDEX */
+
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the runtime statistics of a thread.
+ * @details If the specified thread is the invoking thread then the time
+ *          elapsed since the last accounting point is included.
+ * @pre     The option @p CH_DBG_STATISTICS must be enabled.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[out] tsp      pointer to a @p thread_stats_t structure
+ *
+ * @api
+ */
+void chRegGetThreadStats(Thread *tp, thread_stats_t *tsp) {
+
+  chDbgCheck((tp != NULL) && (tsp != NULL), "chRegGetThreadStats");
+
+  chSysLock();
+  *tsp = tp->p_stats;
+  if (tp == currp) {
+    uint32_t delta = port_rt_get_counter_value() - dbg_kernel_stats.ks_last;
+
+    tsp->ts_runtime += delta;
+    tsp->ts_burst += delta;
+    if (tsp->ts_burst > tsp->ts_worst)
+      tsp->ts_worst = tsp->ts_burst;
+  }
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns the kernel runtime statistics.
+ * @pre     The option @p CH_DBG_STATISTICS must be enabled.
+ *
+ * @param[out] ksp      pointer to a @p kernel_stats_t structure
+ *
+ * @api
+ */
+void chRegGetKernelStats(kernel_stats_t *ksp) {
+
+  chDbgCheck(ksp != NULL, "chRegGetKernelStats");
+
+  chSysLock();
+  *ksp = dbg_kernel_stats;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Clears the runtime statistics of all the threads and the kernel.
+ * @pre     The option @p CH_DBG_STATISTICS must be enabled.
+ *
+ * @api
+ */
+void chRegResetStats(void) {
+  Thread *tp;
+
+  chSysLock();
+  tp = rlist.r_newer;
+  while (tp != (Thread *)&rlist) {
+    tp->p_stats.ts_runtime = 0;
+    tp->p_stats.ts_burst = 0;
+    tp->p_stats.ts_worst = 0;
+    tp->p_stats.ts_switches = 0;
+    tp = tp->p_newer;
+  }
+  dbg_kernel_stats.ks_isr_time = 0;
+  dbg_kernel_stats.ks_isr_count = 0;
+  dbg_kernel_stats.ks_switches = 0;
+  dbg_kernel_stats.ks_last = port_rt_get_counter_value();
+  chSysUnlock();
+}
+#endif /* CH_DBG_STATISTICS */
+
 #endif /* CH_USE_REGISTRY */
 
 /** @} */
@@ -0,0 +1,366 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chring.c
+ * @brief   Lock-free ring buffers and doorbells code.
+ *
+ * @addtogroup ringbuffers
+ * @details Lock-free ring buffers and doorbells related APIs and services.
+ *
+ *          <h2>Operation mode</h2>
+ *          Interrupt handlers running above the kernel priority (fast
+ *          interrupts) cannot invoke any system API. A ring buffer lets
+ *          such a handler pass @p msg_t values to a thread without locks,
+ *          the producer only writes the write pointer and the consumer
+ *          only writes the read pointer, the accesses are ordered using
+ *          @p port_memory_barrier(). A ring buffer must have exactly one
+ *          producer and one consumer.<br>
+ *          A doorbell wakes the consumer thread on behalf of the fast
+ *          handler. Ringing a doorbell is lock-free, the waiting thread is
+ *          resumed on exit from the next kernel-level interrupt by
+ *          @p CH_IRQ_EPILOGUE(). The wakeup latency is bounded by the
+ *          system tick period; in tickless mode (@p CH_TIMEDELTA greater
+ *          than zero) there is no periodic tick and a polling timer is
+ *          armed while a thread is waiting on a doorbell, the latency is
+ *          then bounded by @p CH_DOORBELL_POLL_PERIOD. A fast handler
+ *          requiring a shorter latency can trigger a kernel-level
+ *          interrupt after ringing.<br>
+ *          A typical consumer loop is:
+ *          @code
+ *          while (TRUE) {
+ *            msg_t sample;
+ *
+ *            while (chRbGet(&rb, &sample))
+ *              process(sample);
+ *            chDbWaitTimeout(&db, TIME_INFINITE);
+ *          }
+ *          @endcode
+ * @pre     In order to use the ring buffers APIs the @p CH_USE_RINGBUFFERS
+ *          option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_USE_RINGBUFFERS || defined(__DOXYGEN__)
+
+/**
+ * @brief   Registered doorbells.
+ */
+DoorbellList dblist;
+
+#if CH_TIMEDELTA > 0
+/*
+ * Polling timer callback, the rung doorbells are served and the timer is
+ * armed again while a thread is still waiting on a doorbell.
+ */
+static void db_poll_cb(void *p) {
+  Doorbell *dbp;
+
+  (void)p;
+  chSysLockFromIsr();
+  if (dblist.dl_pending)
+    chDbServeI();
+  for (dbp = dblist.dl_next; dbp != NULL; dbp = dbp->db_next) {
+    if (dbp->db_thread != NULL) {
+      chVTSetI(&dblist.dl_vt, CH_DOORBELL_POLL_PERIOD, db_poll_cb, NULL);
+      break;
+    }
+  }
+  chSysUnlockFromIsr();
+}
+#endif /* CH_TIMEDELTA > 0 */
+
+/**
+ * @brief   Initializes a @p RingBuffer object.
+ *
+ * @param[out] rbp      the pointer to the @p RingBuffer structure to be
+ *                      initialized
+ * @param[in] buf       pointer to the messages buffer as an array of
+ *                      @p msg_t
+ * @param[in] n         number of elements in the buffer array, the ring
+ *                      buffer holds up to <tt>n - 1</tt> messages
+ *
+ * @init
+ */
+void chRbInit(RingBuffer *rbp, msg_t *buf, cnt_t n) {
+
+  chDbgCheck((rbp != NULL) && (buf != NULL) && (n > 1), "chRbInit");
+
+  rbp->rb_buffer = rbp->rb_wrptr = rbp->rb_rdptr = buf;
+  rbp->rb_top = &buf[n];
+}
+
+/**
+ * @brief   Puts a message into a ring buffer.
+ * @note    This function can be called in any context, including interrupt
+ *          handlers above the kernel priority, but only by the single
+ *          producer of the ring buffer.
+ *
+ * @param[in] rbp       the pointer to an initialized @p RingBuffer object
+ * @param[in] msg       the message to be buffered
+ * @return              The operation status.
+ * @retval TRUE         if the message has been buffered.
+ * @retval FALSE        if the ring buffer is full.
+ *
+ * @special
+ */
+bool_t chRbPut(RingBuffer *rbp, msg_t msg) {
+  volatile msg_t *wp = rbp->rb_wrptr;
+  volatile msg_t *next = wp + 1;
+
+  if (next >= rbp->rb_top)
+    next = rbp->rb_buffer;
+  if (next == rbp->rb_rdptr)
+    return FALSE;
+
+  *wp = msg;
+  /* The message must be visible before the new write pointer.*/
+  port_memory_barrier();
+  rbp->rb_wrptr = next;
+  return TRUE;
+}
+
+/**
+ * @brief   Gets a message from a ring buffer.
+ * @note    This function can be called in any context but only by the
+ *          single consumer of the ring buffer.
+ *
+ * @param[in] rbp       the pointer to an initialized @p RingBuffer object
+ * @param[out] msgp     pointer to a @p msg_t variable receiving the message
+ * @return              The operation status.
+ * @retval TRUE         if a message has been fetched.
+ * @retval FALSE        if the ring buffer is empty.
+ *
+ * @special
+ */
+bool_t chRbGet(RingBuffer *rbp, msg_t *msgp) {
+  volatile msg_t *rp = rbp->rb_rdptr;
+
+  if (rp == rbp->rb_wrptr)
+    return FALSE;
+
+  /* The message must be read after the write pointer.*/
+  port_memory_barrier();
+  *msgp = *rp++;
+  if (rp >= rbp->rb_top)
+    rp = rbp->rb_buffer;
+  /* The slot must be read before being released to the producer.*/
+  port_memory_barrier();
+  rbp->rb_rdptr = rp;
+  return TRUE;
+}
+
+/**
+ * @brief   Returns the number of messages in a ring buffer.
+ * @note    This function can be called in any context, the returned value
+ *          can only grow for the consumer and only shrink for the producer.
+ *
+ * @param[in] rbp       the pointer to an initialized @p RingBuffer object
+ * @return              The number of buffered messages.
+ *
+ * @special
+ */
+cnt_t chRbGetUsedCount(RingBuffer *rbp) {
+  volatile msg_t *wp = rbp->rb_wrptr;
+  volatile msg_t *rp = rbp->rb_rdptr;
+
+  if (wp >= rp)
+    return (cnt_t)(wp - rp);
+  return (cnt_t)((rbp->rb_top - rbp->rb_buffer) - (rp - wp));
+}
+
+/**
+ * @brief   Initializes the doorbells registry.
+ *
+ * @notapi
+ */
+void _db_init(void) {
+
+  dblist.dl_next = NULL;
+  dblist.dl_pending = FALSE;
+#if CH_TIMEDELTA > 0
+  dblist.dl_vt.vt_func = NULL;
+#endif
+}
+
+/**
+ * @brief   Initializes a @p Doorbell object.
+ * @details The doorbell is registered in the system and is scanned on exit
+ *          from the kernel-level interrupts after being rung.
+ * @note    Doorbells cannot be unregistered, they must be static objects
+ *          or objects living for the whole application lifetime.
+ *
+ * @param[out] dbp      the pointer to the @p Doorbell structure to be
+ *                      initialized
+ *
+ * @api
+ */
+void chDbInit(Doorbell *dbp) {
+
+  chDbgCheck(dbp != NULL, "chDbInit");
+
+  dbp->db_rung = dbp->db_served = 0;
+  dbp->db_thread = NULL;
+  chSysLock();
+  dbp->db_next = dblist.dl_next;
+  dblist.dl_next = dbp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Rings a doorbell.
+ * @details The thread waiting on the doorbell, if any, is resumed on exit
+ *          from the next kernel-level interrupt. A ring while no thread is
+ *          waiting is remembered and satisfies the next wait.
+ * @note    This function can be called in any context, including interrupt
+ *          handlers above the kernel priority, but a doorbell must have a
+ *          single ringer.
+ *
+ * @param[in] dbp       the pointer to an initialized @p Doorbell object
+ *
+ * @special
+ */
+void chDbRing(Doorbell *dbp) {
+
+  /* Data produced before ringing must be visible to the woken thread.*/
+  port_memory_barrier();
+  dbp->db_rung++;
+  port_memory_barrier();
+  dblist.dl_pending = TRUE;
+}
+
+/**
+ * @brief   Serves the rung doorbells.
+ * @details The threads waiting on the doorbells rung since the last serve
+ *          are made ready. This function is invoked automatically on exit
+ *          from the kernel-level interrupts, it can also be invoked by any
+ *          other I-class context.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @iclass
+ */
+void chDbServeI(void) {
+  Doorbell *dbp;
+
+  chDbgCheckClassI();
+
+  /* The flag is cleared before the scan, a ring happening during the scan
+     sets it again and is served the next time.*/
+  dblist.dl_pending = FALSE;
+  port_memory_barrier();
+  for (dbp = dblist.dl_next; dbp != NULL; dbp = dbp->db_next) {
+    if ((dbp->db_thread != NULL) && (dbp->db_rung != dbp->db_served)) {
+      dbp->db_served = dbp->db_rung;
+      chSchReadyI(dbp->db_thread)->p_u.rdymsg = RDY_OK;
+      dbp->db_thread = NULL;
+    }
+  }
+}
+
+/**
+ * @brief   Waits for a doorbell to be rung.
+ * @details If the doorbell has been rung after the previous wait then the
+ *          function returns immediately, else the invoking thread waits
+ *          until the doorbell is rung and served or the timeout expires.
+ * @note    A doorbell can have a single waiting thread.
+ *
+ * @param[in] dbp       the pointer to an initialized @p Doorbell object
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval RDY_OK       if the doorbell has been rung.
+ * @retval RDY_TIMEOUT  if the doorbell has not been rung within the
+ *                      specified timeout.
+ *
+ * @sclass
+ */
+msg_t chDbWaitTimeoutS(Doorbell *dbp, systime_t time) {
+  cnt_t rung;
+  msg_t msg;
+
+  chDbgCheckClassS();
+  chDbgCheck(dbp != NULL, "chDbWaitTimeoutS");
+  chDbgAssert(dbp->db_thread == NULL,
+              "chDbWaitTimeoutS(), #1", "already waiting");
+
+  rung = dbp->db_rung;
+  if (rung != dbp->db_served) {
+    dbp->db_served = rung;
+    return RDY_OK;
+  }
+  if (TIME_IMMEDIATE == time)
+    return RDY_TIMEOUT;
+
+  dbp->db_thread = currp;
+#if CH_TIMEDELTA > 0
+  /* No periodic tick would serve the doorbell.*/
+  if (!chVTIsArmedI(&dblist.dl_vt))
+    chVTSetI(&dblist.dl_vt, CH_DOORBELL_POLL_PERIOD, db_poll_cb, NULL);
+#endif
+  msg = chSchGoSleepTimeoutS(THD_STATE_SUSPENDED, time);
+  dbp->db_thread = NULL;
+  return msg;
+}
+
+/**
+ * @brief   Waits for a doorbell to be rung.
+ * @details If the doorbell has been rung after the previous wait then the
+ *          function returns immediately, else the invoking thread waits
+ *          until the doorbell is rung and served or the timeout expires.
+ * @note    A doorbell can have a single waiting thread.
+ *
+ * @param[in] dbp       the pointer to an initialized @p Doorbell object
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval RDY_OK       if the doorbell has been rung.
+ * @retval RDY_TIMEOUT  if the doorbell has not been rung within the
+ *                      specified timeout.
+ *
+ * @api
+ */
+msg_t chDbWaitTimeout(Doorbell *dbp, systime_t time) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chDbWaitTimeoutS(dbp, time);
+  chSysUnlock();
+  return msg;
+}
+
+#endif /* CH_USE_RINGBUFFERS */
+
+/** @} */
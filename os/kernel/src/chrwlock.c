@@ -0,0 +1,383 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chrwlock.c
+ * @brief   Readers-Writer Locks code.
+ *
+ * @addtogroup rwlocks
+ * @details Readers-Writer Locks related APIs and services.
+ *
+ *          <h2>Operation mode</h2>
+ *          A readers-writer lock can be held by any number of readers at
+ *          the same time or by a single writer, it is meant to protect data
+ *          structures that are read often and modified rarely.<br>
+ *          The lock gives preference to the writers, a reader trying to
+ *          acquire the lock is queued if the lock is owned by a writer or
+ *          if there are writers waiting for it, this prevents a continuous
+ *          flow of readers from starving the writers.<br>
+ *          Readers and writers are queued in priority order. When the lock
+ *          is released the highest priority waiting writer, if any, becomes
+ *          the new owner, else all the waiting readers are awakened
+ *          together.
+ *          <h2>Constraints</h2>
+ *          In order to use the readers-writer lock correctly there are some
+ *          restrictions:
+ *          - The lock is not recursive, a thread must not try to acquire a
+ *            lock it already holds, either as reader or writer.
+ *          - A read lock cannot be upgraded to a write lock.
+ *          - There is no priority inheritance, a low priority thread
+ *            holding the lock can delay higher priority threads waiting
+ *            for it.
+ *          .
+ * @pre     In order to use the readers-writer lock APIs the
+ *          @p CH_USE_RWLOCKS option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_USE_RWLOCKS || defined(__DOXYGEN__)
+
+/*
+ * Makes ready all the waiting readers, the readers count is updated.
+ */
+static void rwlock_wakeup_readers(RWLock *rwp) {
+
+  while (notempty(&rwp->rw_rqueue)) {
+    rwp->rw_readers++;
+    chSchReadyI(fifo_remove(&rwp->rw_rqueue))->p_u.rdymsg = RDY_OK;
+  }
+}
+
+/**
+ * @brief   Initializes s @p RWLock structure.
+ *
+ * @param[out] rwp      pointer to a @p RWLock structure
+ *
+ * @init
+ */
+void chRWLockInit(RWLock *rwp) {
+
+  chDbgCheck(rwp != NULL, "chRWLockInit");
+
+  queue_init(&rwp->rw_rqueue);
+  queue_init(&rwp->rw_wqueue);
+  rwp->rw_owner = NULL;
+  rwp->rw_readers = 0;
+}
+
+/**
+ * @brief   Acquires the lock as reader.
+ * @details The invoking thread is queued if the lock is owned by a writer or
+ *          if there are writers waiting for it.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ *
+ * @api
+ */
+void chRWLockReadLock(RWLock *rwp) {
+
+  chSysLock();
+  chRWLockReadLockS(rwp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Acquires the lock as reader.
+ * @details The invoking thread is queued if the lock is owned by a writer or
+ *          if there are writers waiting for it.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ *
+ * @sclass
+ */
+void chRWLockReadLockS(RWLock *rwp) {
+
+  (void)chRWLockReadLockTimeoutS(rwp, TIME_INFINITE);
+}
+
+/**
+ * @brief   Acquires the lock as reader with timeout specification.
+ * @details The invoking thread is queued if the lock is owned by a writer or
+ *          if there are writers waiting for it.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval RDY_OK       if the lock has been acquired.
+ * @retval RDY_TIMEOUT  if the lock has not been acquired within the specified
+ *                      timeout.
+ *
+ * @api
+ */
+msg_t chRWLockReadLockTimeout(RWLock *rwp, systime_t time) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chRWLockReadLockTimeoutS(rwp, time);
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Acquires the lock as reader with timeout specification.
+ * @details The invoking thread is queued if the lock is owned by a writer or
+ *          if there are writers waiting for it.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval RDY_OK       if the lock has been acquired.
+ * @retval RDY_TIMEOUT  if the lock has not been acquired within the specified
+ *                      timeout.
+ *
+ * @sclass
+ */
+msg_t chRWLockReadLockTimeoutS(RWLock *rwp, systime_t time) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL, "chRWLockReadLockTimeoutS");
+  chDbgAssert(rwp->rw_owner != currp,
+              "chRWLockReadLockTimeoutS(), #1",
+              "already owned as writer");
+
+  if ((rwp->rw_owner == NULL) && isempty(&rwp->rw_wqueue)) {
+    rwp->rw_readers++;
+    return RDY_OK;
+  }
+  if (TIME_IMMEDIATE == time)
+    return RDY_TIMEOUT;
+  currp->p_u.wtobjp = rwp;
+  prio_insert(currp, &rwp->rw_rqueue);
+  return chSchGoSleepTimeoutS(THD_STATE_WTRWLOCK, time);
+}
+
+/**
+ * @brief   Releases a lock acquired as reader.
+ * @details If this is the last reader and there are waiting writers then
+ *          the highest priority writer becomes the new owner.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ *
+ * @api
+ */
+void chRWLockReadUnlock(RWLock *rwp) {
+
+  chSysLock();
+  chRWLockReadUnlockS(rwp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Releases a lock acquired as reader.
+ * @details If this is the last reader and there are waiting writers then
+ *          the highest priority writer becomes the new owner.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ *
+ * @sclass
+ */
+void chRWLockReadUnlockS(RWLock *rwp) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL, "chRWLockReadUnlockS");
+  chDbgAssert((rwp->rw_owner == NULL) && (rwp->rw_readers > 0),
+              "chRWLockReadUnlockS(), #1",
+              "not locked for reading");
+
+  if ((--rwp->rw_readers == 0) && notempty(&rwp->rw_wqueue)) {
+    rwp->rw_owner = fifo_remove(&rwp->rw_wqueue);
+    chSchReadyI(rwp->rw_owner)->p_u.rdymsg = RDY_OK;
+  }
+}
+
+/**
+ * @brief   Acquires the lock as writer.
+ * @details The invoking thread is queued if the lock is held by readers or
+ *          by another writer.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ *
+ * @api
+ */
+void chRWLockWriteLock(RWLock *rwp) {
+
+  chSysLock();
+  chRWLockWriteLockS(rwp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Acquires the lock as writer.
+ * @details The invoking thread is queued if the lock is held by readers or
+ *          by another writer.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ *
+ * @sclass
+ */
+void chRWLockWriteLockS(RWLock *rwp) {
+
+  (void)chRWLockWriteLockTimeoutS(rwp, TIME_INFINITE);
+}
+
+/**
+ * @brief   Acquires the lock as writer with timeout specification.
+ * @details The invoking thread is queued if the lock is held by readers or
+ *          by another writer.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval RDY_OK       if the lock has been acquired.
+ * @retval RDY_TIMEOUT  if the lock has not been acquired within the specified
+ *                      timeout.
+ *
+ * @api
+ */
+msg_t chRWLockWriteLockTimeout(RWLock *rwp, systime_t time) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chRWLockWriteLockTimeoutS(rwp, time);
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Acquires the lock as writer with timeout specification.
+ * @details The invoking thread is queued if the lock is held by readers or
+ *          by another writer.
+ * @note    If the timeout expires while the lock is held by readers and no
+ *          other writers are waiting then the readers queued behind this
+ *          writer are awakened.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval RDY_OK       if the lock has been acquired.
+ * @retval RDY_TIMEOUT  if the lock has not been acquired within the specified
+ *                      timeout.
+ *
+ * @sclass
+ */
+msg_t chRWLockWriteLockTimeoutS(RWLock *rwp, systime_t time) {
+  msg_t msg;
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL, "chRWLockWriteLockTimeoutS");
+  chDbgAssert(rwp->rw_owner != currp,
+              "chRWLockWriteLockTimeoutS(), #1",
+              "already owned");
+
+  if ((rwp->rw_owner == NULL) && (rwp->rw_readers == 0)) {
+    rwp->rw_owner = currp;
+    return RDY_OK;
+  }
+  if (TIME_IMMEDIATE == time)
+    return RDY_TIMEOUT;
+  currp->p_u.wtobjp = rwp;
+  prio_insert(currp, &rwp->rw_wqueue);
+  msg = chSchGoSleepTimeoutS(THD_STATE_WTRWLOCK, time);
+  if ((msg == RDY_TIMEOUT) && (rwp->rw_owner == NULL) &&
+      isempty(&rwp->rw_wqueue) && notempty(&rwp->rw_rqueue)) {
+    /* The readers were only waiting because of this writer.*/
+    rwlock_wakeup_readers(rwp);
+    chSchRescheduleS();
+  }
+  return msg;
+}
+
+/**
+ * @brief   Releases a lock acquired as writer.
+ * @details The highest priority waiting writer, if any, becomes the new
+ *          owner else all the waiting readers acquire the lock.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ *
+ * @api
+ */
+void chRWLockWriteUnlock(RWLock *rwp) {
+
+  chSysLock();
+  chRWLockWriteUnlockS(rwp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Releases a lock acquired as writer.
+ * @details The highest priority waiting writer, if any, becomes the new
+ *          owner else all the waiting readers acquire the lock.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] rwp       pointer to the @p RWLock structure
+ *
+ * @sclass
+ */
+void chRWLockWriteUnlockS(RWLock *rwp) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL, "chRWLockWriteUnlockS");
+  chDbgAssert(rwp->rw_owner == currp,
+              "chRWLockWriteUnlockS(), #1",
+              "ownership failure");
+
+  if (notempty(&rwp->rw_wqueue)) {
+    rwp->rw_owner = fifo_remove(&rwp->rw_wqueue);
+    chSchReadyI(rwp->rw_owner)->p_u.rdymsg = RDY_OK;
+  }
+  else {
+    rwp->rw_owner = NULL;
+    rwlock_wakeup_readers(rwp);
+  }
+}
+
+#endif /* CH_USE_RWLOCKS */
+
+/** @} */
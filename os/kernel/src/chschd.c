@@ -47,6 +47,81 @@
 ReadyList rlist;
 #endif /* !defined(PORT_OPTIMIZED_RLIST_VAR) */
 
+#if CH_USE_READYLIST_BITMAP || defined(__DOXYGEN__)
+/*
+ * Ready list bitmap management.
+ * The ready list is still a single priority ordered queue but the threads
+ * having the same priority form a contiguous FIFO segment. The last thread
+ * of each non-empty segment is recorded in r_tails[] and the non-empty
+ * priority levels are marked in a two-levels bitmap, the insertion point
+ * for any priority is found in constant time by looking up the nearest
+ * non-empty higher level.
+ */
+#if defined(__GNUC__)
+#define rl_ctz(w) ((unsigned)__builtin_ctzl((unsigned long)(w)))
+#else
+static const uint8_t rl_debruijn[32] = {
+  0,  1,  28, 2,  29, 14, 24, 3,  30, 22, 20, 15, 25, 17, 4,  8,
+  31, 27, 13, 23, 21, 19, 16, 7,  26, 12, 18, 6,  11, 5,  10, 9
+};
+#define rl_ctz(w)                                                           \
+  ((unsigned)rl_debruijn[(uint32_t)(((w) & (0U - (w))) * 0x077CB531U) >> 27])
+#endif
+
+static void rl_set(tprio_t prio) {
+
+  rlist.r_map[prio >> 5] |= (uint32_t)1 << (prio & 31);
+  rlist.r_mapmask |= (uint32_t)1 << (prio >> 5);
+}
+
+static void rl_clear(tprio_t prio) {
+
+  if ((rlist.r_map[prio >> 5] &= ~((uint32_t)1 << (prio & 31))) == 0)
+    rlist.r_mapmask &= ~((uint32_t)1 << (prio >> 5));
+}
+
+/*
+ * Returns the last thread of the nearest non-empty priority level greater
+ * than the specified one or the ready list header if there is none.
+ */
+static Thread *rl_higher(tprio_t prio) {
+  unsigned w = (unsigned)(prio >> 5);
+  uint32_t m = rlist.r_map[w] & ~(((uint32_t)2 << (prio & 31)) - 1);
+
+  if (m == 0) {
+    m = rlist.r_mapmask & ~(((uint32_t)2 << w) - 1);
+    if (m == 0)
+      return (Thread *)&rlist.r_queue;
+    w = rl_ctz(m);
+    m = rlist.r_map[w];
+  }
+  return rlist.r_tails[(w << 5) + rl_ctz(m)];
+}
+
+/*
+ * Inserts a thread after the specified one.
+ */
+static void rl_insert_after(Thread *tp, Thread *cp) {
+
+  tp->p_prev = cp;
+  tp->p_next = cp->p_next;
+  tp->p_next->p_prev = cp->p_next = tp;
+}
+
+/*
+ * Removes the first thread from the ready list.
+ */
+static Thread *rl_fifo_remove(void) {
+  Thread *tp = fifo_remove(&rlist.r_queue);
+
+  if (rlist.r_tails[tp->p_prio] == tp)
+    rl_clear(tp->p_prio);
+  return tp;
+}
+#else /* !CH_USE_READYLIST_BITMAP */
+#define rl_fifo_remove() fifo_remove(&rlist.r_queue)
+#endif /* !CH_USE_READYLIST_BITMAP */
+
 /**
  * @brief   Scheduler initialization.
  *
@@ -59,6 +134,15 @@ void _scheduler_init(void) {
 #if CH_USE_REGISTRY
   rlist.r_newer = rlist.r_older = (Thread *)&rlist;
 #endif
+#if CH_USE_READYLIST_BITMAP
+  {
+    unsigned i;
+
+    rlist.r_mapmask = 0;
+    for (i = 0; i < RL_MAP_WORDS; i++)
+      rlist.r_map[i] = 0;
+  }
+#endif
 }
 
 /**
@@ -90,6 +174,22 @@ Thread *chSchReadyI(Thread *tp) {
               "invalid state");
 
   tp->p_state = THD_STATE_READY;
+#if CH_USE_READYLIST_BITMAP
+  chDbgAssert(tp->p_prio < RL_PRIO_LEVELS,
+              "chSchReadyI(), #2",
+              "priority out of range");
+
+  /* Insertion behind the last thread with the same priority or, if none,
+     behind the last thread of the nearest higher priority level.*/
+  if (rlist.r_map[tp->p_prio >> 5] & ((uint32_t)1 << (tp->p_prio & 31)))
+    cp = rlist.r_tails[tp->p_prio];
+  else {
+    cp = rl_higher(tp->p_prio);
+    rl_set(tp->p_prio);
+  }
+  rl_insert_after(tp, cp);
+  rlist.r_tails[tp->p_prio] = tp;
+#else /* !CH_USE_READYLIST_BITMAP */
   cp = (Thread *)&rlist.r_queue;
   do {
     cp = cp->p_next;
@@ -98,10 +198,41 @@ Thread *chSchReadyI(Thread *tp) {
   tp->p_next = cp;
   tp->p_prev = cp->p_prev;
   tp->p_prev->p_next = cp->p_prev = tp;
+#endif /* !CH_USE_READYLIST_BITMAP */
   return tp;
 }
 #endif /* !defined(PORT_OPTIMIZED_READYI) */
 
+#if CH_USE_READYLIST_BITMAP || defined(__DOXYGEN__)
+/**
+ * @brief   Removes a thread from the ready list.
+ * @details The thread is removed regardless of its position in the ready
+ *          list, its state is not changed.
+ * @pre     The thread must be in the ready list and its priority must not
+ *          have been changed after the insertion.
+ *
+ * @param[in] tp        the thread to be removed
+ * @return              The thread pointer.
+ *
+ * @iclass
+ */
+Thread *chSchDequeueI(Thread *tp) {
+
+  chDbgCheckClassI();
+
+  if (rlist.r_tails[tp->p_prio] == tp) {
+    /* The thread is the last one of its priority level, the previous
+       thread becomes the new last one if it has the same priority.*/
+    if ((tp->p_prev != (Thread *)&rlist.r_queue) &&
+        (tp->p_prev->p_prio == tp->p_prio))
+      rlist.r_tails[tp->p_prio] = tp->p_prev;
+    else
+      rl_clear(tp->p_prio);
+  }
+  return dequeue(tp);
+}
+#endif /* CH_USE_READYLIST_BITMAP */
+
 /**
  * @brief   Puts the current thread to sleep into the specified state.
  * @details The thread goes into a sleeping state. The possible
@@ -123,7 +254,7 @@ void chSchGoSleepS(tstate_t newstate) {
      time quantum when it will wakeup.*/
   otp->p_preempt = CH_TIME_QUANTUM;
 #endif
-  setcurrp(fifo_remove(&rlist.r_queue));
+  setcurrp(rl_fifo_remove());
   currp->p_state = THD_STATE_CURRENT;
   chSysSwitch(currp, otp);
 }
@@ -144,7 +275,7 @@ static void wakeup(void *p) {
     chSysUnlockFromIsr();
     return;
 #if CH_USE_SEMAPHORES || CH_USE_QUEUES ||                                   \
-    (CH_USE_CONDVARS && CH_USE_CONDVARS_TIMEOUT)
+    (CH_USE_CONDVARS && CH_USE_CONDVARS_TIMEOUT) || CH_USE_RWLOCKS
 #if CH_USE_SEMAPHORES
   case THD_STATE_WTSEM:
     chSemFastSignalI((Semaphore *)tp->p_u.wtobjp);
@@ -155,6 +286,9 @@ static void wakeup(void *p) {
 #endif
 #if CH_USE_CONDVARS && CH_USE_CONDVARS_TIMEOUT
   case THD_STATE_WTCOND:
+#endif
+#if CH_USE_RWLOCKS
+  case THD_STATE_WTRWLOCK:
 #endif
     /* States requiring dequeuing.*/
     dequeue(tp);
@@ -306,7 +440,7 @@ void chSchDoRescheduleBehind(void) {
 
   otp = currp;
   /* Picks the first thread from the ready queue and makes it current.*/
-  setcurrp(fifo_remove(&rlist.r_queue));
+  setcurrp(rl_fifo_remove());
   currp->p_state = THD_STATE_CURRENT;
 #if CH_TIME_QUANTUM > 0
   otp->p_preempt = CH_TIME_QUANTUM;
@@ -327,14 +461,26 @@ void chSchDoRescheduleBehind(void) {
  */
 #if !defined(PORT_OPTIMIZED_DORESCHEDULEAHEAD) || defined(__DOXYGEN__)
 void chSchDoRescheduleAhead(void) {
-  Thread *otp, *cp;
+  Thread *otp;
+#if !CH_USE_READYLIST_BITMAP
+  Thread *cp;
+#endif
 
   otp = currp;
   /* Picks the first thread from the ready queue and makes it current.*/
-  setcurrp(fifo_remove(&rlist.r_queue));
+  setcurrp(rl_fifo_remove());
   currp->p_state = THD_STATE_CURRENT;
 
   otp->p_state = THD_STATE_READY;
+#if CH_USE_READYLIST_BITMAP
+  /* Insertion ahead of the threads with the same priority, behind the last
+     thread of the nearest higher priority level.*/
+  rl_insert_after(otp, rl_higher(otp->p_prio));
+  if (!(rlist.r_map[otp->p_prio >> 5] & ((uint32_t)1 << (otp->p_prio & 31)))) {
+    rl_set(otp->p_prio);
+    rlist.r_tails[otp->p_prio] = otp;
+  }
+#else /* !CH_USE_READYLIST_BITMAP */
   cp = (Thread *)&rlist.r_queue;
   do {
     cp = cp->p_next;
@@ -343,6 +489,7 @@ void chSchDoRescheduleAhead(void) {
   otp->p_next = cp;
   otp->p_prev = cp->p_prev;
   otp->p_prev->p_next = cp->p_prev = otp;
+#endif /* !CH_USE_READYLIST_BITMAP */
 
   chSysSwitch(currp, otp);
 }
@@ -58,7 +58,13 @@
  *          also have other uses, queues guards and counters for example.<br>
  *          Semaphores usually use a FIFO queuing strategy but it is possible
  *          to make them order threads by priority by enabling
- *          @p CH_USE_SEMAPHORES_PRIORITY in @p chconf.h.
+ *          @p CH_USE_SEMAPHORES_PRIORITY in @p chconf.h.<br>
+ *          If the @p CH_USE_ATOMIC_FASTPATH option is enabled and the port
+ *          supports it, @p chSemWait(), @p chSemWaitTimeout() and
+ *          @p chSemSignal() update the counter using a compare and swap
+ *          when the calling thread does not need to be queued or another
+ *          thread does not need to be awakened, the kernel lock is not
+ *          entered in that case.
  * @pre     In order to use the semaphore APIs the @p CH_USE_SEMAPHORES
  *          option must be enabled in @p chconf.h.
  * @{
@@ -68,6 +74,40 @@
 
 #if CH_USE_SEMAPHORES || defined(__DOXYGEN__)
 
+#if SEM_FASTPATH || defined(__DOXYGEN__)
+/*
+ * Decrements the counter if positive without entering the kernel lock.
+ */
+static bool_t sem_fast_wait(Semaphore *sp) {
+  cnt_t cnt;
+
+  while ((cnt = sp->s_cnt) > 0) {
+    if (port_cas(&sp->s_cnt, cnt, cnt - 1)) {
+      trace_sem_fast_wait(sp, cnt);
+      dbg_lock_acquired_atomic(&sp->s_stats);
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/*
+ * Increments the counter if there are no waiting threads without entering
+ * the kernel lock.
+ */
+static bool_t sem_fast_signal(Semaphore *sp) {
+  cnt_t cnt;
+
+  while ((cnt = sp->s_cnt) >= 0) {
+    if (port_cas(&sp->s_cnt, cnt, cnt + 1)) {
+      trace_sem_fast_signal(sp, cnt);
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+#endif /* SEM_FASTPATH */
+
 #if CH_USE_SEMAPHORES_PRIORITY
 #define sem_insert(tp, qp) prio_insert(tp, qp)
 #else
@@ -89,6 +129,10 @@ void chSemInit(Semaphore *sp, cnt_t n) {
 
   queue_init(&sp->s_queue);
   sp->s_cnt = n;
+#if CH_USE_WAITSETS
+  sp->s_wslist = NULL;
+#endif
+  dbg_lock_init(&sp->s_stats);
 }
 
 /**
@@ -147,6 +191,8 @@ void chSemResetI(Semaphore *sp, cnt_t n) {
   sp->s_cnt = n;
   while (++cnt <= 0)
     chSchReadyI(lifo_remove(&sp->s_queue))->p_u.rdymsg = RDY_RESET;
+  if (n > 0)
+    ws_notify_i(sp->s_wslist);
 }
 
 /**
@@ -164,6 +210,10 @@ void chSemResetI(Semaphore *sp, cnt_t n) {
 msg_t chSemWait(Semaphore *sp) {
   msg_t msg;
 
+#if SEM_FASTPATH
+  if (sem_fast_wait(sp))
+    return RDY_OK;
+#endif
   chSysLock();
   msg = chSemWaitS(sp);
   chSysUnlock();
@@ -191,12 +241,21 @@ msg_t chSemWaitS(Semaphore *sp) {
               "chSemWaitS(), #1",
               "inconsistent semaphore");
 
+  trace_sem_wait(sp);
   if (--sp->s_cnt < 0) {
+#if CH_DBG_LOCK_STATISTICS
+    uint32_t start = port_rt_get_counter_value();
+#endif
     currp->p_u.wtobjp = sp;
     sem_insert(currp, &sp->s_queue);
     chSchGoSleepS(THD_STATE_WTSEM);
+    dbg_lock_waited(&sp->s_stats, start);
+    if (currp->p_u.rdymsg == RDY_OK) {
+      dbg_lock_acquired(&sp->s_stats);
+    }
     return currp->p_u.rdymsg;
   }
+  dbg_lock_acquired(&sp->s_stats);
   return RDY_OK;
 }
 
@@ -222,6 +281,10 @@ msg_t chSemWaitS(Semaphore *sp) {
 msg_t chSemWaitTimeout(Semaphore *sp, systime_t time) {
   msg_t msg;
 
+#if SEM_FASTPATH
+  if (sem_fast_wait(sp))
+    return RDY_OK;
+#endif
   chSysLock();
   msg = chSemWaitTimeoutS(sp, time);
   chSysUnlock();
@@ -256,15 +319,31 @@ msg_t chSemWaitTimeoutS(Semaphore *sp, systime_t time) {
               "chSemWaitTimeoutS(), #1",
               "inconsistent semaphore");
 
+  trace_sem_wait(sp);
   if (--sp->s_cnt < 0) {
+#if CH_DBG_LOCK_STATISTICS
+    uint32_t start;
+    msg_t msg;
+#endif
     if (TIME_IMMEDIATE == time) {
       sp->s_cnt++;
       return RDY_TIMEOUT;
     }
     currp->p_u.wtobjp = sp;
     sem_insert(currp, &sp->s_queue);
+#if CH_DBG_LOCK_STATISTICS
+    start = port_rt_get_counter_value();
+    msg = chSchGoSleepTimeoutS(THD_STATE_WTSEM, time);
+    dbg_lock_waited(&sp->s_stats, start);
+    if (msg == RDY_OK) {
+      dbg_lock_acquired(&sp->s_stats);
+    }
+    return msg;
+#else
     return chSchGoSleepTimeoutS(THD_STATE_WTSEM, time);
+#endif
   }
+  dbg_lock_acquired(&sp->s_stats);
   return RDY_OK;
 }
 
@@ -283,9 +362,32 @@ void chSemSignal(Semaphore *sp) {
               "chSemSignal(), #1",
               "inconsistent semaphore");
 
+#if SEM_FASTPATH
+  if (sem_fast_signal(sp)) {
+#if CH_USE_WAITSETS
+    /* The list is checked after the counter update, an entry added before
+       the update is notified here, an entry added after the update finds
+       the counter already positive.*/
+    if (sp->s_wslist != NULL) {
+      chSysLock();
+      _ws_notify_i(sp->s_wslist);
+      chSchRescheduleS();
+      chSysUnlock();
+    }
+#endif
+    return;
+  }
+#endif
   chSysLock();
+  trace_sem_signal(sp);
   if (++sp->s_cnt <= 0)
     chSchWakeupS(fifo_remove(&sp->s_queue), RDY_OK);
+#if CH_USE_WAITSETS
+  else if (sp->s_wslist != NULL) {
+    _ws_notify_i(sp->s_wslist);
+    chSchRescheduleS();
+  }
+#endif
   chSysUnlock();
 }
 
@@ -309,6 +411,7 @@ void chSemSignalI(Semaphore *sp) {
               "chSemSignalI(), #1",
               "inconsistent semaphore");
 
+  trace_sem_signal(sp);
   if (++sp->s_cnt <= 0) {
     /* Note, it is done this way in order to allow a tail call on
              chSchReadyI().*/
@@ -316,6 +419,8 @@ void chSemSignalI(Semaphore *sp) {
     tp->p_u.rdymsg = RDY_OK;
     chSchReadyI(tp);
   }
+  else
+    ws_notify_i(sp->s_wslist);
 }
 
 /**
@@ -340,11 +445,14 @@ void chSemAddCounterI(Semaphore *sp, cnt_t n) {
               "chSemAddCounterI(), #1",
               "inconsistent semaphore");
 
+  trace_sem_signal(sp);
   while (n > 0) {
     if (++sp->s_cnt <= 0)
       chSchReadyI(fifo_remove(&sp->s_queue))->p_u.rdymsg = RDY_OK;
     n--;
   }
+  if (sp->s_cnt > 0)
+    ws_notify_i(sp->s_wslist);
 }
 
 #if CH_USE_SEMSW || defined(__DOXYGEN__)
@@ -377,16 +485,28 @@ msg_t chSemSignalWait(Semaphore *sps, Semaphore *spw) {
               "inconsistent semaphore");
 
   chSysLock();
+  trace_sem_signal(sps);
   if (++sps->s_cnt <= 0)
     chSchReadyI(fifo_remove(&sps->s_queue))->p_u.rdymsg = RDY_OK;
+  else
+    ws_notify_i(sps->s_wslist);
+  trace_sem_wait(spw);
   if (--spw->s_cnt < 0) {
     Thread *ctp = currp;
+#if CH_DBG_LOCK_STATISTICS
+    uint32_t start = port_rt_get_counter_value();
+#endif
     sem_insert(ctp, &spw->s_queue);
     ctp->p_u.wtobjp = spw;
     chSchGoSleepS(THD_STATE_WTSEM);
     msg = ctp->p_u.rdymsg;
+    dbg_lock_waited(&spw->s_stats, start);
+    if (msg == RDY_OK) {
+      dbg_lock_acquired(&spw->s_stats);
+    }
   }
   else {
+    dbg_lock_acquired(&spw->s_stats);
     chSchRescheduleS();
     msg = RDY_OK;
   }
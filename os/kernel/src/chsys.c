@@ -96,9 +96,21 @@ void chSysInit(void) {
 #if CH_USE_HEAP
   _heap_init();
 #endif
+#if CH_USE_RINGBUFFERS
+  _db_init();
+#endif
+#if CH_USE_REGISTRY_INDEX
+  _reg_init();
+#endif
 #if CH_DBG_ENABLE_TRACE
   _trace_init();
 #endif
+#if CH_USE_TRACE
+  _tracer_init();
+#endif
+#if CH_DBG_STATISTICS
+  _stats_init();
+#endif
 
   /* Now this instructions flow becomes the main thread.*/
   setcurrp(_thread_init(&mainthread, NORMALPRIO));
@@ -131,6 +143,8 @@ void chSysInit(void) {
  * @note    The frequency of the timer determines the system tick granularity
  *          and, together with the @p CH_TIME_QUANTUM macro, the round robin
  *          interval.
+ * @note    In tickless mode this function is invoked by the port alarm
+ *          interrupt and only manages the timers.
  *
  * @iclass
  */
@@ -0,0 +1,420 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chtasks.c
+ * @brief   Stackless Tasks code.
+ *
+ * @addtogroup tasks
+ * @details Stackless Tasks related APIs and services.
+ *
+ *          <h2>Operation mode</h2>
+ *          A stackless task is a coroutine executed by an host thread, the
+ *          tasks do not have a stack so thousands of tasks can run in the
+ *          space of a few working areas. The task function is invoked by
+ *          the host thread each time the task is scheduled and returns
+ *          when the task blocks, the execution is then resumed after the
+ *          blocking macro.<br>
+ *          The tasks of a scheduler are executed in round robin order, a
+ *          task runs until it blocks or yields, there is no preemption
+ *          between the tasks of the same scheduler. The host thread is a
+ *          normal thread, its priority is the priority of all its tasks.
+ *          <br>
+ *          The tasks can wait on the following objects:
+ *          - Semaphores, the task is made ready by the semaphore when the
+ *            counter becomes positive and acquires the semaphore when it
+ *            is resumed.
+ *          - Mailboxes, the task is made ready when a message is posted
+ *            and fetches the message when it is resumed.
+ *          - Events, the event sources are registered on the host thread,
+ *            the events received by the host thread are delivered to all
+ *            the tasks waiting for them. The events not waited by any task
+ *            are discarded.
+ *          - Time, the sleeping tasks are kept in a delta list served by
+ *            the host thread.
+ *          .
+ *          The semaphores and mailboxes notify the waiting tasks using the
+ *          same mechanism of the wait sets.
+ *          <h2>Constraints</h2>
+ *          - The local variables of the task functions are not preserved
+ *            across the blocking macros.
+ *          - A task cannot invoke blocking kernel APIs, a task blocking the
+ *            host thread blocks all the tasks of the scheduler.
+ *          - The task structures must not go out of scope before the task
+ *            terminates.
+ *          .
+ * @pre     In order to use the stackless tasks APIs the @p CH_USE_TASKS
+ *          option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_USE_TASKS || defined(__DOXYGEN__)
+
+/*
+ * Appends a task to the ready list and notifies the host thread if the
+ * list was empty.
+ */
+static void ts_ready_i(TaskScheduler *tsp, Task *tp) {
+
+  tp->t_state = TASK_STATE_READY;
+  tp->t_next = NULL;
+  if (tsp->ts_rhead == NULL) {
+    tsp->ts_rhead = tp;
+    if (tsp->ts_thread != NULL)
+      chEvtSignalI(tsp->ts_thread, TASK_READY_EVENT);
+  }
+  else
+    tsp->ts_rtail->t_next = tp;
+  tsp->ts_rtail = tp;
+}
+
+/*
+ * Notification callback of the objects watched by the tasks.
+ */
+static void ts_notify(WaitSetEntry *wep) {
+  Task *tp = (Task *)wep;
+
+  if (tp->t_state == TASK_STATE_WTOBJ)
+    ts_ready_i(tp->t_tsp, tp);
+}
+
+/*
+ * Makes ready the sleeping tasks whose delay expired.
+ */
+static void ts_timers(TaskScheduler *tsp) {
+  systime_t now = chTimeNow();
+  systime_t elapsed = now - tsp->ts_lasttime;
+  Task *tp;
+
+  tsp->ts_lasttime = now;
+  while ((tp = tsp->ts_slist) != NULL) {
+    if (tp->t_u.delta > elapsed) {
+      tp->t_u.delta -= elapsed;
+      return;
+    }
+    elapsed -= tp->t_u.delta;
+    tsp->ts_slist = tp->t_next;
+    chSysLock();
+    ts_ready_i(tsp, tp);
+    chSysUnlock();
+  }
+}
+
+/*
+ * Delivers the events received by the host thread to the waiting tasks.
+ */
+static void ts_events(TaskScheduler *tsp, eventmask_t events) {
+  Task **tpp = &tsp->ts_evlist;
+  Task *tp;
+
+  events &= ~TASK_READY_EVENT;
+  if (events == 0)
+    return;
+  while ((tp = *tpp) != NULL) {
+    if ((tp->t_u.events & events) == 0) {
+      tpp = &tp->t_next;
+      continue;
+    }
+    *tpp = tp->t_next;
+    tp->t_u.events &= events;
+    chSysLock();
+    ts_ready_i(tsp, tp);
+    chSysUnlock();
+  }
+}
+
+/*
+ * Invokes a task function and handles the return code.
+ */
+static void ts_execute(TaskScheduler *tsp, Task *tp) {
+
+  tp->t_state = TASK_STATE_CURRENT;
+  switch (tp->t_func(tp)) {
+  case TASK_YIELDED:
+    chSysLock();
+    ts_ready_i(tsp, tp);
+    chSysUnlock();
+    break;
+  case TASK_EXITED:
+    chDbgAssert(tp->t_wlpp == NULL,
+                "ts_execute(), #1", "still watching an object");
+    tp->t_state = TASK_STATE_FINAL;
+    chSysLock();
+    tsp->ts_n--;
+    chSysUnlock();
+    break;
+  }
+}
+
+/**
+ * @brief   Initializes a @p TaskScheduler structure.
+ *
+ * @param[out] tsp      pointer to a @p TaskScheduler structure
+ *
+ * @init
+ */
+void chTaskSchedulerInit(TaskScheduler *tsp) {
+
+  chDbgCheck(tsp != NULL, "chTaskSchedulerInit");
+
+  tsp->ts_rhead = NULL;
+  tsp->ts_rtail = NULL;
+  tsp->ts_evlist = NULL;
+  tsp->ts_slist = NULL;
+  tsp->ts_lasttime = 0;
+  tsp->ts_thread = NULL;
+  tsp->ts_n = 0;
+}
+
+/**
+ * @brief   Executes the tasks of a scheduler.
+ * @details The invoking thread becomes the host thread of the scheduler,
+ *          the tasks are executed until all of them terminate or the
+ *          thread termination is requested using @p chThdTerminate().
+ * @note    The termination request is served after the current round of
+ *          the ready tasks, the host thread should be awakened by
+ *          signaling @p TASK_READY_EVENT.
+ *
+ * @param[in] tsp       pointer to the @p TaskScheduler structure
+ *
+ * @api
+ */
+void chTaskSchedulerRun(TaskScheduler *tsp) {
+  eventmask_t events;
+  Task *tp, *next;
+
+  chDbgCheck(tsp != NULL, "chTaskSchedulerRun");
+
+  chSysLock();
+  chDbgAssert(tsp->ts_thread == NULL,
+              "chTaskSchedulerRun(), #1", "already running");
+  tsp->ts_thread = currp;
+  tsp->ts_lasttime = chTimeNow();
+  chSysUnlock();
+
+  while ((tsp->ts_n > 0) && !chThdShouldTerminate()) {
+    ts_timers(tsp);
+    if (tsp->ts_rhead == NULL)
+      events = chEvtWaitAnyTimeout(ALL_EVENTS,
+                                   tsp->ts_slist == NULL ?
+                                   TIME_INFINITE : tsp->ts_slist->t_u.delta);
+    else
+      events = chEvtGetAndClearEvents(ALL_EVENTS);
+    ts_events(tsp, events);
+    ts_timers(tsp);
+
+    /* The ready list is detached, the tasks made ready during the round
+       are executed in the next round.*/
+    chSysLock();
+    tp = tsp->ts_rhead;
+    tsp->ts_rhead = NULL;
+    chSysUnlock();
+    while (tp != NULL) {
+      next = tp->t_next;
+      ts_execute(tsp, tp);
+      tp = next;
+    }
+  }
+
+  chSysLock();
+  tsp->ts_thread = NULL;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Starts a task.
+ * @details The task is added to the ready list of the scheduler.
+ *
+ * @param[in] tsp       pointer to the @p TaskScheduler structure
+ * @param[out] tp       pointer to the @p Task structure
+ * @param[in] func      the task function
+ * @param[in] arg       the task argument, it can be retrieved using
+ *                      @p chTaskGetArg()
+ *
+ * @api
+ */
+void chTaskStart(TaskScheduler *tsp, Task *tp, taskfunc_t func, void *arg) {
+
+  chSysLock();
+  chTaskStartI(tsp, tp, func, arg);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Starts a task.
+ * @details The task is added to the ready list of the scheduler.
+ *
+ * @param[in] tsp       pointer to the @p TaskScheduler structure
+ * @param[out] tp       pointer to the @p Task structure
+ * @param[in] func      the task function
+ * @param[in] arg       the task argument, it can be retrieved using
+ *                      @p chTaskGetArg()
+ *
+ * @iclass
+ */
+void chTaskStartI(TaskScheduler *tsp, Task *tp, taskfunc_t func, void *arg) {
+
+  chDbgCheckClassI();
+  chDbgCheck((tsp != NULL) && (tp != NULL) && (func != NULL), "chTaskStartI");
+
+  tp->we_func = ts_notify;
+  tp->t_tsp = tsp;
+  tp->t_func = func;
+  tp->t_arg = arg;
+  tp->t_wlpp = NULL;
+  tp->t_lc = 0;
+  tsp->ts_n++;
+  ts_ready_i(tsp, tp);
+}
+
+/**
+ * @brief   Tries to acquire a semaphore.
+ * @details If the semaphore is not available then the task is linked in the
+ *          list of the semaphore and made waiting.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @param[in] sp        pointer to the @p Semaphore structure
+ * @return              The operation status.
+ * @retval TRUE         if the semaphore has been acquired.
+ * @retval FALSE        if the task must wait.
+ *
+ * @notapi
+ */
+bool_t _task_sem_wait(Task *tp, Semaphore *sp) {
+
+  chSysLock();
+  if (chSemGetCounterI(sp) > 0) {
+    chSemFastWaitI(sp);
+    if (tp->t_wlpp != NULL) {
+      _ws_unlink_i(tp->t_wlpp, (WaitSetEntry *)tp);
+      tp->t_wlpp = NULL;
+    }
+    chSysUnlock();
+    return TRUE;
+  }
+  if (tp->t_wlpp == NULL) {
+    tp->t_wlpp = &sp->s_wslist;
+    _ws_link_i(tp->t_wlpp, (WaitSetEntry *)tp);
+  }
+  tp->t_state = TASK_STATE_WTOBJ;
+  chSysUnlock();
+  return FALSE;
+}
+
+#if CH_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @brief   Tries to fetch a message from a mailbox.
+ * @details If the mailbox is empty then the task is linked in the list of
+ *          the mailbox and made waiting.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @param[in] mbp       pointer to the @p Mailbox structure
+ * @param[out] msgp     pointer to a message variable for the received
+ *                      message
+ * @return              The operation status.
+ * @retval TRUE         if a message has been fetched.
+ * @retval FALSE        if the task must wait.
+ *
+ * @notapi
+ */
+bool_t _task_mb_fetch(Task *tp, Mailbox *mbp, msg_t *msgp) {
+
+  chSysLock();
+  if (chMBFetchI(mbp, msgp) == RDY_OK) {
+    if (tp->t_wlpp != NULL) {
+      _ws_unlink_i(tp->t_wlpp, (WaitSetEntry *)tp);
+      tp->t_wlpp = NULL;
+    }
+    /* The fetch could have made ready a sender.*/
+    chSchRescheduleS();
+    chSysUnlock();
+    return TRUE;
+  }
+  if (tp->t_wlpp == NULL) {
+    tp->t_wlpp = &mbp->mb_fullsem.s_wslist;
+    _ws_link_i(tp->t_wlpp, (WaitSetEntry *)tp);
+  }
+  tp->t_state = TASK_STATE_WTOBJ;
+  chSysUnlock();
+  return FALSE;
+}
+#endif /* CH_USE_MAILBOXES */
+
+/**
+ * @brief   Makes a task wait for events.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @param[in] mask      mask of the events to wait for
+ *
+ * @notapi
+ */
+void _task_evt_wait(Task *tp, eventmask_t mask) {
+  TaskScheduler *tsp = tp->t_tsp;
+
+  chDbgCheck((mask & ~TASK_READY_EVENT) != 0, "_task_evt_wait");
+
+  tp->t_u.events = mask;
+  tp->t_state = TASK_STATE_WTEVT;
+  tp->t_next = tsp->ts_evlist;
+  tsp->ts_evlist = tp;
+}
+
+/**
+ * @brief   Makes a task sleep.
+ * @details The task is inserted in the delta list of the sleeping tasks.
+ *
+ * @param[in] tp        pointer to the @p Task structure
+ * @param[in] time      the number of ticks
+ *
+ * @notapi
+ */
+void _task_sleep(Task *tp, systime_t time) {
+  TaskScheduler *tsp = tp->t_tsp;
+  Task **tpp = &tsp->ts_slist;
+
+  chDbgCheck((time != TIME_IMMEDIATE) && (time != TIME_INFINITE),
+             "_task_sleep");
+
+  /* The delta list is relative to the time of the last update.*/
+  time += chTimeNow() - tsp->ts_lasttime;
+  while ((*tpp != NULL) && ((*tpp)->t_u.delta <= time)) {
+    time -= (*tpp)->t_u.delta;
+    tpp = &(*tpp)->t_next;
+  }
+  tp->t_u.delta = time;
+  tp->t_state = TASK_STATE_SLEEPING;
+  tp->t_next = *tpp;
+  *tpp = tp;
+  if (tp->t_next != NULL)
+    tp->t_next->t_u.delta -= time;
+}
+
+#endif /* CH_USE_TASKS */
+
+/** @} */
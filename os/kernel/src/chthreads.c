@@ -85,12 +85,22 @@ Thread *_thread_init(Thread *tp, tprio_t prio) {
   tp->p_realprio = prio;
   tp->p_mtxlist = NULL;
 #endif
+#if CH_DBG_DEADLOCK_DETECTION
+  tp->p_boosted = THD_BOOST_NONE;
+  tp->p_boostvt.vt_func = NULL;
+#endif
 #if CH_USE_EVENTS
   tp->p_epending = 0;
 #endif
 #if CH_DBG_THREADS_PROFILING
   tp->p_time = 0;
 #endif
+#if CH_DBG_STATISTICS
+  tp->p_stats.ts_runtime = 0;
+  tp->p_stats.ts_burst = 0;
+  tp->p_stats.ts_worst = 0;
+  tp->p_stats.ts_switches = 0;
+#endif
 #if CH_USE_DYNAMIC
   tp->p_refs = 1;
 #endif
@@ -374,6 +384,11 @@ void chThdExitS(msg_t msg) {
   while (notempty(&tp->p_waiting))
     chSchReadyI(list_remove(&tp->p_waiting));
 #endif
+#if CH_DBG_DEADLOCK_DETECTION
+  /* The thread structure could be released after the exit.*/
+  if (chVTIsArmedI(&tp->p_boostvt))
+    chVTResetI(&tp->p_boostvt);
+#endif
 #if CH_USE_REGISTRY
   /* Static threads are immediately removed from the registry because
      there is no memory to recover.*/
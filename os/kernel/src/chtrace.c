@@ -0,0 +1,303 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chtrace.c
+ * @brief   Kernel events tracer code.
+ *
+ * @addtogroup trace
+ * @details Kernel events tracer.
+ *          <h2>Operation mode</h2>
+ *          The kernel instrumentation points record context switches,
+ *          ISRs entry and exit, semaphores, mutexes and queues operations,
+ *          virtual timers firings and user events into a circular buffer
+ *          of fixed size binary records. Each record is timestamped using
+ *          the port realtime counter, if available, else the system time.<br>
+ *          If the port implements the compare and swap then the records
+ *          are written without entering the kernel lock, from any context.
+ *          A writer reserves a slot by incrementing the ring sequence
+ *          counter with a compare and swap, claims the slot by replacing
+ *          the sequence number of the previous record in it with the
+ *          complement of its own, then fills the record and stores its
+ *          sequence number as last operation. The reader only copies the
+ *          records carrying the expected sequence number. A writer finding
+ *          its slot still claimed by a preempted writer of the previous
+ *          ring round discards its record, which is then reported as lost.
+ *          On the other ports the records are written from within the
+ *          kernel lock.<br>
+ *          The cost of an enabled event is a mask test, two compare and
+ *          swap operations and a record store, disabled event types cost
+ *          the mask test only.<br>
+ *          The ring is drained, in binary form, into any
+ *          @p BaseSequentialStream. A dump is made of a header, produced
+ *          by @p chTraceWriteHeader(), followed by the records produced
+ *          by one or more invocations of @p chTraceDrain(). If the ring
+ *          overflows between two drains then the oldest records are
+ *          replaced by a single @p TRACE_EV_LOST record.<br>
+ *          The @p tools/trace/chtrace.py script converts dumps into the
+ *          Chrome trace event format for timeline viewers.
+ * @pre     In order to use the tracer the @p CH_USE_TRACE option must be
+ *          enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_USE_TRACE || defined(__DOXYGEN__)
+
+/**
+ * @brief   Trace ring.
+ */
+trace_ring_t trace_ring;
+
+/**
+ * @brief   Tracer initialization.
+ * @note    Internal use only.
+ *
+ * @notapi
+ */
+void _tracer_init(void) {
+  uint32_t i;
+
+  trace_ring.tr_wrseq = 0;
+  trace_ring.tr_rdseq = 0;
+  trace_ring.tr_mask = TRACE_MASK_ALL;
+  /* The slots appear as written in the round before the first one.*/
+  for (i = 0; i < TRACE_BUFFER_SIZE; i++)
+    trace_ring.tr_buffer[i].tr_seq = i - TRACE_BUFFER_SIZE;
+}
+
+/**
+ * @brief   Writes a record in the trace ring.
+ * @details If @p TRACE_LOCKFREE is @p TRUE the function can be invoked from
+ *          any context, else it must be invoked from within the kernel
+ *          lock.
+ * @note    Not a user function, use the @p _trace_event() macro instead.
+ *
+ * @param[in] type      the event type
+ * @param[in] info      event specific 8 bits value
+ * @param[in] obj       object of the event
+ * @param[in] arg       event specific argument
+ *
+ * @notapi
+ */
+void _trace_write(uint8_t type, uint8_t info, size_t obj, size_t arg) {
+  trace_record_t *rp;
+  uint32_t time, seq;
+#if TRACE_LOCKFREE
+  uint32_t prev;
+#endif
+
+  time = TRACE_TIMESTAMP();
+#if TRACE_LOCKFREE
+  do {
+    seq = trace_ring.tr_wrseq;
+  } while (!port_cas((volatile cnt_t *)&trace_ring.tr_wrseq,
+                     (cnt_t)seq, (cnt_t)(seq + 1)));
+  rp = &trace_ring.tr_buffer[seq & (TRACE_BUFFER_SIZE - 1)];
+  /* The slot is claimed only if it holds a complete record of an older
+     round, the record is lost if the slot is still claimed by a preempted
+     writer or has already been reused by a newer writer.*/
+  do {
+    prev = rp->tr_seq;
+    if ((((prev ^ seq) & (TRACE_BUFFER_SIZE - 1)) != 0) ||
+        ((int32_t)(prev - seq) >= 0))
+      return;
+  } while (!port_cas((volatile cnt_t *)&rp->tr_seq,
+                     (cnt_t)prev, (cnt_t)~seq));
+#else
+  seq = trace_ring.tr_wrseq++;
+  rp = &trace_ring.tr_buffer[seq & (TRACE_BUFFER_SIZE - 1)];
+  rp->tr_seq = ~seq;
+#endif
+  rp->tr_obj  = obj;
+  rp->tr_arg  = arg;
+  rp->tr_time = time;
+  rp->tr_type = type;
+  rp->tr_info = info;
+  rp->tr_prio = (uint16_t)currp->p_prio;
+  port_memory_barrier();
+  rp->tr_seq  = seq;
+}
+
+/**
+ * @brief   Sets the mask of the recorded event types.
+ * @details Bit @p n of the mask enables the events of type @p n, events
+ *          types not in the mask are not recorded.
+ *
+ * @param[in] mask      the new events mask
+ *
+ * @api
+ */
+void chTraceSetMask(trace_mask_t mask) {
+
+  chSysLock();
+  trace_ring.tr_mask = mask;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Records a user event.
+ *
+ * @param[in] id        user event identifier
+ * @param[in] arg       user event argument
+ *
+ * @api
+ */
+void chTraceUser(uint32_t id, uint32_t arg) {
+
+  chSysLock();
+  chTraceUserI(id, arg);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Writes a trace dump header.
+ * @details The header contains the timestamps frequency and, if the
+ *          registry is enabled, the names of the threads existing at the
+ *          time of the invocation.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ *
+ * @api
+ */
+void chTraceWriteHeader(BaseSequentialStream *chp) {
+  trace_header_t th;
+  unsigned n = 0;
+#if CH_USE_REGISTRY
+  Thread *tp;
+  trace_thread_t td;
+  unsigned i;
+
+  tp = chRegFirstThread();
+  do {
+    n++;
+    tp = chRegNextThread(tp);
+  } while ((tp != NULL) && (n < TRACE_MAX_THREADS));
+#if CH_USE_DYNAMIC
+  if (tp != NULL)
+    chThdRelease(tp);
+#endif
+#endif
+
+  th.th_magic[0] = 'C';
+  th.th_magic[1] = 'H';
+  th.th_magic[2] = 'T';
+  th.th_magic[3] = 'R';
+  th.th_bom = TRACE_BOM;
+  th.th_version = TRACE_FORMAT_VERSION;
+  th.th_recsize = (uint8_t)sizeof (trace_record_t);
+  th.th_frequency = TRACE_FREQUENCY;
+  th.th_nthreads = (uint16_t)n;
+  th.th_objsize = (uint8_t)sizeof (size_t);
+  th.th_reserved = 0;
+  chSequentialStreamWrite(chp, (const uint8_t *)&th, sizeof (trace_header_t));
+
+#if CH_USE_REGISTRY
+  /* Threads could have been created or terminated meanwhile, the list is
+     padded with empty descriptors if required.*/
+  tp = chRegFirstThread();
+  while (n > 0) {
+    const char *name = NULL;
+
+    td.td_obj = (size_t)tp;
+    if (tp != NULL) {
+      name = tp->p_name;
+      tp = chRegNextThread(tp);
+    }
+    for (i = 0; i < TRACE_NAME_SIZE; i++) {
+      td.td_name[i] = (name != NULL) ? *name : '\0';
+      if ((name != NULL) && (*name++ == '\0'))
+        name = NULL;
+    }
+    chSequentialStreamWrite(chp, (const uint8_t *)&td,
+                            sizeof (trace_thread_t));
+    n--;
+  }
+#if CH_USE_DYNAMIC
+  if (tp != NULL)
+    chThdRelease(tp);
+#endif
+#endif
+}
+
+/**
+ * @brief   Drains the trace ring into a stream.
+ * @details The records present in the ring at the time of the invocation
+ *          are written in binary form, events happening meanwhile are
+ *          left in the ring for the next invocation. The kernel lock is
+ *          held only while copying each single record, the drain stops at
+ *          the first record still being written.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ * @return              The number of records written.
+ *
+ * @api
+ */
+size_t chTraceDrain(BaseSequentialStream *chp) {
+  trace_record_t r;
+  uint32_t end;
+  size_t n = 0;
+
+  chSysLock();
+  end = trace_ring.tr_wrseq;
+  while ((int32_t)(end - trace_ring.tr_rdseq) > 0) {
+    uint32_t pending = trace_ring.tr_wrseq - trace_ring.tr_rdseq;
+
+    if (pending > TRACE_BUFFER_SIZE) {
+      /* The oldest records have been overwritten, a single record takes
+         their place, its timestamp is the one of the oldest surviving
+         record.*/
+      trace_ring.tr_rdseq += pending - TRACE_BUFFER_SIZE;
+      r = trace_ring.tr_buffer[trace_ring.tr_rdseq & (TRACE_BUFFER_SIZE - 1)];
+      r.tr_seq  = trace_ring.tr_rdseq - 1;
+      r.tr_type = TRACE_EV_LOST;
+      r.tr_info = 0;
+      r.tr_prio = 0;
+      r.tr_obj  = 0;
+      r.tr_arg  = pending - TRACE_BUFFER_SIZE;
+    }
+    else {
+      r = trace_ring.tr_buffer[trace_ring.tr_rdseq &
+                               (TRACE_BUFFER_SIZE - 1)];
+      if (r.tr_seq != trace_ring.tr_rdseq)
+        break;
+      trace_ring.tr_rdseq++;
+    }
+    chSysUnlock();
+    chSequentialStreamWrite(chp, (const uint8_t *)&r,
+                            sizeof (trace_record_t));
+    n++;
+    chSysLock();
+  }
+  chSysUnlock();
+  return n;
+}
+
+#endif /* CH_USE_TRACE */
+
+/** @} */
@@ -41,6 +41,148 @@
  */
 VTList vtlist;
 
+#if CH_USE_TIMING_WHEEL || defined(__DOXYGEN__)
+/*
+ * Inserts a timer in the wheel slot matching its deadline, the parameter
+ * base is the first system time value not yet processed by the ticker.
+ * The level is chosen so that the slot is reached, directly or after
+ * being cascaded to the lower levels, exactly at the deadline.
+ */
+static void wheel_insert(VirtualTimer *vtp, systime_t base) {
+  systime_t delta = vtp->vt_time - base;
+  systime_t t = vtp->vt_time;
+  unsigned level = 0;
+  VTWheelSlot *sp;
+
+  while ((uint32_t)delta >= ((uint32_t)1 << (VT_WHEEL_BITS * (level + 1)))) {
+    if (++level >= VT_WHEEL_LEVELS) {
+      /* Deadline beyond the wheel span, the timer is parked in the last
+         slot reachable and re-evaluated when the slot is cascaded.*/
+      level = VT_WHEEL_LEVELS - 1;
+      t = base + (systime_t)(((uint32_t)1 <<
+                              (VT_WHEEL_BITS * VT_WHEEL_LEVELS)) - 1);
+      break;
+    }
+  }
+  sp = &vtlist.vt_wheel[level][(t >> (VT_WHEEL_BITS * level)) &
+                               VT_WHEEL_MASK];
+  vtp->vt_next = (VirtualTimer *)sp;
+  vtp->vt_prev = sp->vt_prev;
+  vtp->vt_prev->vt_next = sp->vt_prev = vtp;
+}
+
+/*
+ * Moves the timers of the current slot of the specified level to the
+ * lower levels, returns the slot index.
+ */
+static unsigned wheel_cascade(unsigned level, systime_t now) {
+  unsigned i = (unsigned)(now >> (VT_WHEEL_BITS * level)) & VT_WHEEL_MASK;
+  VTWheelSlot *sp = &vtlist.vt_wheel[level][i];
+  VirtualTimer *vtp = sp->vt_next;
+
+  sp->vt_next = sp->vt_prev = (VirtualTimer *)sp;
+  while (vtp != (VirtualTimer *)sp) {
+    VirtualTimer *next = vtp->vt_next;
+    wheel_insert(vtp, now);
+    vtp = next;
+  }
+  return i;
+}
+
+/**
+ * @brief   Timing wheel ticker.
+ * @details Advances the system time by one tick, cascades the higher
+ *          levels slots when the lower level completes a revolution then
+ *          triggers all the timers in the current slot of the first level.
+ * @note    The system lock is released before entering the callback and
+ *          re-acquired immediately after. It is callback's responsibility
+ *          to acquire the lock if needed.
+ *
+ * @notapi
+ */
+void _vt_wheel_tick(void) {
+  systime_t now = ++vtlist.vt_systime;
+  unsigned i = (unsigned)now & VT_WHEEL_MASK;
+  VTWheelSlot *sp, expired;
+
+  if (i == 0) {
+    unsigned level = 1;
+
+    while ((level < VT_WHEEL_LEVELS) && (wheel_cascade(level, now) == 0))
+      level++;
+  }
+
+  /* The expired timers are moved in a local list because the callbacks
+     could re-arm timers falling in the current slot.*/
+  sp = &vtlist.vt_wheel[0][i];
+  if (sp->vt_next == (VirtualTimer *)sp)
+    return;
+  expired.vt_next = sp->vt_next;
+  expired.vt_prev = sp->vt_prev;
+  expired.vt_next->vt_prev = (VirtualTimer *)&expired;
+  expired.vt_prev->vt_next = (VirtualTimer *)&expired;
+  sp->vt_next = sp->vt_prev = (VirtualTimer *)sp;
+  while (expired.vt_next != (VirtualTimer *)&expired) {
+    VirtualTimer *vtp = expired.vt_next;
+    vtfunc_t fn = vtp->vt_func;
+
+    vtp->vt_func = (vtfunc_t)NULL;
+    (expired.vt_next = vtp->vt_next)->vt_prev = (VirtualTimer *)&expired;
+    trace_timer(vtp);
+    chSysUnlockFromIsr();
+    fn(vtp->vt_par);
+    chSysLockFromIsr();
+  }
+}
+#endif /* CH_USE_TIMING_WHEEL */
+
+#if (CH_TIMEDELTA > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Tickless mode alarm handler.
+ * @details Triggers all the timers whose deadline has been reached then
+ *          programs the alarm on the next deadline, the alarm is stopped if
+ *          there are no more armed timers.
+ * @note    The system lock is released before entering the callback and
+ *          re-acquired immediately after. It is callback's responsibility
+ *          to acquire the lock if needed.
+ *
+ * @notapi
+ */
+void _vt_alarm_tick(void) {
+  VirtualTimer *vtp;
+  systime_t now, delta;
+
+  now = port_timer_get_time();
+  /* The loop is stopped by the list header because its delta is the
+     maximum time value.*/
+  while ((vtp = vtlist.vt_next)->vt_time <=
+         (systime_t)(now - vtlist.vt_lasttime)) {
+    vtfunc_t fn = vtp->vt_func;
+
+    vtlist.vt_lasttime += vtp->vt_time;
+    vtp->vt_func = (vtfunc_t)NULL;
+    vtp->vt_next->vt_prev = (void *)&vtlist;
+    vtlist.vt_next = vtp->vt_next;
+    if (vtlist.vt_next == (void *)&vtlist)
+      port_timer_stop_alarm();
+    trace_timer(vtp);
+    chSysUnlockFromIsr();
+    fn(vtp->vt_par);
+    chSysLockFromIsr();
+    now = port_timer_get_time();
+  }
+
+  if (vtp == (void *)&vtlist)
+    return;
+
+  /* Next deadline.*/
+  delta = vtp->vt_time - (systime_t)(now - vtlist.vt_lasttime);
+  if (delta < CH_TIMEDELTA)
+    delta = CH_TIMEDELTA;
+  port_timer_set_alarm(now + delta);
+}
+#endif /* CH_TIMEDELTA > 0 */
+
 /**
  * @brief   Virtual Timers initialization.
  * @note    Internal use only.
@@ -49,9 +191,22 @@ VTList vtlist;
  */
 void _vt_init(void) {
 
+#if CH_USE_TIMING_WHEEL
+  unsigned level, i;
+
+  for (level = 0; level < VT_WHEEL_LEVELS; level++)
+    for (i = 0; i < VT_WHEEL_SLOTS; i++)
+      vtlist.vt_wheel[level][i].vt_next = vtlist.vt_wheel[level][i].vt_prev =
+        (VirtualTimer *)&vtlist.vt_wheel[level][i];
+#else
   vtlist.vt_next = vtlist.vt_prev = (void *)&vtlist;
   vtlist.vt_time = (systime_t)-1;
+#endif
+#if CH_TIMEDELTA > 0
+  vtlist.vt_lasttime = 0;
+#else
   vtlist.vt_systime = 0;
+#endif
 }
 
 /**
@@ -74,7 +229,9 @@ void _vt_init(void) {
  * @iclass
  */
 void chVTSetI(VirtualTimer *vtp, systime_t time, vtfunc_t vtfunc, void *par) {
+#if !CH_USE_TIMING_WHEEL
   VirtualTimer *p;
+#endif
 
   chDbgCheckClassI();
   chDbgCheck((vtp != NULL) && (vtfunc != NULL) && (time != TIME_IMMEDIATE),
@@ -82,6 +239,37 @@ void chVTSetI(VirtualTimer *vtp, systime_t time, vtfunc_t vtfunc, void *par) {
 
   vtp->vt_par = par;
   vtp->vt_func = vtfunc;
+#if CH_USE_TIMING_WHEEL
+  vtp->vt_time = vtlist.vt_systime + time;
+  wheel_insert(vtp, vtlist.vt_systime + 1);
+#else /* !CH_USE_TIMING_WHEEL */
+#if CH_TIMEDELTA > 0
+  {
+    systime_t now = port_timer_get_time();
+
+    if (time < CH_TIMEDELTA)
+      time = CH_TIMEDELTA;
+
+    if (vtlist.vt_next == (void *)&vtlist) {
+      /* Empty list, the time base is realigned and the alarm started.*/
+      vtlist.vt_lasttime = now;
+      port_timer_start_alarm(now + time);
+    }
+    else {
+      /* The delay is made relative to the list time base, a deadline not
+         representable from the base is clamped to the maximum delta.*/
+      systime_t elapsed = now - vtlist.vt_lasttime;
+
+      if (time > (systime_t)-1 - elapsed)
+        time = (systime_t)-1;
+      else
+        time += elapsed;
+      /* New first timer, the alarm is moved earlier.*/
+      if (time < vtlist.vt_next->vt_time)
+        port_timer_set_alarm(vtlist.vt_lasttime + time);
+    }
+  }
+#endif /* CH_TIMEDELTA > 0 */
   p = vtlist.vt_next;
   while (p->vt_time < time) {
     time -= p->vt_time;
@@ -93,6 +281,7 @@ void chVTSetI(VirtualTimer *vtp, systime_t time, vtfunc_t vtfunc, void *par) {
   vtp->vt_time = time;
   if (p != (void *)&vtlist)
     p->vt_time -= time;
+#endif /* !CH_USE_TIMING_WHEEL */
 }
 
 /**
@@ -111,8 +300,37 @@ void chVTResetI(VirtualTimer *vtp) {
               "chVTResetI(), #1",
               "timer not set or already triggered");
 
+#if CH_TIMEDELTA > 0
+  if (vtlist.vt_next == vtp) {
+    systime_t nowdelta, delta;
+
+    /* Removing the first timer, the alarm must be stopped or moved to
+       the next deadline.*/
+    vtlist.vt_next = vtp->vt_next;
+    vtp->vt_next->vt_prev = (void *)&vtlist;
+    vtp->vt_func = (vtfunc_t)NULL;
+    if (vtlist.vt_next == (void *)&vtlist) {
+      port_timer_stop_alarm();
+      return;
+    }
+    vtlist.vt_next->vt_time += vtp->vt_time;
+
+    /* If the next deadline is already due then the pending alarm will
+       handle it.*/
+    nowdelta = port_timer_get_time() - vtlist.vt_lasttime;
+    if (nowdelta >= vtlist.vt_next->vt_time)
+      return;
+    delta = vtlist.vt_next->vt_time - nowdelta;
+    if (delta < CH_TIMEDELTA)
+      delta = CH_TIMEDELTA;
+    port_timer_set_alarm(vtlist.vt_lasttime + nowdelta + delta);
+    return;
+  }
+#endif /* CH_TIMEDELTA > 0 */
+#if !CH_USE_TIMING_WHEEL
   if (vtp->vt_next != (void *)&vtlist)
     vtp->vt_next->vt_time += vtp->vt_time;
+#endif
   vtp->vt_prev->vt_next = vtp->vt_next;
   vtp->vt_next->vt_prev = vtp->vt_prev;
   vtp->vt_func = (vtfunc_t)NULL;
@@ -0,0 +1,469 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chwaitset.c
+ * @brief   Wait Sets code.
+ *
+ * @addtogroup waitsets
+ * @details Wait Sets related APIs and services.
+ *
+ *          <h2>Operation mode</h2>
+ *          A wait set allows a thread to wait on several objects at once,
+ *          the objects can be semaphores, mailboxes, input queues and event
+ *          sources in any combination. The wait returns the index of an
+ *          object found ready, the index is the value returned when the
+ *          object has been added to the set.<br>
+ *          An object is ready when:
+ *          - Semaphore, the counter is positive. The semaphore is acquired
+ *            by the wait.
+ *          - Mailbox, there is at least a message. The message is fetched
+ *            by the wait and can be retrieved using @p chWSGetMessage().
+ *          - Input queue, there is at least a byte in the queue. The data
+ *            is not read by the wait, the thread should read the queue
+ *            using a non-blocking function.
+ *          - Event source, one of the events associated to the source is
+ *            pending. The events are cleared by the wait and can be
+ *            retrieved using @p chWSGetEvents().
+ *          .
+ *          The readiness is evaluated by the waiting thread under the
+ *          kernel lock, the objects just awaken the thread when their state
+ *          changes so wakeups cannot be lost. The entries are scanned in
+ *          round robin order starting after the last returned entry, this
+ *          prevents a busy object from starving the others.
+ *          <h2>Constraints</h2>
+ *          - A wait set is owned by a single thread, the entries must be
+ *            added, the wait performed and the set cleared by the same
+ *            thread.
+ *          - The set must be cleared using @p chWSClear() before the
+ *            entries storage or the watched objects go out of scope.
+ *          .
+ * @pre     In order to use the wait sets APIs the @p CH_USE_WAITSETS option
+ *          must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_USE_WAITSETS || defined(__DOXYGEN__)
+
+/*
+ * Notification callback of the wait set entries, the thread waiting on the
+ * set is made ready.
+ */
+static void ws_wakeup(WaitSetEntry *wep) {
+  Thread *tp = wep->we_wsp->ws_thread;
+
+  if ((tp != NULL) && (tp->p_state == THD_STATE_WTSET))
+    chSchReadyI(tp)->p_u.rdymsg = RDY_OK;
+}
+
+/*
+ * Takes the next free entry of the set.
+ */
+static WaitSetEntry *ws_alloc(WaitSet *wsp, void *obj, uint8_t type) {
+  WaitSetEntry *wep;
+
+  chDbgAssert(wsp->ws_n < wsp->ws_size, "ws_alloc(), #1", "wait set full");
+  chDbgAssert(wsp->ws_thread == NULL, "ws_alloc(), #2", "wait in progress");
+
+  wep = &wsp->ws_entries[wsp->ws_n++];
+  wep->we_func = ws_wakeup;
+  wep->we_wsp = wsp;
+  wep->we_obj = obj;
+  wep->we_type = type;
+  return wep;
+}
+
+/*
+ * Checks if the object of an entry is ready and consumes it, must be
+ * invoked by the waiting thread from within the kernel lock.
+ */
+static bool_t ws_ready(WaitSet *wsp, WaitSetEntry *wep) {
+
+  switch (wep->we_type) {
+  case WS_SEMAPHORE:
+    if (chSemGetCounterI((Semaphore *)wep->we_obj) <= 0)
+      return FALSE;
+    chSemFastWaitI((Semaphore *)wep->we_obj);
+    return TRUE;
+#if CH_USE_MAILBOXES
+  case WS_MAILBOX:
+    return chMBFetchI((Mailbox *)wep->we_obj, &wsp->ws_u.msg) == RDY_OK;
+#endif
+#if CH_USE_QUEUES
+  case WS_INPUTQUEUE:
+    return !chIQIsEmptyI((InputQueue *)wep->we_obj);
+#endif
+#if CH_USE_EVENTS
+  case WS_EVENTSOURCE:
+    wsp->ws_u.events = currp->p_epending & wep->we_listener.el_mask;
+    if (wsp->ws_u.events == 0)
+      return FALSE;
+    currp->p_epending &= ~wsp->ws_u.events;
+    return TRUE;
+#endif
+  }
+  return FALSE;
+}
+
+/*
+ * Scans the entries in round robin order, returns the index of the first
+ * ready entry or RDY_TIMEOUT.
+ */
+static msg_t ws_poll(WaitSet *wsp) {
+  cnt_t i, n;
+
+  i = wsp->ws_next;
+  for (n = 0; n < wsp->ws_n; n++, i++) {
+    if (i >= wsp->ws_n)
+      i = 0;
+    if (ws_ready(wsp, &wsp->ws_entries[i])) {
+      wsp->ws_next = i + 1;
+      return (msg_t)i;
+    }
+  }
+  return RDY_TIMEOUT;
+}
+
+/**
+ * @brief   Notifies the watchers of an object.
+ * @details The callbacks of the watchers are invoked, the threads waiting
+ *          on the wait sets are made ready and the ready objects are then
+ *          found by the threads themselves.
+ * @note    A callback can remove its own watcher from the list.
+ *
+ * @param[in] wep       first watcher in the list of the object
+ *
+ * @notapi
+ */
+void _ws_notify_i(WaitSetEntry *wep) {
+  WaitSetEntry *next;
+
+  chDbgCheckClassI();
+
+  do {
+    next = wep->we_next;
+    wep->we_func(wep);
+    wep = next;
+  } while (wep != NULL);
+}
+
+/**
+ * @brief   Links a watcher into the list of an object.
+ *
+ * @param[in] wlpp      pointer to the list of the object
+ * @param[in] wep       the watcher to be linked
+ *
+ * @notapi
+ */
+void _ws_link_i(WaitSetEntry **wlpp, WaitSetEntry *wep) {
+
+  wep->we_next = *wlpp;
+  *wlpp = wep;
+}
+
+/**
+ * @brief   Removes a watcher from the list of an object.
+ * @pre     The watcher must be linked in the list.
+ *
+ * @param[in] wlpp      pointer to the list of the object
+ * @param[in] wep       the watcher to be removed
+ *
+ * @notapi
+ */
+void _ws_unlink_i(WaitSetEntry **wlpp, WaitSetEntry *wep) {
+
+  while (*wlpp != wep)
+    wlpp = &(*wlpp)->we_next;
+  *wlpp = wep->we_next;
+}
+
+/**
+ * @brief   Initializes a @p WaitSet structure.
+ *
+ * @param[out] wsp      pointer to a @p WaitSet structure
+ * @param[in] entries   array of @p WaitSetEntry structures used as storage
+ *                      for the entries of the set
+ * @param[in] n         number of elements in the array
+ *
+ * @init
+ */
+void chWSInit(WaitSet *wsp, WaitSetEntry *entries, cnt_t n) {
+
+  chDbgCheck((wsp != NULL) && (entries != NULL) && (n > 0), "chWSInit");
+
+  wsp->ws_entries = entries;
+  wsp->ws_size = n;
+  wsp->ws_n = 0;
+  wsp->ws_next = 0;
+  wsp->ws_thread = NULL;
+#if CH_USE_EVENTS
+  wsp->ws_evmask = 0;
+#endif
+}
+
+/**
+ * @brief   Adds a semaphore to a wait set.
+ * @details The semaphore is ready when its counter is positive, the wait
+ *          acquires the semaphore.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ * @param[in] sp        pointer to the @p Semaphore structure
+ * @return              The index of the entry.
+ *
+ * @api
+ */
+cnt_t chWSAddSemaphore(WaitSet *wsp, Semaphore *sp) {
+  WaitSetEntry *wep;
+
+  chDbgCheck((wsp != NULL) && (sp != NULL), "chWSAddSemaphore");
+
+  wep = ws_alloc(wsp, sp, WS_SEMAPHORE);
+  chSysLock();
+  _ws_link_i(&sp->s_wslist, wep);
+  chSysUnlock();
+  return wsp->ws_n - 1;
+}
+
+#if CH_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @brief   Adds a mailbox to a wait set.
+ * @details The mailbox is ready when it contains at least a message, the
+ *          wait fetches the message.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ * @param[in] mbp       pointer to the @p Mailbox structure
+ * @return              The index of the entry.
+ *
+ * @api
+ */
+cnt_t chWSAddMailbox(WaitSet *wsp, Mailbox *mbp) {
+  WaitSetEntry *wep;
+
+  chDbgCheck((wsp != NULL) && (mbp != NULL), "chWSAddMailbox");
+
+  wep = ws_alloc(wsp, mbp, WS_MAILBOX);
+  chSysLock();
+  _ws_link_i(&mbp->mb_fullsem.s_wslist, wep);
+  chSysUnlock();
+  return wsp->ws_n - 1;
+}
+#endif /* CH_USE_MAILBOXES */
+
+#if CH_USE_QUEUES || defined(__DOXYGEN__)
+/**
+ * @brief   Adds an input queue to a wait set.
+ * @details The input queue is ready when it is not empty, the wait does not
+ *          read the queue.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ * @param[in] iqp       pointer to the @p InputQueue structure
+ * @return              The index of the entry.
+ *
+ * @api
+ */
+cnt_t chWSAddInputQueue(WaitSet *wsp, InputQueue *iqp) {
+  WaitSetEntry *wep;
+
+  chDbgCheck((wsp != NULL) && (iqp != NULL), "chWSAddInputQueue");
+
+  wep = ws_alloc(wsp, iqp, WS_INPUTQUEUE);
+  chSysLock();
+  _ws_link_i(&iqp->q_wslist, wep);
+  chSysUnlock();
+  return wsp->ws_n - 1;
+}
+#endif /* CH_USE_QUEUES */
+
+#if CH_USE_EVENTS || defined(__DOXYGEN__)
+/**
+ * @brief   Adds an event source to a wait set.
+ * @details An event listener embedded in the entry is registered on the
+ *          event source. The event source is ready when one of the events
+ *          in @p mask is pending, the wait clears the events.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ * @param[in] esp       pointer to the @p EventSource structure
+ * @param[in] mask      the mask of events to be signaled to the thread by
+ *                      the event source
+ * @return              The index of the entry.
+ *
+ * @api
+ */
+cnt_t chWSAddEventSource(WaitSet *wsp, EventSource *esp, eventmask_t mask) {
+  WaitSetEntry *wep;
+
+  chDbgCheck((wsp != NULL) && (esp != NULL) && (mask != 0),
+             "chWSAddEventSource");
+
+  wep = ws_alloc(wsp, esp, WS_EVENTSOURCE);
+  wsp->ws_evmask |= mask;
+  chEvtRegisterMask(esp, &wep->we_listener, mask);
+  return wsp->ws_n - 1;
+}
+#endif /* CH_USE_EVENTS */
+
+/**
+ * @brief   Removes all the entries from a wait set.
+ * @details The entries are removed from the watched objects, the entries
+ *          storage can be reused after this call.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ *
+ * @api
+ */
+void chWSClear(WaitSet *wsp) {
+  WaitSetEntry *wep;
+
+  chDbgCheck(wsp != NULL, "chWSClear");
+  chDbgAssert(wsp->ws_thread == NULL, "chWSClear(), #1", "wait in progress");
+
+  while (wsp->ws_n > 0) {
+    wep = &wsp->ws_entries[--wsp->ws_n];
+#if CH_USE_EVENTS
+    if (wep->we_type == WS_EVENTSOURCE) {
+      chEvtUnregister((EventSource *)wep->we_obj, &wep->we_listener);
+      continue;
+    }
+#endif
+    chSysLock();
+    switch (wep->we_type) {
+    case WS_SEMAPHORE:
+      _ws_unlink_i(&((Semaphore *)wep->we_obj)->s_wslist, wep);
+      break;
+#if CH_USE_MAILBOXES
+    case WS_MAILBOX:
+      _ws_unlink_i(&((Mailbox *)wep->we_obj)->mb_fullsem.s_wslist, wep);
+      break;
+#endif
+#if CH_USE_QUEUES
+    case WS_INPUTQUEUE:
+      _ws_unlink_i(&((InputQueue *)wep->we_obj)->q_wslist, wep);
+      break;
+#endif
+    }
+    chSysUnlock();
+  }
+  wsp->ws_next = 0;
+#if CH_USE_EVENTS
+  wsp->ws_evmask = 0;
+#endif
+}
+
+/**
+ * @brief   Waits for one of the objects in a wait set to become ready.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ * @return              The index of the ready entry.
+ *
+ * @api
+ */
+msg_t chWSWait(WaitSet *wsp) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chWSWaitTimeoutS(wsp, TIME_INFINITE);
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Waits for one of the objects in a wait set to become ready.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The index of the ready entry.
+ * @retval RDY_TIMEOUT  if no object became ready within the specified
+ *                      timeout.
+ *
+ * @api
+ */
+msg_t chWSWaitTimeout(WaitSet *wsp, systime_t time) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chWSWaitTimeoutS(wsp, time);
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Waits for one of the objects in a wait set to become ready.
+ * @details The objects are scanned and, if none is ready, the thread sleeps
+ *          until one of the objects changes its state, the scan is then
+ *          repeated. The timeout is not restarted by the wakeups not
+ *          resulting in a ready object.
+ *
+ * @param[in] wsp       pointer to the @p WaitSet structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The index of the ready entry.
+ * @retval RDY_TIMEOUT  if no object became ready within the specified
+ *                      timeout.
+ *
+ * @sclass
+ */
+msg_t chWSWaitTimeoutS(WaitSet *wsp, systime_t time) {
+  systime_t start, elapsed;
+  msg_t msg;
+
+  chDbgCheckClassS();
+  chDbgCheck(wsp != NULL, "chWSWaitTimeoutS");
+  chDbgAssert(wsp->ws_thread == NULL,
+              "chWSWaitTimeoutS(), #1",
+              "wait in progress");
+
+  start = chTimeNow();
+  while ((msg = ws_poll(wsp)) == RDY_TIMEOUT) {
+    elapsed = chTimeNow() - start;
+    if ((time != TIME_INFINITE) && (elapsed >= time))
+      return RDY_TIMEOUT;
+    wsp->ws_thread = currp;
+#if CH_USE_EVENTS
+    currp->p_u.ewmask = wsp->ws_evmask;
+#endif
+    chSchGoSleepTimeoutS(THD_STATE_WTSET,
+                         time == TIME_INFINITE ? TIME_INFINITE :
+                                                 time - elapsed);
+    wsp->ws_thread = NULL;
+  }
+  /* A mailbox fetch could have made ready a sender.*/
+  chSchRescheduleS();
+  return msg;
+}
+
+#endif /* CH_USE_WAITSETS */
+
+/** @} */
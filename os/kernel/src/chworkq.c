@@ -0,0 +1,385 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chworkq.c
+ * @brief   Work Queues code.
+ *
+ * @addtogroup workqueues
+ * @details Work Queues related APIs and services.
+ *
+ *          <h2>Operation mode</h2>
+ *          A work queue defers the execution of functions, the works, to
+ *          one or more worker threads. Works are submitted from threads,
+ *          from interrupt handlers or from callbacks, optionally with a
+ *          delay, and are executed in FIFO order by the first available
+ *          worker.<br>
+ *          Work queues allow the drivers callbacks and the interrupt
+ *          handlers to move the processing out of the interrupt context
+ *          without a dedicated thread for each driver, the workers
+ *          priority is the priority of the deferred processing, separate
+ *          work queues can be used for different priority levels.<br>
+ *          The work items are allocated from a memory pool preloaded with a
+ *          static array so the submission does not depend on a memory
+ *          allocator and is bounded in time. A submission fails if the
+ *          pool is exhausted.
+ * @pre     In order to use the work queues APIs the @p CH_USE_WORKQUEUES
+ *          option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_USE_WORKQUEUES || defined(__DOXYGEN__)
+
+/*
+ * Appends an item to the queue and awakens a worker.
+ */
+static void wq_enqueue_i(WorkQueue *wqp, WorkItem *wip) {
+
+  wip->wi_next = NULL;
+  if (wqp->wq_head == NULL)
+    wqp->wq_head = wip;
+  else
+    wqp->wq_tail->wi_next = wip;
+  wqp->wq_tail = wip;
+  chSemSignalI(&wqp->wq_sem);
+}
+
+/*
+ * Timer callback of the delayed works.
+ */
+static void wq_timer_cb(void *p) {
+  WorkItem *wip = (WorkItem *)p;
+
+  chSysLockFromIsr();
+  wq_enqueue_i(wip->wi_wqp, wip);
+  chSysUnlockFromIsr();
+}
+
+/*
+ * Allocates and initializes an item.
+ */
+static WorkItem *wq_alloc_i(WorkQueue *wqp, workfunc_t func, void *arg) {
+  WorkItem *wip;
+
+  wip = chPoolAllocI(&wqp->wq_pool);
+  if (wip != NULL) {
+    wip->wi_seq++;
+    wip->wi_wqp = wqp;
+    wip->wi_func = func;
+    wip->wi_arg = arg;
+    wip->wi_vt.vt_func = NULL;
+  }
+  return wip;
+}
+
+/*
+ * Worker thread, the item is returned to the pool before invoking the work
+ * function so the function can submit itself again.
+ */
+static msg_t worker(void *p) {
+  WorkQueue *wqp = (WorkQueue *)p;
+  WorkItem *wip;
+  workfunc_t func;
+  void *arg;
+
+  chRegSetThreadName("worker");
+  while (!chThdShouldTerminate()) {
+    chSysLock();
+    if (chSemWaitS(&wqp->wq_sem) != RDY_OK) {
+      chSysUnlock();
+      continue;
+    }
+    wip = wqp->wq_head;
+    wqp->wq_head = wip->wi_next;
+    func = wip->wi_func;
+    arg = wip->wi_arg;
+    chPoolFreeI(&wqp->wq_pool, wip);
+    chSysUnlock();
+    func(arg);
+  }
+  return 0;
+}
+
+/**
+ * @brief   Initializes a @p WorkQueue structure.
+ * @details The work items pool is loaded with the specified array.
+ *
+ * @param[out] wqp      pointer to a @p WorkQueue structure
+ * @param[in] items     array of @p WorkItem structures
+ * @param[in] n         number of elements in the array, it is the maximum
+ *                      number of works pending at the same time
+ *
+ * @init
+ */
+void chWorkQueueInit(WorkQueue *wqp, WorkItem *items, size_t n) {
+
+  chDbgCheck((wqp != NULL) && (items != NULL) && (n > 0), "chWorkQueueInit");
+
+  wqp->wq_head = NULL;
+  wqp->wq_tail = NULL;
+  chSemInit(&wqp->wq_sem, 0);
+  chPoolInit(&wqp->wq_pool, sizeof (WorkItem), NULL);
+  chPoolLoadArray(&wqp->wq_pool, items, n);
+}
+
+/**
+ * @brief   Creates a worker thread serving a work queue.
+ * @details More workers can serve the same work queue, the works are then
+ *          executed concurrently.
+ * @note    A worker terminates if @p chThdTerminate() has been invoked on
+ *          it and the work queue is reset using @p chWorkQueueReset().
+ *
+ * @param[in] wqp       pointer to the @p WorkQueue structure
+ * @param[out] wsp      pointer to a working area dedicated to the worker
+ * @param[in] size      size of the working area, the stack must be enough
+ *                      for the work functions
+ * @param[in] prio      the priority level of the worker
+ * @return              The pointer to the @p Thread structure of the worker.
+ *
+ * @api
+ */
+Thread *chWorkQueueAddWorker(WorkQueue *wqp, void *wsp, size_t size,
+                             tprio_t prio) {
+
+  chDbgCheck(wqp != NULL, "chWorkQueueAddWorker");
+
+  return chThdCreateStatic(wsp, size, prio, worker, wqp);
+}
+
+/**
+ * @brief   Resets a work queue.
+ * @details The queued works are discarded and their items are returned to
+ *          the pool, the waiting workers are resumed and terminate if
+ *          requested by @p chThdTerminate().
+ * @note    The delayed works not yet queued are not affected, use
+ *          @p chWorkCancel() in order to discard them.
+ *
+ * @param[in] wqp       pointer to the @p WorkQueue structure
+ *
+ * @api
+ */
+void chWorkQueueReset(WorkQueue *wqp) {
+  WorkItem *wip;
+
+  chDbgCheck(wqp != NULL, "chWorkQueueReset");
+
+  chSysLock();
+  while ((wip = wqp->wq_head) != NULL) {
+    wqp->wq_head = wip->wi_next;
+    chPoolFreeI(&wqp->wq_pool, wip);
+  }
+  chSemResetI(&wqp->wq_sem, 0);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Submits a work.
+ *
+ * @param[in] wqp       pointer to the @p WorkQueue structure
+ * @param[in] func      the work function
+ * @param[in] arg       argument passed to the work function
+ * @return              The operation status.
+ * @retval TRUE         if the work has been queued.
+ * @retval FALSE        if the work items pool is exhausted.
+ *
+ * @api
+ */
+bool_t chWorkSubmit(WorkQueue *wqp, workfunc_t func, void *arg) {
+  bool_t b;
+
+  chSysLock();
+  b = chWorkSubmitI(wqp, func, arg);
+  chSchRescheduleS();
+  chSysUnlock();
+  return b;
+}
+
+/**
+ * @brief   Submits a work.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] wqp       pointer to the @p WorkQueue structure
+ * @param[in] func      the work function
+ * @param[in] arg       argument passed to the work function
+ * @return              The operation status.
+ * @retval TRUE         if the work has been queued.
+ * @retval FALSE        if the work items pool is exhausted.
+ *
+ * @iclass
+ */
+bool_t chWorkSubmitI(WorkQueue *wqp, workfunc_t func, void *arg) {
+  WorkItem *wip;
+
+  chDbgCheckClassI();
+  chDbgCheck((wqp != NULL) && (func != NULL), "chWorkSubmitI");
+
+  wip = wq_alloc_i(wqp, func, arg);
+  if (wip == NULL)
+    return FALSE;
+  wq_enqueue_i(wqp, wip);
+  return TRUE;
+}
+
+/**
+ * @brief   Submits a delayed work.
+ * @details The work is queued after the specified delay.
+ *
+ * @param[in] wqp       pointer to the @p WorkQueue structure
+ * @param[in] func      the work function
+ * @param[in] arg       argument passed to the work function
+ * @param[in] delay     the number of ticks before the work is queued, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[out] whp      pointer to a @p WorkHandle structure receiving the
+ *                      handle of the work, it can be used to cancel the work
+ *                      before it is queued. It can be @p NULL if the work
+ *                      is never cancelled.
+ * @return              The operation status.
+ * @retval TRUE         if the work has been submitted.
+ * @retval FALSE        if the work items pool is exhausted.
+ *
+ * @api
+ */
+bool_t chWorkSubmitDelayed(WorkQueue *wqp, workfunc_t func, void *arg,
+                           systime_t delay, WorkHandle *whp) {
+  bool_t b;
+
+  chSysLock();
+  b = chWorkSubmitDelayedI(wqp, func, arg, delay, whp);
+  chSysUnlock();
+  return b;
+}
+
+/**
+ * @brief   Submits a delayed work.
+ * @details The work is queued after the specified delay.
+ *
+ * @param[in] wqp       pointer to the @p WorkQueue structure
+ * @param[in] func      the work function
+ * @param[in] arg       argument passed to the work function
+ * @param[in] delay     the number of ticks before the work is queued, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[out] whp      pointer to a @p WorkHandle structure receiving the
+ *                      handle of the work, it can be used to cancel the work
+ *                      before it is queued. It can be @p NULL if the work
+ *                      is never cancelled.
+ * @return              The operation status.
+ * @retval TRUE         if the work has been submitted.
+ * @retval FALSE        if the work items pool is exhausted.
+ *
+ * @iclass
+ */
+bool_t chWorkSubmitDelayedI(WorkQueue *wqp, workfunc_t func, void *arg,
+                            systime_t delay, WorkHandle *whp) {
+  WorkItem *wip;
+
+  chDbgCheckClassI();
+  chDbgCheck((wqp != NULL) && (func != NULL) && (delay != TIME_IMMEDIATE),
+             "chWorkSubmitDelayedI");
+
+  wip = wq_alloc_i(wqp, func, arg);
+  if (wip == NULL)
+    return FALSE;
+  chVTSetI(&wip->wi_vt, delay, wq_timer_cb, wip);
+  if (whp != NULL) {
+    whp->wh_wip = wip;
+    whp->wh_seq = wip->wi_seq;
+  }
+  return TRUE;
+}
+
+/**
+ * @brief   Cancels a delayed work.
+ * @details The work is discarded if it has not been queued yet. The handle
+ *          can be used after the work has been executed or cancelled, the
+ *          item could then have been reused by another submission and the
+ *          function has no effect.
+ *
+ * @param[in] whp       pointer to the @p WorkHandle structure filled by the
+ *                      delayed submission
+ * @return              The operation status.
+ * @retval TRUE         if the work has been discarded.
+ * @retval FALSE        if the work has already been queued, executed or
+ *                      cancelled.
+ *
+ * @api
+ */
+bool_t chWorkCancel(const WorkHandle *whp) {
+  bool_t b;
+
+  chSysLock();
+  b = chWorkCancelI(whp);
+  chSysUnlock();
+  return b;
+}
+
+/**
+ * @brief   Cancels a delayed work.
+ * @details The work is discarded if it has not been queued yet. The handle
+ *          can be used after the work has been executed or cancelled, the
+ *          item could then have been reused by another submission and the
+ *          function has no effect.
+ *
+ * @param[in] whp       pointer to the @p WorkHandle structure filled by the
+ *                      delayed submission
+ * @return              The operation status.
+ * @retval TRUE         if the work has been discarded.
+ * @retval FALSE        if the work has already been queued, executed or
+ *                      cancelled.
+ *
+ * @iclass
+ */
+bool_t chWorkCancelI(const WorkHandle *whp) {
+  WorkItem *wip;
+
+  chDbgCheckClassI();
+  chDbgCheck((whp != NULL) && (whp->wh_wip != NULL), "chWorkCancelI");
+
+  wip = whp->wh_wip;
+  if ((wip->wi_seq != whp->wh_seq) || !chVTIsArmedI(&wip->wi_vt))
+    return FALSE;
+  chVTResetI(&wip->wi_vt);
+  chPoolFreeI(&wip->wi_wqp->wq_pool, wip);
+  return TRUE;
+}
+
+#endif /* CH_USE_WORKQUEUES */
+
+/** @} */
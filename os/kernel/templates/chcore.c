@@ -138,4 +138,149 @@ void port_halt(void) {
 void port_switch(Thread *ntp, Thread *otp) {
 }
 
+#if (CH_TIMEDELTA > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the alarm.
+ * @details The alarm interrupt is enabled and programmed to trigger at the
+ *          specified system time, the interrupt handler must invoke
+ *          @p chSysTimerHandlerI().
+ * @note    Required in tickless mode only.
+ *
+ * @param[in] time      the time to be set for the alarm
+ */
+void port_timer_start_alarm(systime_t time) {
+}
+
+/**
+ * @brief   Stops the alarm.
+ * @note    Required in tickless mode only.
+ */
+void port_timer_stop_alarm(void) {
+}
+
+/**
+ * @brief   Changes the time of an already started alarm.
+ * @note    Required in tickless mode only.
+ *
+ * @param[in] time      the time to be set for the alarm
+ */
+void port_timer_set_alarm(systime_t time) {
+}
+
+/**
+ * @brief   Returns the system time.
+ * @details The time is read from a free-running counter incrementing at
+ *          @p CH_FREQUENCY.
+ * @note    Required in tickless mode only.
+ *
+ * @return              The system time.
+ */
+systime_t port_timer_get_time(void) {
+
+  return 0;
+}
+#endif /* CH_TIMEDELTA > 0 */
+
+#if PORT_SUPPORTS_CAS || defined(__DOXYGEN__)
+/**
+ * @brief   Counter compare and swap.
+ * @details Atomically compares the counter pointed by @p p with @p cmp and,
+ *          if equal, replaces it with @p xchg.
+ * @note    Required only if @p PORT_SUPPORTS_CAS is @p TRUE, the function
+ *          must be callable from any context and must be atomic with
+ *          respect to interrupts, it does not need to be atomic with
+ *          respect to kernel lock protected code.
+ *
+ * @param[in] p         pointer to the counter
+ * @param[in] cmp       the expected value
+ * @param[in] xchg      the new value
+ * @return              The operation result.
+ * @retval FALSE        if the counter did not match @p cmp.
+ * @retval TRUE         if the counter has been replaced.
+ */
+bool_t port_cas(volatile cnt_t *p, cnt_t cmp, cnt_t xchg) {
+
+  return FALSE;
+}
+
+/**
+ * @brief   Pointer compare and swap.
+ * @details Atomically compares the pointer pointed by @p p with @p cmp and,
+ *          if equal, replaces it with @p xchg.
+ * @note    Required only if @p PORT_SUPPORTS_CAS is @p TRUE, the function
+ *          must be callable from any context and must be atomic with
+ *          respect to interrupts, it does not need to be atomic with
+ *          respect to kernel lock protected code.
+ *
+ * @param[in] p         pointer to the pointer
+ * @param[in] cmp       the expected value
+ * @param[in] xchg      the new value
+ * @return              The operation result.
+ * @retval FALSE        if the pointer did not match @p cmp.
+ * @retval TRUE         if the pointer has been replaced.
+ */
+bool_t port_casp(void * volatile *p, void *cmp, void *xchg) {
+
+  return FALSE;
+}
+#endif /* PORT_SUPPORTS_CAS */
+
+#if PORT_SUPPORTS_CAS2 || defined(__DOXYGEN__)
+/**
+ * @brief   Double word compare and swap.
+ * @details Atomically compares the double word pointed by @p p with
+ *          @p cmp and, if equal, replaces it with @p xchg.
+ * @note    Required only if @p PORT_SUPPORTS_CAS2 is @p TRUE, the function
+ *          must be callable from any context, including fast interrupts.
+ *
+ * @param[in] p         pointer to the double word
+ * @param[in] cmp       the expected value
+ * @param[in] xchg      the new value
+ * @return              The operation result.
+ * @retval FALSE        if the double word did not match @p cmp.
+ * @retval TRUE         if the double word has been replaced.
+ */
+bool_t port_cas2(volatile port_cas2_t *p, port_cas2_t cmp,
+                 port_cas2_t xchg) {
+
+  return FALSE;
+}
+#endif /* PORT_SUPPORTS_CAS2 */
+
+#if PORT_SUPPORTS_LLSC || defined(__DOXYGEN__)
+/**
+ * @brief   List pop.
+ * @details Atomically removes the first object of a linked list, the first
+ *          field of each object is the pointer to the next object.
+ * @note    Required only if @p PORT_SUPPORTS_LLSC is @p TRUE, the function
+ *          must be callable from any context, including fast interrupts,
+ *          and must not be affected by the ABA problem. This is the case
+ *          when the store-conditional fails after any intervening
+ *          interrupt.
+ *
+ * @param[in] p         pointer to the list head
+ * @return              The removed object.
+ * @retval NULL         if the list is empty.
+ */
+void *port_llsc_pop(void * volatile *p) {
+
+  return NULL;
+}
+#endif /* PORT_SUPPORTS_LLSC */
+
+#if PORT_SUPPORTS_RT || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the current value of the realtime counter.
+ * @note    Required only if @p PORT_SUPPORTS_RT is @p TRUE, the function
+ *          must be callable from any context.
+ *
+ * @return              The counter value, it increments at
+ *                      @p PORT_RT_FREQUENCY and wraps at 32 bits.
+ */
+uint32_t port_rt_get_counter_value(void) {
+
+  return 0;
+}
+#endif /* PORT_SUPPORTS_RT */
+
 /** @} */
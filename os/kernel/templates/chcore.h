@@ -114,6 +114,55 @@
  */
 typedef uint8_t stkalign_t;
 
+/**
+ * @brief   Word compare and swap support.
+ * @details If @p TRUE the port implements the @p port_cas() and
+ *          @p port_casp() functions, the kernel uses them for the lock-free
+ *          fast paths of some services. Ports not supporting the operation
+ *          can leave this macro undefined.
+ */
+#define PORT_SUPPORTS_CAS               FALSE
+
+/**
+ * @brief   Double word compare and swap support.
+ * @details If @p TRUE the port implements the @p port_cas2_t type and the
+ *          @p port_cas2() function, the kernel uses them for the lock-free
+ *          variants of some services. Ports not supporting the operation
+ *          can leave this macro undefined.
+ */
+#define PORT_SUPPORTS_CAS2              FALSE
+
+/**
+ * @brief   Load-linked/store-conditional list pop support.
+ * @details If @p TRUE the port implements the @p port_llsc_pop() function,
+ *          the kernel uses it for the lock-free variants of some services
+ *          on architectures lacking a double word compare and swap. Ports
+ *          not supporting the operation can leave this macro undefined.
+ */
+#define PORT_SUPPORTS_LLSC              FALSE
+
+/**
+ * @brief   Double word type used by @p port_cas2().
+ * @details The type must be as wide as two pointers and naturally aligned
+ *          as required by the atomic operation.
+ */
+typedef uint64_t port_cas2_t;
+
+/**
+ * @brief   Realtime counter support.
+ * @details If @p TRUE the port implements @p port_rt_get_counter_value(), a
+ *          free-running 32 bits counter incrementing at
+ *          @p PORT_RT_FREQUENCY. The kernel uses it for high resolution
+ *          timestamps. Ports not supporting the counter can leave this
+ *          macro undefined.
+ */
+#define PORT_SUPPORTS_RT                FALSE
+
+/**
+ * @brief   Realtime counter frequency.
+ */
+#define PORT_RT_FREQUENCY               0
+
 /**
  * @brief   Interrupt saved context.
  * @details This structure represents the stack frame saved during a
@@ -197,6 +246,15 @@ struct context {
  */
 #define PORT_FAST_IRQ_HANDLER(id) void id(void)
 
+/**
+ * @brief   Memory barrier.
+ * @details Orders the memory accesses before the barrier with respect to
+ *          the accesses after it, both for the compiler and the CPU. It is
+ *          used by the lock-free services shared with fast interrupt
+ *          handlers. Ports not defining this macro get an empty default.
+ */
+#define port_memory_barrier()
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -211,6 +269,26 @@ extern "C" {
   void port_wait_for_interrupt(void);
   void port_halt(void);
   void port_switch(Thread *ntp, Thread *otp);
+#if CH_TIMEDELTA > 0
+  void port_timer_start_alarm(systime_t time);
+  void port_timer_stop_alarm(void);
+  void port_timer_set_alarm(systime_t time);
+  systime_t port_timer_get_time(void);
+#endif
+#if PORT_SUPPORTS_CAS
+  bool_t port_cas(volatile cnt_t *p, cnt_t cmp, cnt_t xchg);
+  bool_t port_casp(void * volatile *p, void *cmp, void *xchg);
+#endif
+#if PORT_SUPPORTS_CAS2
+  bool_t port_cas2(volatile port_cas2_t *p, port_cas2_t cmp,
+                   port_cas2_t xchg);
+#endif
+#if PORT_SUPPORTS_LLSC
+  void *port_llsc_pop(void * volatile *p);
+#endif
+#if PORT_SUPPORTS_RT
+  uint32_t port_rt_get_counter_value(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -171,6 +171,12 @@ struct intctx {};
 
 #endif /* defined(__DOXYGEN__) */
 
+/**
+ * @brief   Memory barrier.
+ * @details The @p dmb instruction is available on all the Cortex-M cores.
+ */
+#define port_memory_barrier() asm volatile ("dmb" : : : "memory")
+
 /**
  * @brief   Excludes the default @p chSchIsPreemptionRequired()implementation.
  */
@@ -254,4 +254,36 @@ void _port_thread_start(void) {
                 "bl      chThdExit");
 }
 
+/**
+ * @brief   List pop.
+ * @details Atomically removes the first object of a linked list, the first
+ *          field of each object is the pointer to the next object. The link
+ *          of the first object is read between the @p LDREX and the
+ *          @p STREX instructions, the store fails if the head has been
+ *          written or an exception occurred meanwhile.
+ *
+ * @param[in] p         pointer to the list head
+ * @return              The removed object.
+ * @retval NULL         if the list is empty.
+ */
+void *port_llsc_pop(void * volatile *p) {
+  void *objp, *next;
+  uint32_t failed;
+
+  asm volatile ("1:                                             \n\t"
+                "ldrex   %0, [%3]                               \n\t"
+                "cbz     %0, 2f                                 \n\t"
+                "ldr     %1, [%0]                               \n\t"
+                "strex   %2, %1, [%3]                           \n\t"
+                "cmp     %2, #0                                 \n\t"
+                "bne     1b                                     \n\t"
+                "b       3f                                     \n\t"
+                "2:                                             \n\t"
+                "clrex                                          \n\t"
+                "3:"
+                : "=&l" (objp), "=&r" (next), "=&r" (failed)
+                : "r" (p) : "cc", "memory");
+  return objp;
+}
+
 /** @} */
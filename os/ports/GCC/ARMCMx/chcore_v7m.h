@@ -217,6 +217,23 @@
 #define CH_PORT_INFO                    "Compact kernel mode"
 #endif
 
+/**
+ * @brief   Word compare and swap support.
+ * @details The operation is implemented using the @p LDREX and @p STREX
+ *          instructions, the exclusive monitor is cleared on exception
+ *          entry so the operation is atomic with respect to interrupts.
+ */
+#define PORT_SUPPORTS_CAS               TRUE
+
+/**
+ * @brief   Load-linked/store-conditional list pop support.
+ * @details The operation is implemented using the @p LDREX and @p STREX
+ *          instructions, the exclusive monitor is cleared on exception
+ *          entry so the store fails if the list has been modified by an
+ *          interrupt or another thread meanwhile.
+ */
+#define PORT_SUPPORTS_LLSC              TRUE
+
 /*===========================================================================*/
 /* Port implementation part.                                                 */
 /*===========================================================================*/
@@ -433,6 +450,18 @@ struct context {
  */
 #define port_unlock_from_isr() port_unlock()
 
+/**
+ * @brief   Counter compare and swap.
+ */
+#define port_cas(p, cmp, xchg)                                              \
+  ((bool_t)__sync_bool_compare_and_swap((p), (cmp), (xchg)))
+
+/**
+ * @brief   Pointer compare and swap.
+ */
+#define port_casp(p, cmp, xchg)                                             \
+  ((bool_t)__sync_bool_compare_and_swap((p), (cmp), (xchg)))
+
 /**
  * @brief   Disables all the interrupt sources.
  * @note    Of course non-maskable interrupt sources are not included.
@@ -517,6 +546,7 @@ extern "C" {
   void _port_exit_from_isr(void);
   void _port_switch(Thread *ntp, Thread *otp);
   void _port_thread_start(void);
+  void *port_llsc_pop(void * volatile *p);
 #if !CH_OPTIMIZE_SPEED
   void _port_lock(void);
   void _port_unlock(void);
@@ -26,116 +26,184 @@
 */
 
 /**
- * @file    templates/chcore.c
- * @brief   Port related template code.
- * @details This file is a template of the system driver functions provided by
- *          a port. Some of the following functions may be implemented as
- *          macros in chcore.h if the implementer decides that there is an
- *          advantage in doing so, for example because performance concerns.
- *
- * @addtogroup core
- * @details Non portable code templates.
+ * @addtogroup POSIX_CORE
  * @{
  */
 
+#include <stddef.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+
 #include "ch.h"
+#include "hal.h"
+
+/*
+ * Assembler symbols decoration, Mach-O symbols have a leading underscore.
+ */
+#if defined(__APPLE__)
+#define ASM_SYM(s) "_" #s
+#else
+#define ASM_SYM(s) #s
+#endif
 
 /**
- * @brief   Port-related initialization code.
- * @note    This function is usually empty.
+ * Performs a context switch between two threads.
+ * Only the callee-saved registers of the System V x86-64 ABI are saved, the
+ * stack pointer is stored in the @p p_ctx field of the thread structure.
+ * @param ntp the thread to be switched in, passed in @p rdi
+ * @param otp the thread to be switched out, passed in @p rsi
  */
-void port_init(void) {
+__attribute__((used))
+static void __dummy(void) {
+
+  asm volatile (
+                ".globl " ASM_SYM(port_switch) "                \n\t"
+                ASM_SYM(port_switch) ":                         \n\t"
+                "push    %%rbp                                  \n\t"
+                "push    %%rbx                                  \n\t"
+                "push    %%r12                                  \n\t"
+                "push    %%r13                                  \n\t"
+                "push    %%r14                                  \n\t"
+                "push    %%r15                                  \n\t"
+                "movq    %%rsp, %c0(%%rsi)                      \n\t"
+                "movq    %c0(%%rdi), %%rsp                      \n\t"
+                "pop     %%r15                                  \n\t"
+                "pop     %%r14                                  \n\t"
+                "pop     %%r13                                  \n\t"
+                "pop     %%r12                                  \n\t"
+                "pop     %%rbx                                  \n\t"
+                "pop     %%rbp                                  \n\t"
+                "ret                                            \n\t"
+                : : "i" (offsetof(Thread, p_ctx)));
 }
 
 /**
- * @brief   Kernel-lock action.
- * @details Usually this function just disables interrupts but may perform more
- *          actions.
+ * @brief   Thread start trampoline.
+ * @details The first context switch to a thread lands here, the thread
+ *          function and its argument prepared by @p SETUP_CONTEXT() into
+ *          @p r12 and @p r13 are moved into the argument registers and
+ *          @p _port_thread_entry() is invoked. The stack is 16 bytes aligned
+ *          before the call as required by the ABI.
  */
-void port_lock(void) {
+__attribute__((used))
+static void __dummy2(void) {
+
+  asm volatile (
+                ".globl " ASM_SYM(_port_thread_start) "         \n\t"
+                ASM_SYM(_port_thread_start) ":                  \n\t"
+                "movq    %r12, %rdi                             \n\t"
+                "movq    %r13, %rsi                             \n\t"
+                "call    " ASM_SYM(_port_thread_entry) "        \n\t"
+                "hlt");
 }
 
 /**
- * @brief   Kernel-unlock action.
- * @details Usually this function just enables interrupts but may perform more
- *          actions.
+ * Double word compare and swap.
+ * The double word pointed by @p p is atomically replaced by @p xchg if it
+ * is equal to @p cmp.
+ * @param p pointer to the double word, must be 16 bytes aligned
+ * @param cmp the expected value
+ * @param xchg the new value
+ * @return @p TRUE if the double word has been replaced.
  */
-void port_unlock(void) {
+bool_t port_cas2(volatile port_cas2_t *p, port_cas2_t cmp,
+                 port_cas2_t xchg) {
+  uint64_t lo = (uint64_t)cmp, hi = (uint64_t)(cmp >> 64);
+  uint8_t ok;
+
+  asm volatile ("lock cmpxchg16b %1                             \n\t"
+                "setz    %0"
+                : "=q" (ok), "+m" (*p), "+a" (lo), "+d" (hi)
+                : "b" ((uint64_t)xchg), "c" ((uint64_t)(xchg >> 64))
+                : "cc", "memory");
+  return (bool_t)ok;
+}
+
+#if POSIX_USE_SIGNALS || defined(__DOXYGEN__)
+/*
+ * Masks or unmasks the signals used as simulated interrupt sources.
+ */
+static void irq_mask(int how) {
+  sigset_t set;
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGALRM);
+  sigaddset(&set, SIGIO);
+  sigprocmask(how, &set, NULL);
 }
 
 /**
- * @brief   Kernel-lock action from an interrupt handler.
- * @details This function is invoked before invoking I-class APIs from
- *          interrupt handlers. The implementation is architecture dependent,
- *          in its simplest form it is void.
+ * Kernel-lock action, the simulated interrupt sources are masked.
  */
-void port_lock_from_isr(void) {
+void port_lock(void) {
+
+  irq_mask(SIG_BLOCK);
 }
 
 /**
- * @brief   Kernel-unlock action from an interrupt handler.
- * @details This function is invoked after invoking I-class APIs from interrupt
- *          handlers. The implementation is architecture dependent, in its
- *          simplest form it is void.
+ * Kernel-unlock action, the simulated interrupt sources are unmasked and
+ * the pending signals, if any, are served immediately.
  */
-void port_unlock_from_isr(void) {
+void port_unlock(void) {
+
+  irq_mask(SIG_UNBLOCK);
 }
 
 /**
- * @brief   Disables all the interrupt sources.
- * @note    Of course non-maskable interrupt sources are not included.
+ * Disables all the simulated interrupt sources.
  */
 void port_disable(void) {
+
+  irq_mask(SIG_BLOCK);
 }
 
 /**
- * @brief   Disables the interrupt sources below kernel-level priority.
- * @note    Interrupt sources above kernel level remains enabled.
+ * Disables the simulated interrupt sources, there are no sources above
+ * the kernel level in this simulator.
  */
 void port_suspend(void) {
+
+  irq_mask(SIG_BLOCK);
 }
 
 /**
- * @brief   Enables all the interrupt sources.
+ * Enables all the simulated interrupt sources.
  */
 void port_enable(void) {
+
+  irq_mask(SIG_UNBLOCK);
 }
 
 /**
- * @brief   Enters an architecture-dependent IRQ-waiting mode.
- * @details The function is meant to return when an interrupt becomes pending.
- *          The simplest implementation is an empty function or macro but this
- *          would not take advantage of architecture-specific power saving
- *          modes.
+ * Waits for a simulated interrupt, the process sleeps until a signal is
+ * delivered.
  */
 void port_wait_for_interrupt(void) {
+
+  pause();
 }
+#endif /* POSIX_USE_SIGNALS */
 
 /**
- * @brief   Halts the system.
- * @details This function is invoked by the operating system when an
- *          unrecoverable error is detected (for example because a programming
- *          error in the application code that triggers an assertion while in
- *          debug mode).
+ * Halts the system. In this implementation it just exits the simulation.
  */
 void port_halt(void) {
 
-  port_disable();
-  while (TRUE) {
-  }
+  exit(2);
 }
 
 /**
- * @brief   Performs a context switch between two threads.
- * @details This is the most critical code in any port, this function
- *          is responsible for the context switch between 2 threads.
- * @note    The implementation of this code affects <b>directly</b> the context
- *          switch performance so optimize here as much as you can.
- *
- * @param[in] ntp       the thread to be switched in
- * @param[in] otp       the thread to be switched out
+ * @brief   Start a thread by invoking its work function.
+ * @details If the work function returns @p chThdExit() is automatically
+ *          invoked.
  */
-void port_switch(Thread *ntp, Thread *otp) {
+__attribute__((used, noreturn))
+void _port_thread_entry(msg_t (*pf)(void *), void *p) {
+
+  chSysUnlock();
+  chThdExit(pf(p));
+  while(1);
 }
 
 /** @} */
@@ -26,223 +26,333 @@
 */
 
 /**
- * @file    templates/chcore.h
- * @brief   Port related template macros and structures.
- * @details This file is a template of the system driver macros provided by
- *          a port.
- *
- * @addtogroup core
+ * @addtogroup POSIX_CORE
  * @{
  */
 
 #ifndef _CHCORE_H_
 #define _CHCORE_H_
 
-/*===========================================================================*/
-/* Port constants.                                                           */
-/*===========================================================================*/
-#define SIMULATOR
-
-/*===========================================================================*/
-/* Port macros.                                                              */
-/*===========================================================================*/
+#if CH_DBG_ENABLE_STACK_CHECK
+#error "option CH_DBG_ENABLE_STACK_CHECK not supported by this port"
+#endif
 
-/*===========================================================================*/
-/* Port configurable parameters.                                             */
-/*===========================================================================*/
+#if !defined(__x86_64__)
+#error "this port requires an x86-64 host compiler"
+#endif
 
 /**
- * @brief   Stack size for the system idle thread.
- * @details This size depends on the idle thread implementation, usually
- *          the idle thread should take no more space than those reserved
- *          by @p PORT_INT_REQUIRED_STACK.
+ * @brief   Signals based interrupts simulation.
+ * @details If enabled the simulated interrupt sources are served by host
+ *          signal handlers, @p SIGALRM for the system timer and @p SIGIO for
+ *          the simulated serial ports, preempting the running thread. The
+ *          kernel lock is implemented by masking the signals.
+ *          If disabled the interrupt sources are polled by
+ *          @p ChkIntSources().
+ * @note    In preemptive mode host library functions that are not
+ *          async-signal-safe must not be invoked concurrently by different
+ *          threads unless the kernel is locked.
  */
-#ifndef PORT_IDLE_THREAD_STACK_SIZE
-#define PORT_IDLE_THREAD_STACK_SIZE     0
+#if !defined(POSIX_USE_SIGNALS) || defined(__DOXYGEN__)
+#define POSIX_USE_SIGNALS               FALSE
 #endif
 
 /**
- * @brief   Per-thread stack overhead for interrupts servicing.
- * @details This constant is used in the calculation of the correct working
- *          area size.
- *          This value can be zero on those architecture where there is a
- *          separate interrupt stack and the stack space between @p intctx and
- *          @p extctx is known to be zero.
+ * Enables the simulator specific code in the test suite.
  */
-#ifndef PORT_INT_REQUIRED_STACK
-#define PORT_INT_REQUIRED_STACK         0
+#if !defined(SIMULATOR)
+#define SIMULATOR
 #endif
 
-/*===========================================================================*/
-/* Port derived parameters.                                                  */
-/*===========================================================================*/
-
-/*===========================================================================*/
-/* Port exported info.                                                       */
-/*===========================================================================*/
-
 /**
- * @brief   Unique macro for the implemented architecture.
+ * Macro defining the simulated x86-64 architecture.
  */
-#define CH_ARCHITECTURE_XXX
+#define CH_ARCHITECTURE_SIMX86_64
 
 /**
- * @brief   Name of the implemented architecture.
+ * Name of the implemented architecture.
  */
-#define CH_ARCHITECTURE_NAME            ""
+#define CH_ARCHITECTURE_NAME            "Simulator"
 
 /**
  * @brief   Name of the architecture variant (optional).
  */
-#define CH_ARCHITECTURE_VARIANT_NAME    ""
+#define CH_CORE_VARIANT_NAME            "x86-64 (integer only)"
 
 /**
  * @brief   Name of the compiler supported by this port.
  */
-#define CH_COMPILER_NAME                "GCC"
+#define CH_COMPILER_NAME                "GCC " __VERSION__
 
 /**
  * @brief   Port-specific information string.
  */
-#define CH_PORT_INFO                    ""
+#if POSIX_USE_SIGNALS || defined(__DOXYGEN__)
+#define CH_PORT_INFO                    "Preemption through host signals"
+#else
+#define CH_PORT_INFO                    "No preemption"
+#endif
+
+/**
+ * 16 bytes stack alignment, required by the x86-64 ABI.
+ */
+typedef struct {
+  uint8_t a[16];
+} stkalign_t __attribute__((aligned(16)));
+
+/**
+ * The word compare and swap is implemented using the @p lock @p cmpxchg
+ * instruction.
+ */
+#define PORT_SUPPORTS_CAS               TRUE
+
+/**
+ * The double word compare and swap is implemented using the
+ * @p cmpxchg16b instruction.
+ */
+#define PORT_SUPPORTS_CAS2              TRUE
 
-/*===========================================================================*/
-/* Port implementation part.                                                 */
-/*===========================================================================*/
+/**
+ * Double word type used by @p port_cas2().
+ */
+typedef unsigned __int128 port_cas2_t;
+
+/**
+ * The realtime counter is the simulated microseconds counter of the Posix
+ * HAL.
+ */
+#define PORT_SUPPORTS_RT                TRUE
 
 /**
- * @brief   Base type for stack and memory alignment.
+ * Realtime counter frequency.
  */
-typedef uint8_t stkalign_t;
+#define PORT_RT_FREQUENCY               1000000
 
 /**
- * @brief   Interrupt saved context.
- * @details This structure represents the stack frame saved during a
- *          preemption-capable interrupt handler.
+ * Generic x86-64 register.
+ */
+typedef void *regx86;
+
+/**
+ * Interrupt saved context.
+ * This structure represents the stack frame saved during a preemption-capable
+ * interrupt handler.
  */
 struct extctx {
 };
 
 /**
- * @brief   System saved context.
- * @details This structure represents the inner stack frame during a context
- *          switching.
+ * System saved context.
+ * Only the callee-saved registers of the System V x86-64 ABI are saved,
+ * the return address is the last field.
+ * @note In this simulator the floating point registers are not saved.
  */
 struct intctx {
+  regx86  r15;
+  regx86  r14;
+  regx86  r13;
+  regx86  r12;
+  regx86  rbx;
+  regx86  rbp;
+  regx86  rip;
 };
 
 /**
- * @brief   Platform dependent part of the @p Thread structure.
- * @details This structure usually contains just the saved stack pointer
- *          defined as a pointer to a @p intctx structure.
+ * Platform dependent part of the @p Thread structure.
+ * This structure usually contains just the saved stack pointer defined as a
+ * pointer to a @p intctx structure.
+ * @note The field name is the same of the SIMIA32 port, the simulator demos
+ *       access it.
  */
 struct context {
-  struct intctx *sp;
+  struct intctx volatile *esp;
 };
 
 /**
- * @brief   Platform dependent part of the @p chThdCreateI() API.
- * @details This code usually setup the context switching frame represented
- *          by an @p intctx structure.
+ * Platform dependent part of the @p chThdCreateI() API.
+ * This code usually setup the context switching frame represented by a
+ * @p intctx structure.
+ * The thread function and its argument are passed into @p r12 and @p r13 to
+ * the @p _port_thread_start() trampoline, the frame is placed so that the
+ * stack is 16 bytes aligned when the trampoline performs its call.
  */
-#define SETUP_CONTEXT(workspace, wsize, pf, arg) {                          \
+#define SETUP_CONTEXT(workspace, wsize, pf, arg) {                      \
+  uint8_t *rsp = (uint8_t *)workspace + wsize;                          \
+  rsp = (uint8_t *)((uintptr_t)rsp & ~(uintptr_t)15);                   \
+  rsp -= sizeof(struct intctx);                                         \
+  ((struct intctx *)rsp)->rip = (void *)_port_thread_start;             \
+  ((struct intctx *)rsp)->r12 = (void *)(pf);                           \
+  ((struct intctx *)rsp)->r13 = (void *)(arg);                          \
+  ((struct intctx *)rsp)->r14 = 0;                                      \
+  ((struct intctx *)rsp)->r15 = 0;                                      \
+  ((struct intctx *)rsp)->rbx = 0;                                      \
+  ((struct intctx *)rsp)->rbp = 0;                                      \
+  tp->p_ctx.esp = (struct intctx *)rsp;                                 \
 }
 
 /**
- * @brief   Enforces a correct alignment for a stack area size value.
+ * Stack size for the system idle thread.
  */
-#define STACK_ALIGN(n) ((((n) - 1) | (sizeof(stkalign_t) - 1)) + 1)
+#ifndef PORT_IDLE_THREAD_STACK_SIZE
+#define PORT_IDLE_THREAD_STACK_SIZE     256
+#endif
 
 /**
- * @brief   Computes the thread working area global size.
+ * Per-thread stack overhead for interrupts servicing, it is used in the
+ * calculation of the correct working area size.
+ * It requires stack space because the simulated "interrupt handlers" can
+ * invoke host library functions inside so it better have a lot of space,
+ * the 64 bits host library is greedier than the 32 bits one.
  */
-#define THD_WA_SIZE(n) STACK_ALIGN(sizeof(Thread) +                         \
-                                   sizeof(struct intctx) +                  \
-                                   sizeof(struct extctx) +                  \
+#ifndef PORT_INT_REQUIRED_STACK
+#define PORT_INT_REQUIRED_STACK         32768
+#endif
+
+/**
+ * Enforces a correct alignment for a stack area size value.
+ */
+#define STACK_ALIGN(n) ((((n) - 1) | (sizeof(stkalign_t) - 1)) + 1)
+
+ /**
+  * Computes the thread working area global size.
+  */
+#define THD_WA_SIZE(n) STACK_ALIGN(sizeof(Thread) +                     \
+                                   sizeof(void *) * 4 +                 \
+                                   sizeof(struct intctx) +              \
+                                   sizeof(struct extctx) +              \
                                    (n) + (PORT_INT_REQUIRED_STACK))
 
 /**
- * @brief   Static working area allocation.
- * @details This macro is used to allocate a static thread working area
- *          aligned as both position and size.
+ * Macro used to allocate a thread working area aligned as both position and
+ * size.
  */
 #define WORKING_AREA(s, n) stkalign_t s[THD_WA_SIZE(n) / sizeof(stkalign_t)]
 
 /**
- * @brief   IRQ prologue code.
- * @details This macro must be inserted at the start of all IRQ handlers
- *          enabled to invoke system APIs.
+ * IRQ prologue code, inserted at the start of all IRQ handlers enabled to
+ * invoke system APIs.
  */
 #define PORT_IRQ_PROLOGUE()
 
 /**
- * @brief   IRQ epilogue code.
- * @details This macro must be inserted at the end of all IRQ handlers
- *          enabled to invoke system APIs.
+ * IRQ epilogue code, inserted at the end of all IRQ handlers enabled to
+ * invoke system APIs.
  */
 #define PORT_IRQ_EPILOGUE()
 
 /**
- * @brief   IRQ handler function declaration.
- * @note    @p id can be a function name or a vector number depending on the
- *          port implementation.
+ * IRQ handler function declaration.
  */
 #define PORT_IRQ_HANDLER(id) void id(void)
 
 /**
- * @brief   Fast IRQ handler function declaration.
- * @note    @p id can be a function name or a vector number depending on the
- *          port implementation.
- * @note    Not all architectures support fast interrupts, in this case this
- *          macro must be omitted.
+ * Does nothing in this simulator, the simulated interrupt handlers run
+ * with the interrupt sources already masked.
  */
-#define PORT_FAST_IRQ_HANDLER(id) void id(void)
+#define port_lock_from_isr()
 
 /**
- * @brief   Managed RAM size.
- * @details Size of the RAM area to be managed by the OS. If set to zero
- *          then the whole available RAM is used. The core memory is made
- *          available to the heap allocator and/or can be used directly through
- *          the simplified core memory allocator.
- *
- * @note    In order to let the OS manage the whole RAM the linker script must
- *          provide the @p __heap_base__ and @p __heap_end__ symbols.
- * @note    Requires @p CH_USE_MEMCORE.
+ * Does nothing in this simulator.
  */
-#ifdef CH_MEMCORE_SIZE
- #undef CH_MEMCORE_SIZE
-#endif
-#define CH_MEMCORE_SIZE                 0x40000
+#define port_unlock_from_isr()
 
 /**
- * @brief   Debug option, stack checks.
- * @details If enabled then a runtime stack check is performed.
- *
- * @note    The default is @p FALSE.
- * @note    The stack check is performed in a architecture/port dependent way.
- *          It may not be implemented or some ports.
- * @note    The default failure mode is to halt the system with the global
- *          @p panic_msg variable set to @p NULL.
+ * Simulator initialization, the simulated interrupt sources are setup by
+ * the HAL.
  */
-#ifdef CH_DBG_ENABLE_STACK_CHECK
- #undef CH_DBG_ENABLE_STACK_CHECK
+#define port_init()
+
+#if !POSIX_USE_SIGNALS || defined(__DOXYGEN__)
+/**
+ * Does nothing in this simulator.
+ */
+#define port_lock() asm volatile("nop")
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_unlock() asm volatile("nop")
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_disable()
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_suspend()
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_enable()
+
+/**
+ * In the simulator this does a polling pass on the simulated interrupt
+ * sources.
+ */
+#define port_wait_for_interrupt() ChkIntSources()
+#endif /* !POSIX_USE_SIGNALS */
+
+/*
+ * In tickless mode the alarm and the free-running counter are simulated by
+ * the Posix HAL.
+ */
+#if CH_TIMEDELTA > 0
+#define port_timer_start_alarm(time) hal_lld_start_alarm(time)
+#define port_timer_stop_alarm() hal_lld_stop_alarm()
+#define port_timer_set_alarm(time) hal_lld_start_alarm(time)
+#define port_timer_get_time() hal_lld_get_time()
 #endif
-#define CH_DBG_ENABLE_STACK_CHECK       FALSE
+
+/**
+ * Realtime counter, it is provided by the Posix HAL.
+ */
+#define port_rt_get_counter_value() hal_lld_get_counter_value()
+
+/**
+ * Word compare and swap, atomic with respect to the signal handlers.
+ */
+#define port_cas(p, cmp, xchg)                                              \
+  ((bool_t)__sync_bool_compare_and_swap((p), (cmp), (xchg)))
+
+/**
+ * Pointer compare and swap, atomic with respect to the signal handlers.
+ */
+#define port_casp(p, cmp, xchg)                                             \
+  ((bool_t)__sync_bool_compare_and_swap((p), (cmp), (xchg)))
+
+/**
+ * Full memory barrier.
+ */
+#define port_memory_barrier() __sync_synchronize()
 
 #ifdef __cplusplus
 extern "C" {
 #endif
-  void port_init(void);
+#if POSIX_USE_SIGNALS
   void port_lock(void);
   void port_unlock(void);
-  void port_lock_from_isr(void);
-  void port_unlock_from_isr(void);
   void port_disable(void);
   void port_suspend(void);
   void port_enable(void);
   void port_wait_for_interrupt(void);
-  void port_halt(void);
+#endif
   void port_switch(Thread *ntp, Thread *otp);
+  void port_halt(void);
+  bool_t port_cas2(volatile port_cas2_t *p, port_cas2_t cmp,
+                   port_cas2_t xchg);
+  void _port_thread_start(void);
+  __attribute__((noreturn)) void _port_thread_entry(msg_t (*pf)(void *),
+                                                    void *p);
+  void ChkIntSources(void);
+#if CH_TIMEDELTA > 0
+  void hal_lld_start_alarm(systime_t time);
+  void hal_lld_stop_alarm(void);
+  systime_t hal_lld_get_time(void);
+#endif
+  uint32_t hal_lld_get_counter_value(void);
 #ifdef __cplusplus
 }
 #endif
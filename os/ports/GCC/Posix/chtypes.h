@@ -25,100 +25,26 @@
     for full details of how and when the exception can be applied.
 */
 
-/**
- * @file    templates/chtypes.h
- * @brief   System types template.
- * @details The types defined in this file may change depending on the target
- *          architecture. You may also try to optimize the size of the various
- *          types in order to privilege size or performance, be careful in
- *          doing so.
- *
- * @addtogroup types
- * @details System types and macros.
- * @{
- */
-
 #ifndef _CHTYPES_H_
 #define _CHTYPES_H_
 
-#define __need_NULL
-#define __need_size_t
 #include <stddef.h>
-
-#if !defined(_STDINT_H) && !defined(__STDINT_H_)
 #include <stdint.h>
-#endif
-
-/* Added to make the header stand-alone when included from asm.*/
-#ifndef FALSE
-#define FALSE       0
-#endif
-#ifndef TRUE
-#define TRUE        (!FALSE)
-#endif
-#ifndef true /* FIXME */
-#define true TRUE
-#endif
-
-/**
- * @brief   Boolean, recommended the fastest signed.
- */
-typedef int32_t         bool_t;
-
-/**
- * @brief   Thread mode flags, uint8_t is ok.
- */
-typedef uint8_t         tmode_t;
-
-/**
- * @brief   Thread state, uint8_t is ok.
- */
-typedef uint8_t         tstate_t;
-
-/**
- * @brief   Thread references counter, uint8_t is ok.
- */
-typedef uint8_t         trefs_t;
-
-/**
- * @brief   Thread time slices counter.
- */
-typedef uint8_t         tslices_t;
-
-/**
- * @brief   Priority, use the fastest unsigned type.
- */
-typedef uint32_t        tprio_t;
-
-/**
- * @brief   Message, use signed pointer equivalent.
- */
-typedef int32_t         msg_t;
-
-/**
- * @brief   Event Id, use fastest signed.
- */
-typedef int32_t         eventid_t;
-
-/**
- * @brief   Event Mask, recommended fastest unsigned.
- */
-typedef uint32_t        eventmask_t;
-
-/**
- * @brief   Event flags.
- */
-typedef uint32_t        flagsmask_t;
-
-/**
- * @brief   System Time, recommended fastest unsigned.
- */
-typedef uint32_t        systime_t;
-
-/**
- * @brief   Counter, recommended fastest signed.
- */
-typedef int32_t         cnt_t;
+#include <stdbool.h>
+
+typedef bool            bool_t;         /**< Fast boolean type.             */
+typedef uint8_t         tmode_t;        /**< Thread flags.                  */
+typedef uint8_t         tstate_t;       /**< Thread state.                  */
+typedef uint8_t         trefs_t;        /**< Thread references counter.     */
+typedef uint8_t         tslices_t;      /**< Thread time slices counter.    */
+typedef uint32_t        tprio_t;        /**< Thread priority.               */
+typedef intptr_t        msg_t;          /**< Inter-thread message, it must
+                                             be able to carry a pointer.    */
+typedef int32_t         eventid_t;      /**< Event Id.                      */
+typedef uint32_t        eventmask_t;    /**< Event mask.                    */
+typedef uint32_t        flagsmask_t;    /**< Event flags.                   */
+typedef uint32_t        systime_t;      /**< System time.                   */
+typedef int32_t         cnt_t;          /**< Resources counter.             */
 
 /**
  * @brief   Inline function modifier.
@@ -127,32 +53,26 @@ typedef int32_t         cnt_t;
 
 /**
  * @brief   ROM constant modifier.
- * @note    This is required because some compilers require a custom keyword,
- *          usually this macro is just set to "const" for the GCC compiler.
- * @note    This macro is not used to place constants in different address
- *          spaces (like AVR requires for example) because it is assumed that
- *          a pointer to a ROMCONST constant is compatible with a pointer
- *          to a normal variable. It is just like the "const" keyword but
- *          requires that the constant is placed in ROM if the architecture
- *          supports it.
+ * @note    It is set to use the "const" keyword in this port.
  */
 #define ROMCONST const
 
 /**
  * @brief   Packed structure modifier (within).
+ * @note    It uses the "packed" GCC attribute.
  */
 #define PACK_STRUCT_STRUCT __attribute__((packed))
 
 /**
  * @brief   Packed structure modifier (before).
+ * @note    Empty in this port.
  */
 #define PACK_STRUCT_BEGIN
 
 /**
  * @brief   Packed structure modifier (after).
+ * @note    Empty in this port.
  */
 #define PACK_STRUCT_END
 
 #endif /* _CHTYPES_H_ */
-
-/** @} */
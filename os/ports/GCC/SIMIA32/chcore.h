@@ -69,6 +69,25 @@ typedef struct {
   uint8_t a[16];
 } stkalign_t __attribute__((aligned(16)));
 
+/**
+ * The word compare and swap is implemented using the @p lock @p cmpxchg
+ * instruction.
+ */
+#define PORT_SUPPORTS_CAS               TRUE
+
+#if !defined(_WIN32) || defined(__DOXYGEN__)
+/**
+ * The realtime counter is the simulated microseconds counter of the Posix
+ * HAL, the Win32 HAL does not provide it.
+ */
+#define PORT_SUPPORTS_RT                TRUE
+
+/**
+ * Realtime counter frequency.
+ */
+#define PORT_RT_FREQUENCY               1000000
+#endif
+
 /**
  * Generic x86 register.
  */
@@ -233,6 +252,41 @@ struct context {
  */
 #define port_wait_for_interrupt() ChkIntSources()
 
+/*
+ * In tickless mode the alarm and the free-running counter are simulated by
+ * the Posix HAL.
+ */
+#if CH_TIMEDELTA > 0
+#define port_timer_start_alarm(time) hal_lld_start_alarm(time)
+#define port_timer_stop_alarm() hal_lld_stop_alarm()
+#define port_timer_set_alarm(time) hal_lld_start_alarm(time)
+#define port_timer_get_time() hal_lld_get_time()
+#endif
+
+#if !defined(_WIN32) || defined(__DOXYGEN__)
+/**
+ * Realtime counter, it is provided by the Posix HAL.
+ */
+#define port_rt_get_counter_value() hal_lld_get_counter_value()
+#endif
+
+/**
+ * Word compare and swap.
+ */
+#define port_cas(p, cmp, xchg)                                              \
+  ((bool_t)__sync_bool_compare_and_swap((p), (cmp), (xchg)))
+
+/**
+ * Pointer compare and swap.
+ */
+#define port_casp(p, cmp, xchg)                                             \
+  ((bool_t)__sync_bool_compare_and_swap((p), (cmp), (xchg)))
+
+/**
+ * Full memory barrier.
+ */
+#define port_memory_barrier() __sync_synchronize()
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -241,6 +295,14 @@ extern "C" {
   __attribute__((cdecl, noreturn)) void _port_thread_start(msg_t (*pf)(void *),
                                                            void *p);
   void ChkIntSources(void);
+#if CH_TIMEDELTA > 0
+  void hal_lld_start_alarm(systime_t time);
+  void hal_lld_stop_alarm(void);
+  systime_t hal_lld_get_time(void);
+#endif
+#if !defined(_WIN32)
+  uint32_t hal_lld_get_counter_value(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -31,7 +31,8 @@
 #include "chprintf.h"
 #include "memstreams.h"
 
-#define MAX_FILLER 11
+/* Digits of the longest long, in octal.*/
+#define MAX_FILLER (sizeof(long) > 4 ? 22 : 11)
 #define FLOAT_PRECISION 100000
 
 static char *long_to_string_with_divisor(char *p,
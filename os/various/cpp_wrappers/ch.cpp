@@ -523,6 +523,13 @@ namespace chibios_rt {
     chMtxInit(&mutex);
   }
 
+#if CH_USE_MUTEXES_CEILING
+  Mutex::Mutex(tprio_t ceiling) {
+
+    chMtxInitCeiling(&mutex, ceiling);
+  }
+#endif
+
   bool Mutex::tryLock(void) {
 
     return chMtxTryLock(&mutex);
@@ -591,6 +598,66 @@ namespace chibios_rt {
 #endif /* CH_USE_CONDVARS */
 #endif /* CH_USE_MUTEXES */
 
+#if CH_USE_RWLOCKS
+  /*------------------------------------------------------------------------*
+   * chibios_rt::RWLock                                                     *
+   *------------------------------------------------------------------------*/
+  RWLock::RWLock(void) {
+
+    chRWLockInit(&rwlock);
+  }
+
+  void RWLock::readLock(void) {
+
+    chRWLockReadLock(&rwlock);
+  }
+
+  void RWLock::readLockS(void) {
+
+    chRWLockReadLockS(&rwlock);
+  }
+
+  msg_t RWLock::readLockTimeout(systime_t time) {
+
+    return chRWLockReadLockTimeout(&rwlock, time);
+  }
+
+  void RWLock::readUnlock(void) {
+
+    chRWLockReadUnlock(&rwlock);
+  }
+
+  void RWLock::readUnlockS(void) {
+
+    chRWLockReadUnlockS(&rwlock);
+  }
+
+  void RWLock::writeLock(void) {
+
+    chRWLockWriteLock(&rwlock);
+  }
+
+  void RWLock::writeLockS(void) {
+
+    chRWLockWriteLockS(&rwlock);
+  }
+
+  msg_t RWLock::writeLockTimeout(systime_t time) {
+
+    return chRWLockWriteLockTimeout(&rwlock, time);
+  }
+
+  void RWLock::writeUnlock(void) {
+
+    chRWLockWriteUnlock(&rwlock);
+  }
+
+  void RWLock::writeUnlockS(void) {
+
+    chRWLockWriteUnlockS(&rwlock);
+  }
+#endif /* CH_USE_RWLOCKS */
+
 #if CH_USE_EVENTS
   /*------------------------------------------------------------------------*
    * chibios_rt::EvtListener                                              *
@@ -1159,6 +1159,19 @@ namespace chibios_rt {
      */
     Mutex(void);
 
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+    /**
+     * @brief   Priority ceiling mutex object constructor.
+     * @details The embedded @p ::Mutex structure is initialized with the
+     *          specified priority ceiling.
+     *
+     * @param[in] ceiling   the priority ceiling
+     *
+     * @init
+     */
+    Mutex(tprio_t ceiling);
+#endif
+
     /**
      * @brief   Tries to lock a mutex.
      * @details This function attempts to lock a mutex, if the mutex is already
@@ -1331,6 +1344,132 @@ namespace chibios_rt {
 #endif /* CH_USE_CONDVARS */
 #endif /* CH_USE_MUTEXES */
 
+#if CH_USE_RWLOCKS || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::RWLock                                                     *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating a readers-writer lock.
+   */
+  class RWLock {
+  public:
+    /**
+     * @brief   Embedded @p ::RWLock structure.
+     */
+    ::RWLock rwlock;
+
+    /**
+     * @brief   RWLock object constructor.
+     * @details The embedded @p ::RWLock structure is initialized.
+     *
+     * @init
+     */
+    RWLock(void);
+
+    /**
+     * @brief   Acquires the lock as reader.
+     * @details The invoking thread is queued if the lock is owned by a writer
+     *          or if there are writers waiting for it.
+     *
+     * @api
+     */
+    void readLock(void);
+
+    /**
+     * @brief   Acquires the lock as reader.
+     * @details The invoking thread is queued if the lock is owned by a writer
+     *          or if there are writers waiting for it.
+     *
+     * @sclass
+     */
+    void readLockS(void);
+
+    /**
+     * @brief   Acquires the lock as reader with timeout specification.
+     *
+     * @param[in] time      the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval RDY_OK       if the lock has been acquired.
+     * @retval RDY_TIMEOUT  if the lock has not been acquired within the
+     *                      specified timeout.
+     *
+     * @api
+     */
+    msg_t readLockTimeout(systime_t time);
+
+    /**
+     * @brief   Releases a lock acquired as reader.
+     *
+     * @api
+     */
+    void readUnlock(void);
+
+    /**
+     * @brief   Releases a lock acquired as reader.
+     * @post    This function does not reschedule so a call to a rescheduling
+     *          function must be performed before unlocking the kernel.
+     *
+     * @sclass
+     */
+    void readUnlockS(void);
+
+    /**
+     * @brief   Acquires the lock as writer.
+     * @details The invoking thread is queued if the lock is held by readers
+     *          or by another writer.
+     *
+     * @api
+     */
+    void writeLock(void);
+
+    /**
+     * @brief   Acquires the lock as writer.
+     * @details The invoking thread is queued if the lock is held by readers
+     *          or by another writer.
+     *
+     * @sclass
+     */
+    void writeLockS(void);
+
+    /**
+     * @brief   Acquires the lock as writer with timeout specification.
+     *
+     * @param[in] time      the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval RDY_OK       if the lock has been acquired.
+     * @retval RDY_TIMEOUT  if the lock has not been acquired within the
+     *                      specified timeout.
+     *
+     * @api
+     */
+    msg_t writeLockTimeout(systime_t time);
+
+    /**
+     * @brief   Releases a lock acquired as writer.
+     *
+     * @api
+     */
+    void writeUnlock(void);
+
+    /**
+     * @brief   Releases a lock acquired as writer.
+     * @post    This function does not reschedule so a call to a rescheduling
+     *          function must be performed before unlocking the kernel.
+     *
+     * @sclass
+     */
+    void writeUnlockS(void);
+  };
+#endif /* CH_USE_RWLOCKS */
+
 #if CH_USE_EVENTS || defined(__DOXYGEN__)
   /*------------------------------------------------------------------------*
    * chibios_rt::EvtListener                                                *
@@ -2199,6 +2338,9 @@ namespace chibios_rt {
   public:
     /**
      * @brief   ObjectsPool constructor.
+     * @note    The pool has no memory provider so, when the pools are
+     *          lock-free, objects can be taken and returned from any
+     *          context including fast interrupts.
      *
      * @init
      */
@@ -106,12 +106,119 @@ static void cmd_systime(BaseSequentialStream *chp, int argc, char *argv[]) {
   chprintf(chp, "%lu\r\n", (unsigned long)chTimeNow());
 }
 
+#if (CH_DBG_STATISTICS && CH_USE_REGISTRY) || defined(__DOXYGEN__)
+static void cmd_top(BaseSequentialStream *chp, int argc, char *argv[]) {
+  Thread *tp;
+  thread_stats_t ts;
+  kernel_stats_t ks;
+  uint64_t total;
+  unsigned pm;
+
+  if ((argc > 1) || ((argc == 1) && (strcasecmp(argv[0], "reset") != 0))) {
+    usage(chp, "top [reset]");
+    return;
+  }
+  if (argc == 1) {
+    chRegResetStats();
+    return;
+  }
+
+  /* The total is the sum of the times of the existing threads and of the
+     ISRs, the time of the terminated threads is not included.*/
+  chRegGetKernelStats(&ks);
+  total = ks.ks_isr_time;
+  tp = chRegFirstThread();
+  do {
+    chRegGetThreadStats(tp, &ts);
+    total += ts.ts_runtime;
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+  if (total == 0)
+    total = 1;
+
+  chprintf(chp, "name         prio   switches    time ms   cpu%%"
+               "  max burst us\r\n");
+  tp = chRegFirstThread();
+  do {
+    chRegGetThreadStats(tp, &ts);
+    pm = (unsigned)((ts.ts_runtime * 1000) / total);
+    chprintf(chp, "%-12.12s %4lu %10lu %10lu %4u.%u %13lu\r\n",
+             tp->p_name != NULL ? tp->p_name : "-",
+             (unsigned long)tp->p_prio,
+             (unsigned long)ts.ts_switches,
+             (unsigned long)((ts.ts_runtime * 1000) / PORT_RT_FREQUENCY),
+             pm / 10, pm % 10,
+             (unsigned long)(((uint64_t)ts.ts_worst * 1000000) /
+                             PORT_RT_FREQUENCY));
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+  pm = (unsigned)((ks.ks_isr_time * 1000) / total);
+  chprintf(chp, "%-12.12s      %10lu %10lu %4u.%u\r\n",
+           "ISRs", (unsigned long)ks.ks_isr_count,
+           (unsigned long)((ks.ks_isr_time * 1000) / PORT_RT_FREQUENCY),
+           pm / 10, pm % 10);
+  chprintf(chp, "context switches: %lu\r\n", (unsigned long)ks.ks_switches);
+}
+#endif
+
+#if CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+/*
+ * Converts realtime counter ticks to microseconds.
+ */
+#define RT2US(t) ((unsigned long)(((uint64_t)(t) * 1000000) / PORT_RT_FREQUENCY))
+
+static void cmd_locks(BaseSequentialStream *chp, int argc, char *argv[]) {
+  lock_stats_t *lsp;
+  lock_stats_t ls;
+  Thread *tp;
+  unsigned i;
+
+  if ((argc > 1) || ((argc == 1) && (strcasecmp(argv[0], "reset") != 0))) {
+    usage(chp, "locks [reset]");
+    return;
+  }
+  if (argc == 1) {
+    chDbgResetLockStats();
+    return;
+  }
+  chprintf(chp, "name           acquired  contended    wait us  max wait us"
+               "  max hold us  top waiters\r\n");
+  for (lsp = chDbgLockFirst(); lsp != NULL; lsp = chDbgLockNext(lsp)) {
+    chDbgGetLockStats(lsp, &ls);
+    chprintf(chp, "%-12.12s %10lu %10lu %10lu %12lu %12lu ",
+             ls.ls_name,
+             (unsigned long)ls.ls_acquisitions,
+             (unsigned long)ls.ls_contentions,
+             RT2US(ls.ls_wait_total),
+             RT2US(ls.ls_wait_max),
+             RT2US(ls.ls_hold_max));
+    for (i = 0; (i < LOCK_STATS_WAITERS) &&
+                ((tp = ls.ls_waiters[i].lw_thread) != NULL); i++) {
+#if CH_USE_REGISTRY
+      if (tp->p_name != NULL) {
+        chprintf(chp, " %s", tp->p_name);
+        continue;
+      }
+#endif
+      chprintf(chp, " %.*lx", (int)(sizeof (Thread *) * 2), (unsigned long)tp);
+    }
+    chprintf(chp, "\r\n");
+  }
+}
+#endif
+
 /**
  * @brief   Array of the default commands.
  */
 static ShellCommand local_commands[] = {
   {"info", cmd_info},
   {"systime", cmd_systime},
+#if CH_DBG_STATISTICS && CH_USE_REGISTRY
+  {"top", cmd_top},
+#endif
+#if CH_DBG_LOCK_STATISTICS
+  {"locks", cmd_locks},
+#endif
   {NULL, NULL}
 };
 
@@ -29,14 +29,22 @@
 #include "testthd.h"
 #include "testsem.h"
 #include "testmtx.h"
+#include "testrwl.h"
 #include "testmsg.h"
 #include "testmbox.h"
+#include "testmsgq.h"
 #include "testevt.h"
 #include "testheap.h"
 #include "testpools.h"
 #include "testdyn.h"
 #include "testqueues.h"
+#include "testws.h"
+#include "testring.h"
+#include "testwq.h"
+#include "testtask.h"
+#include "testtrace.h"
 #include "testbmk.h"
+#include "testlat.h"
 
 /*
  * Array of all the test patterns.
@@ -45,14 +53,22 @@ static ROMCONST struct testcase * ROMCONST *patterns[] = {
   patternthd,
   patternsem,
   patternmtx,
+  patternrwl,
   patternmsg,
   patternmbox,
+  patternmsgq,
   patternevt,
   patternheap,
   patternpools,
   patterndyn,
   patternqueues,
+  patternws,
+  patternring,
+  patternwq,
+  patterntasks,
+  patterntrace,
   patternbmk,
+  patternlat,
   NULL
 };
 
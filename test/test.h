@@ -39,6 +39,13 @@
 #define TEST_NO_BENCHMARKS      FALSE
 #endif
 
+/**
+ * @brief   Number of samples collected by each latency benchmark.
+ */
+#if !defined(TEST_LATENCY_SAMPLES) || defined(__DOXYGEN__)
+#define TEST_LATENCY_SAMPLES    10000
+#endif
+
 #define MAX_THREADS             5
 #define MAX_TOKENS              16
 
@@ -46,7 +53,7 @@
 #define THREADS_STACK_SIZE      48
 #elif defined(CH_ARCHITECTURE_STM8)
 #define THREADS_STACK_SIZE      64
-#elif defined(CH_ARCHITECTURE_SIMIA32)
+#elif defined(CH_ARCHITECTURE_SIMIA32) || defined(CH_ARCHITECTURE_SIMX86_64)
 #define THREADS_STACK_SIZE      512
 #else
 #define THREADS_STACK_SIZE      128
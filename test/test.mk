@@ -3,14 +3,22 @@ TESTSRC = ${CHIBIOS}/test/test.c \
           ${CHIBIOS}/test/testthd.c \
           ${CHIBIOS}/test/testsem.c \
           ${CHIBIOS}/test/testmtx.c \
+          ${CHIBIOS}/test/testrwl.c \
           ${CHIBIOS}/test/testmsg.c \
           ${CHIBIOS}/test/testmbox.c \
+          ${CHIBIOS}/test/testmsgq.c \
           ${CHIBIOS}/test/testevt.c \
           ${CHIBIOS}/test/testheap.c \
           ${CHIBIOS}/test/testpools.c \
           ${CHIBIOS}/test/testdyn.c \
           ${CHIBIOS}/test/testqueues.c \
-          ${CHIBIOS}/test/testbmk.c
+          ${CHIBIOS}/test/testws.c \
+          ${CHIBIOS}/test/testring.c \
+          ${CHIBIOS}/test/testwq.c \
+          ${CHIBIOS}/test/testtask.c \
+          ${CHIBIOS}/test/testtrace.c \
+          ${CHIBIOS}/test/testbmk.c \
+          ${CHIBIOS}/test/testlat.c
 
 # Required include directories
 TESTINC = ${CHIBIOS}/test
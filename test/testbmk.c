@@ -15,6 +15,7 @@
 */
 
 #include "ch.h"
+#include "hal.h"
 #include "test.h"
 
 /**
@@ -49,6 +50,16 @@
  * - @subpage test_benchmarks_011
  * - @subpage test_benchmarks_012
  * - @subpage test_benchmarks_013
+ * - @subpage test_benchmarks_014
+ * - @subpage test_benchmarks_015
+ * - @subpage test_benchmarks_016
+ * - @subpage test_benchmarks_017
+ * - @subpage test_benchmarks_018
+ * - @subpage test_benchmarks_019
+ * - @subpage test_benchmarks_020
+ * - @subpage test_benchmarks_021
+ * - @subpage test_benchmarks_022
+ * - @subpage test_benchmarks_023
  * .
  * @file testbmk.c Kernel Benchmarks
  * @brief Kernel Benchmarks source file
@@ -60,6 +71,25 @@ static Semaphore sem1;
 #if CH_USE_MUTEXES || defined(__DOXYGEN__)
 static Mutex mtx1;
 #endif
+#if CH_USE_RWLOCKS || defined(__DOXYGEN__)
+static RWLock rw1;
+#endif
+#if CH_USE_MSGQUEUES || defined(__DOXYGEN__)
+#define MQ_BUFFERS 8
+static MsgQueue mq1, mq2;
+static MemoryPool mp1;
+static struct {
+  MsgHeader     header;
+  msg_t         payload;
+} mq_buffers[MQ_BUFFERS];
+#endif
+#if CH_USE_THREAD_CACHE || (CH_USE_HEAP && !CH_USE_MALLOC_HEAP) ||          \
+    defined(__DOXYGEN__)
+static MemoryHeap heap1;
+#endif
+#if CH_USE_THREAD_CACHE || defined(__DOXYGEN__)
+static ThreadCache tc1;
+#endif
 
 static msg_t thread1(void *p) {
   Thread *tp;
@@ -672,6 +702,11 @@ static void bmk13_execute(void) {
   test_printn(sizeof(CondVar));
   test_println(" bytes");
 #endif
+#if CH_USE_RWLOCKS || defined(__DOXYGEN__)
+  test_print("--- RWLock: ");
+  test_printn(sizeof(RWLock));
+  test_println(" bytes");
+#endif
 #if CH_USE_QUEUES || defined(__DOXYGEN__)
   test_print("--- Queue : ");
   test_printn(sizeof(GenericQueue));
@@ -691,6 +726,652 @@ ROMCONST struct testcase testbmk13 = {
   bmk13_execute
 };
 
+/*
+ * Maximum number of dummy threads that can be placed in the test buffer,
+ * one of them is used as the probe thread.
+ */
+#define RLIST_MAX_THREADS (sizeof(test.buffer) / sizeof(Thread))
+
+/*
+ * Crowds the ready list with the specified number of dummy threads at
+ * priorities lower than the tester thread then measures the ready list
+ * insertion and removal of a probe thread having the lowest priority.
+ * The dummy threads are never executed because the tester thread never
+ * leaves the running state while they are in the ready list.
+ */
+static void rlist_test(unsigned n) {
+  Thread *tp = (Thread *)test.buffer;
+  Thread *probe;
+  tprio_t prio = chThdGetPriority();
+  uint32_t i, cnt;
+
+  if (n > RLIST_MAX_THREADS - 1)
+    n = RLIST_MAX_THREADS - 1;
+  probe = &tp[n];
+  probe->p_prio = LOWPRIO;
+
+  test_wait_tick();
+  chSysLock();
+  for (i = 0; i < n; i++) {
+    tp[i].p_prio = prio - 1 - (tprio_t)(i % (prio - LOWPRIO - 1));
+    tp[i].p_state = THD_STATE_SUSPENDED;
+    chSchReadyI(&tp[i]);
+  }
+  chSysUnlock();
+
+  cnt = 0;
+  test_start_timer(1000);
+  do {
+    chSysLock();
+    probe->p_state = THD_STATE_SUSPENDED;
+    chSchDequeueI(chSchReadyI(probe));
+    probe->p_state = THD_STATE_SUSPENDED;
+    chSchDequeueI(chSchReadyI(probe));
+    probe->p_state = THD_STATE_SUSPENDED;
+    chSchDequeueI(chSchReadyI(probe));
+    probe->p_state = THD_STATE_SUSPENDED;
+    chSchDequeueI(chSchReadyI(probe));
+    chSysUnlock();
+    cnt += 4;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+
+  chSysLock();
+  for (i = 0; i < n; i++)
+    chSchDequeueI(&tp[i]);
+  chSysUnlock();
+
+  test_print("--- Score : ");
+  test_printn(cnt);
+  test_print(" ready+dequeue/S, ");
+  test_printn(n);
+  test_println(" ready threads");
+}
+
+/**
+ * @page test_benchmarks_014 Ready list performance, 4 threads
+ *
+ * <h2>Description</h2>
+ * Four dummy threads with mixed priorities are placed in the ready list,
+ * a lower priority thread is then continuously inserted in and removed from
+ * the ready list.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static void bmk14_execute(void) {
+
+  rlist_test(4);
+}
+
+ROMCONST struct testcase testbmk14 = {
+  "Benchmark, ready list, 4 threads",
+  NULL,
+  NULL,
+  bmk14_execute
+};
+
+/**
+ * @page test_benchmarks_015 Ready list performance, 16 threads
+ *
+ * <h2>Description</h2>
+ * Sixteen dummy threads with mixed priorities are placed in the ready list,
+ * a lower priority thread is then continuously inserted in and removed from
+ * the ready list.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ * @note    The number of threads is limited by the size of the test buffer.
+ */
+
+static void bmk15_execute(void) {
+
+  rlist_test(16);
+}
+
+ROMCONST struct testcase testbmk15 = {
+  "Benchmark, ready list, 16 threads",
+  NULL,
+  NULL,
+  bmk15_execute
+};
+
+/**
+ * @page test_benchmarks_016 Ready list performance, 64 threads
+ *
+ * <h2>Description</h2>
+ * Sixty-four dummy threads with mixed priorities are placed in the ready
+ * list, a lower priority thread is then continuously inserted in and
+ * removed from the ready list.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ * @note    The number of threads is limited by the size of the test buffer.
+ */
+
+static void bmk16_execute(void) {
+
+  rlist_test(64);
+}
+
+ROMCONST struct testcase testbmk16 = {
+  "Benchmark, ready list, 64 threads",
+  NULL,
+  NULL,
+  bmk16_execute
+};
+
+/*
+ * Maximum number of background timers that can be placed in the test
+ * buffer.
+ */
+#define VT_MAX_TIMERS (sizeof(test.buffer) / sizeof(VirtualTimer))
+
+/*
+ * Arms the specified number of long lasting background timers then measures
+ * the set/reset rate of a probe timer.
+ */
+static void vt_sweep_test(unsigned n) {
+  VirtualTimer *vtp = (VirtualTimer *)test.buffer;
+  static VirtualTimer vt;
+  uint32_t i, cnt;
+
+  if (n > VT_MAX_TIMERS)
+    n = VT_MAX_TIMERS;
+
+  test_wait_tick();
+  chSysLock();
+  for (i = 0; i < n; i++)
+    chVTSetI(&vtp[i], S2ST(5) + i, tmo, NULL);
+  chSysUnlock();
+
+  cnt = 0;
+  test_start_timer(1000);
+  do {
+    chSysLock();
+    chVTSetI(&vt, S2ST(10), tmo, NULL);
+    chVTResetI(&vt);
+    chSysUnlock();
+    cnt++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+
+  chSysLock();
+  for (i = 0; i < n; i++)
+    chVTResetI(&vtp[i]);
+  chSysUnlock();
+
+  test_print("--- Score : ");
+  test_printn(cnt);
+  test_print(" timers/S, ");
+  test_printn(n);
+  test_println(" armed");
+}
+
+/**
+ * @page test_benchmarks_017 Virtual Timers sweep
+ *
+ * <h2>Description</h2>
+ * A virtual timer is set and immediately reset into a continuous loop while
+ * 1, 10, 100 and 1000 long lasting timers are armed in background.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations for each step.
+ * @note    The number of background timers is limited by the size of the
+ *          test buffer.
+ */
+
+static void bmk17_execute(void) {
+
+  vt_sweep_test(1);
+  vt_sweep_test(10);
+  vt_sweep_test(100);
+  vt_sweep_test(1000);
+}
+
+ROMCONST struct testcase testbmk17 = {
+  "Benchmark, virtual timers sweep",
+  NULL,
+  NULL,
+  bmk17_execute
+};
+
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_018 Priority ceiling mutexes lock/unlock performance
+ *
+ * <h2>Description</h2>
+ * A priority ceiling mutex is locked/unlocked into a continuous loop, the
+ * figure is meant to be compared with @ref test_benchmarks_012.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static void bmk18_setup(void) {
+
+  chMtxInitCeiling(&mtx1, chThdGetPriority() + 1);
+}
+
+ROMCONST struct testcase testbmk18 = {
+  "Benchmark, mutexes lock/unlock, priority ceiling",
+  bmk18_setup,
+  NULL,
+  bmk12_execute
+};
+
+/**
+ * @page test_benchmarks_019 Mutexes contention, inheritance vs ceiling
+ *
+ * <h2>Description</h2>
+ * The tester thread locks a mutex and wakes an higher priority thread that
+ * tries to lock the same mutex, then unlocks it. The cycle is measured
+ * using a priority inheritance mutex first, then using a priority ceiling
+ * mutex with ceiling equal to the higher priority thread.<br>
+ * With priority inheritance the higher priority thread preempts the owner
+ * and blocks on the mutex, with priority ceiling the owner is not
+ * preempted and the mutex is always found free.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations for each protocol.
+ */
+
+static msg_t thread19(void *p) {
+
+  (void)p;
+  while (TRUE) {
+    chSemWait(&sem1);
+    if (chThdShouldTerminate())
+      break;
+    chMtxLock(&mtx1);
+    chMtxUnlock();
+  }
+  return 0;
+}
+
+static uint32_t mtx_contention_test(void) {
+  uint32_t n = 0;
+
+  chSemInit(&sem1, 0);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority() + 1,
+                                 thread19, NULL);
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chMtxLock(&mtx1);
+    chSemSignal(&sem1);
+    chMtxUnlock();
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_terminate_threads();
+  chSemSignal(&sem1);
+  test_wait_threads();
+  return n;
+}
+
+static void bmk19_execute(void) {
+  uint32_t n;
+
+  chMtxInit(&mtx1);
+  n = mtx_contention_test();
+  test_print("--- Inher.: ");
+  test_printn(n);
+  test_println(" cycles/S");
+
+  chMtxInitCeiling(&mtx1, chThdGetPriority() + 1);
+  n = mtx_contention_test();
+  test_print("--- Ceil. : ");
+  test_printn(n);
+  test_println(" cycles/S");
+}
+
+ROMCONST struct testcase testbmk19 = {
+  "Benchmark, mutexes contention, inheritance vs ceiling",
+  NULL,
+  NULL,
+  bmk19_execute
+};
+#endif /* CH_USE_MUTEXES_CEILING */
+
+#if CH_USE_RWLOCKS || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_020 RW locks read lock/unlock performance
+ *
+ * <h2>Description</h2>
+ * A readers-writer lock is locked/unlocked as reader into a continuous
+ * loop, no Context Switch happens because there are no writers asking for
+ * the lock. The figure is meant to be compared with
+ * @ref test_benchmarks_012.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static void bmk20_setup(void) {
+
+  chRWLockInit(&rw1);
+}
+
+static void bmk20_execute(void) {
+  uint32_t n = 0;
+
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chRWLockReadLock(&rw1);
+    chRWLockReadUnlock(&rw1);
+    chRWLockReadLock(&rw1);
+    chRWLockReadUnlock(&rw1);
+    chRWLockReadLock(&rw1);
+    chRWLockReadUnlock(&rw1);
+    chRWLockReadLock(&rw1);
+    chRWLockReadUnlock(&rw1);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Score : ");
+  test_printn(n * 4);
+  test_println(" lock+unlock/S");
+}
+
+ROMCONST struct testcase testbmk20 = {
+  "Benchmark, RW locks read lock/unlock",
+  bmk20_setup,
+  NULL,
+  bmk20_execute
+};
+#endif /* CH_USE_RWLOCKS */
+
+#if CH_USE_MSGQUEUES || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_021 Message queues performance
+ *
+ * <h2>Description</h2>
+ * A server thread with the same priority of the client thread returns the
+ * requests received from a message queue into a second queue, the client
+ * keeps eight requests in flight. The same buffers are passed back and
+ * forth without copies and the context switches happen once for each
+ * batch of requests. The figure is meant to be compared with
+ * @ref test_benchmarks_001.<br>
+ * The performance is calculated by measuring the number of requests served
+ * after a second of continuous operations.
+ */
+
+static msg_t thread21(void *p) {
+  msg_t *buf;
+
+  (void)p;
+  while (TRUE) {
+    buf = chMsgQFetch(&mq1, TIME_INFINITE);
+    if (*buf == 0)
+      break;
+    chMsgQPost(&mq2, buf);
+  }
+  chMsgBufRelease(buf);
+  return 0;
+}
+
+static void bmk21_setup(void) {
+
+  chMsgQInit(&mq1);
+  chMsgQInit(&mq2);
+  chPoolInit(&mp1, sizeof (mq_buffers[0]), NULL);
+  chPoolLoadArray(&mp1, mq_buffers, MQ_BUFFERS);
+}
+
+static void bmk21_execute(void) {
+  uint32_t n = 0;
+  msg_t *buf;
+  int i;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority(),
+                                 thread21, NULL);
+  for (i = 0; i < MQ_BUFFERS - 1; i++) {
+    buf = chMsgBufAlloc(&mp1);
+    *buf = 1;
+    chMsgQPost(&mq1, buf);
+  }
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chMsgQPost(&mq1, chMsgQFetch(&mq2, TIME_INFINITE));
+    chMsgQPost(&mq1, chMsgQFetch(&mq2, TIME_INFINITE));
+    chMsgQPost(&mq1, chMsgQFetch(&mq2, TIME_INFINITE));
+    chMsgQPost(&mq1, chMsgQFetch(&mq2, TIME_INFINITE));
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  for (i = 0; i < MQ_BUFFERS - 1; i++)
+    chMsgBufRelease(chMsgQFetch(&mq2, TIME_INFINITE));
+  buf = chMsgBufAlloc(&mp1);
+  *buf = 0;
+  chMsgQPost(&mq1, buf);
+  test_wait_threads();
+  test_print("--- Score : ");
+  test_printn(n * 4);
+  test_println(" msgs/S");
+}
+
+ROMCONST struct testcase testbmk21 = {
+  "Benchmark, message queues",
+  bmk21_setup,
+  NULL,
+  bmk21_execute
+};
+#endif /* CH_USE_MSGQUEUES */
+
+#if CH_USE_THREAD_CACHE || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_022 Threads performance, full cycle from cache
+ *
+ * <h2>Description</h2>
+ * Threads are continuously created and terminated into a loop. A full
+ * @p chThdCreateFromCache() / @p chThdExit() / @p chThdWait() cycle is
+ * performed in each iteration, the working area is reused from the cache
+ * after the first iteration. The figure is meant to be compared with
+ * @ref test_benchmarks_005.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static void bmk22_setup(void) {
+
+  chHeapInit(&heap1, test.buffer, sizeof(union test_buffers));
+  chThdCacheInit(&tc1, &heap1, 1);
+}
+
+static void bmk22_execute(void) {
+
+  uint32_t n = 0;
+  tprio_t prio = chThdGetPriority() - 1;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chThdWait(chThdCreateFromCache(&tc1, WA_SIZE, prio, thread2, NULL));
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Score : ");
+  test_printn(n);
+  test_println(" threads/S");
+}
+
+ROMCONST struct testcase testbmk22 = {
+  "Benchmark, threads, full cycle from cache",
+  bmk22_setup,
+  NULL,
+  bmk22_execute
+};
+#endif /* CH_USE_THREAD_CACHE */
+
+#if (CH_USE_HEAP && !CH_USE_MALLOC_HEAP) || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_023 Heap, randomized allocations
+ *
+ * <h2>Description</h2>
+ * A pseudo-random sequence of allocations and releases of blocks of random
+ * size is performed on a local heap for @p BMK23_PERIODS periods of one
+ * second. The fragmentation of the free space is printed in the output log
+ * at the end of each period, in order to show its evolution over time, it
+ * is the fraction of the free space not usable by the largest possible
+ * allocation. The average operations throughput and the worst case
+ * duration of a single allocation and release are printed at the end.<br>
+ * The test expects to find the heap back to the initial status after all
+ * the blocks have been released.
+ */
+
+#define BMK23_SLOTS     32
+#define BMK23_PERIODS   8
+#define BMK23_MAX_SIZE  (sizeof(union test_buffers) / 32)
+
+#if HAL_IMPLEMENTS_COUNTERS
+typedef halrtcnt_t bmk23cnt_t;
+#define bmk23_now()     halGetCounterValue()
+#define BMK23_FREQUENCY halGetCounterFrequency()
+#else
+typedef systime_t bmk23cnt_t;
+#define bmk23_now()     chTimeNow()
+#define BMK23_FREQUENCY CH_FREQUENCY
+#endif
+
+static void *bmk23_slots[BMK23_SLOTS];
+static uint32_t bmk23_seed;
+
+static uint32_t bmk23_rand(void) {
+
+  bmk23_seed = bmk23_seed * 1103515245U + 12345U;
+  return bmk23_seed >> 16;
+}
+
+static uint32_t bmk23_ns(bmk23cnt_t t) {
+
+  return (uint32_t)(((uint64_t)t * 1000000000U) / BMK23_FREQUENCY);
+}
+
+/*
+ * Size of the biggest block that can be allocated from the test heap.
+ */
+static size_t bmk23_largest(void) {
+  size_t lo = 0, hi = sizeof(union test_buffers), mid;
+  void *p;
+
+  while (lo < hi) {
+    mid = hi - (hi - lo) / 2;
+    p = chHeapAlloc(&heap1, mid);
+    if (p != NULL) {
+      chHeapFree(p);
+      lo = mid;
+    }
+    else
+      hi = mid - 1;
+  }
+  return lo;
+}
+
+/*
+ * Prints the fragmentation of the test heap with the blocks still
+ * allocated.
+ */
+static void bmk23_print_frag(unsigned period) {
+  size_t freesz, largest, nfrags;
+
+  nfrags = chHeapStatus(&heap1, &freesz);
+  largest = bmk23_largest();
+  test_print("--- Frag. ");
+  test_printn(period);
+  test_print(" : ");
+  test_printn((uint32_t)nfrags);
+  test_print(" fragments, ");
+  test_printn(freesz > 0 ? (uint32_t)((freesz - largest) * 100 / freesz) : 0);
+  test_println("% unusable");
+}
+
+static void bmk23_setup(void) {
+
+  chHeapInit(&heap1, test.buffer, sizeof(union test_buffers));
+}
+
+static void bmk23_execute(void) {
+  bmk23cnt_t start, t, walloc, wfree;
+  uint32_t n, failures;
+  size_t sz, freesz;
+  unsigned i, period;
+
+  for (i = 0; i < BMK23_SLOTS; i++)
+    bmk23_slots[i] = NULL;
+  (void)chHeapStatus(&heap1, &sz);
+  bmk23_seed = 0x12345678;
+  walloc = wfree = 0;
+  n = failures = 0;
+
+  for (period = 1; period <= BMK23_PERIODS; period++) {
+    test_wait_tick();
+    test_start_timer(1000);
+    do {
+      i = bmk23_rand() % BMK23_SLOTS;
+      if (bmk23_slots[i] == NULL) {
+        size_t size = bmk23_rand() % BMK23_MAX_SIZE + 1;
+
+        start = bmk23_now();
+        bmk23_slots[i] = chHeapAlloc(&heap1, size);
+        t = bmk23_now() - start;
+        if (t > walloc)
+          walloc = t;
+        if (bmk23_slots[i] == NULL)
+          failures++;
+      }
+      else {
+        start = bmk23_now();
+        chHeapFree(bmk23_slots[i]);
+        t = bmk23_now() - start;
+        if (t > wfree)
+          wfree = t;
+        bmk23_slots[i] = NULL;
+      }
+      n++;
+#if defined(SIMULATOR)
+      ChkIntSources();
+#endif
+    } while (!test_timer_done);
+
+    /* Fragmentation measured with the last blocks still allocated.*/
+    bmk23_print_frag(period);
+  }
+
+  for (i = 0; i < BMK23_SLOTS; i++)
+    if (bmk23_slots[i] != NULL)
+      chHeapFree(bmk23_slots[i]);
+
+  test_print("--- Score : ");
+  test_printn(n / BMK23_PERIODS);
+  test_print(" ops/S, ");
+  test_printn(failures);
+  test_println(" failed");
+  test_print("--- Worst : ");
+  test_printn(bmk23_ns(walloc));
+  test_print(" nS alloc, ");
+  test_printn(bmk23_ns(wfree));
+  test_println(" nS free");
+
+  test_assert(1, chHeapStatus(&heap1, &freesz) == 1, "heap fragmented");
+  test_assert(2, freesz == sz, "size changed");
+}
+
+ROMCONST struct testcase testbmk23 = {
+  "Benchmark, heap, randomized allocations",
+  bmk23_setup,
+  NULL,
+  bmk23_execute
+};
+#endif /* CH_USE_HEAP && !CH_USE_MALLOC_HEAP */
+
 /**
  * @brief   Test sequence for benchmarks.
  */
@@ -715,6 +1396,26 @@ ROMCONST struct testcase * ROMCONST patternbmk[] = {
   &testbmk12,
 #endif
   &testbmk13,
+  &testbmk14,
+  &testbmk15,
+  &testbmk16,
+  &testbmk17,
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+  &testbmk18,
+  &testbmk19,
+#endif
+#if CH_USE_RWLOCKS || defined(__DOXYGEN__)
+  &testbmk20,
+#endif
+#if CH_USE_MSGQUEUES || defined(__DOXYGEN__)
+  &testbmk21,
+#endif
+#if CH_USE_THREAD_CACHE || defined(__DOXYGEN__)
+  &testbmk22,
+#endif
+#if (CH_USE_HEAP && !CH_USE_MALLOC_HEAP) || defined(__DOXYGEN__)
+  &testbmk23,
+#endif
 #endif
   NULL
 };
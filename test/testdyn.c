@@ -34,6 +34,8 @@
  * - @p CH_USE_DYNAMIC
  * - @p CH_USE_HEAP
  * - @p CH_USE_MEMPOOLS
+ * - @p CH_USE_THREAD_CACHE
+ * - @p CH_USE_REGISTRY_INDEX
  * .
  * In case some of the required options are not enabled then some or all tests
  * may be skipped.
@@ -42,6 +44,8 @@
  * - @subpage test_dynamic_001
  * - @subpage test_dynamic_002
  * - @subpage test_dynamic_003
+ * - @subpage test_dynamic_004
+ * - @subpage test_dynamic_005
  * .
  * @file testdyn.c
  * @brief Dynamic thread APIs test source file
@@ -56,6 +60,9 @@ static MemoryHeap heap1;
 #if CH_USE_MEMPOOLS || defined(__DOXYGEN__)
 static MemoryPool mp1;
 #endif
+#if CH_USE_THREAD_CACHE || defined(__DOXYGEN__)
+static ThreadCache tc1;
+#endif
 
 /**
  * @page test_dynamic_001 Threads creation from Memory Heap
@@ -242,6 +249,134 @@ ROMCONST struct testcase testdyn3 = {
   dyn3_execute
 };
 #endif /* CH_USE_HEAP && CH_USE_REGISTRY */
+
+#if CH_USE_THREAD_CACHE || defined(__DOXYGEN__)
+/**
+ * @page test_dynamic_004 Threads creation from Thread Cache
+ *
+ * <h2>Description</h2>
+ * Two threads are started from a thread cache able to retain a single
+ * working area, a third thread is started after the first two terminated
+ * then the cache is flushed.<br>
+ * The test expects the third thread to reuse one of the working areas
+ * released by the first two threads and the heap to be restored to its
+ * initial state after the flush.
+ */
+
+static void dyn4_setup(void) {
+
+  chHeapInit(&heap1, test.buffer, sizeof(union test_buffers));
+  chThdCacheInit(&tc1, &heap1, 1);
+}
+
+static void dyn4_execute(void) {
+  size_t n, sz;
+  Thread *tpa, *tpb;
+  tprio_t prio = chThdGetPriority();
+
+  (void)chHeapStatus(&heap1, &sz);
+  /* Starting threads from the cache, the working areas are allocated from
+     the heap.*/
+  tpa = threads[0] = chThdCreateFromCache(&tc1, WA_SIZE, prio-1, thread, "A");
+  tpb = threads[1] = chThdCreateFromCache(&tc1, WA_SIZE, prio-2, thread, "B");
+  test_assert(1, (threads[0] != NULL) && (threads[1] != NULL),
+                 "thread creation failed");
+
+  /* Claiming the memory from terminated threads, only one working area is
+     retained by the cache.*/
+  test_wait_threads();
+  test_assert_sequence(2, "AB");
+  test_assert(3, chThdCacheGetCountI(&tc1) == 1, "wrong cached count");
+
+  /* The third thread reuses the cached working area.*/
+  threads[2] = chThdCreateFromCache(&tc1, WA_SIZE, prio-3, thread, "C");
+  test_assert(4, (threads[2] == tpa) || (threads[2] == tpb),
+                 "working area not reused");
+  test_assert(5, chThdCacheGetCountI(&tc1) == 0, "wrong cached count");
+  test_wait_threads();
+  test_assert_sequence(6, "C");
+  test_assert(7, chThdCacheGetCountI(&tc1) == 1, "wrong cached count");
+
+  /* Flushing the cache, the heap must be restored.*/
+  chThdCacheFlush(&tc1);
+  test_assert(8, chThdCacheGetCountI(&tc1) == 0, "cache not empty");
+  test_assert(9, chHeapStatus(&heap1, &n) == 1, "heap fragmented");
+  test_assert(10, n == sz, "heap size changed");
+}
+
+ROMCONST struct testcase testdyn4 = {
+  "Dynamic APIs, threads creation from thread cache",
+  dyn4_setup,
+  NULL,
+  dyn4_execute
+};
+#endif /* CH_USE_THREAD_CACHE */
+
+#if CH_USE_REGISTRY_INDEX || defined(__DOXYGEN__)
+/**
+ * @page test_dynamic_005 Registry index
+ *
+ * <h2>Description</h2>
+ * A named thread is started then it is looked up by identifier and by
+ * name, the lookups are repeated after the thread termination and after
+ * the creation of a new thread in the same working area.<br>
+ * The test expects the lookups to find the thread only while it is in the
+ * registry and the new thread to be assigned a different identifier.
+ */
+
+static msg_t thread5(void *p) {
+
+  chRegSetThreadName(p);
+  while (!chThdShouldTerminate())
+    chThdSleepMilliseconds(1);
+  return 0;
+}
+
+static void dyn5_execute(void) {
+  Thread *tp;
+  tid_t id;
+  tprio_t prio = chThdGetPriority();
+
+  /* The thread is started at higher priority so that its name is set.*/
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread5, "dyn5");
+  id = chRegGetThreadId(threads[0]);
+  test_assert(1, id != 0, "thread not indexed");
+
+  /* Lookups.*/
+  tp = chRegFindThreadById(id);
+  test_assert(2, tp == threads[0], "lookup by identifier failed");
+  chThdRelease(tp);
+  tp = chRegFindThreadByName("dyn5");
+  test_assert(3, tp == threads[0], "lookup by name failed");
+  chThdRelease(tp);
+  test_assert(4, chRegFindThreadByName("dyn") == NULL, "unexpected thread");
+  test_assert(5, chRegFindThreadById(id + REG_INDEX_SIZE) == NULL,
+              "identifier sequence ignored");
+
+  /* The terminated thread is no more found.*/
+  chThdTerminate(threads[0]);
+  test_wait_threads();
+  test_assert(6, chRegFindThreadById(id) == NULL, "thread still indexed");
+  test_assert(7, chRegFindThreadByName("dyn5") == NULL, "name still hashed");
+
+  /* A new thread in the same working area gets a new identifier.*/
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread5, "dyn5");
+  test_assert(8, chRegGetThreadId(threads[0]) != id, "identifier reused");
+  test_assert(9, chRegFindThreadById(id) == NULL, "stale identifier found");
+  tp = chRegFindThreadByName("dyn5");
+  test_assert(10, tp == threads[0], "lookup by name failed");
+  chThdRelease(tp);
+  chThdTerminate(threads[0]);
+  test_wait_threads();
+}
+
+ROMCONST struct testcase testdyn5 = {
+  "Dynamic APIs, registry index",
+  NULL,
+  NULL,
+  dyn5_execute
+};
+#endif /* CH_USE_REGISTRY_INDEX */
 #endif /* CH_USE_DYNAMIC */
 
 /**
@@ -259,6 +394,12 @@ ROMCONST struct testcase * ROMCONST patterndyn[] = {
     defined(__DOXYGEN__)
   &testdyn3,
 #endif
+#if CH_USE_THREAD_CACHE || defined(__DOXYGEN__)
+  &testdyn4,
+#endif
+#if CH_USE_REGISTRY_INDEX || defined(__DOXYGEN__)
+  &testdyn5,
+#endif
 #endif
   NULL
 };
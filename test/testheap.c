@@ -37,6 +37,7 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage test_heap_001
+ * - @subpage test_heap_002
  * .
  * @file testheap.c
  * @brief Heap test source file
@@ -146,6 +147,105 @@ ROMCONST struct testcase testheap1 = {
   heap1_execute
 };
 
+/**
+ * @page test_heap_002 Core memory regions
+ *
+ * <h2>Description</h2>
+ * Two core memory regions are registered over static buffers, the test
+ * verifies the lookup by name, the blocks alignment and placement, the
+ * exhaustion of a region and the binding of a heap and of a memory pool
+ * to a region.
+ */
+
+#define REGION_SIZE     256
+#define REGION_ALIGN    32
+
+static stkalign_t fast_buffer[REGION_SIZE / sizeof(stkalign_t)];
+static stkalign_t slow_buffer[REGION_SIZE / sizeof(stkalign_t)];
+static MemoryRegion fast_region;
+static MemoryRegion slow_region;
+
+static CORE_REGION_PROVIDER(slow_provider, &slow_region)
+#if CH_USE_MEMPOOLS
+static CORE_REGION_PROVIDER_I(fast_provider, &fast_region)
+#endif
+
+static bool_t in_buffer(void *p, stkalign_t *buf) {
+
+  return (bool_t)(((uint8_t *)p >= (uint8_t *)buf) &&
+                  ((uint8_t *)p < (uint8_t *)buf + REGION_SIZE));
+}
+
+static void heap2_setup(void) {
+
+  /* The fast region base is misaligned on purpose.*/
+  chCoreRegionInit(&fast_region, "fast", (uint8_t *)fast_buffer + 1,
+                   REGION_SIZE - 1, REGION_ALIGN);
+  chCoreRegionInit(&slow_region, "slow", slow_buffer, REGION_SIZE,
+                   MEM_ALIGN_SIZE);
+}
+
+static void heap2_execute(void) {
+  void *p1, *p2;
+  size_t n;
+
+  /* Lookup.*/
+  test_assert(1, chCoreGetRegion("fast") == &fast_region, "not found");
+  test_assert(2, chCoreGetRegion("slow") == &slow_region, "not found");
+  test_assert(3, chCoreGetRegion(CORE_DEFAULT_REGION_NAME) != NULL,
+              "not found");
+  test_assert(4, chCoreGetRegion("fas") == NULL, "found");
+  test_assert(5, chCoreGetRegion("faster") == NULL, "found");
+
+  /* Alignment and placement.*/
+  p1 = chCoreAllocFrom(&fast_region, 1);
+  p2 = chCoreAllocFrom(&fast_region, 1);
+  test_assert(6, in_buffer(p1, fast_buffer) && in_buffer(p2, fast_buffer),
+              "out of region");
+  test_assert(7, (((size_t)p1 & (REGION_ALIGN - 1)) == 0) &&
+                 ((uint8_t *)p2 == (uint8_t *)p1 + REGION_ALIGN),
+              "misaligned");
+
+  /* Exhaustion.*/
+  n = 2;
+  while (chCoreAllocFrom(&fast_region, 1) != NULL)
+    n++;
+  test_assert(8, n >= REGION_SIZE / REGION_ALIGN - 1, "region too small");
+  test_assert(9, chCoreRegionStatus(&fast_region) < REGION_ALIGN,
+              "not exhausted");
+
+  /* Heap bound to a region.*/
+  chHeapInitProvider(&test_heap, slow_provider);
+  p1 = chHeapAlloc(&test_heap, SIZE);
+  test_assert(10, in_buffer(p1, slow_buffer), "out of region");
+  chHeapFree(p1);
+  p2 = chHeapAlloc(&test_heap, SIZE);
+  test_assert(11, p2 == p1, "block not reused");
+  chHeapFree(p2);
+
+#if CH_USE_MEMPOOLS
+  /* Memory pool bound to a region.*/
+  chCoreRegionInit(&fast_region, "fast", fast_buffer, REGION_SIZE,
+                   REGION_ALIGN);
+  {
+    MemoryPool mp;
+
+    chPoolInit(&mp, SIZE, fast_provider);
+    p1 = chPoolAlloc(&mp);
+    test_assert(12, in_buffer(p1, fast_buffer) &&
+                    (((size_t)p1 & (REGION_ALIGN - 1)) == 0),
+                "out of region");
+  }
+#endif
+}
+
+ROMCONST struct testcase testheap2 = {
+  "Heap, core memory regions",
+  heap2_setup,
+  NULL,
+  heap2_execute
+};
+
 #endif /* CH_USE_HEAP.*/
 
 /**
@@ -154,6 +254,7 @@ ROMCONST struct testcase testheap1 = {
 ROMCONST struct testcase * ROMCONST patternheap[] = {
 #if (CH_USE_HEAP && !CH_USE_MALLOC_HEAP) || defined(__DOXYGEN__)
   &testheap1,
+  &testheap2,
 #endif
   NULL
 };
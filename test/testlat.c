@@ -0,0 +1,590 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_latency Latency Benchmarks
+ *
+ * File: @ref testlat.c
+ *
+ * <h2>Description</h2>
+ * This module implements a series of latency benchmarks. Each benchmark
+ * repeats a kernel operation @p TEST_LATENCY_SAMPLES times, the duration of
+ * each single operation is measured using the port realtime counter and
+ * accumulated into an histogram.<br>
+ * The distribution is reported as 50th, 99th and 99.9th percentiles and
+ * worst case, all values are expressed in nanoseconds and are upper bounds
+ * with the resolution of the realtime counter: a measure of N counter
+ * ticks is reported as N + 1 ticks, so an operation shorter than one tick
+ * is reported as one tick and not as zero. Each benchmark prints two
+ * result lines meant to be extracted from the test log by host tools:
+ * - <tt>--- JSON: {"name":...,"samples":...,"p50_ns":...,"p99_ns":...,
+ *   "p999_ns":...,"max_ns":...}</tt>
+ * - <tt>--- CSV : name,samples,p50_ns,p99_ns,p999_ns,max_ns</tt>
+ * .
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to provide the worst case figures of the
+ * most critical system paths, the throughput benchmarks in
+ * @ref test_benchmarks only report average figures.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires a port supporting the realtime counter
+ * (@p PORT_SUPPORTS_RT) and the following kernel options:
+ * - @p CH_USE_SEMAPHORES
+ * - @p CH_USE_MUTEXES
+ * - @p CH_USE_MAILBOXES
+ * - @p CH_USE_HEAP
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_latency_001
+ * - @subpage test_latency_002
+ * - @subpage test_latency_003
+ * - @subpage test_latency_004
+ * - @subpage test_latency_005
+ * - @subpage test_latency_006
+ * .
+ * @file testlat.c Latency Benchmarks
+ * @brief Latency Benchmarks source file
+ * @file testlat.h
+ * @brief Latency Benchmarks header file
+ */
+
+#if (!TEST_NO_BENCHMARKS && defined(PORT_SUPPORTS_RT) && PORT_SUPPORTS_RT) || \
+    defined(__DOXYGEN__)
+
+/*
+ * Histogram layout, values below LAT_LINEAR are counted exactly, larger
+ * values are grouped in LAT_SUBBUCKETS buckets for each power of two so the
+ * relative error is bounded to 1/LAT_SUBBUCKETS.
+ */
+#define LAT_SUBBITS     3
+#define LAT_SUBBUCKETS  (1U << LAT_SUBBITS)
+#define LAT_LINEAR      (2U << LAT_SUBBITS)
+#define LAT_BUCKETS     (LAT_LINEAR + (32U - (LAT_SUBBITS + 1U)) * LAT_SUBBUCKETS)
+
+static struct {
+  uint32_t          n;
+  uint32_t          max;
+  uint32_t          counts[LAT_BUCKETS];
+} hist;
+
+/*
+ * Start time of the operation being measured, it is written by the tester
+ * thread when the measure is closed by another thread.
+ */
+static volatile uint32_t lat_start;
+
+#if CH_USE_SEMAPHORES || defined(__DOXYGEN__)
+static Semaphore sem1, sem2;
+#endif
+#if CH_USE_MUTEXES || defined(__DOXYGEN__)
+static Mutex mtx1;
+#endif
+
+static uint32_t lat_now(void) {
+
+  return (uint32_t)port_rt_get_counter_value();
+}
+
+static unsigned lat_bucket(uint32_t v) {
+  unsigned msb;
+
+  if (v < LAT_LINEAR)
+    return (unsigned)v;
+  msb = 31;
+  while ((v & (1U << msb)) == 0)
+    msb--;
+  return LAT_LINEAR + (msb - (LAT_SUBBITS + 1)) * LAT_SUBBUCKETS +
+         ((v >> (msb - LAT_SUBBITS)) & (LAT_SUBBUCKETS - 1));
+}
+
+static uint32_t lat_bucket_limit(unsigned b) {
+  unsigned shift;
+
+  if (b < LAT_LINEAR)
+    return (uint32_t)b;
+  b -= LAT_LINEAR;
+  shift = b / LAT_SUBBUCKETS + 1;
+  return ((LAT_SUBBUCKETS + (b % LAT_SUBBUCKETS)) << shift) |
+         ((1U << shift) - 1);
+}
+
+static void lat_reset(void) {
+  unsigned i;
+
+  hist.n = 0;
+  hist.max = 0;
+  for (i = 0; i < LAT_BUCKETS; i++)
+    hist.counts[i] = 0;
+}
+
+/*
+ * Closes a measure started at the specified time.
+ */
+static void lat_record(uint32_t start) {
+  uint32_t d = lat_now() - start;
+
+  hist.n++;
+  if (d > hist.max)
+    hist.max = d;
+  hist.counts[lat_bucket(d)]++;
+}
+
+/*
+ * Returns the value, in counter ticks, below which the specified fraction,
+ * in thousandths, of the samples falls. The upper limit of the bucket is
+ * returned so the figure is never optimistic.
+ */
+static uint32_t lat_percentile(uint32_t permille) {
+  uint32_t rank = (uint32_t)(((uint64_t)hist.n * permille + 999) / 1000);
+  uint32_t acc = 0, limit;
+  unsigned b;
+
+  for (b = 0; b < LAT_BUCKETS; b++) {
+    acc += hist.counts[b];
+    if ((acc > 0) && (acc >= rank))
+      break;
+  }
+  limit = lat_bucket_limit(b);
+  return limit < hist.max ? limit : hist.max;
+}
+
+/*
+ * Converts a measure in counter ticks into an upper bound in nanoseconds, the
+ * measured operation can be up to one tick longer than the ticks count.
+ */
+static uint32_t lat_ns(uint32_t ticks) {
+
+  return (uint32_t)((((uint64_t)ticks + 1) * 1000000000U) /
+                    PORT_RT_FREQUENCY);
+}
+
+static void lat_print_field(const char *name, uint32_t n) {
+
+  test_print(",\"");
+  test_print(name);
+  test_print("\":");
+  test_printn(n);
+}
+
+/*
+ * Prints the distribution in the JSON and CSV formats.
+ */
+static void lat_print(const char *name) {
+  uint32_t p50 = lat_ns(lat_percentile(500));
+  uint32_t p99 = lat_ns(lat_percentile(990));
+  uint32_t p999 = lat_ns(lat_percentile(999));
+  uint32_t max = lat_ns(hist.max);
+
+  test_print("--- JSON: {\"name\":\"");
+  test_print(name);
+  test_print("\"");
+  lat_print_field("samples", hist.n);
+  lat_print_field("p50_ns", p50);
+  lat_print_field("p99_ns", p99);
+  lat_print_field("p999_ns", p999);
+  lat_print_field("max_ns", max);
+  test_println("}");
+
+  test_print("--- CSV : ");
+  test_print(name);
+  test_print(",");
+  test_printn(hist.n);
+  test_print(",");
+  test_printn(p50);
+  test_print(",");
+  test_printn(p99);
+  test_print(",");
+  test_printn(p999);
+  test_print(",");
+  test_printn(max);
+  test_println("");
+}
+
+static void lat_setup(void) {
+
+  lat_reset();
+#if CH_USE_SEMAPHORES || defined(__DOXYGEN__)
+  chSemInit(&sem1, 0);
+  chSemInit(&sem2, 0);
+#endif
+#if CH_USE_MUTEXES || defined(__DOXYGEN__)
+  chMtxInit(&mtx1);
+#endif
+}
+
+/**
+ * @page test_latency_001 Context switch latency
+ *
+ * <h2>Description</h2>
+ * A thread is created that just performs a @p chSchGoSleepS() into a loop,
+ * the tester thread wakes it up and the time between the wakeup and the
+ * thread resuming execution is measured.
+ */
+
+static msg_t thread1(void *p) {
+  Thread *self = chThdSelf();
+
+  (void)p;
+  chSysLock();
+  while (TRUE) {
+    chSchGoSleepS(THD_STATE_SUSPENDED);
+    if (self->p_u.rdymsg != RDY_OK)
+      break;
+    lat_record(lat_start);
+  }
+  chSysUnlock();
+  return 0;
+}
+
+static void lat1_execute(void) {
+  Thread *tp;
+  unsigned i;
+
+  tp = threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()+1,
+                                      thread1, NULL);
+  test_wait_tick();
+  for (i = 0; i < TEST_LATENCY_SAMPLES; i++) {
+    chSysLock();
+    lat_start = lat_now();
+    chSchWakeupS(tp, RDY_OK);
+    chSysUnlock();
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  chSysLock();
+  chSchWakeupS(tp, RDY_TIMEOUT);
+  chSysUnlock();
+  test_wait_threads();
+
+  test_assert(1, hist.n == TEST_LATENCY_SAMPLES, "missing samples");
+  lat_print("ctxsw");
+}
+
+ROMCONST struct testcase testlat1 = {
+  "Latency, context switch",
+  lat_setup,
+  NULL,
+  lat1_execute
+};
+
+#if CH_USE_SEMAPHORES || defined(__DOXYGEN__)
+/**
+ * @page test_latency_002 Semaphores ping-pong latency
+ *
+ * <h2>Description</h2>
+ * A thread is created that waits on a semaphore and signals a second
+ * semaphore back, the round trip time of the exchange is measured by the
+ * tester thread.
+ */
+
+static msg_t thread2(void *p) {
+
+  (void)p;
+  while (TRUE) {
+    chSemWait(&sem1);
+    if (chThdShouldTerminate())
+      break;
+    chSemSignal(&sem2);
+  }
+  return 0;
+}
+
+static void lat2_execute(void) {
+  uint32_t start;
+  unsigned i;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()+1,
+                                 thread2, NULL);
+  test_wait_tick();
+  for (i = 0; i < TEST_LATENCY_SAMPLES; i++) {
+    start = lat_now();
+    chSemSignal(&sem1);
+    chSemWait(&sem2);
+    lat_record(start);
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  test_terminate_threads();
+  chSemSignal(&sem1);
+  test_wait_threads();
+
+  test_assert(1, hist.n == TEST_LATENCY_SAMPLES, "missing samples");
+  lat_print("sem_pingpong");
+}
+
+ROMCONST struct testcase testlat2 = {
+  "Latency, semaphores ping-pong",
+  lat_setup,
+  NULL,
+  lat2_execute
+};
+#endif /* CH_USE_SEMAPHORES */
+
+#if (CH_USE_MUTEXES && CH_USE_SEMAPHORES) || defined(__DOXYGEN__)
+/**
+ * @page test_latency_003 Mutexes handoff latency
+ *
+ * <h2>Description</h2>
+ * A thread is created that blocks on a mutex owned by the tester thread,
+ * the time between the release of the mutex and the waiting thread
+ * resuming as the new owner is measured.
+ */
+
+static msg_t thread3(void *p) {
+
+  (void)p;
+  while (TRUE) {
+    chSemWait(&sem1);
+    if (chThdShouldTerminate())
+      break;
+    chMtxLock(&mtx1);
+    lat_record(lat_start);
+    chMtxUnlock();
+  }
+  return 0;
+}
+
+static void lat3_execute(void) {
+  unsigned i;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()+1,
+                                 thread3, NULL);
+  test_wait_tick();
+  for (i = 0; i < TEST_LATENCY_SAMPLES; i++) {
+    chMtxLock(&mtx1);
+    chSemSignal(&sem1);
+    lat_start = lat_now();
+    chMtxUnlock();
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  test_terminate_threads();
+  chSemSignal(&sem1);
+  test_wait_threads();
+
+  test_assert(1, hist.n == TEST_LATENCY_SAMPLES, "missing samples");
+  lat_print("mtx_handoff");
+}
+
+ROMCONST struct testcase testlat3 = {
+  "Latency, mutexes handoff",
+  lat_setup,
+  NULL,
+  lat3_execute
+};
+#endif /* CH_USE_MUTEXES && CH_USE_SEMAPHORES */
+
+#if CH_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @page test_latency_004 Mailboxes round trip latency
+ *
+ * <h2>Description</h2>
+ * A thread is created that fetches messages from a mailbox and posts them
+ * back into a second mailbox, the round trip time of a message is measured
+ * by the tester thread.
+ */
+
+static msg_t mb1_buf[1], mb2_buf[1];
+static MAILBOX_DECL(mb1, mb1_buf, 1);
+static MAILBOX_DECL(mb2, mb2_buf, 1);
+
+static msg_t thread4(void *p) {
+  msg_t msg;
+
+  (void)p;
+  while (TRUE) {
+    (void)chMBFetch(&mb1, &msg, TIME_INFINITE);
+    if (msg == 0)
+      break;
+    (void)chMBPost(&mb2, msg, TIME_INFINITE);
+  }
+  return 0;
+}
+
+static void lat4_setup(void) {
+
+  lat_reset();
+  chMBReset(&mb1);
+  chMBReset(&mb2);
+}
+
+static void lat4_execute(void) {
+  uint32_t start;
+  msg_t msg;
+  unsigned i;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()+1,
+                                 thread4, NULL);
+  test_wait_tick();
+  for (i = 0; i < TEST_LATENCY_SAMPLES; i++) {
+    start = lat_now();
+    (void)chMBPost(&mb1, 1, TIME_INFINITE);
+    (void)chMBFetch(&mb2, &msg, TIME_INFINITE);
+    lat_record(start);
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  (void)chMBPost(&mb1, 0, TIME_INFINITE);
+  test_wait_threads();
+
+  test_assert(1, hist.n == TEST_LATENCY_SAMPLES, "missing samples");
+  lat_print("mbox_roundtrip");
+}
+
+ROMCONST struct testcase testlat4 = {
+  "Latency, mailboxes round trip",
+  lat4_setup,
+  NULL,
+  lat4_execute
+};
+#endif /* CH_USE_MAILBOXES */
+
+/**
+ * @page test_latency_005 Virtual Timers set/reset latency
+ *
+ * <h2>Description</h2>
+ * A virtual timer is set and immediately reset while a second timer is
+ * armed, the time of each set/reset pair is measured.
+ */
+
+static void tmo(void *param) {(void)param;}
+
+static void lat5_execute(void) {
+  static VirtualTimer vt1, vt2;
+  uint32_t start;
+  unsigned i;
+
+  chVTSet(&vt2, 10000, tmo, NULL);
+  test_wait_tick();
+  for (i = 0; i < TEST_LATENCY_SAMPLES; i++) {
+    chSysLock();
+    start = lat_now();
+    chVTSetI(&vt1, 1, tmo, NULL);
+    chVTResetI(&vt1);
+    lat_record(start);
+    chSysUnlock();
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  chVTReset(&vt2);
+
+  test_assert(1, hist.n == TEST_LATENCY_SAMPLES, "missing samples");
+  lat_print("vt_setreset");
+}
+
+ROMCONST struct testcase testlat5 = {
+  "Latency, virtual timers set/reset",
+  lat_setup,
+  NULL,
+  lat5_execute
+};
+
+#if CH_USE_HEAP || defined(__DOXYGEN__)
+/**
+ * @page test_latency_006 Heap allocation/free latency
+ *
+ * <h2>Description</h2>
+ * A block is allocated and freed from a partially fragmented heap, the time
+ * of each allocation/free pair is measured.
+ */
+
+static MemoryHeap test_heap;
+
+static void lat6_setup(void) {
+
+  lat_reset();
+  chHeapInit(&test_heap, test.buffer, sizeof(union test_buffers));
+}
+
+static void lat6_execute(void) {
+  void *p1, *p2, *p3, *p;
+  uint32_t start;
+  unsigned i;
+
+  /* Leaving an hole at the start of the heap.*/
+  p1 = chHeapAlloc(&test_heap, 16);
+  p2 = chHeapAlloc(&test_heap, 64);
+  p3 = chHeapAlloc(&test_heap, 16);
+  test_assert(1, (p1 != NULL) && (p2 != NULL) && (p3 != NULL),
+              "allocation failed");
+  chHeapFree(p1);
+
+  test_wait_tick();
+  p = NULL;
+  for (i = 0; i < TEST_LATENCY_SAMPLES; i++) {
+    start = lat_now();
+    p = chHeapAlloc(&test_heap, 32);
+    if (p == NULL)
+      break;
+    chHeapFree(p);
+    lat_record(start);
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  chHeapFree(p2);
+  chHeapFree(p3);
+
+  test_assert(2, p != NULL, "allocation failed");
+  test_assert(3, hist.n == TEST_LATENCY_SAMPLES, "missing samples");
+  lat_print("heap_allocfree");
+}
+
+ROMCONST struct testcase testlat6 = {
+  "Latency, heap allocation/free",
+  lat6_setup,
+  NULL,
+  lat6_execute
+};
+#endif /* CH_USE_HEAP */
+
+#endif /* !TEST_NO_BENCHMARKS && PORT_SUPPORTS_RT */
+
+/**
+ * @brief   Test sequence for latency benchmarks.
+ */
+ROMCONST struct testcase * ROMCONST patternlat[] = {
+#if (!TEST_NO_BENCHMARKS && defined(PORT_SUPPORTS_RT) && PORT_SUPPORTS_RT) || \
+    defined(__DOXYGEN__)
+  &testlat1,
+#if CH_USE_SEMAPHORES || defined(__DOXYGEN__)
+  &testlat2,
+#endif
+#if (CH_USE_MUTEXES && CH_USE_SEMAPHORES) || defined(__DOXYGEN__)
+  &testlat3,
+#endif
+#if CH_USE_MAILBOXES || defined(__DOXYGEN__)
+  &testlat4,
+#endif
+  &testlat5,
+#if CH_USE_HEAP || defined(__DOXYGEN__)
+  &testlat6,
+#endif
+#endif
+  NULL
+};
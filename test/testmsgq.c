@@ -0,0 +1,232 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_msgq Message Queues test
+ *
+ * File: @ref testmsgq.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref msgqueues
+ * subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref msgqueues code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_USE_MSGQUEUES
+ * - @p CH_USE_MSGQUEUES_PRIORITY (test case #2)
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_msgq_001
+ * - @subpage test_msgq_002
+ * - @subpage test_msgq_003
+ * .
+ * @file testmsgq.c
+ * @brief Message Queues test source file
+ * @file testmsgq.h
+ * @brief Message Queues test header file
+ */
+
+#if CH_USE_MSGQUEUES || defined(__DOXYGEN__)
+
+#define ALLOWED_DELAY MS2ST(5)
+#define MQ_BUFFERS    4
+
+static MsgQueue mq1;
+static MemoryPool mp1;
+static struct {
+  MsgHeader     header;
+  char          payload;
+} buffers[MQ_BUFFERS];
+
+static void msgq_setup(void) {
+
+  chMsgQInit(&mq1);
+  chPoolInit(&mp1, sizeof (buffers[0]), NULL);
+  chPoolLoadArray(&mp1, buffers, MQ_BUFFERS);
+}
+
+/*
+ * Allocates a buffer and writes a character in the payload.
+ */
+static char *msgq_alloc(char c) {
+  char *buf = chMsgBufAlloc(&mp1);
+
+  if (buf != NULL)
+    *buf = c;
+  return buf;
+}
+
+/**
+ * @page test_msgq_001 Queue and pool operations
+ *
+ * <h2>Description</h2>
+ * All the buffers of the pool are allocated and posted, the allocation of
+ * one more buffer is expected to fail. The buffers are then fetched and
+ * are expected to be the same buffers in FIFO order, after the release
+ * the pool is expected to be full again.
+ */
+
+static void msgq1_execute(void) {
+  char *bufs[MQ_BUFFERS], *buf;
+  int i;
+
+  for (i = 0; i < MQ_BUFFERS; i++) {
+    bufs[i] = msgq_alloc('A' + i);
+    test_assert(1, bufs[i] != NULL, "allocation failed");
+    chMsgQPost(&mq1, bufs[i]);
+  }
+  test_assert(2, chMsgBufAlloc(&mp1) == NULL, "pool not empty");
+  test_assert(3, chMsgQGetUsedCountI(&mq1) == MQ_BUFFERS, "wrong count");
+
+  for (i = 0; i < MQ_BUFFERS; i++) {
+    buf = chMsgQFetch(&mq1, TIME_IMMEDIATE);
+    test_assert(4, buf == bufs[i], "wrong buffer");
+    test_emit_token(*buf);
+    chMsgBufRelease(buf);
+  }
+  test_assert_sequence(5, "ABCD");
+  test_assert(6, chMsgQFetch(&mq1, TIME_IMMEDIATE) == NULL, "not empty");
+  chSysLock();
+  buf = chMsgQFetchI(&mq1);
+  chSysUnlock();
+  test_assert(7, buf == NULL, "not empty");
+
+  for (i = 0; i < MQ_BUFFERS; i++)
+    test_assert(8, (bufs[i] = chMsgBufAlloc(&mp1)) != NULL, "pool not full");
+  for (i = 0; i < MQ_BUFFERS; i++)
+    chMsgBufRelease(bufs[i]);
+}
+
+ROMCONST struct testcase testmsgq1 = {
+  "Message queues, queue and pool operations",
+  msgq_setup,
+  NULL,
+  msgq1_execute
+};
+
+#if CH_USE_MSGQUEUES_PRIORITY || defined(__DOXYGEN__)
+/**
+ * @page test_msgq_002 Priority delivery
+ *
+ * <h2>Description</h2>
+ * Buffers with different priorities are posted, the messages are expected
+ * to be fetched in priority order and in FIFO order for equal priorities.
+ */
+
+static void msgq2_execute(void) {
+  static const tprio_t prios[MQ_BUFFERS] = {
+    NORMALPRIO, NORMALPRIO + 2, NORMALPRIO + 1, NORMALPRIO + 2
+  };
+  char *buf;
+  int i;
+
+  for (i = 0; i < MQ_BUFFERS; i++) {
+    buf = msgq_alloc('A' + i);
+    chMsgBufSetPriority(buf, prios[i]);
+    chMsgQPost(&mq1, buf);
+  }
+  while ((buf = chMsgQFetch(&mq1, TIME_IMMEDIATE)) != NULL) {
+    test_emit_token(*buf);
+    chMsgBufRelease(buf);
+  }
+  test_assert_sequence(1, "BDCA");
+}
+
+ROMCONST struct testcase testmsgq2 = {
+  "Message queues, priority delivery",
+  msgq_setup,
+  NULL,
+  msgq2_execute
+};
+#endif /* CH_USE_MSGQUEUES_PRIORITY */
+
+/**
+ * @page test_msgq_003 Transfer between threads
+ *
+ * <h2>Description</h2>
+ * A receiver thread fetches messages with a timeout and releases the
+ * buffers, the tester thread posts a message before and a message after
+ * the receiver timeout. The posts are expected to not block the tester
+ * and the receiver is expected to get the messages and the timeout in the
+ * correct order.
+ */
+
+static msg_t thread3(void *p) {
+  char *buf;
+  int i;
+
+  (void)p;
+  for (i = 0; i < 2; i++) {
+    buf = chMsgQFetch(&mq1, MS2ST(20));
+    if (buf == NULL)
+      test_emit_token('T');
+    else {
+      test_emit_token(*buf);
+      chMsgBufRelease(buf);
+    }
+  }
+  buf = chMsgQFetch(&mq1, TIME_INFINITE);
+  test_emit_token(*buf);
+  chMsgBufRelease(buf);
+  return 0;
+}
+
+static void msgq3_execute(void) {
+  systime_t target_time;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()-1,
+                                 thread3, NULL);
+  test_wait_tick();
+  target_time = chTimeNow();
+  chMsgQPost(&mq1, msgq_alloc('A'));
+  test_assert_time_window(1, target_time, target_time + ALLOWED_DELAY);
+  chThdSleepMilliseconds(40);
+  chMsgQPost(&mq1, msgq_alloc('B'));
+  test_wait_threads();
+  test_assert_sequence(2, "ATB");
+}
+
+ROMCONST struct testcase testmsgq3 = {
+  "Message queues, transfer between threads",
+  msgq_setup,
+  NULL,
+  msgq3_execute
+};
+
+#endif /* CH_USE_MSGQUEUES */
+
+/**
+ * @brief   Test sequence for message queues.
+ */
+ROMCONST struct testcase * ROMCONST patternmsgq[] = {
+#if CH_USE_MSGQUEUES || defined(__DOXYGEN__)
+  &testmsgq1,
+#if CH_USE_MSGQUEUES_PRIORITY || defined(__DOXYGEN__)
+  &testmsgq2,
+#endif
+  &testmsgq3,
+#endif
+  NULL
+};
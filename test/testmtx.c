@@ -36,6 +36,9 @@
  * - @p CH_USE_MUTEXES
  * - @p CH_USE_CONDVARS
  * - @p CH_DBG_THREADS_PROFILING
+ * - @p CH_USE_MUTEXES_CEILING
+ * - @p CH_DBG_LOCK_STATISTICS
+ * - @p CH_DBG_DEADLOCK_DETECTION
  * .
  * In case some of the required options are not enabled then some or all tests
  * may be skipped.
@@ -49,6 +52,10 @@
  * - @subpage test_mtx_006
  * - @subpage test_mtx_007
  * - @subpage test_mtx_008
+ * - @subpage test_mtx_009
+ * - @subpage test_mtx_010
+ * - @subpage test_mtx_011
+ * - @subpage test_mtx_012
  * .
  * @file testmtx.c
  * @brief Mutexes and CondVars test source file
@@ -612,6 +619,305 @@ ROMCONST struct testcase testmtx8 = {
   mtx8_execute
 };
 #endif /* CH_USE_CONDVARS */
+
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @page test_mtx_009 Priority ceiling
+ *
+ * <h2>Description</h2>
+ * The tester thread locks priority ceiling mutexes, nested with normal
+ * mutexes, using all the lock and unlock variants. A thread with priority
+ * equal to the ceiling is created while the mutex is owned.<br>
+ * The test expects the tester thread to run at the ceiling priority while
+ * owning the mutex and the created thread to not preempt it before the
+ * mutex is released.
+ */
+
+static void mtx9_setup(void) {
+
+  chMtxInitCeiling(&m1, chThdGetPriority() + 2);
+  chMtxInit(&m2);
+}
+
+static msg_t thread9(void *p) {
+
+  test_emit_token(*(char *)p);
+  return 0;
+}
+
+static void mtx9_execute(void) {
+  tprio_t prio = chThdGetPriority();
+  bool_t b;
+
+  chMtxLock(&m1);
+  test_assert(1, chThdGetPriority() == prio + 2, "not at ceiling");
+  chMtxLock(&m2);
+  test_assert(2, chThdGetPriority() == prio + 2, "not at ceiling");
+  chMtxUnlock();
+  test_assert(3, chThdGetPriority() == prio + 2, "not at ceiling");
+  chMtxUnlock();
+  test_assert(4, chThdGetPriority() == prio, "wrong priority level");
+
+  /* Nested the other way around, the unlock recalculates the priority from
+     the mutexes still owned.*/
+  chMtxLock(&m2);
+  b = chMtxTryLock(&m1);
+  test_assert(5, b, "already locked");
+  test_assert(6, chThdGetPriority() == prio + 2, "not at ceiling");
+  chSysLock();
+  chMtxUnlockS();
+  chSysUnlock();
+  test_assert(7, chThdGetPriority() == prio, "wrong priority level");
+  chMtxUnlock();
+
+  chMtxLock(&m1);
+  chMtxUnlockAll();
+  test_assert(8, chThdGetPriority() == prio, "wrong priority level");
+  test_assert(9, m1.m_owner == NULL, "still owned");
+
+  /* The thread at ceiling priority cannot preempt the mutex owner.*/
+  chMtxLock(&m1);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio + 2, thread9, "B");
+  test_emit_token('A');
+  chMtxUnlock();
+  test_assert_sequence(10, "AB");
+  test_assert(11, chThdGetPriority() == prio, "wrong priority level");
+}
+
+ROMCONST struct testcase testmtx9 = {
+  "Mutexes, priority ceiling",
+  mtx9_setup,
+  NULL,
+  mtx9_execute
+};
+
+/**
+ * @page test_mtx_010 Priority ceiling, contention
+ *
+ * <h2>Description</h2>
+ * The tester thread locks a priority ceiling mutex then sleeps, a lower
+ * priority thread tries to lock the same mutex and is queued.<br>
+ * The test expects the mutex to be handed off to the queued thread on
+ * unlock, the new owner must be raised to the ceiling and must return to
+ * its base priority on unlock.
+ */
+
+static msg_t thread13(void *p) {
+  tprio_t prio = chThdGetPriority();
+
+  (void)p;
+  chMtxLock(&m1);
+  test_emit_token(chThdGetPriority() == m1.m_ceiling ? 'A' : 'X');
+  chMtxUnlock();
+  test_emit_token(chThdGetPriority() == prio ? 'B' : 'Y');
+  return 0;
+}
+
+static void mtx10_execute(void) {
+  tprio_t prio = chThdGetPriority();
+
+  chMtxLock(&m1);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio + 1, thread13, NULL);
+  chThdSleepMilliseconds(50);
+  test_assert(1, !isempty(&m1.m_queue), "not queued");
+  test_assert(2, chThdGetPriority() == prio + 2, "not at ceiling");
+  chMtxUnlock();
+  test_assert(3, chThdGetPriority() == prio, "wrong priority level");
+  test_wait_threads();
+  test_assert_sequence(4, "AB");
+}
+
+ROMCONST struct testcase testmtx10 = {
+  "Mutexes, priority ceiling, contention",
+  mtx9_setup,
+  NULL,
+  mtx10_execute
+};
+#endif /* CH_USE_MUTEXES_CEILING */
+
+#if CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @page test_mtx_011 Lock statistics
+ *
+ * <h2>Description</h2>
+ * A named mutex is locked once without contention then it is locked again
+ * and a higher priority thread is queued on it while the tester thread
+ * sleeps.<br>
+ * The test expects the acquisitions, the contention and the waiting thread
+ * to be recorded, the mutex to be in the named locks list and the
+ * statistics to be cleared by a new initialization.
+ */
+
+static const char m1_name[] = "m1";
+
+static void mtx11_setup(void) {
+
+  chMtxInit(&m1);
+  chMtxSetName(&m1, m1_name);
+}
+
+static void mtx11_teardown(void) {
+
+  chDbgLockUnregister(&m1.m_stats);
+}
+
+static void mtx11_execute(void) {
+  lock_stats_t ls, *lsp;
+  Thread *tp;
+  tprio_t prio = chThdGetPriority();
+
+  chMtxLock(&m1);
+  chMtxUnlock();
+  chMtxLock(&m1);
+  tp = threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread1, "A");
+  chThdSleepMilliseconds(10);
+  chMtxUnlock();
+  test_wait_threads();
+  test_assert_sequence(1, "A");
+
+  chDbgGetLockStats(&m1.m_stats, &ls);
+  test_assert(2, ls.ls_acquisitions == 3, "wrong acquisitions count");
+  test_assert(3, ls.ls_contentions == 1, "wrong contentions count");
+  test_assert(4, (ls.ls_wait_max > 0) && (ls.ls_wait_total == ls.ls_wait_max),
+              "wrong wait time");
+  test_assert(5, ls.ls_hold_max > 0, "wrong hold time");
+  test_assert(6, (ls.ls_waiters[0].lw_thread == tp) &&
+                 (ls.ls_waiters[0].lw_time == ls.ls_wait_max),
+              "waiter not recorded");
+#if LOCK_STATS_WAITERS > 1
+  test_assert(7, ls.ls_waiters[1].lw_thread == NULL, "unexpected waiter");
+#endif
+
+  /* The mutex is found in the named locks list.*/
+  lsp = chDbgLockFirst();
+  while ((lsp != NULL) && (lsp != &m1.m_stats))
+    lsp = chDbgLockNext(lsp);
+  test_assert(8, lsp != NULL, "mutex not listed");
+
+  /* A new initialization clears the statistics, the name is retained.*/
+  chMtxInit(&m1);
+  chDbgGetLockStats(&m1.m_stats, &ls);
+  test_assert(9, (ls.ls_acquisitions == 0) && (ls.ls_contentions == 0) &&
+                 (ls.ls_waiters[0].lw_thread == NULL),
+              "statistics not cleared");
+  test_assert(10, ls.ls_name == m1_name, "name lost");
+}
+
+ROMCONST struct testcase testmtx11 = {
+  "Mutexes, lock statistics",
+  mtx11_setup,
+  mtx11_teardown,
+  mtx11_execute
+};
+#endif /* CH_DBG_LOCK_STATISTICS */
+
+#if CH_DBG_DEADLOCK_DETECTION || defined(__DOXYGEN__)
+/**
+ * @page test_mtx_012 Deadlock and priority inversion detection
+ *
+ * <h2>Description</h2>
+ * The tester thread locks a mutex then a higher priority thread locks a
+ * second mutex and is queued on the first one, the tester thread is boosted
+ * by the priority inheritance.<br>
+ * The test expects a wait of the tester thread on the second mutex to be
+ * detected as a deadlock with the whole cycle reported, then the boost is
+ * held for longer than the threshold and the tester thread is expected to
+ * be reported as a priority inversion before it unlocks the first mutex.<br>
+ * Finally the tester thread locks a priority ceiling mutex then a second
+ * mutex, a higher priority thread waits on the second mutex. The boost is
+ * expected to end when the ceiling mutex is unlocked and no inversion is
+ * expected to be reported after the threshold.
+ */
+
+static void mtx12_setup(void) {
+
+  chMtxInit(&m1);
+  chMtxInit(&m2);
+}
+
+static msg_t thread14(void *p) {
+
+  chMtxLock(&m2);
+  chMtxLock(&m1);
+  test_emit_token(*(char *)p);
+  chMtxUnlock();
+  chMtxUnlock();
+  return 0;
+}
+
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+static msg_t thread15(void *p) {
+
+  chMtxLock(&m2);
+  test_emit_token(*(char *)p);
+  chMtxUnlock();
+  return 0;
+}
+#endif
+
+static void mtx12_execute(void) {
+  deadlock_report_t dr;
+  bool_t b;
+  Thread *tp, *ctp = chThdSelf();
+  cnt_t inversions = dbg_inversions;
+  tprio_t prio = chThdGetPriority();
+
+  chMtxLock(&m1);
+  chSysLock();
+  b = chDbgCheckDeadlockS(&m2, &dr);
+  chSysUnlock();
+  test_assert(1, !b, "unexpected deadlock");
+
+  tp = threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread14, "A");
+  test_assert(2, chThdGetPriority() == prio+1, "not boosted");
+  chSysLock();
+  b = chDbgCheckDeadlockS(&m2, &dr);
+  chSysUnlock();
+  test_assert(3, b, "deadlock not detected");
+  test_assert(4, (dr.dr_length == 2) &&
+                 (dr.dr_threads[0] == ctp) && (dr.dr_mutexes[0] == &m2) &&
+                 (dr.dr_threads[1] == tp) && (dr.dr_mutexes[1] == &m1),
+              "wrong cycle");
+
+  /* The boost is reported while it is still active.*/
+  chThdSleep(CH_INVERSION_THRESHOLD + MS2ST(10));
+  test_assert(5, dbg_inversions == inversions + 1, "inversion not detected");
+  test_assert(6, (dbg_inversion_thread == ctp) &&
+                 (dbg_inversion_time >= CH_INVERSION_THRESHOLD),
+              "wrong inversion");
+  chMtxUnlock();
+  test_wait_threads();
+  test_assert_sequence(7, "A");
+  test_assert(8, chThdGetPriority() == prio, "wrong priority");
+  test_assert(9, dbg_inversions == inversions + 1, "inversion reported twice");
+
+#if CH_USE_MUTEXES_CEILING
+  /* The boost ends when the ceiling mutex is unlocked with no waiters.*/
+  chMtxInitCeiling(&m1, prio+1);
+  chMtxInit(&m2);
+  chMtxLock(&m1);
+  chMtxLock(&m2);
+  chThdCreateStatic(wa[0], WA_SIZE, prio+2, thread15, "B");
+  test_assert(10, chThdGetPriority() == prio+2, "not boosted");
+  chMtxUnlock();
+  test_assert(11, chThdGetPriority() == prio+1, "wrong priority");
+  chMtxUnlock();
+  test_wait_threads();
+  test_assert_sequence(12, "B");
+  test_assert(13, chThdGetPriority() == prio, "wrong priority");
+  test_assert(14, ctp->p_boosted == THD_BOOST_NONE, "boost not ended");
+  chThdSleep(CH_INVERSION_THRESHOLD + MS2ST(10));
+  test_assert(15, dbg_inversions == inversions + 1, "unexpected inversion");
+#endif
+}
+
+ROMCONST struct testcase testmtx12 = {
+  "Mutexes, deadlock and priority inversion detection",
+  mtx12_setup,
+  NULL,
+  mtx12_execute
+};
+#endif /* CH_DBG_DEADLOCK_DETECTION */
 #endif /* CH_USE_MUTEXES */
 
 /**
@@ -631,6 +937,16 @@ ROMCONST struct testcase * ROMCONST patternmtx[] = {
   &testmtx7,
   &testmtx8,
 #endif
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+  &testmtx9,
+  &testmtx10,
+#endif
+#if CH_DBG_LOCK_STATISTICS || defined(__DOXYGEN__)
+  &testmtx11,
+#endif
+#if CH_DBG_DEADLOCK_DETECTION || defined(__DOXYGEN__)
+  &testmtx12,
+#endif
 #endif
   NULL
 };
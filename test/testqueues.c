@@ -43,6 +43,7 @@
  * <h2>Test Cases</h2>
  * - @subpage test_queues_001
  * - @subpage test_queues_002
+ * - @subpage test_queues_003
  * .
  * @file testqueues.c
  * @brief I/O Queues test source file
@@ -230,6 +231,99 @@ ROMCONST struct testcase testqueues2 = {
   NULL,
   queues2_execute
 };
+
+/**
+ * @page test_queues_003 Queues block and span APIs
+ *
+ * <h2>Description</h2>
+ * This test case tests the I-class block operations and the contiguous
+ * span accessors of @p InputQueue and @p OutputQueue objects, including
+ * transfers wrapping around the end of the queue buffer.
+ */
+
+static void queues3_setup(void) {
+
+  chIQInit(&iq, wa[0], TEST_QUEUES_SIZE, notify, NULL);
+  chOQInit(&oq, wa[1], TEST_QUEUES_SIZE, notify, NULL);
+}
+
+static void queues3_execute(void) {
+  uint8_t buf[TEST_QUEUES_SIZE * 2];
+  uint8_t *p;
+  size_t i, n, span;
+
+  /* Input queue, block write wrapping around the buffer end.*/
+  chSysLock();
+  n = chIQWriteI(&iq, (const uint8_t *)"ABC", 3);
+  chSysUnlock();
+  test_assert(1, n == 3, "wrong returned size");
+  n = chIQReadTimeout(&iq, buf, 2, TIME_IMMEDIATE);
+  test_assert(2, n == 2, "wrong returned size");
+  chSysLock();
+  n = chIQWriteI(&iq, (const uint8_t *)"DEFG", 4);
+  chSysUnlock();
+  test_assert(3, n == 3, "overflow not detected");
+  n = chIQReadTimeout(&iq, buf, sizeof buf, TIME_IMMEDIATE);
+  test_assert(4, n == TEST_QUEUES_SIZE, "wrong returned size");
+  for (i = 0; i < n; i++)
+    test_emit_token(buf[i]);
+  test_assert_sequence(5, "CDEF");
+
+  /* Input queue, in place write and commit.*/
+  chSysLock();
+  p = chIQGetEmptySpanI(&iq, &span);
+  chSysUnlock();
+  test_assert(6, span == 2, "wrong span size");
+  p[0] = 'X';
+  p[1] = 'Y';
+  chSysLock();
+  chIQCommitI(&iq, span);
+  chSysUnlock();
+  test_assert_lock(7, chIQGetFullI(&iq) == 2, "wrong queue content");
+  test_emit_token(chIQGet(&iq));
+  test_emit_token(chIQGet(&iq));
+  test_assert_sequence(8, "XY");
+  test_assert_lock(9, chIQIsEmptyI(&iq), "not empty");
+
+  /* Output queue, block read wrapping around the buffer end.*/
+  chOQWriteTimeout(&oq, (const uint8_t *)"ABC", 3, TIME_IMMEDIATE);
+  chSysLock();
+  n = chOQReadI(&oq, buf, 2);
+  chSysUnlock();
+  test_assert(10, n == 2, "wrong returned size");
+  n = chOQWriteTimeout(&oq, (const uint8_t *)"DEF", 3, TIME_IMMEDIATE);
+  test_assert(11, n == 3, "wrong returned size");
+  chSysLock();
+  n = chOQReadI(&oq, buf, sizeof buf);
+  chSysUnlock();
+  test_assert(12, n == TEST_QUEUES_SIZE, "wrong returned size");
+  for (i = 0; i < n; i++)
+    test_emit_token(buf[i]);
+  test_assert_sequence(13, "CDEF");
+  test_assert_lock(14, chOQReadI(&oq, buf, sizeof buf) == 0,
+                   "failed to report empty");
+
+  /* Output queue, in place read and consume.*/
+  chOQWriteTimeout(&oq, (const uint8_t *)"GH", 2, TIME_IMMEDIATE);
+  chSysLock();
+  p = chOQGetFullSpanI(&oq, &span);
+  chSysUnlock();
+  test_assert(15, span == 2, "wrong span size");
+  test_emit_token(p[0]);
+  test_emit_token(p[1]);
+  test_assert_sequence(16, "GH");
+  chSysLock();
+  chOQConsumeI(&oq, span);
+  chSysUnlock();
+  test_assert_lock(17, chOQIsEmptyI(&oq), "not empty");
+}
+
+ROMCONST struct testcase testqueues3 = {
+  "Queues, block and span operations",
+  queues3_setup,
+  NULL,
+  queues3_execute
+};
 #endif /* CH_USE_QUEUES */
 
 /**
@@ -239,6 +333,7 @@ ROMCONST struct testcase * ROMCONST patternqueues[] = {
 #if CH_USE_QUEUES || defined(__DOXYGEN__)
   &testqueues1,
   &testqueues2,
+  &testqueues3,
 #endif
   NULL
 };
@@ -0,0 +1,184 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_ring Ring Buffers and Doorbells test
+ *
+ * File: @ref testring.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref ringbuffers
+ * subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref ringbuffers
+ * code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_USE_RINGBUFFERS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_ring_001
+ * - @subpage test_ring_002
+ * .
+ * @file testring.c
+ * @brief Ring Buffers and Doorbells test source file
+ * @file testring.h
+ * @brief Ring Buffers and Doorbells test header file
+ */
+
+#if CH_USE_RINGBUFFERS || defined(__DOXYGEN__)
+
+#define RB_SIZE 4
+
+static msg_t rb_buffer[RB_SIZE];
+static RINGBUFFER_DECL(rb1, rb_buffer, RB_SIZE);
+static Doorbell db1;
+
+/**
+ * @page test_ring_001 Ring buffer operations
+ *
+ * <h2>Description</h2>
+ * The ring buffer is filled and emptied several times in order to test
+ * the full and empty conditions and the pointers wrapping.
+ */
+
+static void ring1_setup(void) {
+
+  chRbInit(&rb1, rb_buffer, RB_SIZE);
+}
+
+static void ring1_execute(void) {
+  unsigned i;
+  msg_t msg;
+
+  test_assert(1, chRbIsEmpty(&rb1), "not empty");
+  test_assert(2, !chRbGet(&rb1, &msg), "empty not detected");
+
+  for (i = 0; i < 3; i++) {
+    /* Filling.*/
+    test_assert(3, chRbPut(&rb1, 'A' + i), "full");
+    test_assert(4, chRbPut(&rb1, 'B' + i), "full");
+    test_assert(5, chRbPut(&rb1, 'C' + i), "full");
+    test_assert(6, !chRbPut(&rb1, 'X'), "full not detected");
+    test_assert(7, chRbGetUsedCount(&rb1) == RB_SIZE - 1, "wrong count");
+
+    /* Partial emptying, the following fills wrap around.*/
+    test_assert(8, chRbGet(&rb1, &msg), "empty");
+    test_emit_token((char)msg);
+    test_assert(9, chRbGetUsedCount(&rb1) == RB_SIZE - 2, "wrong count");
+    while (chRbGet(&rb1, &msg))
+      test_emit_token((char)msg);
+    test_assert(10, chRbIsEmpty(&rb1), "not empty");
+    test_assert(11, chRbGetUsedCount(&rb1) == 0, "wrong count");
+  }
+  test_assert_sequence(12, "ABCBCDCDE");
+}
+
+ROMCONST struct testcase testring1 = {
+  "Ring buffers, queuing",
+  ring1_setup,
+  NULL,
+  ring1_execute
+};
+
+/**
+ * @page test_ring_002 Doorbells
+ *
+ * <h2>Description</h2>
+ * A doorbell is rung with no waiting thread, the ring must satisfy the
+ * next wait. Then a thread fills the ring buffer and rings the doorbell
+ * without using any system API, as an interrupt handler above the kernel
+ * priority would do, and the consumer must be woken by the kernel.
+ */
+
+static void ring2_setup(void) {
+
+  chRbInit(&rb1, rb_buffer, RB_SIZE);
+  chDbInit(&db1);
+}
+
+static msg_t thread1(void *p) {
+
+  (void)p;
+  chThdSleepMilliseconds(20);
+  chRbPut(&rb1, 'A');
+  chRbPut(&rb1, 'B');
+  chDbRing(&db1);
+  chThdSleepMilliseconds(20);
+  chRbPut(&rb1, 'C');
+  chDbRing(&db1);
+  return 0;
+}
+
+static void ring2_execute(void) {
+  unsigned n;
+  msg_t msg;
+
+  /* Ring remembered when there is no waiting thread.*/
+  test_assert(1, chDbWaitTimeout(&db1, TIME_IMMEDIATE) == RDY_TIMEOUT,
+              "not timeout");
+  chDbRing(&db1);
+  chDbRing(&db1);
+  test_assert(2, chDbWaitTimeout(&db1, TIME_IMMEDIATE) == RDY_OK,
+              "ring not remembered");
+  test_assert(3, chDbWaitTimeout(&db1, TIME_IMMEDIATE) == RDY_TIMEOUT,
+              "not timeout");
+  test_assert(4, chDbWaitTimeout(&db1, MS2ST(10)) == RDY_TIMEOUT,
+              "not timeout");
+
+  /* Consumer woken by the producer thread.*/
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority() + 1,
+                                 thread1, NULL);
+  n = 0;
+  while (n < 3) {
+    if (chDbWaitTimeout(&db1, MS2ST(500)) != RDY_OK)
+      break;
+    while (chRbGet(&rb1, &msg)) {
+      test_emit_token((char)msg);
+      n++;
+    }
+  }
+  test_wait_threads();
+  test_assert_sequence(5, "ABC");
+}
+
+ROMCONST struct testcase testring2 = {
+  "Ring buffers, doorbells",
+  ring2_setup,
+  NULL,
+  ring2_execute
+};
+
+#endif /* CH_USE_RINGBUFFERS */
+
+/**
+ * @brief   Test sequence for ring buffers and doorbells.
+ */
+ROMCONST struct testcase * ROMCONST patternring[] = {
+#if CH_USE_RINGBUFFERS || defined(__DOXYGEN__)
+  &testring1,
+  &testring2,
+#endif
+  NULL
+};
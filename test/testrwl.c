@@ -0,0 +1,208 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_rwl Readers-Writer Locks test
+ *
+ * File: @ref testrwl.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref rwlocks subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref rwlocks code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_USE_RWLOCKS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_rwl_001
+ * - @subpage test_rwl_002
+ * - @subpage test_rwl_003
+ * .
+ * @file testrwl.c
+ * @brief Readers-Writer Locks test source file
+ * @file testrwl.h
+ * @brief Readers-Writer Locks test header file
+ */
+
+#if CH_USE_RWLOCKS || defined(__DOXYGEN__)
+
+#define ALLOWED_DELAY MS2ST(5)
+
+/*
+ * Note, the static initializer is not really required because the
+ * variable is explicitly initialized in each test case. It is done in order
+ * to test the macro.
+ */
+static RWLOCK_DECL(rw1);
+
+static void rwl_setup(void) {
+
+  chRWLockInit(&rw1);
+}
+
+static msg_t reader(void *p) {
+
+  chRWLockReadLock(&rw1);
+  test_emit_token(*(char *)p);
+  chRWLockReadUnlock(&rw1);
+  return 0;
+}
+
+static msg_t writer(void *p) {
+
+  chRWLockWriteLock(&rw1);
+  test_emit_token(*(char *)p);
+  chRWLockWriteUnlock(&rw1);
+  return 0;
+}
+
+/**
+ * @page test_rwl_001 Shared readers and writer preference
+ *
+ * <h2>Description</h2>
+ * The tester thread acquires the lock as reader, a second reader is
+ * expected to acquire the lock without waiting. A writer is then queued
+ * followed by two higher priority readers, the new readers are expected to
+ * wait for the writer even if the lock is held by readers only. The lock is
+ * released and the threads are expected to run in the order writer, then
+ * readers by priority.
+ */
+
+static void rwl1_execute(void) {
+  tprio_t prio = chThdGetPriority();
+
+  chRWLockReadLock(&rw1);
+  test_assert(1, chRWLockReadLockTimeout(&rw1, TIME_IMMEDIATE) == RDY_OK,
+              "shared read failed");
+  test_assert(2, chRWLockGetReadersI(&rw1) == 2, "wrong readers count");
+  chRWLockReadUnlock(&rw1);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, writer, "A");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, reader, "C");
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio+3, reader, "B");
+  test_assert(3, chRWLockGetReadersI(&rw1) == 1, "readers not queued");
+  test_assert(4, chRWLockReadLockTimeout(&rw1, TIME_IMMEDIATE) == RDY_TIMEOUT,
+              "writer preference failure");
+  chRWLockReadUnlock(&rw1);
+  test_wait_threads();
+  test_assert_sequence(5, "ABC");
+  test_assert(6, (chRWLockGetReadersI(&rw1) == 0) &&
+                 (chRWLockGetWriterI(&rw1) == NULL), "not released");
+}
+
+ROMCONST struct testcase testrwl1 = {
+  "RW Locks, shared readers and writer preference",
+  rwl_setup,
+  NULL,
+  rwl1_execute
+};
+
+/**
+ * @page test_rwl_002 Priority ordering
+ *
+ * <h2>Description</h2>
+ * The tester thread acquires the lock as writer, then two writers and two
+ * readers are queued with priorities not matching their creation order.
+ * The lock is released and the writers are expected to acquire the lock
+ * in priority order followed by the readers in priority order.
+ */
+
+static void rwl2_execute(void) {
+  tprio_t prio = chThdGetPriority();
+
+  chRWLockWriteLock(&rw1);
+  test_assert(1, chRWLockGetWriterI(&rw1) == chThdSelf(), "not owned");
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+3, reader, "D");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+1, writer, "B");
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio+4, reader, "C");
+  threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio+2, writer, "A");
+  chRWLockWriteUnlock(&rw1);
+  test_wait_threads();
+  test_assert_sequence(2, "ABCD");
+}
+
+ROMCONST struct testcase testrwl2 = {
+  "RW Locks, priority ordering",
+  rwl_setup,
+  NULL,
+  rwl2_execute
+};
+
+/**
+ * @page test_rwl_003 Timeouts
+ *
+ * <h2>Description</h2>
+ * The tester thread acquires the lock as reader then a writer is queued
+ * with a timeout followed by an higher priority reader. When the writer
+ * timeout expires the reader, only queued because of the writer preference,
+ * is expected to acquire the lock.
+ */
+
+static msg_t thread3(void *p) {
+
+  if (chRWLockWriteLockTimeout(&rw1, MS2ST(50)) == RDY_TIMEOUT)
+    test_emit_token(*(char *)p);
+  else
+    chRWLockWriteUnlock(&rw1);
+  return 0;
+}
+
+static void rwl3_execute(void) {
+  tprio_t prio = chThdGetPriority();
+  systime_t target_time;
+
+  chRWLockReadLock(&rw1);
+  target_time = chTimeNow() + MS2ST(50);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread3, "B");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, reader, "A");
+  test_wait_threads();
+  test_assert_sequence(1, "AB");
+  test_assert_time_window(2, target_time, target_time + ALLOWED_DELAY);
+  test_assert(3, chRWLockGetReadersI(&rw1) == 1, "wrong readers count");
+  chRWLockReadUnlock(&rw1);
+  test_assert(4, chRWLockWriteLockTimeout(&rw1, TIME_IMMEDIATE) == RDY_OK,
+              "not released");
+  chRWLockWriteUnlock(&rw1);
+}
+
+ROMCONST struct testcase testrwl3 = {
+  "RW Locks, timeouts",
+  rwl_setup,
+  NULL,
+  rwl3_execute
+};
+
+#endif /* CH_USE_RWLOCKS */
+
+/**
+ * @brief   Test sequence for readers-writer locks.
+ */
+ROMCONST struct testcase * ROMCONST patternrwl[] = {
+#if CH_USE_RWLOCKS || defined(__DOXYGEN__)
+  &testrwl1,
+  &testrwl2,
+  &testrwl3,
+#endif
+  NULL
+};
@@ -0,0 +1,236 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_tasks Stackless Tasks test
+ *
+ * File: @ref testtask.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref tasks subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref tasks code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_USE_TASKS
+ * - @p CH_USE_MAILBOXES
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_tasks_001
+ * - @subpage test_tasks_002
+ * - @subpage test_tasks_003
+ * .
+ * @file testtask.c
+ * @brief Stackless Tasks test source file
+ * @file testtask.h
+ * @brief Stackless Tasks test header file
+ */
+
+#if (CH_USE_TASKS && CH_USE_MAILBOXES) || defined(__DOXYGEN__)
+
+#define ALLOWED_DELAY MS2ST(5)
+
+static TaskScheduler ts1;
+static Task tasks[4];
+static Semaphore sem1;
+static Mailbox mb1;
+static msg_t mb_buffer[4];
+static msg_t mb_msg;
+static EventSource es1;
+static EventListener el1;
+static systime_t wake_time;
+
+static void tasks_setup(void) {
+
+  chTaskSchedulerInit(&ts1);
+  chSemInit(&sem1, 0);
+  chMBInit(&mb1, mb_buffer, 4);
+  chEvtInit(&es1);
+}
+
+static msg_t host(void *p) {
+
+  chTaskSchedulerRun(p);
+  return 0;
+}
+
+/**
+ * @page test_tasks_001 Round robin
+ *
+ * <h2>Description</h2>
+ * Three tasks emit a token and yield three times, the tasks are expected
+ * to be executed in round robin order and the host thread is expected to
+ * return when all the tasks terminated.
+ */
+
+static msg_t task1(Task *tp) {
+  TASK_BEGIN(tp);
+  test_emit_token(*(char *)chTaskGetArg(tp));
+  TASK_YIELD(tp);
+  test_emit_token(*(char *)chTaskGetArg(tp));
+  TASK_YIELD(tp);
+  test_emit_token(*(char *)chTaskGetArg(tp));
+  TASK_END(tp);
+}
+
+static void tasks1_execute(void) {
+
+  chTaskStart(&ts1, &tasks[0], task1, "A");
+  chTaskStart(&ts1, &tasks[1], task1, "B");
+  chTaskStart(&ts1, &tasks[2], task1, "C");
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()-1,
+                                 host, &ts1);
+  test_wait_threads();
+  test_assert_sequence(1, "ABCABCABC");
+  test_assert(2, chTaskIsTerminated(&tasks[0]) &&
+                 chTaskIsTerminated(&tasks[1]) &&
+                 chTaskIsTerminated(&tasks[2]), "not terminated");
+}
+
+ROMCONST struct testcase testtasks1 = {
+  "Stackless tasks, round robin",
+  tasks_setup,
+  NULL,
+  tasks1_execute
+};
+
+/**
+ * @page test_tasks_002 Semaphores and mailboxes
+ *
+ * <h2>Description</h2>
+ * Two tasks wait on a semaphore and a task fetches messages from a
+ * mailbox, the tester thread signals the semaphore and posts the messages.
+ * The tasks are expected to be resumed in the signaling order and the
+ * watchers to be removed from the objects.
+ */
+
+static msg_t task2_sem(Task *tp) {
+  TASK_BEGIN(tp);
+  TASK_SEM_WAIT(tp, &sem1);
+  test_emit_token(*(char *)chTaskGetArg(tp));
+  TASK_END(tp);
+}
+
+static msg_t task2_mb(Task *tp) {
+  TASK_BEGIN(tp);
+  TASK_MB_FETCH(tp, &mb1, &mb_msg);
+  test_emit_token((char)mb_msg);
+  TASK_MB_FETCH(tp, &mb1, &mb_msg);
+  test_emit_token((char)mb_msg);
+  TASK_END(tp);
+}
+
+static void tasks2_execute(void) {
+
+  chTaskStart(&ts1, &tasks[0], task2_sem, "A");
+  chTaskStart(&ts1, &tasks[1], task2_sem, "A");
+  chTaskStart(&ts1, &tasks[2], task2_mb, NULL);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()+1,
+                                 host, &ts1);
+  chSemSignal(&sem1);
+  (void)chMBPost(&mb1, 'B', TIME_INFINITE);
+  chSemSignal(&sem1);
+  (void)chMBPost(&mb1, 'D', TIME_INFINITE);
+  test_wait_threads();
+  test_assert_sequence(1, "ABAD");
+  test_assert(2, (sem1.s_wslist == NULL) &&
+                 (mb1.mb_fullsem.s_wslist == NULL), "still watched");
+}
+
+ROMCONST struct testcase testtasks2 = {
+  "Stackless tasks, semaphores and mailboxes",
+  tasks_setup,
+  NULL,
+  tasks2_execute
+};
+
+/**
+ * @page test_tasks_003 Sleep and events
+ *
+ * <h2>Description</h2>
+ * Three tasks sleep for different times while a fourth task waits for the
+ * events of an event source registered on the host thread, the tester
+ * thread broadcasts the event after the sleeping tasks woke up. The tasks
+ * are expected to be resumed in the correct order and at the correct
+ * times.
+ */
+
+static msg_t task3_sleep(Task *tp) {
+  TASK_BEGIN(tp);
+  TASK_SLEEP(tp, MS2ST(10) * (*(char *)chTaskGetArg(tp) - 'A' + 1));
+  test_emit_token(*(char *)chTaskGetArg(tp));
+  wake_time = chTimeNow();
+  TASK_END(tp);
+}
+
+static msg_t task3_evt(Task *tp) {
+  TASK_BEGIN(tp);
+  chEvtRegisterMask(&es1, &el1, EVENT_MASK(0));
+  TASK_EVT_WAIT(tp, EVENT_MASK(0));
+  if (chTaskGetEvents(tp) == EVENT_MASK(0))
+    test_emit_token('D');
+  chEvtUnregister(&es1, &el1);
+  TASK_END(tp);
+}
+
+static void tasks3_execute(void) {
+  systime_t target_time;
+
+  test_wait_tick();
+  target_time = chTimeNow() + MS2ST(30);
+  chTaskStart(&ts1, &tasks[0], task3_sleep, "C");
+  chTaskStart(&ts1, &tasks[1], task3_evt, NULL);
+  chTaskStart(&ts1, &tasks[2], task3_sleep, "A");
+  chTaskStart(&ts1, &tasks[3], task3_sleep, "B");
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()+1,
+                                 host, &ts1);
+  chThdSleepMilliseconds(40);
+  test_assert_sequence(1, "ABC");
+  test_assert(2, (systime_t)(wake_time - target_time) <= ALLOWED_DELAY,
+              "out of time window");
+  chEvtBroadcast(&es1);
+  test_wait_threads();
+  test_assert_sequence(3, "D");
+}
+
+ROMCONST struct testcase testtasks3 = {
+  "Stackless tasks, sleep and events",
+  tasks_setup,
+  NULL,
+  tasks3_execute
+};
+
+#endif /* CH_USE_TASKS && CH_USE_MAILBOXES */
+
+/**
+ * @brief   Test sequence for stackless tasks.
+ */
+ROMCONST struct testcase * ROMCONST patterntasks[] = {
+#if (CH_USE_TASKS && CH_USE_MAILBOXES) || defined(__DOXYGEN__)
+  &testtasks1,
+  &testtasks2,
+  &testtasks3,
+#endif
+  NULL
+};
@@ -40,6 +40,7 @@
  * - @subpage test_threads_002
  * - @subpage test_threads_003
  * - @subpage test_threads_004
+ * - @subpage test_threads_005
  * .
  * @file testthd.c
  * @brief Threads and Scheduler test source file
@@ -219,6 +220,56 @@ ROMCONST struct testcase testthd4 = {
   thd4_execute
 };
 
+#if (CH_DBG_STATISTICS && CH_USE_REGISTRY) || defined(__DOXYGEN__)
+/**
+ * @page test_threads_005 Runtime statistics
+ *
+ * <h2>Description</h2>
+ * The statistics are cleared then a thread with higher priority is created,
+ * the thread consumes some time and terminates. The test expects the
+ * thread to have been switched in once and to have been accounted a single
+ * run burst. The invoking thread is expected to have been switched in again.
+ */
+
+static msg_t thread5(void *p) {
+  uint32_t start = port_rt_get_counter_value();
+
+  (void)p;
+  while (port_rt_get_counter_value() - start < PORT_RT_FREQUENCY / 1000) {
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  return 0;
+}
+
+static void thd5_execute(void) {
+  thread_stats_t ts;
+  kernel_stats_t ks;
+
+  chRegResetStats();
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority() + 1,
+                                 thread5, NULL);
+  chRegGetThreadStats(threads[0], &ts);
+  test_assert(1, ts.ts_switches == 1, "wrong switches count");
+  test_assert(2, ts.ts_runtime > 0, "runtime not accounted");
+  test_assert(3, ts.ts_worst == ts.ts_runtime, "wrong run burst");
+  test_wait_threads();
+
+  chRegGetThreadStats(chThdSelf(), &ts);
+  test_assert(4, ts.ts_switches >= 1, "wrong switches count");
+  chRegGetKernelStats(&ks);
+  test_assert(5, ks.ks_switches >= 2, "wrong context switches count");
+}
+
+ROMCONST struct testcase testthd5 = {
+  "Threads, runtime statistics",
+  NULL,
+  NULL,
+  thd5_execute
+};
+#endif /* CH_DBG_STATISTICS && CH_USE_REGISTRY */
+
 /**
  * @brief   Test sequence for threads.
  */
@@ -227,5 +278,8 @@ ROMCONST struct testcase * ROMCONST patternthd[] = {
   &testthd2,
   &testthd3,
   &testthd4,
+#if (CH_DBG_STATISTICS && CH_USE_REGISTRY) || defined(__DOXYGEN__)
+  &testthd5,
+#endif
   NULL
 };
@@ -0,0 +1,333 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_trace Events Tracer test
+ *
+ * File: @ref testtrace.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref trace subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref trace code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_USE_TRACE
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_trace_001
+ * - @subpage test_trace_002
+ * - @subpage test_trace_003
+ * - @subpage test_trace_004
+ * - @subpage test_trace_005
+ * .
+ * @file testtrace.c
+ * @brief Events Tracer test source file
+ * @file testtrace.h
+ * @brief Events Tracer test header file
+ */
+
+#if CH_USE_TRACE || defined(__DOXYGEN__)
+
+#define TRACE_USER_MASK ((trace_mask_t)(1U << TRACE_EV_USER))
+
+/*
+ * Stream capturing the dump, the first bytes and the last record are
+ * retained.
+ */
+static struct {
+  size_t            n;
+  size_t            nrec;
+  uint8_t           head[sizeof (trace_header_t) + sizeof (trace_record_t)];
+  trace_record_t    first;
+  trace_record_t    last;
+} capture;
+
+static size_t capture_write(void *ip, const uint8_t *bp, size_t n) {
+  size_t i;
+
+  (void)ip;
+  for (i = 0; i < n; i++) {
+    if (capture.n + i < sizeof (capture.head))
+      capture.head[capture.n + i] = bp[i];
+    if (n == sizeof (trace_record_t)) {
+      if (capture.nrec == 0)
+        ((uint8_t *)&capture.first)[i] = bp[i];
+      ((uint8_t *)&capture.last)[i] = bp[i];
+    }
+  }
+  if (n == sizeof (trace_record_t))
+    capture.nrec++;
+  capture.n += n;
+  return n;
+}
+
+static size_t capture_read(void *ip, uint8_t *bp, size_t n) {
+
+  (void)ip;
+  (void)bp;
+  (void)n;
+  return 0;
+}
+
+static msg_t capture_put(void *ip, uint8_t b) {
+
+  return capture_write(ip, &b, 1) == 1 ? RDY_OK : RDY_RESET;
+}
+
+static msg_t capture_get(void *ip) {
+
+  (void)ip;
+  return RDY_RESET;
+}
+
+static const struct BaseSequentialStreamVMT capture_vmt = {
+  capture_write, capture_read, capture_put, capture_get
+};
+
+static BaseSequentialStream capture_stream = {&capture_vmt};
+
+static void capture_reset(void) {
+
+  capture.n = 0;
+  capture.nrec = 0;
+}
+
+/*
+ * Mask in use before the test case, it is restored on exit.
+ */
+static trace_mask_t saved_mask;
+
+static void trace_setup(void) {
+
+  /* Only the events generated by the test cases are recorded, the old
+     records are discarded.*/
+  saved_mask = chTraceGetMask();
+  chTraceSetMask(TRACE_USER_MASK);
+  chTraceDrain(&capture_stream);
+  capture_reset();
+}
+
+static void trace_teardown(void) {
+
+  chTraceSetMask(saved_mask);
+}
+
+/**
+ * @page test_trace_001 Dump header and user events
+ *
+ * <h2>Description</h2>
+ * A dump header is written then three user events are recorded and drained,
+ * the records are checked for type, content and order. A second drain is
+ * expected to write nothing.
+ */
+
+static void trace1_execute(void) {
+  trace_header_t *thp = (trace_header_t *)capture.head;
+
+  chTraceWriteHeader(&capture_stream);
+  test_assert(1, (thp->th_magic[0] == 'C') && (thp->th_magic[1] == 'H') &&
+                 (thp->th_magic[2] == 'T') && (thp->th_magic[3] == 'R'),
+              "wrong magic");
+  test_assert(2, (thp->th_recsize == sizeof (trace_record_t)) &&
+                 (thp->th_objsize == sizeof (size_t)),
+              "wrong record size");
+  test_assert(3, capture.n == sizeof (trace_header_t) +
+                              thp->th_nthreads * sizeof (trace_thread_t),
+              "wrong header size");
+
+  capture_reset();
+  chTraceUser(1, 100);
+  chTraceUser(2, 200);
+  chTraceUser(3, 300);
+  test_assert(4, chTraceDrain(&capture_stream) == 3, "wrong records count");
+  test_assert(5, (capture.first.tr_type == TRACE_EV_USER) &&
+                 (capture.first.tr_obj == 1) &&
+                 (capture.first.tr_arg == 100), "wrong first record");
+  test_assert(6, (capture.last.tr_type == TRACE_EV_USER) &&
+                 (capture.last.tr_obj == 3) &&
+                 (capture.last.tr_arg == 300), "wrong last record");
+  test_assert(7, capture.last.tr_seq - capture.first.tr_seq == 2,
+              "wrong sequence numbers");
+  test_assert(8, capture.last.tr_time - capture.first.tr_time < 0x80000000U,
+              "timestamps not ordered");
+  test_assert(9, capture.first.tr_prio == chThdGetPriority(),
+              "wrong priority");
+  test_assert(10, chTraceDrain(&capture_stream) == 0, "ring not empty");
+}
+
+ROMCONST struct testcase testtrace1 = {
+  "Tracer, header and user events",
+  trace_setup,
+  trace_teardown,
+  trace1_execute
+};
+
+/**
+ * @page test_trace_002 Ring overflow
+ *
+ * <h2>Description</h2>
+ * More user events than the ring size are recorded, the drain operation is
+ * expected to report the lost records count before the surviving records.
+ */
+
+static void trace2_execute(void) {
+  uint32_t i;
+
+  for (i = 0; i < TRACE_BUFFER_SIZE + 10; i++)
+    chTraceUser(i, 0);
+  test_assert(1, chTraceDrain(&capture_stream) == TRACE_BUFFER_SIZE + 1,
+              "wrong records count");
+  test_assert(2, (capture.first.tr_type == TRACE_EV_LOST) &&
+                 (capture.first.tr_arg == 10), "lost records not reported");
+  test_assert(3, capture.last.tr_obj == TRACE_BUFFER_SIZE + 9,
+              "wrong last record");
+}
+
+ROMCONST struct testcase testtrace2 = {
+  "Tracer, ring overflow",
+  trace_setup,
+  trace_teardown,
+  trace2_execute
+};
+
+#if CH_USE_SEMAPHORES || defined(__DOXYGEN__)
+/**
+ * @page test_trace_003 Kernel events
+ *
+ * <h2>Description</h2>
+ * Only semaphore events are enabled, a semaphore is signaled and waited and
+ * the two records are checked. Event types not in the mask are expected to
+ * be ignored.
+ */
+
+static SEMAPHORE_DECL(sem1, 0);
+
+static void trace3_execute(void) {
+
+  chTraceSetMask((1U << TRACE_EV_SEM_WAIT) | (1U << TRACE_EV_SEM_SIGNAL));
+  chSemSignal(&sem1);
+  chTraceUser(1, 0);
+  chSemWait(&sem1);
+  test_assert(1, chTraceDrain(&capture_stream) == 2, "wrong records count");
+  test_assert(2, (capture.first.tr_type == TRACE_EV_SEM_SIGNAL) &&
+                 (capture.first.tr_obj == (size_t)&sem1) &&
+                 (capture.first.tr_arg == 0), "wrong signal record");
+  test_assert(3, (capture.last.tr_type == TRACE_EV_SEM_WAIT) &&
+                 (capture.last.tr_obj == (size_t)&sem1) &&
+                 (capture.last.tr_arg == 1), "wrong wait record");
+}
+
+ROMCONST struct testcase testtrace3 = {
+  "Tracer, kernel events",
+  trace_setup,
+  trace_teardown,
+  trace3_execute
+};
+#endif /* CH_USE_SEMAPHORES */
+
+/**
+ * @page test_trace_004 Records being written
+ *
+ * <h2>Description</h2>
+ * A record is marked as still being written, as a writer preempted before
+ * completing it would leave it. The drain operation is expected to stop
+ * before the record and to drain it once it has been completed.
+ */
+
+static void trace4_execute(void) {
+  trace_record_t *rp;
+  uint32_t seq;
+
+  chTraceUser(1, 0);
+  chTraceUser(2, 0);
+  seq = trace_ring.tr_wrseq - 1;
+  rp = &trace_ring.tr_buffer[seq & (TRACE_BUFFER_SIZE - 1)];
+  rp->tr_seq = ~seq;
+  test_assert(1, chTraceDrain(&capture_stream) == 1, "wrong records count");
+  test_assert(2, capture.last.tr_obj == 1, "wrong record");
+  rp->tr_seq = seq;
+  test_assert(3, chTraceDrain(&capture_stream) == 1, "wrong records count");
+  test_assert(4, capture.last.tr_obj == 2, "wrong record");
+}
+
+ROMCONST struct testcase testtrace4 = {
+  "Tracer, records being written",
+  trace_setup,
+  trace_teardown,
+  trace4_execute
+};
+
+#if CH_USE_MUTEXES || defined(__DOXYGEN__)
+/**
+ * @page test_trace_005 Mutex events
+ *
+ * <h2>Description</h2>
+ * Only mutex events are enabled, a free mutex is locked and unlocked and
+ * the two records are checked. The operations are expected to be recorded
+ * also when performed by the atomic fast paths.
+ */
+
+static MUTEX_DECL(mtx1);
+
+static void trace5_execute(void) {
+
+  chTraceSetMask((1U << TRACE_EV_MTX_LOCK) | (1U << TRACE_EV_MTX_UNLOCK));
+  chMtxLock(&mtx1);
+  test_assert(1, chMtxUnlock() == &mtx1, "wrong mutex");
+  test_assert(2, chTraceDrain(&capture_stream) == 2, "wrong records count");
+  test_assert(3, (capture.first.tr_type == TRACE_EV_MTX_LOCK) &&
+                 (capture.first.tr_obj == (size_t)&mtx1) &&
+                 (capture.first.tr_info == 0), "wrong lock record");
+  test_assert(4, (capture.last.tr_type == TRACE_EV_MTX_UNLOCK) &&
+                 (capture.last.tr_obj == (size_t)&mtx1), "wrong unlock record");
+}
+
+ROMCONST struct testcase testtrace5 = {
+  "Tracer, mutex events",
+  trace_setup,
+  trace_teardown,
+  trace5_execute
+};
+#endif /* CH_USE_MUTEXES */
+
+#endif /* CH_USE_TRACE */
+
+/**
+ * @brief   Test sequence for the events tracer.
+ */
+ROMCONST struct testcase * ROMCONST patterntrace[] = {
+#if CH_USE_TRACE || defined(__DOXYGEN__)
+  &testtrace1,
+  &testtrace2,
+#if CH_USE_SEMAPHORES || defined(__DOXYGEN__)
+  &testtrace3,
+#endif
+  &testtrace4,
+#if CH_USE_MUTEXES || defined(__DOXYGEN__)
+  &testtrace5,
+#endif
+#endif
+  NULL
+};
@@ -0,0 +1,231 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_wq Work Queues test
+ *
+ * File: @ref testwq.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref workqueues
+ * subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref workqueues code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_USE_WORKQUEUES
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_wq_001
+ * - @subpage test_wq_002
+ * - @subpage test_wq_003
+ * .
+ * @file testwq.c
+ * @brief Work Queues test source file
+ * @file testwq.h
+ * @brief Work Queues test header file
+ */
+
+#if CH_USE_WORKQUEUES || defined(__DOXYGEN__)
+
+#define ALLOWED_DELAY MS2ST(5)
+#define WQ_ITEMS      4
+
+static WorkQueue wq1;
+static WorkItem items[WQ_ITEMS];
+static Semaphore done;
+
+static void wq_setup(void) {
+
+  chWorkQueueInit(&wq1, items, WQ_ITEMS);
+  chSemInit(&done, 0);
+}
+
+static void wq_teardown(void) {
+
+  test_terminate_threads();
+  chWorkQueueReset(&wq1);
+}
+
+/*
+ * Emits a token and notifies the tester thread.
+ */
+static void work(void *p) {
+
+  test_emit_token(*(char *)p);
+  chSemSignal(&done);
+}
+
+/*
+ * Waits for the specified number of works to be completed, returns the
+ * number of the completed works.
+ */
+static int wait_works(int n) {
+  int i;
+
+  for (i = 0; i < n; i++)
+    if (chSemWaitTimeout(&done, MS2ST(500)) != RDY_OK)
+      break;
+  return i;
+}
+
+/**
+ * @page test_wq_001 FIFO execution and pool exhaustion
+ *
+ * <h2>Description</h2>
+ * A worker with lower priority than the tester thread is created and more
+ * works than the available items are submitted, the last submission is
+ * expected to fail and the queued works are expected to be executed in
+ * FIFO order.
+ */
+
+static void wq1_execute(void) {
+  bool_t c, d, e;
+
+  threads[0] = chWorkQueueAddWorker(&wq1, wa[0], WA_SIZE,
+                                    chThdGetPriority()-1);
+  test_assert(1, chWorkSubmit(&wq1, work, "A"), "submit failed");
+  test_assert(2, chWorkSubmit(&wq1, work, "B"), "submit failed");
+  chSysLock();
+  c = chWorkSubmitI(&wq1, work, "C");
+  d = chWorkSubmitI(&wq1, work, "D");
+  e = chWorkSubmitI(&wq1, work, "E");
+  chSysUnlock();
+  test_assert(3, c && d, "submit failed");
+  test_assert(4, !e, "pool not exhausted");
+  test_assert(5, wait_works(4) == 4, "works not executed");
+  test_assert_sequence(6, "ABCD");
+}
+
+ROMCONST struct testcase testwq1 = {
+  "Work queues, FIFO execution and pool exhaustion",
+  wq_setup,
+  wq_teardown,
+  wq1_execute
+};
+
+/**
+ * @page test_wq_002 Delayed works
+ *
+ * <h2>Description</h2>
+ * Delayed works are submitted in reverse order of expiration, one of them
+ * is cancelled before expiring and its item is reused by another delayed
+ * work, the stale handle is expected to not cancel the new work. The works
+ * are expected to be executed in expiration order and the last one at the
+ * expected time.
+ */
+
+static void wq2_execute(void) {
+  systime_t target_time;
+  WorkHandle wh;
+
+  threads[0] = chWorkQueueAddWorker(&wq1, wa[0], WA_SIZE,
+                                    chThdGetPriority()+1);
+  test_wait_tick();
+  target_time = chTimeNow() + MS2ST(30);
+  test_assert(1, chWorkSubmitDelayed(&wq1, work, "D", MS2ST(30), NULL),
+              "submit failed");
+  test_assert(2, chWorkSubmitDelayed(&wq1, work, "B", MS2ST(20), NULL),
+              "submit failed");
+  test_assert(3, chWorkSubmitDelayed(&wq1, work, "A", MS2ST(10), NULL),
+              "submit failed");
+  test_assert(4, chWorkSubmitDelayed(&wq1, work, "E", MS2ST(15), &wh),
+              "submit failed");
+  test_assert(5, chWorkCancel(&wh), "not cancelled");
+  test_assert(6, chWorkSubmitDelayed(&wq1, work, "C", MS2ST(25), NULL),
+              "submit failed");
+  test_assert(7, !chWorkCancel(&wh), "stale handle cancelled");
+  test_assert(8, wait_works(4) == 4, "works not executed");
+  test_assert_time_window(9, target_time, target_time + ALLOWED_DELAY);
+  test_assert_sequence(10, "ABCD");
+  test_assert(11, chSemWaitTimeout(&done, MS2ST(20)) == RDY_TIMEOUT,
+              "cancelled work executed");
+}
+
+ROMCONST struct testcase testwq2 = {
+  "Work queues, delayed works",
+  wq_setup,
+  wq_teardown,
+  wq2_execute
+};
+
+/**
+ * @page test_wq_003 Reset and workers pool
+ *
+ * <h2>Description</h2>
+ * Works are queued and then discarded by resetting the queue before the
+ * worker can run, the pool is expected to be fully available again. A
+ * second worker is then created and four blocking works are expected to
+ * be executed two at time.
+ */
+
+static void slow_work(void *p) {
+
+  chThdSleepMilliseconds(20);
+  work(p);
+}
+
+static void wq3_execute(void) {
+  systime_t target_time;
+
+  threads[0] = chWorkQueueAddWorker(&wq1, wa[0], WA_SIZE,
+                                    chThdGetPriority()-1);
+  (void)chWorkSubmit(&wq1, work, "A");
+  (void)chWorkSubmit(&wq1, work, "B");
+  chWorkQueueReset(&wq1);
+  test_assert(1, chSemWaitTimeout(&done, MS2ST(20)) == RDY_TIMEOUT,
+              "discarded work executed");
+
+  threads[1] = chWorkQueueAddWorker(&wq1, wa[1], WA_SIZE,
+                                    chThdGetPriority()-1);
+  test_wait_tick();
+  target_time = chTimeNow() + MS2ST(40);
+  test_assert(2, chWorkSubmit(&wq1, slow_work, "C"), "submit failed");
+  test_assert(3, chWorkSubmit(&wq1, slow_work, "D"), "submit failed");
+  test_assert(4, chWorkSubmit(&wq1, slow_work, "E"), "submit failed");
+  test_assert(5, chWorkSubmit(&wq1, slow_work, "F"), "submit failed");
+  test_assert(6, wait_works(4) == 4, "works not executed");
+  test_assert_time_window(7, target_time, target_time + ALLOWED_DELAY);
+}
+
+ROMCONST struct testcase testwq3 = {
+  "Work queues, reset and workers pool",
+  wq_setup,
+  wq_teardown,
+  wq3_execute
+};
+
+#endif /* CH_USE_WORKQUEUES */
+
+/**
+ * @brief   Test sequence for work queues.
+ */
+ROMCONST struct testcase * ROMCONST patternwq[] = {
+#if CH_USE_WORKQUEUES || defined(__DOXYGEN__)
+  &testwq1,
+  &testwq2,
+  &testwq3,
+#endif
+  NULL
+};
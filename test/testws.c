@@ -0,0 +1,261 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_ws Wait Sets test
+ *
+ * File: @ref testws.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref waitsets subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref waitsets code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_USE_WAITSETS
+ * - @p CH_USE_MAILBOXES
+ * - @p CH_USE_QUEUES
+ * - @p CH_USE_EVENTS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_ws_001
+ * - @subpage test_ws_002
+ * - @subpage test_ws_003
+ * .
+ * @file testws.c
+ * @brief Wait Sets test source file
+ * @file testws.h
+ * @brief Wait Sets test header file
+ */
+
+#if (CH_USE_WAITSETS && CH_USE_MAILBOXES && CH_USE_QUEUES && CH_USE_EVENTS) || \
+    defined(__DOXYGEN__)
+
+#define ALLOWED_DELAY MS2ST(5)
+#define WS_ENTRIES    4
+
+static WaitSet ws1;
+static WaitSetEntry entries[WS_ENTRIES];
+static Semaphore sem1;
+static Mailbox mb1;
+static msg_t mb_buffer[4];
+static InputQueue iq1;
+static uint8_t iq_buffer[4];
+static EventSource es1;
+
+static void ws_setup(void) {
+
+  chSemInit(&sem1, 0);
+  chMBInit(&mb1, mb_buffer, 4);
+  chIQInit(&iq1, iq_buffer, 4, NULL, NULL);
+  chEvtInit(&es1);
+  chEvtGetAndClearEvents(ALL_EVENTS);
+  chWSInit(&ws1, entries, WS_ENTRIES);
+  (void)chWSAddSemaphore(&ws1, &sem1);
+  (void)chWSAddMailbox(&ws1, &mb1);
+  (void)chWSAddInputQueue(&ws1, &iq1);
+  (void)chWSAddEventSource(&ws1, &es1, EVENT_MASK(0));
+}
+
+static void ws_teardown(void) {
+
+  chWSClear(&ws1);
+}
+
+/**
+ * @page test_ws_001 Ready objects
+ *
+ * <h2>Description</h2>
+ * All the objects in the set are made ready before waiting, the waits are
+ * expected to return the entries in round robin order consuming the
+ * semaphore, the mailbox message and the events. The set is then cleared
+ * and the objects are expected to be no more watched.
+ */
+
+static void ws1_execute(void) {
+  msg_t msg;
+
+  chSysLock();
+  chSemAddCounterI(&sem1, 2);
+  (void)chIQPutI(&iq1, 'Q');
+  chSysUnlock();
+  (void)chMBPost(&mb1, 'M', TIME_IMMEDIATE);
+  chEvtBroadcast(&es1);
+
+  test_assert(1, chWSWaitTimeout(&ws1, TIME_IMMEDIATE) == 0,
+              "semaphore not ready");
+  test_assert(2, chSemGetCounterI(&sem1) == 1, "semaphore not acquired");
+  test_assert(3, chWSWaitTimeout(&ws1, TIME_IMMEDIATE) == 1,
+              "mailbox not ready");
+  test_assert(4, chWSGetMessage(&ws1) == 'M', "wrong message");
+  test_assert(5, chWSWaitTimeout(&ws1, TIME_IMMEDIATE) == 2,
+              "queue not ready");
+  test_assert(6, chWSWaitTimeout(&ws1, TIME_IMMEDIATE) == 3,
+              "event source not ready");
+  test_assert(7, chWSGetEvents(&ws1) == EVENT_MASK(0), "wrong events");
+
+  /* Round robin, the queue is still not empty.*/
+  test_assert(8, chWSWaitTimeout(&ws1, TIME_IMMEDIATE) == 0,
+              "semaphore not ready");
+  test_assert(9, chWSWaitTimeout(&ws1, TIME_IMMEDIATE) == 2,
+              "queue not ready");
+  msg = chIQGetTimeout(&iq1, TIME_IMMEDIATE);
+  test_assert(10, msg == 'Q', "wrong queue data");
+  test_assert(11, chWSWaitTimeout(&ws1, TIME_IMMEDIATE) == RDY_TIMEOUT,
+              "not empty");
+
+  chWSClear(&ws1);
+  test_assert(12, chWSGetCount(&ws1) == 0, "not cleared");
+  test_assert(13, (sem1.s_wslist == NULL) &&
+                  (mb1.mb_fullsem.s_wslist == NULL) &&
+                  (iq1.q_wslist == NULL) && !chEvtIsListeningI(&es1),
+              "still watched");
+}
+
+ROMCONST struct testcase testws1 = {
+  "Wait sets, ready objects",
+  ws_setup,
+  ws_teardown,
+  ws1_execute
+};
+
+/**
+ * @page test_ws_002 Objects signaled by other threads
+ *
+ * <h2>Description</h2>
+ * Four threads make ready a different object of the set after an
+ * increasing delay, the tester thread waits on the set and is expected to
+ * be awakened once for each object in the order the objects are signaled.
+ */
+
+static msg_t thread2(void *p) {
+
+  chThdSleepMilliseconds(10 * (*(char *)p - 'A' + 1));
+  switch (*(char *)p) {
+  case 'A':
+    chSemSignal(&sem1);
+    break;
+  case 'B':
+    (void)chMBPost(&mb1, 'B', TIME_INFINITE);
+    break;
+  case 'C':
+    chSysLock();
+    (void)chIQPutI(&iq1, 'C');
+    chSchRescheduleS();
+    chSysUnlock();
+    break;
+  case 'D':
+    chEvtBroadcast(&es1);
+    break;
+  }
+  return 0;
+}
+
+static void ws2_execute(void) {
+  static const char tokens[] = "ABCD";
+  tprio_t prio = chThdGetPriority();
+  msg_t msg, mbmsg = 0;
+  int i;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio-1, thread2, "A");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio-1, thread2, "B");
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio-1, thread2, "C");
+  threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio-1, thread2, "D");
+  for (i = 0; i < 4; i++) {
+    msg = chWSWaitTimeout(&ws1, MS2ST(100));
+    if (msg == RDY_TIMEOUT)
+      break;
+    test_emit_token(tokens[msg]);
+    if (msg == 1)
+      mbmsg = chWSGetMessage(&ws1);
+    if (msg == 2)
+      (void)chIQGetTimeout(&iq1, TIME_IMMEDIATE);
+  }
+  test_wait_threads();
+  test_assert_sequence(1, "ABCD");
+  test_assert(2, mbmsg == 'B', "wrong message");
+}
+
+ROMCONST struct testcase testws2 = {
+  "Wait sets, objects signaled by other threads",
+  ws_setup,
+  ws_teardown,
+  ws2_execute
+};
+
+/**
+ * @page test_ws_003 Timeouts
+ *
+ * <h2>Description</h2>
+ * The tester thread waits on the set with a timeout while an higher
+ * priority thread signals and takes back the semaphore, the wait is
+ * expected to timeout at the initially specified time regardless of the
+ * wakeup not resulting in a ready object.
+ */
+
+static msg_t thread3(void *p) {
+
+  (void)p;
+  chThdSleepMilliseconds(20);
+  chSemSignal(&sem1);
+  chSemWait(&sem1);
+  return 0;
+}
+
+static void ws3_execute(void) {
+  systime_t target_time;
+  msg_t msg;
+
+  test_wait_tick();
+  target_time = chTimeNow() + MS2ST(50);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()+1,
+                                 thread3, NULL);
+  msg = chWSWaitTimeout(&ws1, MS2ST(50));
+  test_assert_time_window(1, target_time, target_time + ALLOWED_DELAY);
+  test_assert(2, msg == RDY_TIMEOUT, "wrong wait result");
+  test_wait_threads();
+}
+
+ROMCONST struct testcase testws3 = {
+  "Wait sets, timeouts",
+  ws_setup,
+  ws_teardown,
+  ws3_execute
+};
+
+#endif /* CH_USE_WAITSETS && CH_USE_MAILBOXES && CH_USE_QUEUES &&
+          CH_USE_EVENTS */
+
+/**
+ * @brief   Test sequence for wait sets.
+ */
+ROMCONST struct testcase * ROMCONST patternws[] = {
+#if (CH_USE_WAITSETS && CH_USE_MAILBOXES && CH_USE_QUEUES && CH_USE_EVENTS) || \
+    defined(__DOXYGEN__)
+  &testws1,
+  &testws2,
+  &testws3,
+#endif
+  NULL
+};
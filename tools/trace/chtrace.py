@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+#
+#    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+#
+
+"""Decoder for the ChibiOS/RT kernel events tracer dumps.
+
+A dump is a header written by chTraceWriteHeader() followed by the records
+written by chTraceDrain(). The decoder converts it into the Chrome trace
+event format, which can be loaded into chrome://tracing or ui.perfetto.dev,
+or into a plain text listing.
+
+Usage: chtrace.py [-t] [-o OUTPUT] DUMP
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+FORMAT_VERSION = 2
+HEADER_SIZE = 16
+NAME_SIZE = 16
+
+# Format of the object fields by size, they are as wide as a pointer.
+OBJ_FORMATS = {2: "H", 4: "I", 8: "Q"}
+
+EV_LOST = 0
+EV_SWITCH = 1
+EV_ISR_ENTER = 2
+EV_ISR_LEAVE = 3
+EV_SEM_WAIT = 4
+EV_SEM_SIGNAL = 5
+EV_MTX_LOCK = 6
+EV_MTX_UNLOCK = 7
+EV_QUEUE_PUT = 8
+EV_QUEUE_GET = 9
+EV_TIMER = 10
+EV_USER = 11
+
+EVENT_NAMES = {
+    EV_LOST: "lost",
+    EV_SWITCH: "switch",
+    EV_ISR_ENTER: "isr enter",
+    EV_ISR_LEAVE: "isr leave",
+    EV_SEM_WAIT: "sem wait",
+    EV_SEM_SIGNAL: "sem signal",
+    EV_MTX_LOCK: "mtx lock",
+    EV_MTX_UNLOCK: "mtx unlock",
+    EV_QUEUE_PUT: "queue put",
+    EV_QUEUE_GET: "queue get",
+    EV_TIMER: "timer",
+    EV_USER: "user",
+}
+
+# Same order as THD_STATE_NAMES in chthreads.h.
+STATE_NAMES = ["READY", "CURRENT", "SUSPENDED", "WTSEM", "WTMTX", "WTCOND",
+               "SLEEPING", "WTEXIT", "WTOREVT", "WTANDEVT", "SNDMSGQ",
+               "SNDMSG", "WTMSG", "WTQUEUE", "FINAL", "WTRWLOCK",
+               "WTSET"]
+
+# Track used for the ISRs in the timeline.
+ISR_TID = 0
+
+
+class DumpError(Exception):
+    pass
+
+
+class Record(object):
+    """A decoded trace record, time is in microseconds."""
+
+    def __init__(self, time, etype, info, prio, obj, arg):
+        self.time = time
+        self.type = etype
+        self.info = info
+        self.prio = prio
+        self.obj = obj
+        self.arg = arg
+
+
+def parse(data):
+    """Parses a dump, returns the threads names and the records list."""
+    if len(data) < HEADER_SIZE or data[0:4] != b"CHTR":
+        raise DumpError("not a trace dump")
+    if struct.unpack("<H", data[4:6])[0] == 0xFEFF:
+        endian = "<"
+    elif struct.unpack(">H", data[4:6])[0] == 0xFEFF:
+        endian = ">"
+    else:
+        raise DumpError("invalid byte order mark")
+    version, recsize, frequency, nthreads, objsize = struct.unpack(
+        endian + "BBIHB", data[6:15])
+    if version != FORMAT_VERSION:
+        raise DumpError("unsupported format version %d" % version)
+    if objsize not in OBJ_FORMATS:
+        raise DumpError("unsupported object size %d" % objsize)
+    objfmt = OBJ_FORMATS[objsize]
+    # The records end with padding up to the alignment of the object
+    # fields.
+    recfmt = endian + objfmt * 2 + "IIBBH"
+    if recsize < struct.calcsize(recfmt):
+        raise DumpError("unsupported record size %d" % recsize)
+    recfmt += "%dx" % (recsize - struct.calcsize(recfmt))
+    if frequency == 0:
+        raise DumpError("invalid timestamps frequency")
+
+    names = {}
+    pos = HEADER_SIZE
+    thdfmt = endian + objfmt + "%ds" % NAME_SIZE
+    thdsize = struct.calcsize(thdfmt)
+    for _ in range(nthreads):
+        obj, name = struct.unpack(thdfmt, data[pos:pos + thdsize])
+        if obj != 0:
+            names[obj] = name.split(b"\0")[0].decode("ascii", "replace")
+        pos += thdsize
+
+    records = []
+    last = None
+    ticks = 0
+    while pos + recsize <= len(data):
+        obj, arg, time, _, etype, info, prio = struct.unpack(
+            recfmt, data[pos:pos + recsize])
+        pos += recsize
+        # The timestamps counter wraps at 32 bits, the dump is assumed to
+        # be drained at least once per counter period. Records written
+        # concurrently can be slightly out of order so the difference is
+        # signed.
+        if last is not None:
+            delta = (time - last) & 0xFFFFFFFF
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            ticks += delta
+        last = time
+        records.append(Record(ticks * 1000000.0 / frequency,
+                              etype, info, prio, obj, arg))
+    return names, records
+
+
+def thread_name(names, obj):
+    return names.get(obj, "thd_%x" % obj)
+
+
+def to_text(names, records, out):
+    for r in records:
+        name = EVENT_NAMES.get(r.type, "type %d" % r.type)
+        if r.type == EV_SWITCH:
+            state = STATE_NAMES[r.info] if r.info < len(STATE_NAMES) \
+                else str(r.info)
+            detail = "%s -> %s (%s)" % (thread_name(names, r.arg),
+                                        thread_name(names, r.obj), state)
+        elif r.type == EV_LOST:
+            detail = "%d records" % r.arg
+        else:
+            detail = "obj=%x arg=%x info=%d" % (r.obj, r.arg, r.info)
+        out.write("%14.3f %4d %-10s %s\n" % (r.time, r.prio, name, detail))
+
+
+def to_chrome(names, records, out):
+    """Writes the Chrome trace event format, one track per thread."""
+    events = []
+    seen = set()
+    current = None
+    start = 0.0
+    isr_depth = 0
+
+    def track(obj):
+        if obj not in seen:
+            seen.add(obj)
+            events.append({"ph": "M", "name": "thread_name", "pid": 0,
+                           "tid": obj,
+                           "args": {"name": thread_name(names, obj)}})
+        return obj
+
+    for r in records:
+        if r.type == EV_SWITCH:
+            if current is None:
+                # The thread running before the first switch is known from
+                # the record itself.
+                current = r.arg
+                start = records[0].time
+            events.append({"ph": "X", "name": "running", "pid": 0,
+                           "tid": track(current), "ts": start,
+                           "dur": r.time - start})
+            current = r.obj
+            start = r.time
+        elif r.type == EV_ISR_ENTER:
+            isr_depth += 1
+            events.append({"ph": "B", "name": "ISR", "pid": 0,
+                           "tid": ISR_TID, "ts": r.time})
+        elif r.type == EV_ISR_LEAVE:
+            if isr_depth > 0:
+                isr_depth -= 1
+                events.append({"ph": "E", "name": "ISR", "pid": 0,
+                               "tid": ISR_TID, "ts": r.time})
+        elif r.type == EV_LOST:
+            events.append({"ph": "i", "s": "g", "name": "lost", "pid": 0,
+                           "tid": ISR_TID, "ts": r.time,
+                           "args": {"records": r.arg}})
+        else:
+            if isr_depth > 0 or current is None:
+                tid = ISR_TID
+            else:
+                tid = track(current)
+            events.append({"ph": "i", "s": "t",
+                           "name": EVENT_NAMES.get(r.type,
+                                                   "type %d" % r.type),
+                           "pid": 0, "tid": tid, "ts": r.time,
+                           "args": {"obj": "0x%x" % r.obj,
+                                    "arg": r.arg, "info": r.info,
+                                    "prio": r.prio}})
+    if current is not None and records:
+        events.append({"ph": "X", "name": "running", "pid": 0,
+                       "tid": track(current), "ts": start,
+                       "dur": records[-1].time - start})
+    events.append({"ph": "M", "name": "thread_name", "pid": 0,
+                   "tid": ISR_TID, "args": {"name": "ISR"}})
+    json.dump({"traceEvents": events, "displayTimeUnit": "ns"}, out)
+    out.write("\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Decodes a ChibiOS/RT kernel events trace dump.")
+    parser.add_argument("dump", help="binary dump file")
+    parser.add_argument("-o", "--output",
+                        help="output file, the default is stdout")
+    parser.add_argument("-t", "--text", action="store_true",
+                        help="plain text listing instead of JSON")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        data = f.read()
+    try:
+        names, records = parse(data)
+    except DumpError as e:
+        sys.stderr.write("%s: %s\n" % (args.dump, e))
+        return 1
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    try:
+        if args.text:
+            to_text(names, records, out)
+        else:
+            to_chrome(names, records, out)
+    finally:
+        if out is not sys.stdout:
+            out.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())